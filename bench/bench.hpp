@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal benchmark harness; each suite prints one JSON object to stdout.
+namespace bench {
+class suite final {
+public:
+    explicit suite(std::string_view name, unsigned repeat = 3) : name_(name), repeat_(repeat) {
+        if (auto env = std::getenv("BUSUTO_BENCH_SCALE"); env)
+            scale_ = std::max(1UL, std::strtoul(env, nullptr, 10));
+    }
+
+    suite(const suite&) = delete;
+    auto operator=(const suite&) -> auto& = delete;
+
+    ~suite() {
+        report();
+    }
+
+    auto scale(std::size_t ops) const noexcept {
+        return ops * scale_;
+    }
+
+    // Func performs ops operations; the best of repeated runs is kept. When
+    // bytes is given throughput is also reported in GB/s.
+    template <typename Func>
+    void run(std::string_view name, std::size_t ops, Func func, std::size_t bytes = 0) {
+        auto best = std::chrono::nanoseconds::max();
+        for (unsigned count = 0; count < repeat_; ++count) {
+            const auto start = std::chrono::steady_clock::now();
+            func(ops);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        }
+        results_.push_back({std::string(name), ops, bytes, best});
+    }
+
+    // Func performs and times one operation, returning its latency. The
+    // samples are reported as percentiles rather than a best run.
+    template <typename Func>
+    void sample(std::string_view name, std::size_t count, Func func) {
+        std::vector<std::chrono::nanoseconds> samples;
+        samples.reserve(count);
+        auto total = std::chrono::nanoseconds::zero();
+        for (std::size_t pos = 0; pos < count; ++pos) {
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(func()));
+            total += samples.back();
+        }
+        if (samples.empty()) return;
+        std::ranges::sort(samples);
+        const auto at = [&samples](double pct) {
+            return samples[std::min(samples.size() - 1, std::size_t(double(samples.size()) * pct))];
+        };
+        results_.push_back({std::string(name), count, 0, total, true, at(0.5), at(0.99), samples.back()});
+    }
+
+private:
+    struct result_t {
+        std::string name;
+        std::size_t ops{0};
+        std::size_t bytes{0};
+        std::chrono::nanoseconds elapsed{0};
+        bool latency{false};
+        std::chrono::nanoseconds p50{0}, p99{0}, max{0};
+    };
+
+    std::string name_;
+    unsigned repeat_{3};
+    std::size_t scale_{1};
+    std::vector<result_t> results_;
+
+    void report() const {
+        std::printf("{\"suite\":\"%s\",\"results\":[", name_.c_str());
+        const char *sep = "";
+        for (const auto& result : results_) {
+            const auto nsec = double(result.elapsed.count());
+            const auto ops = double(result.ops);
+            std::printf("%s\n  {\"name\":\"%s\",\"ops\":%zu,\"ns\":%.0f,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f",
+            sep, result.name.c_str(), result.ops, nsec, nsec / ops, nsec > 0 ? ops * 1e9 / nsec : 0.0);
+            if (result.latency)
+                std::printf(",\"p50_ns\":%lld,\"p99_ns\":%lld,\"max_ns\":%lld", (long long)result.p50.count(), (long long)result.p99.count(), (long long)result.max.count());
+            if (result.bytes)
+                std::printf(",\"gb_per_sec\":%.3f", nsec > 0 ? double(result.bytes) / nsec : 0.0);
+            std::printf("}");
+            sep = ",";
+        }
+        std::printf("\n]}\n");
+        std::fflush(stdout);
+    }
+};
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+} // namespace bench
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "binary.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+constexpr std::size_t payload = 1U << 20U;
+
+auto make_payload() {
+    std::vector<std::byte> data(payload);
+    uint32_t seed = 1;
+    for (auto& byte : data) {
+        seed = seed * 1103515245U + 12345U;
+        byte = std::byte(seed >> 16);
+    }
+    return data;
+}
+
+auto make_text(bool ascii) {
+    std::string text;
+    while (text.size() < payload)
+        text += ascii ? "The quick brown fox jumps over the lazy dog. " : "Grüße, 你好, привет, 😀 and plain ascii. ";
+    return text;
+}
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("codecs");
+    const auto data = make_payload();
+    const auto rounds = suite.scale(64);
+    const auto b64 = util::encode_b64(data);
+    const auto hex = util::encode_hex(data);
+    std::string text(b64.size(), '\0');
+    std::vector<std::byte> bytes(data.size());
+
+    suite.run("b64/encode", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::encode_b64(data, text)); }, rounds * payload);
+    suite.run("b64/encode_alloc", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::encode_b64(data).size()); }, rounds * payload);
+    suite.run("b64/decode", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::decode_b64(b64, bytes)); }, rounds * b64.size());
+    suite.run("hex/encode", rounds, [&](std::size_t ops) {
+        text.resize(hex.size());
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::encode_hex(data, text)); }, rounds * payload);
+    suite.run("hex/decode", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::decode_hex(hex, bytes)); }, rounds * hex.size());
+
+    const auto ascii = make_text(true);
+    const auto mixed = make_text(false);
+    suite.run("utf8/ascii", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::is_utf8(ascii)); }, rounds * ascii.size());
+    suite.run("utf8/mixed", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::is_utf8(mixed)); }, rounds * mixed.size());
+    suite.run("utf8/stream", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count) {
+            util::utf8_validator check;
+            for (std::size_t pos = 0; pos < mixed.size(); pos += 1000)
+                check.update(std::string_view(mixed).substr(pos, 1000));
+            bench::keep(check.complete());
+        } }, rounds * mixed.size());
+
+    suite.run("crc32c/frame", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::crc32c(data)); }, rounds * payload);
+    suite.run("hash64/frame", rounds, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::hash64(data)); }, rounds * payload);
+    const auto keys = rounds * 4096;
+    suite.run("hash64/key24", keys, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(util::hash64(data.data() + (count & 1023), 24)); });
+    suite.run("std_hash/key24", keys, [&](std::size_t ops) {
+        for (std::size_t count = 0; count < ops; ++count)
+            bench::keep(std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(data.data()) + (count & 1023), 24))); });
+    return 0;
+}
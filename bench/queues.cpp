@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "atomic.hpp"
+#include "pipeline.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+constexpr std::size_t depth = 1024;
+constexpr unsigned producers = 2, consumers = 2;
+
+template <typename Producer, typename Consumer>
+void spawn(unsigned writers, unsigned readers, Producer producer, Consumer consumer) {
+    std::vector<std::thread> threads;
+    for (unsigned id = 0; id < readers; ++id)
+        threads.emplace_back(consumer);
+    for (unsigned id = 0; id < writers; ++id)
+        threads.emplace_back(producer);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void mpmc_queue(std::size_t ops) {
+    atomic::queue_t<std::size_t, depth> queue;
+    std::atomic<std::size_t> taken{0};
+    spawn(producers, consumers, [&] {
+        for (std::size_t count = 0; count < ops / producers;) {
+            if (queue.push(count))
+                ++count;
+            else
+                std::this_thread::yield();
+        } }, [&] {
+        std::size_t item{};
+        while (taken.load(std::memory_order_relaxed) < ops) {
+            if (queue.try_pop(item)) {
+                bench::keep(item);
+                taken.fetch_add(1, std::memory_order_relaxed);
+            } else
+                std::this_thread::yield();
+        } });
+}
+
+void mpmc_batch(std::size_t ops) {
+    constexpr std::size_t batch = 32;
+    atomic::queue_t<std::size_t, depth> queue;
+    std::atomic<std::size_t> taken{0};
+    spawn(producers, consumers, [&] {
+        std::size_t items[batch]{};
+        for (std::size_t count = 0; count < ops / producers;) {
+            const auto sent = queue.push_n(&items[0], std::min(batch, ops / producers - count));
+            if (!sent) std::this_thread::yield();
+            count += sent;
+        } }, [&] {
+        std::size_t items[batch];
+        while (taken.load(std::memory_order_relaxed) < ops) {
+            const auto count = queue.pop_n(&items[0], batch);
+            if (!count) std::this_thread::yield();
+            bench::keep(items);
+            taken.fetch_add(count, std::memory_order_relaxed);
+        } });
+}
+
+void mpmc_pipeline(std::size_t ops) {
+    system::pipeline<std::size_t, depth> queue;
+    std::atomic<std::size_t> taken{0};
+    std::atomic<unsigned> active{producers};
+    spawn(producers, consumers, [&] {
+        for (std::size_t count = 0; count < ops / producers; ++count)
+            queue.push(count);
+        if (--active == 0) {
+            while (!queue.empty())
+                std::this_thread::yield();
+            queue.close();
+        } }, [&] {
+        std::size_t item{};
+        while (queue.pull(item)) {
+            bench::keep(item);
+            taken.fetch_add(1, std::memory_order_relaxed);
+        } });
+}
+
+void mpmc_pipeline_batch(std::size_t ops) {
+    constexpr std::size_t batch = 32;
+    system::pipeline<std::size_t, depth> queue;
+    std::atomic<unsigned> active{producers};
+    spawn(producers, consumers, [&] {
+        std::size_t items[batch]{};
+        for (std::size_t count = 0; count < ops / producers;) {
+            const auto size = std::min(batch, ops / producers - count);
+            count += queue.push_range(&items[0], &items[size]);
+        }
+        if (--active == 0) {
+            while (!queue.empty())
+                std::this_thread::yield();
+            queue.close();
+        } }, [&] {
+        std::size_t items[batch];
+        while (queue) {
+            bench::keep(items);
+            queue.pull_batch(&items[0], batch);
+        } });
+}
+
+template <typename Queue>
+void spsc(std::size_t ops) {
+    Queue queue;
+    spawn(1, 1, [&] {
+        for (std::size_t count = 0; count < ops;) {
+            if (queue.push(count))
+                ++count;
+            else
+                std::this_thread::yield();
+        } }, [&] {
+        std::size_t item{};
+        for (std::size_t count = 0; count < ops;) {
+            if (queue.try_pop(item)) {
+                bench::keep(item);
+                ++count;
+            } else
+                std::this_thread::yield();
+        } });
+}
+
+void spsc_bulk(std::size_t ops) {
+    constexpr std::size_t batch = 32;
+    atomic::buffer_t<std::size_t, depth> buffer;
+    spawn(1, 1, [&] {
+        std::size_t items[batch]{};
+        for (std::size_t count = 0; count < ops;) {
+            const auto sent = buffer.push_bulk(&items[0], std::min(batch, ops - count));
+            if (!sent) std::this_thread::yield();
+            count += sent;
+        } }, [&] {
+        std::size_t items[batch];
+        for (std::size_t count = 0; count < ops;) {
+            const auto taken = buffer.pull_bulk(&items[0], batch);
+            if (!taken) std::this_thread::yield();
+            bench::keep(items);
+            count += taken;
+        } });
+}
+
+// Adapts buffer_t to the queue_t consumer interface for the spsc runs.
+struct spsc_buffer final {
+    atomic::buffer_t<std::size_t, depth> buffer;
+    auto push(std::size_t item) noexcept { return buffer.push(item); }
+    auto try_pop(std::size_t& item) noexcept { return buffer.pull(item); }
+};
+
+// Pushes and pulls from every thread, so the stack stays shallow.
+void mpmc_stack(std::size_t ops) {
+    atomic::stack_t<std::size_t, depth> stack;
+    spawn(producers + consumers, 0, [&] {
+        std::size_t item{};
+        for (std::size_t count = 0; count < ops / (producers + consumers); ++count) {
+            while (!stack.push(count))
+                std::this_thread::yield();
+            if (stack.pull(item))
+                bench::keep(item);
+        } }, [] {});
+}
+
+// Read-mostly lookups while one writer keeps updating.
+void dictionary_mixed(std::size_t ops) {
+    constexpr std::size_t keys = 4096;
+    atomic::dictionary_t<std::size_t, std::size_t> dict;
+    for (std::size_t key = 0; key < keys; ++key)
+        dict.insert(key, key);
+    std::atomic<bool> done{false};
+    spawn(1, consumers + 1, [&] {
+        for (std::size_t count = 0; !done.load(std::memory_order_relaxed); ++count)
+            dict.insert_or_assign(count % keys, count); }, [&] {
+        for (std::size_t count = 0; count < ops / (consumers + 1); ++count)
+            bench::keep(dict.find((count * 7919) % keys));
+        done.store(true, std::memory_order_relaxed); });
+}
+
+void dictionary_insert(std::size_t ops) {
+    atomic::dictionary_t<std::size_t, std::size_t> dict;
+    for (std::size_t count = 0; count < ops; ++count)
+        dict.insert(count, count);
+    bench::keep(dict.size());
+}
+
+struct spsc_queue final {
+    atomic::queue_t<std::size_t, depth> queue;
+    auto push(std::size_t item) noexcept { return queue.push(std::move(item)); }
+    auto try_pop(std::size_t& item) noexcept { return queue.try_pop(item); }
+};
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("queues");
+    const auto ops = suite.scale(1U << 20U);
+    suite.run("mpmc/queue_t", ops, mpmc_queue);
+    suite.run("mpmc/queue_t/batch", ops, mpmc_batch);
+    suite.run("mpmc/pipeline", ops, mpmc_pipeline);
+    suite.run("mpmc/pipeline/batch", ops, mpmc_pipeline_batch);
+    suite.run("spsc/buffer_t", ops, spsc<spsc_buffer>);
+    suite.run("spsc/buffer_t/bulk", ops, spsc_bulk);
+    suite.run("spsc/queue_t", ops, spsc<spsc_queue>);
+    suite.run("mpmc/stack_t", ops, mpmc_stack);
+    suite.run("dictionary_t/insert", ops / 4, dictionary_insert);
+    suite.run("dictionary_t/mixed", ops, dictionary_mixed);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "service.hpp"
+#include "sync.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace busuto;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr std::size_t workers = 4;
+
+template <typename Dispatcher>
+void wait_for(Dispatcher& dispatcher, std::atomic<std::size_t>& done, std::size_t ops) {
+    for (std::size_t count = 0; count < ops;) {
+        if (dispatcher.dispatch([&done] { done.fetch_add(1, std::memory_order_relaxed); }))
+            ++count;
+        else
+            std::this_thread::yield();
+    }
+    while (done.load(std::memory_order_acquire) < ops)
+        std::this_thread::yield();
+}
+
+template <service::pool::mode_t Mode>
+void pool_dispatch(std::size_t ops) {
+    std::atomic<std::size_t> done{0};
+    service::pool pool(workers, Mode);
+    wait_for(pool, done, ops);
+}
+
+// Tasks fanned out from inside workers, which is where stealing helps. Only
+// children the pool accepted are waited for.
+template <service::pool::mode_t Mode>
+void pool_fanout(std::size_t ops) {
+    constexpr std::size_t fanout = 16;
+    std::atomic<std::size_t> done{0}, accepted{0}, parents{0};
+    service::pool pool(workers, Mode);
+    for (std::size_t count = 0; count < ops / fanout;) {
+        const auto sent = pool.dispatch([&pool, &done, &accepted, &parents] {
+            for (std::size_t child = 0; child < fanout; ++child) {
+                if (pool.dispatch([&done] { done.fetch_add(1, std::memory_order_relaxed); }))
+                    accepted.fetch_add(1, std::memory_order_relaxed);
+            }
+            parents.fetch_add(1, std::memory_order_release);
+        });
+        if (sent)
+            ++count;
+        else
+            std::this_thread::yield();
+    }
+    while (parents.load(std::memory_order_acquire) < ops / fanout || done.load(std::memory_order_acquire) < accepted.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+}
+
+void tasks_dispatch(std::size_t ops) {
+    std::atomic<std::size_t> done{0};
+    service::tasks queue;
+    queue.startup();
+    wait_for(queue, done, ops);
+    queue.shutdown();
+}
+
+// Fan-out tasks each releasing one count of a shared group.
+void group_release(std::size_t ops) {
+    sync::wait_group group(unsigned(ops / workers * workers));
+    std::vector<std::thread> threads;
+    for (std::size_t thread = 0; thread < workers; ++thread) {
+        threads.emplace_back([&group, ops] {
+            for (std::size_t count = 0; count < ops / workers; ++count)
+                (void)group.release();
+        });
+    }
+    group.wait();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+// Time from dispatch until the task starts running.
+template <typename Dispatcher>
+auto latency(Dispatcher& dispatcher) {
+    std::atomic<clock_type::rep> ran{0};
+    const auto start = clock_type::now();
+    dispatcher.dispatch([&ran] { ran.store(clock_type::now().time_since_epoch().count(), std::memory_order_release); });
+    clock_type::rep when{0};
+    while (!(when = ran.load(std::memory_order_acquire)))
+        std::this_thread::yield();
+    return clock_type::time_point(clock_type::duration(when)) - start;
+}
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("services");
+    const auto ops = suite.scale(1U << 18U);
+    const auto samples = suite.scale(10000);
+    suite.run("pool/shared/dispatch", ops, pool_dispatch<service::pool::shared>);
+    suite.run("pool/stealing/dispatch", ops, pool_dispatch<service::pool::stealing>);
+    suite.run("pool/shared/fanout", ops, pool_fanout<service::pool::shared>);
+    suite.run("pool/stealing/fanout", ops, pool_fanout<service::pool::stealing>);
+    suite.run("tasks/dispatch", ops, tasks_dispatch);
+    suite.run("wait_group/release", ops, group_release);
+
+    service::pool shared(workers, service::pool::shared);
+    suite.sample("pool/shared/latency", samples, [&shared] { return latency(shared); });
+    service::pool stealing(workers, service::pool::stealing);
+    suite.sample("pool/stealing/latency", samples, [&stealing] { return latency(stealing); });
+    service::tasks queue;
+    queue.startup();
+    suite.sample("tasks/latency", samples, [&queue] { return latency(queue); });
+    queue.shutdown();
+    return 0;
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "streams.hpp"
+
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+
+using namespace busuto;
+
+namespace {
+constexpr std::size_t chunk = 4096;
+
+// Reads everything the writer sends so the socketpair never backs up.
+auto drain(int fd) {
+    return std::thread([fd] {
+        char buf[65536];
+        while (::read(fd, buf, sizeof(buf)) > 0)
+            ;
+        ::close(fd);
+    });
+}
+
+template <typename Stream, typename Writer>
+void pump(std::size_t ops, Writer writer) {
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair)) return;
+    auto reader = drain(pair[1]);
+    {
+        Stream stream(pair[0]);
+        writer(stream, ops);
+        stream.flush();
+    }
+    reader.join();
+}
+
+void small_writes(std::size_t ops) {
+    pump<system_stream<8192>>(ops, [](auto& stream, std::size_t count) {
+        const std::string line(64, 'x');
+        while (count--)
+            stream.write(line.data(), std::streamsize(line.size()));
+    });
+}
+
+void pooled_writes(std::size_t ops) {
+    pump<pooled_stream>(ops, [](auto& stream, std::size_t count) {
+        const std::string line(64, 'x');
+        while (count--)
+            stream.write(line.data(), std::streamsize(line.size()));
+    });
+}
+
+void large_writes(std::size_t ops) {
+    pump<system_stream<1024>>(ops, [](auto& stream, std::size_t count) {
+        const std::string body(chunk, 'x');
+        while (count--)
+            stream.write(body.data(), std::streamsize(body.size()));
+    });
+}
+
+void gathered_writes(std::size_t ops) {
+    pump<system_stream<1024>>(ops, [](auto& stream, std::size_t count) {
+        const std::string head(64, 'h'), body(chunk - 64, 'x');
+        while (count--)
+            stream.writev(std::string_view(head), std::string_view(body));
+    });
+}
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("streams");
+    const auto ops = suite.scale(1U << 16U);
+    suite.run("socketpair/write64", ops * 16, small_writes, ops * 16 * 64);
+    suite.run("socketpair/pooled64", ops * 16, pooled_writes, ops * 16 * 64);
+    suite.run("socketpair/write4k", ops, large_writes, ops * chunk);
+    suite.run("socketpair/writev4k", ops, gathered_writes, ops * chunk);
+    return 0;
+}
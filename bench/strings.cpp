@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "strings.hpp"
+#include "buffer.hpp"
+#include "scan.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+constexpr std::string_view header = "GET /api/v1/metrics?name=cpu HTTP/1.1";
+constexpr std::string_view command = "set key 'quoted value here' {block of text} 42";
+constexpr std::string_view metric = "host,region,cpu,0.25,0.50,0.75,1.00,idle";
+constexpr std::string_view sample = "1718040000,eu-west,4096,123456789,0.875,42";
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("strings");
+    const auto ops = suite.scale(1U << 20U);
+    suite.run("split/string", ops, [](std::size_t count) {
+        while (count--)
+            bench::keep(strings::split(std::string(metric), ",").size());
+    }, ops * metric.size());
+    suite.run("split/view", ops, [](std::size_t count) {
+        while (count--)
+            bench::keep(strings::split<std::string_view>(metric, ",").size());
+    }, ops * metric.size());
+    suite.run("split_view", ops, [](std::size_t count) {
+        while (count--) {
+            std::size_t fields{0};
+            for (auto field : strings::split_view(metric, ","))
+                fields += field.size();
+            bench::keep(fields);
+        }
+    }, ops * metric.size());
+    suite.run("split_into", ops, [](std::size_t count) {
+        std::array<std::string_view, 3> fields;
+        while (count--) {
+            bench::keep(strings::split_into(header, fields));
+            bench::keep(fields);
+        }
+    }, ops * header.size());
+    suite.run("tokenize/string", ops, [](std::size_t count) {
+        while (count--)
+            bench::keep(strings::tokenize(std::string(command)).size());
+    }, ops * command.size());
+    suite.run("tokenize_view", ops, [](std::size_t count) {
+        while (count--) {
+            std::size_t tokens{0};
+            for (auto token : strings::tokenize_view(command))
+                tokens += token.size();
+            bench::keep(tokens);
+        }
+    }, ops * command.size());
+
+    const auto fields = strings::split(std::string(metric), ",");
+    suite.run("join", ops, [&fields](std::size_t count) {
+        while (count--)
+            bench::keep(strings::join(fields).size());
+    }, ops * metric.size());
+    suite.run("join_to", ops, [&fields](std::size_t count) {
+        std::string line;
+        while (count--) {
+            line.clear();
+            bench::keep(strings::join_to(line, fields).size());
+        }
+    }, ops * metric.size());
+
+    // http style headers framed by crlf, scanned as one input buffer
+    std::string headers;
+    while (headers.size() < 4096)
+        headers += "X-Forwarded-For: 192.168.100.200, 10.0.0.1\r\n";
+    suite.run("input_buffer/getview", ops / 64, [&headers](std::size_t count) {
+        while (count--) {
+            input_buffer input(headers.data(), headers.size());
+            std::size_t lines{0};
+            while (!input.getview().empty())
+                ++lines;
+            bench::keep(lines);
+        }
+    }, (ops / 64) * headers.size());
+
+    suite.run("parse/fields", ops, [](std::size_t count) {
+        while (count--) {
+            std::array<std::string_view, 6> parts;
+            strings::split_into(sample, parts, ",");
+            bench::keep(parse_unsigned<uint64_t>(parts[0]) + parse_unsigned(parts[2]) + parse_unsigned<uint64_t>(parts[3]) + parse_decimal(parts[4]) + parse_integer(parts[5], -100, 100));
+        }
+    }, ops * sample.size());
+    suite.run("parse_record", ops, [](std::size_t count) {
+        uint64_t time{0}, bytes{0};
+        std::string_view region;
+        unsigned size{0};
+        double ratio{0};
+        int delta{0};
+        while (count--) {
+            bench::keep(bool(parse_record(sample, ',', time, region, size, bytes, ratio, delta)));
+            bench::keep(time + size + bytes + ratio + delta);
+        }
+    }, ops * sample.size());
+    return 0;
+}
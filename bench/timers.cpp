@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "bench.hpp"
+#include "service.hpp"
+
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+constexpr std::size_t connections = 50000;
+
+// Idle timeouts armed per connection, refreshed for every packet.
+template <typename Timer>
+void refresh(std::size_t ops) {
+    Timer timer;
+    std::vector<typename Timer::id_t> ids;
+    ids.reserve(connections);
+    for (std::size_t count = 0; count < connections; ++count)
+        ids.push_back(timer.periodic(std::chrono::seconds(30) + std::chrono::milliseconds(count % 1000), [] {}));
+    for (std::size_t count = 0; count < ops; ++count)
+        timer.refresh(ids[(count * 7919) % connections]);
+    for (auto id : ids)
+        timer.cancel(id);
+}
+
+template <typename Timer>
+void churn(std::size_t ops) {
+    Timer timer;
+    for (std::size_t count = 0; count < ops; ++count) {
+        auto id = timer.once(std::chrono::milliseconds(100 + count % 5000), [] {});
+        if (count % 2)
+            timer.cancel(id);
+    }
+    timer.clear();
+}
+} // namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    bench::suite suite("timers");
+    const auto ops = suite.scale(1U << 20U);
+    suite.run("refresh/tree", ops, refresh<service::timer>);
+    suite.run("refresh/wheel", ops, refresh<service::wheel_timer>);
+    suite.run("arm_cancel/tree", ops / 4, churn<service::timer>);
+    suite.run("arm_cancel/wheel", ops / 4, churn<service::wheel_timer>);
+    return 0;
+}
@@ -0,0 +1,356 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "reactor.hpp"
+#include "resolver.hpp"
+#include "pipeline.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <future>
+#include <stdexcept>
+#include <variant>
+
+namespace busuto::async {
+template <typename T = void>
+class task;
+
+template <typename Executor>
+concept executor = requires(Executor& exec, service::task_t task) {
+    { exec.dispatch(std::move(task)) } -> std::convertible_to<bool>;
+};
+
+namespace detail {
+inline std::atomic<service::error_t> failures{nullptr};
+
+class promise_base {
+public:
+    struct final_awaiter {
+        auto await_ready() const noexcept { return false; }
+        void await_resume() const noexcept {}
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> self) noexcept -> std::coroutine_handle<> {
+            auto& promise = self.promise();
+            if (promise.continuation_) return promise.continuation_;
+            if (promise.detached_) self.destroy();
+            return std::noop_coroutine();
+        }
+    };
+
+    auto initial_suspend() const noexcept { return std::suspend_always{}; }
+    auto final_suspend() const noexcept { return final_awaiter{}; }
+
+    void unhandled_exception() noexcept {
+        if (!detached_) {
+            error_ = std::current_exception();
+            return;
+        }
+
+        auto handler = failures.load(std::memory_order_acquire);
+        if (!handler) std::terminate();
+        try {
+            throw;
+        } catch (const std::exception& e) {
+            handler(e);
+        } catch (...) {
+            handler(std::runtime_error("detached task failed"));
+        }
+    }
+
+    void follow(std::coroutine_handle<> next) noexcept { continuation_ = next; }
+    void detach() noexcept { detached_ = true; }
+
+protected:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr error_;
+    bool detached_{false};
+
+    void rethrow() const {
+        if (error_) std::rethrow_exception(error_);
+    }
+};
+
+template <typename T>
+class promise final : public promise_base {
+public:
+    auto get_return_object() noexcept -> task<T>;
+
+    template <typename U>
+    requires std::convertible_to<U, T>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    auto result() -> T {
+        rethrow();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class promise<void> final : public promise_base {
+public:
+    auto get_return_object() noexcept -> task<void>;
+    void return_void() const noexcept {}
+
+    void result() const {
+        rethrow();
+    }
+};
+} // namespace detail
+
+// Lazily started coroutine. Awaiting a task starts it and resumes the
+// awaiter when it finishes; detach() runs one that nobody awaits.
+template <typename T>
+class [[nodiscard]] task final {
+public:
+    using promise_type = detail::promise<T>;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+    explicit task(handle_t handle) noexcept : handle_(handle) {}
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    task(const task&) = delete;
+    auto operator=(const task&) -> task& = delete;
+
+    auto operator=(task&& other) noexcept -> task& {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~task() {
+        if (handle_) handle_.destroy();
+    }
+
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+    auto operator!() const noexcept { return handle_ == nullptr; }
+
+    auto done() const noexcept {
+        return !handle_ || handle_.done();
+    }
+
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            handle_t handle;
+
+            auto await_ready() const noexcept { return !handle || handle.done(); }
+
+            auto await_suspend(std::coroutine_handle<> caller) noexcept -> std::coroutine_handle<> {
+                handle.promise().follow(caller);
+                return handle;
+            }
+
+            auto await_resume() -> T {
+                if (!handle) throw invalid("Empty task");
+                return handle.promise().result();
+            }
+        };
+        return awaiter{handle_};
+    }
+
+    // Starts the task; its frame is released when it completes.
+    void detach() {
+        if (!handle_) return;
+        auto handle = std::exchange(handle_, nullptr);
+        handle.promise().detach();
+        handle.resume();
+    }
+
+private:
+    handle_t handle_;
+};
+
+template <typename T>
+inline auto detail::promise<T>::get_return_object() noexcept -> task<T> {
+    return task<T>{std::coroutine_handle<promise>::from_promise(*this)};
+}
+
+inline auto detail::promise<void>::get_return_object() noexcept -> task<void> {
+    return task<void>{std::coroutine_handle<promise>::from_promise(*this)};
+}
+
+// Exceptions escaping a detached task have no awaiter to receive them, so
+// they are passed here. With no handler they terminate, as an exception
+// escaping a thread would.
+inline void errors(service::error_t handler) noexcept {
+    detail::failures.store(handler, std::memory_order_release);
+}
+
+namespace detail {
+template <typename T>
+inline auto waiter(task<T> work, std::promise<T>& result) -> task<> {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(work);
+            result.set_value();
+        } else
+            result.set_value(co_await std::move(work));
+    } catch (...) {
+        result.set_exception(std::current_exception());
+    }
+}
+} // namespace detail
+
+// Runs a task from ordinary code, blocking until it finishes.
+template <typename T>
+inline auto sync_wait(task<T> work) -> T {
+    std::promise<T> result;
+    auto pending = result.get_future();
+    detail::waiter(std::move(work), result).detach();
+    return pending.get();
+}
+
+// Continues the coroutine on an executor such as service::pool or tasks.
+template <executor Executor>
+inline auto resume_on(Executor& exec) noexcept {
+    struct awaiter {
+        Executor& exec;
+
+        auto await_ready() const noexcept { return false; }
+        void await_resume() const noexcept {}
+
+        auto await_suspend(std::coroutine_handle<> handle) noexcept -> bool {
+            try {
+                return exec.dispatch([handle] { handle.resume(); });
+            } catch (...) {
+                return false;
+            }
+        }
+    };
+    return awaiter{exec};
+}
+
+// Waits for descriptor readiness through a reactor and returns the events,
+// which include reactor::expired if the timeout passed first.
+inline auto ready(service::reactor& loop, int fd, unsigned events, const service::reactor::period_t& timeout = service::reactor::period_t(0)) noexcept {
+    struct awaiter {
+        service::reactor& loop;
+        int fd;
+        unsigned events;
+        service::reactor::period_t timeout;
+        unsigned result{0};
+
+        auto await_ready() const noexcept { return false; }
+        auto await_resume() const noexcept { return result; }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> bool {
+            // nothing here may touch the awaiter once added, since the
+            // callback can resume and finish the coroutine at once.
+            auto self = this;
+            if (loop.add(fd, events, [self, handle](int ready, unsigned revents) {
+                    self->result = revents;
+                    self->loop.remove(ready);
+                    handle.resume();
+                },
+                timeout))
+                return true;
+            result = service::reactor::failed;
+            return false;
+        }
+    };
+    return awaiter{loop, fd, events, timeout};
+}
+
+inline auto readable(service::reactor& loop, int fd, const service::reactor::period_t& timeout = service::reactor::period_t(0)) noexcept {
+    return ready(loop, fd, service::reactor::readable, timeout);
+}
+
+inline auto writable(service::reactor& loop, int fd, const service::reactor::period_t& timeout = service::reactor::period_t(0)) noexcept {
+    return ready(loop, fd, service::reactor::writable, timeout);
+}
+
+// Suspends for a period using a service timer, resuming on the timer
+// thread, or on an executor when one is given. A sleep still pending when
+// the timer is shut down, cleared or destroyed is never resumed, so its
+// frame and anything awaiting it stay suspended; let sleeps finish before
+// stopping the timer. Failing to arm the timer throws from the co_await.
+template <typename Timer>
+inline auto sleep(Timer& timer, const std::chrono::milliseconds& period) {
+    struct awaiter {
+        Timer& timer;
+        std::chrono::milliseconds period;
+
+        auto await_ready() const noexcept { return period.count() <= 0; }
+        void await_resume() const noexcept {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            timer.once(period, [handle] { handle.resume(); });
+        }
+    };
+    return awaiter{timer, period};
+}
+
+template <typename Timer, executor Executor>
+inline auto sleep(Timer& timer, const std::chrono::milliseconds& period, Executor& exec) {
+    struct awaiter {
+        Timer& timer;
+        std::chrono::milliseconds period;
+        Executor& exec;
+
+        auto await_ready() const noexcept { return period.count() <= 0; }
+        void await_resume() const noexcept {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            auto& target = exec;
+            timer.once(period, [handle, &target] {
+                if (!target.dispatch([handle] { handle.resume(); }))
+                    handle.resume();
+            });
+        }
+    };
+    return awaiter{timer, period, exec};
+}
+
+// Takes the next item from a notify pipeline, waiting on its event handle
+// through the reactor; the result is empty if the pipeline closed. Only
+// one coroutine should wait on a given pipeline at a time. Closing does
+// not signal the handle, so waits are sliced to notice a closed pipeline.
+template <typename T, std::size_t S>
+inline auto pull(service::reactor& loop, system::notify_pipeline<T, S>& from, const service::reactor::period_t& slice = service::reactor::period_t(100)) -> task<std::optional<T>> {
+    T item{};
+    for (;;) {
+        if (from.try_pull(item)) co_return std::optional<T>(std::move(item));
+        if (!from.is_open()) co_return std::optional<T>{};
+        if (co_await readable(loop, from.handle(), slice) & service::reactor::failed) co_return std::optional<T>{};
+    }
+}
+
+// Resolves a name on an executor instead of a dedicated thread, resuming
+// on the worker that did the lookup.
+template <executor Executor>
+inline auto resolve(Executor& exec, socket::name_t name, int family = AF_UNSPEC, int type = SOCK_STREAM, int protocol = 0) noexcept {
+    struct awaiter {
+        Executor& exec;
+        socket::name_t name;
+        int family, type, protocol;
+        socket::service result;
+
+        auto await_ready() const noexcept { return false; }
+        auto await_resume() noexcept { return std::move(result); }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> bool {
+            auto self = this;
+            if (exec.dispatch([self, handle] {
+                    self->result = socket::lookup(self->name, self->family, self->type, self->protocol);
+                    handle.resume();
+                }))
+                return true;
+            result = socket::lookup(name, family, type, protocol);
+            return false;
+        }
+    };
+    return awaiter{exec, std::move(name), family, type, protocol, {}};
+}
+} // namespace busuto::async
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "atomic.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+struct record_t {
+    std::atomic<std::uint64_t> epoch{0}; // zero while quiescent
+    std::atomic<bool> used{true};
+    record_t *next{nullptr};
+    unsigned depth{0};
+};
+
+struct retired_t {
+    void *ptr;
+    void (*release)(void *);
+    std::uint64_t epoch;
+};
+
+constexpr std::size_t reclaim_interval = 64;
+
+std::atomic<std::uint64_t> global_epoch{1};
+std::atomic<record_t *> records{nullptr};
+std::mutex orphan_lock;
+
+// Retired objects left behind by exited threads; intentionally never freed
+// so late thread exits during shutdown remain safe.
+auto orphans() -> std::vector<retired_t>& {
+    static auto *list = new std::vector<retired_t>(); // NOLINT
+    return *list;
+}
+
+auto acquire_record() -> record_t * {
+    for (auto rec = records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+        auto expected = false;
+        if (!rec->used.load(std::memory_order_relaxed) && rec->used.compare_exchange_strong(expected, true))
+            return rec;
+    }
+
+    auto rec = new record_t(); // NOLINT
+    auto head = records.load(std::memory_order_relaxed);
+    do { // NOLINT
+        rec->next = head;
+    } while (!records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+    return rec;
+}
+
+// Advance the global epoch if every active thread has seen the current one.
+auto try_advance() noexcept -> std::uint64_t {
+    auto current = global_epoch.load();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto rec = records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+        const auto seen = rec->epoch.load();
+        if (seen != 0 && seen != current) return current;
+    }
+
+    if (global_epoch.compare_exchange_strong(current, current + 1)) return current + 1;
+    return current;
+}
+
+auto release(std::vector<retired_t>& list, std::uint64_t safe) noexcept {
+    std::size_t kept = 0, freed = 0;
+    for (auto& item : list) {
+        if (item.epoch + 2 <= safe) {
+            item.release(item.ptr);
+            ++freed;
+        } else
+            list[kept++] = item;
+    }
+    list.resize(kept);
+    return freed;
+}
+
+struct local_t final {
+    record_t *rec{nullptr};
+    std::vector<retired_t> limbo;
+
+    local_t() = default;
+    local_t(const local_t&) = delete;
+    auto operator=(const local_t&) -> local_t& = delete;
+
+    ~local_t() {
+        if (rec) {
+            rec->epoch.store(0);
+            rec->depth = 0;
+            rec->used.store(false, std::memory_order_release);
+        }
+
+        try_advance();
+        release(limbo, try_advance());
+        if (!limbo.empty()) {
+            const std::lock_guard lock(orphan_lock);
+            orphans().insert(orphans().end(), limbo.begin(), limbo.end());
+        }
+    }
+
+    auto record() -> record_t& {
+        if (!rec) rec = acquire_record();
+        return *rec;
+    }
+};
+
+thread_local local_t local;
+} // namespace
+
+void atomic::epoch::enter() noexcept {
+    auto& rec = local.record();
+    if (rec.depth++ == 0) {
+        rec.epoch.store(global_epoch.load());
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void atomic::epoch::leave() noexcept {
+    auto& rec = local.record();
+    if (rec.depth && --rec.depth == 0)
+        rec.epoch.store(0, std::memory_order_release);
+}
+
+void atomic::epoch::retire(void *ptr, void (*release)(void *)) {
+    local.limbo.push_back({ptr, release, global_epoch.load()});
+    if (local.limbo.size() % reclaim_interval == 0)
+        reclaim();
+}
+
+void atomic::epoch::reclaim() noexcept {
+    const auto safe = try_advance();
+    release(local.limbo, safe);
+    if (orphan_lock.try_lock()) {
+        release(orphans(), safe);
+        orphan_lock.unlock();
+    }
+}
+
+void atomic::epoch::synchronize() {
+    if (local.rec && local.rec->depth)
+        throw invalid("Epoch synchronize inside guard");
+
+    const auto target = global_epoch.load() + 2;
+    while (try_advance() < target)
+        std::this_thread::yield();
+
+    release(local.limbo, target);
+    const std::lock_guard lock(orphan_lock);
+    release(orphans(), target);
+}
+
+auto atomic::epoch::pending() noexcept -> std::size_t {
+    return local.limbo.size();
+}
@@ -5,11 +5,26 @@
 
 #include "common.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <optional>
+#include <limits>
 #include <list>
+#include <memory>
+#include <new>
+
+#ifndef BUSUTO_CACHE_LINE
+#define BUSUTO_CACHE_LINE 64 // NOLINT
+#endif
 
 namespace busuto::atomic {
+inline constexpr std::size_t cache_line = BUSUTO_CACHE_LINE;
+
 template <typename T = unsigned>
 requires std::is_unsigned_v<T>
 class sequence_t final {
@@ -101,8 +116,7 @@ public:
     auto size() const noexcept -> std::size_t {
         auto count = count_.load();
         if (count < 0) return std::size_t(0);
-        if (count > S) return S;
-        return count;
+        return std::min(std::size_t(count), S);
     }
 
     auto empty() const noexcept {
@@ -110,12 +124,13 @@ public:
     }
 
     auto full() const noexcept {
-        return count_.load() >= S;
+        return count_.load() >= int(S);
     }
 
     auto push(const T& item) noexcept {
+        // a count left negative by a racing pull is refused like a full one
         const auto count = count_.fetch_add(1);
-        if (count >= S) {
+        if (count < 0 || std::size_t(count) >= S) {
             count_.fetch_sub(1);
             return false;
         }
@@ -144,11 +159,15 @@ public:
 
 private:
     static_assert(S > 2, "Queue size must be bigger than 2");
+    static_assert(S <= std::size_t(std::numeric_limits<int>::max()), "Queue size must fit an int count");
 
     std::atomic<int> count_{0};
     T data_[S];
 };
 
+// Single-producer/single-consumer ring. Each side keeps its index on its own
+// cache line along with a cached copy of the other side's index, so the
+// shared index is only re-read when the cached view says full or empty.
 template <typename T, std::size_t S>
 class buffer_t final {
 public:
@@ -157,114 +176,399 @@ public:
     auto operator=(const buffer_t&) -> auto& = delete;
 
     explicit operator bool() const noexcept {
-        const auto head = head_.load(std::memory_order_relaxed);
-        const auto tail = tail_.load(std::memory_order_relaxed);
-        return head != tail;
+        return !empty();
     }
 
     auto operator!() const noexcept {
-        const auto head = head_.load(std::memory_order_relaxed);
-        const auto tail = tail_.load(std::memory_order_relaxed);
-        return head == tail;
+        return empty();
     }
 
-    auto operator*() noexcept {
+    auto operator*() {
         return pop();
     }
 
-    auto operator<=(const T& item) noexcept {
+    auto operator<=(const T& item) {
         return push(item);
     }
 
     auto empty() const noexcept {
-        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_relaxed);
+        return head_.pos.load(std::memory_order_relaxed) == tail_.pos.load(std::memory_order_relaxed);
+    }
+
+    auto full() const noexcept {
+        return next(tail_.pos.load(std::memory_order_relaxed)) == head_.pos.load(std::memory_order_acquire);
+    }
+
+    auto size() const noexcept -> std::size_t {
+        const auto head = head_.pos.load(std::memory_order_acquire);
+        const auto tail = tail_.pos.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : S - head + tail;
     }
 
-    auto full() noexcept {
-        const auto tail = tail_.load(std::memory_order_relaxed);
-        auto next = tail;
-        if (++next >= S)
-            next -= S;
+    static constexpr auto capacity() noexcept { return S - 1; }
 
-        return next == head_.load(std::memory_order_acquire);
+    auto push(const T& item) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+        return put(item);
     }
 
-    auto push(const T& item) noexcept {
-        const auto tail = tail_.load(std::memory_order_relaxed);
-        auto next = tail;
-        if (++next >= S)
-            next -= S;
-
-        const auto head = head_.load(std::memory_order_acquire);
-        if (next == head) return false;
-        data_[tail] = item;
-        tail_.store(next, std::memory_order_release);
-        return true;
+    auto push(T&& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        return put(std::move(item));
     }
 
-    auto pull(T& item) noexcept {
-        auto head = head_.load(std::memory_order_relaxed);
-        const auto tail = tail_.load(std::memory_order_acquire);
-        if (head == tail) return false;
-        item = data_[head];
-        if (++head >= S)
-            head -= S;
-
-        tail_.store(tail, std::memory_order_release);
+    auto pull(T& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        const auto head = head_.pos.load(std::memory_order_relaxed);
+        if (readable(head, 1) < 1) return false;
+        item = std::move(data_[head]);
+        head_.pos.store(next(head), std::memory_order_release);
         return true;
     }
 
-    auto pop() noexcept -> std::optional<T> {
-        auto head = head_.load(std::memory_order_relaxed);
-        const auto tail = tail_.load(std::memory_order_acquire);
-        if (head == tail) return {};
-        auto item = data_[head];
-        if (++head >= S)
-            head -= S;
+    auto pop() noexcept(std::is_nothrow_move_constructible_v<T>) -> std::optional<T> {
+        const auto head = head_.pos.load(std::memory_order_relaxed);
+        if (readable(head, 1) < 1) return {};
+        std::optional<T> item(std::move(data_[head]));
+        head_.pos.store(next(head), std::memory_order_release);
+        return item;
+    }
+
+    // Moves up to count items from first and publishes them together.
+    template <typename Iter>
+    auto push_bulk(Iter first, std::size_t count) -> std::size_t {
+        auto tail = tail_.pos.load(std::memory_order_relaxed);
+        count = std::min(count, writable(tail, count));
+        for (std::size_t pos = 0; pos < count; ++pos, ++first) {
+            data_[tail] = std::move(*first);
+            tail = next(tail);
+        }
 
-        tail_.store(tail, std::memory_order_release);
-        return head;
+        if (count)
+            tail_.pos.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    // Moves up to count items into out and releases their slots together.
+    template <typename Out>
+    auto pull_bulk(Out out, std::size_t count) -> std::size_t {
+        auto head = head_.pos.load(std::memory_order_relaxed);
+        count = std::min(count, readable(head, count));
+        for (std::size_t pos = 0; pos < count; ++pos) {
+            *out = std::move(data_[head]);
+            ++out;
+            head = next(head);
+        }
+
+        if (count)
+            head_.pos.store(head, std::memory_order_release);
+        return count;
     }
 
 private:
     static_assert(S > 2, "Queue size must be bigger than 2");
 
-    std::atomic<unsigned> head_{0U}, tail_{0U};
-    T data_[S];
+    struct alignas(cache_line) index_t {
+        std::atomic<std::size_t> pos{0};
+        std::size_t cached{0}; // other side's index, owned by this side
+    };
+
+    index_t head_, tail_;
+    alignas(cache_line) T data_[S];
+
+    static constexpr auto next(std::size_t pos) noexcept -> std::size_t {
+        return ++pos >= S ? pos - S : pos;
+    }
+
+    template <typename Item>
+    auto put(Item&& item) {
+        const auto tail = tail_.pos.load(std::memory_order_relaxed);
+        if (writable(tail, 1) < 1) return false;
+        data_[tail] = std::forward<Item>(item);
+        tail_.pos.store(next(tail), std::memory_order_release);
+        return true;
+    }
+
+    // Free slots seen by the producer, refreshing the cached head if short.
+    auto writable(std::size_t tail, std::size_t want) noexcept -> std::size_t {
+        auto head = tail_.cached;
+        auto room = head > tail ? head - tail - 1 : S - 1 - tail + head;
+        if (room >= want) return room;
+        tail_.cached = head = head_.pos.load(std::memory_order_acquire);
+        return head > tail ? head - tail - 1 : S - 1 - tail + head;
+    }
+
+    // Filled slots seen by the consumer, refreshing the cached tail if short.
+    auto readable(std::size_t head, std::size_t want) noexcept -> std::size_t {
+        auto tail = head_.cached;
+        auto used = tail >= head ? tail - head : S - head + tail;
+        if (used >= want) return used;
+        head_.cached = tail = tail_.pos.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : S - head + tail;
+    }
 };
 
-template <typename K, typename V, std::size_t S = 16>
-class dictionary_t {
+// Bounded multi-producer/multi-consumer ring using per-slot sequence numbers
+// (Vyukov). Producers and consumers only contend on their own index, and
+// batch operations claim a run of slots with a single compare-exchange.
+template <typename T, std::size_t S>
+class queue_t final {
 public:
-    dictionary_t(const dictionary_t&) = delete;
-    auto operator=(const dictionary_t&) -> auto& = delete;
+    queue_t() noexcept {
+        for (std::size_t pos = 0; pos < S; ++pos)
+            slots_[pos].seq.store(pos, std::memory_order_relaxed);
+    }
+
+    queue_t(const queue_t&) = delete;
+    auto operator=(const queue_t&) -> auto& = delete;
+
+    ~queue_t() {
+        clear();
+    }
+
+    explicit operator bool() const noexcept {
+        return !empty();
+    }
+
+    auto operator!() const noexcept {
+        return empty();
+    }
+
+    auto operator*() {
+        return pop();
+    }
 
-    dictionary_t() {
-        for (auto& bucket : table_) {
-            bucket.store(nullptr);
+    auto operator<=(T&& item) {
+        return push(std::move(item));
+    }
+
+    auto size() const noexcept -> std::size_t {
+        const auto tail = tail_.pos.load(std::memory_order_acquire);
+        const auto head = head_.pos.load(std::memory_order_acquire);
+        if (head >= tail) return 0;
+        return std::min(tail - head, S);
+    }
+
+    auto empty() const noexcept {
+        return size() == 0;
+    }
+
+    auto full() const noexcept {
+        return size() >= S;
+    }
+
+    static constexpr auto capacity() noexcept { return S; }
+
+    template <typename... Args>
+    auto emplace(Args&&...args) -> bool {
+        auto pos = tail_.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[pos & mask];
+            const auto seq = slot.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ::new (static_cast<void *>(slot.data)) T(std::forward<Args>(args)...);
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0)
+                return false;
+            else
+                pos = tail_.pos.load(std::memory_order_relaxed);
         }
     }
 
-    dictionary_t(dictionary_t&& other) noexcept : table_(std::move(other.table_)), count_(other.count_.load()) {
-        for (auto& bucket : table_) {
-            bucket.store(nullptr);
+    auto push(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    auto push(const T& item) requires std::is_copy_constructible_v<T> {
+        return emplace(item);
+    }
+
+    auto try_pop(T& item) -> bool {
+        std::size_t pos{};
+        auto slot = acquire(pos);
+        if (!slot) return false;
+        auto ptr = std::launder(reinterpret_cast<T *>(slot->data));
+        item = std::move(*ptr);
+        release(slot, ptr, pos);
+        return true;
+    }
+
+    auto pop() -> std::optional<T> {
+        std::optional<T> item;
+        std::size_t pos{};
+        auto slot = acquire(pos);
+        if (!slot) return item;
+        auto ptr = std::launder(reinterpret_cast<T *>(slot->data));
+        item.emplace(std::move(*ptr));
+        release(slot, ptr, pos);
+        return item;
+    }
+
+    // Moves up to count items from first; returns how many were queued.
+    template <typename Iter>
+    auto push_n(Iter first, std::size_t count) -> std::size_t {
+        std::size_t total = 0;
+        while (total < count) {
+            auto pos = tail_.pos.load(std::memory_order_relaxed);
+            const auto run = claim(tail_, pos, count - total, 0);
+            if (!run) break;
+            for (std::size_t off = 0; off < run; ++off, ++first) {
+                auto& slot = slots_[(pos + off) & mask];
+                ::new (static_cast<void *>(slot.data)) T(std::move(*first));
+                slot.seq.store(pos + off + 1, std::memory_order_release);
+            }
+            total += run;
         }
-        other.count_.store(0);
+        return total;
+    }
+
+    // Moves up to count items into out; returns how many were taken.
+    template <typename Out>
+    auto pop_n(Out out, std::size_t count) -> std::size_t {
+        std::size_t total = 0;
+        while (total < count) {
+            auto pos = head_.pos.load(std::memory_order_relaxed);
+            const auto run = claim(head_, pos, count - total, 1);
+            if (!run) break;
+            for (std::size_t off = 0; off < run; ++off) {
+                auto slot = &slots_[(pos + off) & mask];
+                auto ptr = std::launder(reinterpret_cast<T *>(slot->data));
+                *out = std::move(*ptr);
+                ++out;
+                release(slot, ptr, pos + off);
+            }
+            total += run;
+        }
+        return total;
+    }
+
+    void clear() {
+        while (pop())
+            ;
+    }
+
+private:
+    static_assert(S > 1 && (S & (S - 1)) == 0, "Queue size must be a power of 2");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow movable");
+
+    static constexpr std::size_t mask = S - 1;
+
+    struct slot_t {
+        std::atomic<std::size_t> seq;
+        alignas(T) std::byte data[sizeof(T)];
+    };
+
+    struct alignas(cache_line) index_t {
+        std::atomic<std::size_t> pos{0};
+    };
+
+    index_t tail_, head_;
+    alignas(cache_line) slot_t slots_[S];
+
+    auto acquire(std::size_t& pos) noexcept -> slot_t * {
+        pos = head_.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[pos & mask];
+            const auto seq = slot.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (head_.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return &slot;
+            } else if (diff < 0)
+                return nullptr;
+            else
+                pos = head_.pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Frees a drained slot for the producer one lap ahead.
+    void release(slot_t *slot, T *ptr, std::size_t pos) noexcept {
+        ptr->~T();
+        slot->seq.store(pos + S, std::memory_order_release);
+    }
+
+    // Reserve the longest ready run of slots starting at pos, where a slot
+    // is ready when its sequence is pos + ready (0 to fill, 1 to drain).
+    auto claim(index_t& index, std::size_t& pos, std::size_t limit, std::size_t ready) noexcept -> std::size_t {
+        for (;;) {
+            std::size_t run = 0;
+            while (run < limit && run < S) {
+                const auto seq = slots_[(pos + run) & mask].seq.load(std::memory_order_acquire);
+                if (seq != pos + run + ready) break;
+                ++run;
+            }
+
+            if (!run) {
+                const auto seq = slots_[pos & mask].seq.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - (pos + ready)) < 0) return 0;
+                pos = index.pos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (index.pos.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed))
+                return run;
+        }
+    }
+};
+
+// Epoch based reclamation shared by lock-free structures. Readers hold a
+// guard_t while touching shared nodes; writers unlink a node and retire it,
+// and it is released once every thread active at that time has left.
+namespace epoch {
+void enter() noexcept;
+void leave() noexcept;
+void retire(void *ptr, void (*release)(void *));
+void reclaim() noexcept;
+void synchronize();
+auto pending() noexcept -> std::size_t;
+
+template <typename T>
+inline void retire(T *ptr) {
+    retire(static_cast<void *>(ptr), [](void *obj) { delete static_cast<T *>(obj); });
+}
+
+class guard_t final {
+public:
+    guard_t() noexcept { enter(); }
+    ~guard_t() { leave(); }
+
+    guard_t(const guard_t&) = delete;
+    auto operator=(const guard_t&) -> guard_t& = delete;
+};
+} // namespace epoch
+
+// Concurrent hash map with lock-free reads. Writers serialize on striped
+// locks, and the table doubles when the load factor passes one, migrating
+// old buckets incrementally as writers touch them. S is the initial size,
+// and H the hash, such as binary_hash for byte array keys.
+template <typename K, typename V, std::size_t S = 16, typename H = std::hash<K>>
+class dictionary_t {
+public:
+    dictionary_t(const dictionary_t&) = delete;
+    auto operator=(const dictionary_t&) -> auto& = delete;
+
+    dictionary_t() : table_(new table_t(initial)) {}
+
+    dictionary_t(dictionary_t&& other) : table_(new table_t(initial)) {
+        swap(other);
     }
 
-    auto operator=(dictionary_t&& other) noexcept -> auto& {
+    auto operator=(dictionary_t&& other) -> auto& {
         if (this != &other) {
             clear();
-            table_ = std::move(other.table_);
-            count_.store(other.count_.load());
-            other.count_.store(0);
-            for (auto& bucket : table_) {
-                bucket.store(nullptr);
-            }
+            swap(other);
         }
         return *this;
     }
 
+    ~dictionary_t() {
+        auto table = table_.load(std::memory_order_acquire);
+        if (auto old = table->old.load(std::memory_order_acquire); old)
+            destroy(old);
+        destroy(table);
+    }
+
     explicit operator bool() const noexcept {
         return count_.load() > 0;
     }
@@ -274,19 +578,23 @@ public:
     }
 
     auto operator[](const K& key) const -> const V& {
-        at(key);
+        return at(key);
     }
 
     auto operator[](const K& key) -> V& {
-        at(key);
+        return at(key);
     }
 
     void clear() {
-        for (auto& bucket : table_) {
-            auto current = bucket.exchange(nullptr);
+        const epoch::guard_t guard;
+        const locks_t locks(*this);
+        auto table = table_.load(std::memory_order_acquire);
+        settle(table);
+        for (std::size_t index = 0; index <= table->mask; ++index) {
+            auto current = table->buckets[index].exchange(nullptr, std::memory_order_acq_rel);
             while (current != nullptr) {
-                auto next = current->next.load();
-                delete current;
+                auto next = current->next.load(std::memory_order_relaxed);
+                epoch::retire(current);
                 current = next;
             }
         }
@@ -294,131 +602,83 @@ public:
     }
 
     auto insert(const K& key, const V& value) {
-        auto index = key_index(key);
-        auto made = new node(key, value);
-        node *expected = nullptr;
-
-        do { // NOLINT
-            expected = table_[index].load();
-            made->next.store(expected);
-        } while (!table_[index].compare_exchange_weak(expected, made));
-
-        count_.fetch_add(1, std::memory_order_relaxed);
-        return true;
+        return update(key, [&](std::atomic<node *>& bucket, std::size_t hash) {
+            link(bucket, new node(hash, key, value));
+            return true;
+        });
     }
 
     auto insert_or_assign(const K& key, const V& value) {
-        auto index = key_index(key);
-        auto made = new node(key, value);
-        auto current = table_[index].load();
-
-        while (current != nullptr) {
-            if (current->key == key) {
-                current->value = value;
-                delete made;
-                return true;
+        update(key, [&](std::atomic<node *>& bucket, std::size_t hash) {
+            if (auto prev = search(bucket, key); prev) {
+                auto current = prev->load(std::memory_order_relaxed);
+                auto made = new node(hash, key, value);
+                made->next.store(current->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                prev->store(made, std::memory_order_release);
+                epoch::retire(current);
+                return false;
             }
-            current = current->next.load();
-        }
-
-        delete made;
-        insert(key, value);
+            link(bucket, new node(hash, key, value));
+            return true;
+        });
         return true;
     }
 
     auto emplace(K&& key, V&& value) {
-        auto index = key_index(key);
-        auto made = new node(std::move(key), std::move(value));
-        node *expected = nullptr;
-
-        do { // NOLINT
-            expected = table_[index].load();
-            made->next.store(expected);
-        } while (!table_[index].compare_exchange_weak(expected, made));
-
-        count_.fetch_add(1, std::memory_order_relaxed);
-        return true;
+        return update(key, [&](std::atomic<node *>& bucket, std::size_t hash) {
+            link(bucket, new node(hash, std::move(key), std::move(value)));
+            return true;
+        });
     }
 
     auto try_emplace(K&& key, V&& value) {
-        auto index = key_index(key);
-        auto made = new node(std::move(key), std::move(value));
-        auto current = table_[index].load();
-
-        while (current != nullptr) {
-            if (current->key == key) {
-                delete made;
-                return false;
-            }
-            current = current->next.load();
-        }
-
-        emplace(std::move(made->key), std::move(made->value));
-        delete made;
-        return true;
+        return update(key, [&](std::atomic<node *>& bucket, std::size_t hash) {
+            if (search(bucket, key)) return false;
+            link(bucket, new node(hash, std::move(key), std::move(value)));
+            return true;
+        });
     }
 
     auto find(const K& key) const -> std::optional<V> {
-        auto index = key_index(key);
-        auto current = table_[index].load();
-        while (current != nullptr) {
-            if (current->key == key) return current->value;
-            current = current->next.load();
-        }
+        const epoch::guard_t guard;
+        if (auto current = lookup(key); current) return current->value;
         return std::nullopt;
     }
 
     auto contains(const K& key) const {
-        auto index = key_index(key);
-        auto current = table_[index].load();
-
-        while (current != nullptr) {
-            if (current->key == key) return true;
-            current = current->next.load();
-        }
-        return false;
+        const epoch::guard_t guard;
+        return lookup(key) != nullptr;
     }
 
+    // References stay valid across growth, as migration relinks nodes
+    // rather than copying them, until the entry is replaced or removed.
     auto at(const K& key) const -> const V& {
-        auto index = key_index(key);
-        auto current = table_[index].load();
-        while (current != nullptr) {
-            if (current->key == key) return current->value;
-            current = current->next.load();
-        }
+        const epoch::guard_t guard;
+        if (auto current = lookup(key); current) return current->value;
         throw range("Key not in dictionary");
     }
 
     auto at(const K& key) -> V& {
-        auto index = key_index(key);
-        auto current = table_[index].load();
-        while (current != nullptr) {
-            if (current->key == key) return current->value;
-            current = current->next.load();
-        }
+        const epoch::guard_t guard;
+        if (auto current = lookup(key); current) return current->value;
         throw range("Key not in dictionary");
     }
 
     auto remove(const K& key) {
-        auto index = key_index(key);
-        auto current = table_[index].load();
-        node *prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->key == key) {
-                auto next = current->next.load();
-                if (prev != nullptr)
-                    prev->next.store(next);
-                else
-                    table_[index].store(next);
-                delete current;
-                count_.fetch_sub(1, std::memory_order_relaxed);
-                return true;
+        auto removed = false;
+        update(key, [&](std::atomic<node *>& bucket, std::size_t /* hash */) {
+            if (auto prev = search(bucket, key); prev) {
+                auto current = prev->load(std::memory_order_relaxed);
+                prev->store(current->next.load(std::memory_order_relaxed), std::memory_order_release);
+                epoch::retire(current);
+                removed = true;
             }
-            prev = current;
-            current = current->next.load();
-        }
-        return false;
+            return false;
+        });
+
+        if (removed)
+            count_.fetch_sub(1, std::memory_order_relaxed);
+        return removed;
     }
 
     auto empty() const noexcept {
@@ -429,44 +689,252 @@ public:
         return count_.load();
     }
 
+    auto buckets() const noexcept {
+        return table_.load(std::memory_order_acquire)->mask + 1;
+    }
+
     auto keys() const {
         std::list<K> list;
-        for (auto& bucket : table_) {
-            auto current = bucket.load();
-            while (current != nullptr) {
-                list.push_back(current->key);
-                current = current->next.load();
-            }
-        }
+        visit([&](node *current) {
+            list.push_back(current->key);
+        });
         return list;
     }
 
+    // Func runs while every stripe is held, so it must not call back into
+    // this dictionary.
     template <typename Func>
     void each(Func func) {
-        for (auto& bucket : table_) {
-            auto current = bucket.load();
-            while (current != nullptr) {
-                func(current->key, current->value);
-                current = current->next.load();
-            }
-        }
+        visit([&](node *current) {
+            func(current->key, current->value);
+        });
+    }
+
+    void swap(dictionary_t& other) {
+        if (this == &other) return;
+
+        // lock in address order so opposing swaps of a pair cannot deadlock
+        const auto lower = std::less<const dictionary_t *>()(this, &other);
+        const locks_t first(lower ? *this : other);
+        const locks_t second(lower ? other : *this);
+        auto table = table_.load(std::memory_order_relaxed);
+        table_.store(other.table_.exchange(table, std::memory_order_acq_rel), std::memory_order_release);
+        count_.store(other.count_.exchange(count_.load()));
     }
 
 private:
+    static constexpr std::size_t stripes = 64;
+    static constexpr std::size_t initial = std::bit_ceil(std::max(S, stripes));
+
     struct node {
+        std::size_t hash;
         K key;
         V value;
         std::atomic<node *> next{nullptr};
 
-        node(const K& k, const V& v) : key(k), value(v) {}
-        node(K&& k, V&& v) : key(std::move(k)), value(std::move(v)) {}
+        node(std::size_t h, const K& k, const V& v) : hash(h), key(k), value(v) {}
+        node(std::size_t h, K&& k, V&& v) : hash(h), key(std::move(k)), value(std::move(v)) {}
+    };
+
+    struct table_t {
+        const std::size_t mask;
+        std::unique_ptr<std::atomic<node *>[]> buckets;
+        std::atomic<table_t *> old{nullptr};
+        std::atomic<std::size_t> cursor{0}, done{0};
+
+        explicit table_t(std::size_t size) : mask(size - 1), buckets(new std::atomic<node *>[size]) {
+            for (std::size_t index = 0; index < size; ++index)
+                buckets[index].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    // Holds every stripe, in order, for whole-table operations.
+    class locks_t final {
+    public:
+        explicit locks_t(const dictionary_t& from) : from_(from) {
+            for (auto& lock : from_.locks_)
+                lock.lock();
+        }
+
+        ~locks_t() {
+            for (auto& lock : from_.locks_)
+                lock.unlock();
+        }
+
+        locks_t(const locks_t&) = delete;
+        auto operator=(const locks_t&) -> locks_t& = delete;
+
+    private:
+        const dictionary_t& from_;
     };
 
-    std::atomic<node *> table_[S];
+    std::atomic<table_t *> table_;
     std::atomic<std::size_t> count_{0};
+    std::atomic<bool> resizing_{false};
+    mutable std::mutex locks_[stripes];
+
+    static inline node *const moved = reinterpret_cast<node *>(std::uintptr_t{1}); // NOLINT
+
+    static auto key_hash(const K& key) -> std::size_t {
+        return H()(key);
+    }
+
+    static void link(std::atomic<node *>& bucket, node *made) noexcept {
+        made->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(made, std::memory_order_release);
+    }
 
-    auto key_index(const K& key) const -> std::size_t {
-        return std::hash<K>()(key) % S;
+    // Returns the link pointing at key, for use while holding its stripe.
+    static auto search(std::atomic<node *>& bucket, const K& key) noexcept -> std::atomic<node *> * {
+        auto prev = &bucket;
+        auto current = prev->load(std::memory_order_relaxed);
+        while (current != nullptr) {
+            if (current->key == key) return prev;
+            prev = &current->next;
+            current = prev->load(std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+
+    static void destroy(table_t *table) noexcept {
+        for (std::size_t index = 0; index <= table->mask; ++index) {
+            auto current = table->buckets[index].load(std::memory_order_relaxed);
+            while (current != nullptr && current != moved) {
+                auto next = current->next.load(std::memory_order_relaxed);
+                delete current;
+                current = next;
+            }
+        }
+        delete table;
+    }
+
+    static void release(void *table) {
+        delete static_cast<table_t *>(table);
+    }
+
+    static auto scan(node *current, const K& key, std::size_t hash) noexcept -> node * {
+        while (current != nullptr) {
+            if (current->hash == hash && current->key == key) return current;
+            current = current->next.load(std::memory_order_acquire);
+        }
+        return nullptr;
+    }
+
+    // A bucket being split hands its nodes to the new table while we walk
+    // it, so a miss in the old table is checked again in the new one.
+    auto lookup(const K& key) const noexcept -> node * {
+        const auto hash = key_hash(key);
+        for (;;) {
+            auto table = table_.load(std::memory_order_acquire);
+            if (auto old = table->old.load(std::memory_order_acquire); old) {
+                auto current = old->buckets[hash & old->mask].load(std::memory_order_acquire);
+                if (current != moved) {
+                    if (auto found = scan(current, key, hash); found) return found;
+                }
+            }
+
+            auto current = table->buckets[hash & table->mask].load(std::memory_order_acquire);
+            if (current == moved) continue; // table grew under us
+            if (auto found = scan(current, key, hash); found) return found;
+            if (table_.load(std::memory_order_acquire) == table) return nullptr;
+        }
+    }
+
+    // Func edits a bucket under its stripe lock and returns true if added.
+    template <typename Func>
+    auto update(const K& key, Func func) -> bool {
+        const epoch::guard_t guard;
+        const auto hash = key_hash(key);
+        auto added = false;
+        {
+            const std::lock_guard lock(locks_[hash & (stripes - 1)]);
+            auto table = table_.load(std::memory_order_acquire);
+            if (auto old = table->old.load(std::memory_order_acquire); old)
+                migrate(table, old, hash & old->mask);
+            added = func(table->buckets[hash & table->mask], hash);
+        }
+
+        if (added)
+            grow(count_.fetch_add(1, std::memory_order_relaxed) + 1);
+        help();
+        return added;
+    }
+
+    // Relinks one old bucket into the two new buckets it splits into, so
+    // nodes and references to them survive growth. Nodes move from the
+    // tail, so each is in its new bucket before the link that reached it
+    // from the old one is changed, and a reader walking the old chain that
+    // misses a node will find it in the new table.
+    void migrate(table_t *table, table_t *old, std::size_t index) {
+        auto& bucket = old->buckets[index];
+        auto head = bucket.load(std::memory_order_acquire);
+        if (head == moved) return;
+        node *end = nullptr;
+        while (end != head) {
+            auto current = head;
+            while (current->next.load(std::memory_order_relaxed) != end)
+                current = current->next.load(std::memory_order_relaxed);
+            auto& target = table->buckets[current->hash & table->mask];
+            current->next.store(target.load(std::memory_order_relaxed), std::memory_order_release);
+            target.store(current, std::memory_order_release);
+            end = current;
+        }
+
+        bucket.store(moved, std::memory_order_release);
+        if (old->done.fetch_add(1, std::memory_order_acq_rel) == old->mask) {
+            table->old.store(nullptr, std::memory_order_release);
+            epoch::retire(static_cast<void *>(old), &release);
+        }
+    }
+
+    void help() {
+        auto table = table_.load(std::memory_order_acquire);
+        auto old = table->old.load(std::memory_order_acquire);
+        if (!old) return;
+        for (unsigned count = 0; count < 2; ++count) {
+            const auto index = old->cursor.fetch_add(1, std::memory_order_relaxed);
+            if (index > old->mask) return;
+            const std::lock_guard lock(locks_[index & (stripes - 1)]);
+            if (table->old.load(std::memory_order_acquire) != old) return;
+            migrate(table, old, index);
+        }
+    }
+
+    void grow(std::size_t count) {
+        auto table = table_.load(std::memory_order_acquire);
+        if (count <= table->mask + 1 || table->old.load(std::memory_order_acquire)) return;
+        if (resizing_.exchange(true, std::memory_order_acquire)) return;
+        table = table_.load(std::memory_order_acquire);
+        if (!table->old.load(std::memory_order_acquire) && count > table->mask + 1) {
+            auto made = new table_t((table->mask + 1) * 2);
+            made->old.store(table, std::memory_order_relaxed);
+            table_.store(made, std::memory_order_release);
+        }
+        resizing_.store(false, std::memory_order_release);
+    }
+
+    // Finishes any migration; caller holds every stripe.
+    void settle(table_t *table) {
+        auto old = table->old.load(std::memory_order_acquire);
+        if (!old) return;
+        for (std::size_t index = 0; index <= old->mask; ++index)
+            migrate(table, old, index);
+    }
+
+    template <typename Func>
+    void visit(Func func) const {
+        const epoch::guard_t guard;
+        const locks_t locks(*this);
+        auto self = const_cast<dictionary_t *>(this);
+        auto table = table_.load(std::memory_order_acquire);
+        self->settle(table);
+        for (std::size_t index = 0; index <= table->mask; ++index) {
+            auto current = table->buckets[index].load(std::memory_order_acquire);
+            while (current != nullptr) {
+                func(current);
+                current = current->next.load(std::memory_order_acquire);
+            }
+        }
     }
 };
 } // namespace busuto::atomic
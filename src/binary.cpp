@@ -3,19 +3,35 @@
 
 #include "binary.hpp"
 
+#ifndef BUSUTO_NO_SIMD
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BUSUTO_SIMD_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BUSUTO_SIMD_NEON
+#endif
+#endif
+
+#if !defined(BUSUTO_NO_SIMD) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define BUSUTO_CRC_ARM
+#endif
+
 using namespace busuto;
 
 namespace {
+constexpr char b64_alphabet[] =
+"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr char hex_alphabet[] = "0123456789ABCDEF";
+
 constexpr std::array<uint8_t, 256> b64_lookup = [] {
     std::array<uint8_t, 256> table{};
     table.fill(0xFF); // invalid by default
 
-    const char *alphabet =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "abcdefghijklmnopqrstuvwxyz"
-    "0123456789+/";
     for (uint8_t i = 0; i < 64; ++i)
-        table[static_cast<unsigned char>(alphabet[i])] = i;
+        table[static_cast<unsigned char>(b64_alphabet[i])] = i;
 
     return table;
 }();
@@ -33,36 +49,773 @@ constexpr std::array<uint8_t, 256> hex_lookup = [] {
 
     return table;
 }();
-} // end namespace
 
-auto util::is_utf8(const std::byte *data, std::size_t len) -> bool {
-    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
-    std::size_t i = 0;
+// Vector kernels convert the bulk of the input and return how much they
+// consumed; the scalar code finishes the tail, so a kernel may also stop
+// early at bad input and leave the error report to the scalar path.
+// A utf8 validator returns where the scalar check should resume, or npos.
+using encoder_t = std::size_t (*)(const uint8_t *, std::size_t, char *) noexcept;
+using decoder_t = std::size_t (*)(const char *, std::size_t, uint8_t *) noexcept;
+using validator_t = std::size_t (*)(const uint8_t *, std::size_t) noexcept;
+using finder_t = std::size_t (*)(const char *, std::size_t, const char *, std::size_t) noexcept;
+
+constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+struct codec_t {
+    encoder_t encode_b64;
+    decoder_t decode_b64;
+    encoder_t encode_hex;
+    decoder_t decode_hex;
+    validator_t validate_utf8;
+};
+
+[[maybe_unused]] auto scalar_encode(const uint8_t * /* in */, std::size_t /* len */, char * /* out */) noexcept -> std::size_t {
+    return 0;
+}
+
+[[maybe_unused]] auto scalar_decode(const char * /* in */, std::size_t /* len */, uint8_t * /* out */) noexcept -> std::size_t {
+    return 0;
+}
 
+[[maybe_unused]] auto scalar_validate(const uint8_t * /* in */, std::size_t /* len */) noexcept -> std::size_t {
+    return 0;
+}
+
+[[maybe_unused]] auto scalar_find(const char * /* in */, std::size_t /* len */, const char * /* delim */, std::size_t /* size */) noexcept -> std::size_t {
+    return 0;
+}
+
+constexpr auto sequence_length(uint8_t lead) noexcept -> std::size_t {
+    if (lead >= 0xF0) return 4;
+    if (lead >= 0xE0) return 3;
+    return 2;
+}
+
+// Size of a sequence cut off by the end of data, so it can be carried.
+// Invalid leads count too, leaving them for the scalar check to reject.
+auto partial_tail(const uint8_t *data, std::size_t len) noexcept -> std::size_t {
+    for (std::size_t back = 1; back <= 3 && back <= len; ++back) {
+        const auto byte = data[len - back];
+        if (byte < 0x80) break;
+        if (byte < 0xC0) continue;
+        if (sequence_length(byte) > back) return back;
+        break;
+    }
+    return 0;
+}
+
+// Strict RFC 3629 check: no overlongs, surrogates, or values past U+10FFFF.
+auto validate_utf8(const uint8_t *bytes, std::size_t len) noexcept -> bool {
+    std::size_t i = 0;
     while (i < len) {
+        if (i + 8 <= len) {
+            uint64_t word{};
+            std::memcpy(&word, bytes + i, sizeof(word));
+            if (!(word & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+
         const uint8_t byte = bytes[i];
-        const std::size_t rem = len - i;
         if (byte <= 0x7F) {
-            ++i; // ASCII
-        } else if ((byte >> 5) == 0x6 && rem >= 2 &&
-                   (bytes[i + 1] >> 6) == 0x2) {
-            i += 2; // 2-byte sequence
-        } else if ((byte >> 4) == 0xE && rem >= 3 &&
-                   (bytes[i + 1] >> 6) == 0x2 &&
-                   (bytes[i + 2] >> 6) == 0x2) {
-            i += 3; // 3-byte sequence
-        } else if ((byte >> 3) == 0x1E && rem >= 4 &&
-                   (bytes[i + 1] >> 6) == 0x2 &&
-                   (bytes[i + 2] >> 6) == 0x2 &&
-                   (bytes[i + 3] >> 6) == 0x2) {
-            i += 4; // 4-byte sequence
-        } else {
-            return false;
+            ++i;
+            continue;
         }
+
+        if (byte < 0xC2 || byte > 0xF4) return false;
+        const auto count = sequence_length(byte);
+        if (len - i < count) return false;
+        uint8_t low = 0x80, high = 0xBF;
+        if (byte == 0xE0) low = 0xA0;
+        if (byte == 0xED) high = 0x9F;
+        if (byte == 0xF0) low = 0x90;
+        if (byte == 0xF4) high = 0x8F;
+        if (bytes[i + 1] < low || bytes[i + 1] > high) return false;
+        for (std::size_t next = 2; next < count; ++next) {
+            if ((bytes[i + next] & 0xC0) != 0x80) return false;
+        }
+        i += count;
     }
     return true;
 }
 
+#ifdef BUSUTO_SIMD_X86
+// Base64 packing and lookup follow Wojciech Mula's pshufb method.
+__attribute__((target("ssse3"))) auto b64_encode_ssse3(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const auto shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const auto shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 12, out += 16) {
+        auto data = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos)), shuffle);
+        const auto t0 = _mm_mulhi_epu16(_mm_and_si128(data, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const auto t1 = _mm_mullo_epi16(_mm_and_si128(data, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const auto index = _mm_or_si128(t0, t1);
+        auto lookup = _mm_subs_epu8(index, _mm_set1_epi8(51));
+        lookup = _mm_or_si128(lookup, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), index), _mm_set1_epi8(13)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_add_epi8(_mm_shuffle_epi8(shift, lookup), index));
+    }
+    return pos;
+}
+
+__attribute__((target("avx2"))) auto b64_encode_avx2(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const auto shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const auto shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    std::size_t pos = 0;
+    for (; pos + 28 <= len; pos += 24, out += 32) {
+        const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos));
+        const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos + 12));
+        auto data = _mm256_shuffle_epi8(_mm256_set_m128i(hi, lo), shuffle);
+        const auto t0 = _mm256_mulhi_epu16(_mm256_and_si256(data, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        const auto t1 = _mm256_mullo_epi16(_mm256_and_si256(data, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        const auto index = _mm256_or_si256(t0, t1);
+        auto lookup = _mm256_subs_epu8(index, _mm256_set1_epi8(51));
+        lookup = _mm256_or_si256(lookup, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), index), _mm256_set1_epi8(13)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_add_epi8(_mm256_shuffle_epi8(shift, lookup), index));
+    }
+    return pos;
+}
+
+// Ascii ranges are positive as signed bytes, so high bit input never
+// matches and fails validation.
+__attribute__((target("ssse3"))) inline auto within_ssse3(__m128i data, char lo, char hi) noexcept {
+    return _mm_and_si128(_mm_cmpgt_epi8(data, _mm_set1_epi8(char(lo - 1))), _mm_cmpgt_epi8(_mm_set1_epi8(char(hi + 1)), data));
+}
+
+__attribute__((target("avx2"))) inline auto within_avx2(__m256i data, char lo, char hi) noexcept {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(data, _mm256_set1_epi8(char(lo - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(char(hi + 1)), data));
+}
+
+__attribute__((target("ssse3"))) inline auto b64_values_ssse3(__m128i data, __m128i& values) noexcept -> bool {
+    const auto upper = within_ssse3(data, 'A', 'Z');
+    const auto lower = within_ssse3(data, 'a', 'z');
+    const auto digit = within_ssse3(data, '0', '9');
+    const auto plus = _mm_cmpeq_epi8(data, _mm_set1_epi8('+'));
+    const auto slash = _mm_cmpeq_epi8(data, _mm_set1_epi8('/'));
+    const auto valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+    if (_mm_movemask_epi8(valid) != 0xFFFF) return false;
+
+    auto shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+    shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+    shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+    shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+    values = _mm_add_epi8(data, shift);
+    return true;
+}
+
+__attribute__((target("avx2"))) inline auto b64_values_avx2(__m256i data, __m256i& values) noexcept -> bool {
+    const auto upper = within_avx2(data, 'A', 'Z');
+    const auto lower = within_avx2(data, 'a', 'z');
+    const auto digit = within_avx2(data, '0', '9');
+    const auto plus = _mm256_cmpeq_epi8(data, _mm256_set1_epi8('+'));
+    const auto slash = _mm256_cmpeq_epi8(data, _mm256_set1_epi8('/'));
+    const auto valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus)), slash);
+    if (_mm256_movemask_epi8(valid) != -1) return false;
+
+    auto shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+    values = _mm256_add_epi8(data, shift);
+    return true;
+}
+
+__attribute__((target("ssse3"))) auto b64_decode_ssse3(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    const auto pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16, out += 12) {
+        __m128i values;
+        if (!b64_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos)), values)) break;
+        const auto merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+        alignas(16) uint8_t bytes[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(bytes), _mm_shuffle_epi8(merged, pack));
+        std::memcpy(out, bytes, 12);
+    }
+    return pos;
+}
+
+__attribute__((target("avx2"))) auto b64_decode_avx2(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    const auto pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const auto lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    std::size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32, out += 24) {
+        __m256i values;
+        if (!b64_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos)), values)) break;
+        const auto merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+        alignas(32) uint8_t bytes[32];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(bytes), _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), lanes));
+        std::memcpy(out, bytes, 24);
+    }
+    return pos + b64_decode_ssse3(in + pos, len - pos, out);
+}
+
+__attribute__((target("ssse3"))) auto hex_encode_ssse3(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const auto digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hex_alphabet));
+    const auto nibble = _mm_set1_epi8(0x0f);
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16, out += 32) {
+        const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos));
+        const auto hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(data, 4), nibble));
+        const auto lo = _mm_shuffle_epi8(digits, _mm_and_si128(data, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return pos;
+}
+
+__attribute__((target("avx2"))) auto hex_encode_avx2(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const auto digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex_alphabet)));
+    const auto nibble = _mm256_set1_epi8(0x0f);
+    std::size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32, out += 64) {
+        const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos));
+        const auto hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(data, 4), nibble));
+        const auto lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(data, nibble));
+        const auto first = _mm256_unpacklo_epi8(hi, lo);
+        const auto second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return pos + hex_encode_ssse3(in + pos, len - pos, out);
+}
+
+// Digits and either case of a-f become nibbles, pairs merge with maddubs.
+__attribute__((target("ssse3"))) auto hex_decode_ssse3(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16, out += 8) {
+        const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos));
+        const auto digit = _mm_sub_epi8(data, _mm_set1_epi8('0'));
+        const auto alpha = _mm_sub_epi8(_mm_or_si128(data, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        const auto is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+        if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF) break;
+        const auto values = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+        const auto merged = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(merged, merged));
+    }
+    return pos;
+}
+
+__attribute__((target("avx2"))) auto hex_decode_avx2(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    std::size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32, out += 16) {
+        const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos));
+        const auto digit = _mm256_sub_epi8(data, _mm256_set1_epi8('0'));
+        const auto alpha = _mm256_sub_epi8(_mm256_or_si256(data, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        const auto is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        const auto is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+        if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) != -1) break;
+        const auto values = _mm256_or_si256(_mm256_and_si256(is_digit, digit), _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+        const auto merged = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+        const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(merged, merged), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+    }
+    return pos + hex_decode_ssse3(in + pos, len - pos, out);
+}
+
+constexpr uint8_t too_short = 1 << 0;
+constexpr uint8_t too_long = 1 << 1;
+constexpr uint8_t overlong_3 = 1 << 2;
+constexpr uint8_t too_large = 1 << 3;
+constexpr uint8_t surrogate = 1 << 4;
+constexpr uint8_t overlong_2 = 1 << 5;
+constexpr uint8_t too_large_1000 = 1 << 6;
+constexpr uint8_t overlong_4 = 1 << 6;
+constexpr uint8_t two_conts = 1 << 7;
+constexpr uint8_t carry = too_short | too_long | two_conts;
+
+constexpr uint8_t utf8_byte1_high[16] = {
+too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+two_conts, two_conts, two_conts, two_conts,
+too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+too_short | too_large | too_large_1000 | overlong_4};
+
+constexpr uint8_t utf8_byte1_low[16] = {
+carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000};
+
+constexpr uint8_t utf8_byte2_high[16] = {
+too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+too_long | overlong_2 | two_conts | overlong_3 | too_large,
+too_long | overlong_2 | two_conts | surrogate | too_large,
+too_long | overlong_2 | two_conts | surrogate | too_large,
+too_short, too_short, too_short, too_short};
+
+// Bytes past these at the end of a block start an unfinished sequence.
+constexpr uint8_t utf8_incomplete[32] = {
+255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1};
+
+// Utf8 validation uses the Keiser and Lemire lookup method; each byte
+// pair is classified by three nibble tables and continuation counts are
+// checked against the lead bytes two and three positions back.
+__attribute__((target("ssse3"))) auto utf8_validate_ssse3(const uint8_t *in, std::size_t len) noexcept -> std::size_t {
+    const auto byte1_high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte1_high));
+    const auto byte1_low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte1_low));
+    const auto byte2_high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte2_high));
+    const auto limits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_incomplete + 16));
+    const auto nibble = _mm_set1_epi8(0x0f);
+    auto error = _mm_setzero_si128();
+    auto prev = _mm_setzero_si128();
+    auto incomplete = _mm_setzero_si128();
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16) {
+        const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos));
+        if (!_mm_movemask_epi8(input)) {
+            error = _mm_or_si128(error, incomplete);
+            prev = incomplete = _mm_setzero_si128();
+            continue;
+        }
+
+        const auto prev1 = _mm_alignr_epi8(input, prev, 15);
+        const auto prev2 = _mm_alignr_epi8(input, prev, 14);
+        const auto prev3 = _mm_alignr_epi8(input, prev, 13);
+        auto special = _mm_shuffle_epi8(byte1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+        special = _mm_and_si128(special, _mm_shuffle_epi8(byte1_low, _mm_and_si128(prev1, nibble)));
+        special = _mm_and_si128(special, _mm_shuffle_epi8(byte2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+        const auto third = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80)));
+        const auto fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)));
+        const auto must = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+        error = _mm_or_si128(error, _mm_xor_si128(must, special));
+        incomplete = _mm_subs_epu8(input, limits);
+        prev = input;
+    }
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF) return npos;
+    return pos - partial_tail(in, pos);
+}
+
+__attribute__((target("avx2"))) auto utf8_validate_avx2(const uint8_t *in, std::size_t len) noexcept -> std::size_t {
+    const auto byte1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte1_high)));
+    const auto byte1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte1_low)));
+    const auto byte2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8_byte2_high)));
+    const auto limits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(utf8_incomplete));
+    const auto nibble = _mm256_set1_epi8(0x0f);
+    auto error = _mm256_setzero_si256();
+    auto prev = _mm256_setzero_si256();
+    auto incomplete = _mm256_setzero_si256();
+    std::size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32) {
+        const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos));
+        if (!_mm256_movemask_epi8(input)) {
+            error = _mm256_or_si256(error, incomplete);
+            prev = incomplete = _mm256_setzero_si256();
+            continue;
+        }
+
+        const auto carry = _mm256_permute2x128_si256(prev, input, 0x21);
+        const auto prev1 = _mm256_alignr_epi8(input, carry, 15);
+        const auto prev2 = _mm256_alignr_epi8(input, carry, 14);
+        const auto prev3 = _mm256_alignr_epi8(input, carry, 13);
+        auto special = _mm256_shuffle_epi8(byte1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+        special = _mm256_and_si256(special, _mm256_shuffle_epi8(byte1_low, _mm256_and_si256(prev1, nibble)));
+        special = _mm256_and_si256(special, _mm256_shuffle_epi8(byte2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+        const auto third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xe0 - 0x80)));
+        const auto fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xf0 - 0x80)));
+        const auto must = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must, special));
+        incomplete = _mm256_subs_epu8(input, limits);
+        prev = input;
+    }
+
+    if (!_mm256_testz_si256(error, error)) return npos;
+    return pos - partial_tail(in, pos);
+}
+
+// Delimiter finders compare the first and last delimiter bytes a vector at
+// a time, and return a verified match or where the vector scan stopped.
+auto find_sse2(const char *in, std::size_t len, const char *delim, std::size_t size) noexcept -> std::size_t {
+    const auto first = _mm_set1_epi8(delim[0]);
+    const auto last = _mm_set1_epi8(delim[size - 1]);
+    std::size_t pos = 0;
+    for (; pos + size - 1 + 16 <= len; pos += 16) {
+        const auto head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos));
+        const auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + pos + size - 1));
+        auto mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+        for (; mask; mask &= mask - 1) {
+            const auto at = pos + unsigned(std::countr_zero(mask));
+            if (size <= 2 || !std::memcmp(in + at + 1, delim + 1, size - 2)) return at;
+        }
+    }
+    return pos;
+}
+
+__attribute__((target("avx2"))) auto find_avx2(const char *in, std::size_t len, const char *delim, std::size_t size) noexcept -> std::size_t {
+    const auto first = _mm256_set1_epi8(delim[0]);
+    const auto last = _mm256_set1_epi8(delim[size - 1]);
+    std::size_t pos = 0;
+    for (; pos + size - 1 + 32 <= len; pos += 32) {
+        const auto head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos));
+        const auto tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + pos + size - 1));
+        auto mask = unsigned(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+        for (; mask; mask &= mask - 1) {
+            const auto at = pos + unsigned(std::countr_zero(mask));
+            if (size <= 2 || !std::memcmp(in + at + 1, delim + 1, size - 2)) return at;
+        }
+    }
+    return pos;
+}
+
+auto select_finder() noexcept -> finder_t {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return find_avx2;
+    return find_sse2;
+}
+
+auto select_codec() noexcept -> codec_t {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {b64_encode_avx2, b64_decode_avx2, hex_encode_avx2, hex_decode_avx2, utf8_validate_avx2};
+    if (__builtin_cpu_supports("ssse3"))
+        return {b64_encode_ssse3, b64_decode_ssse3, hex_encode_ssse3, hex_decode_ssse3, utf8_validate_ssse3};
+    return {scalar_encode, scalar_decode, scalar_encode, scalar_decode, scalar_validate};
+}
+#elif defined(BUSUTO_SIMD_NEON)
+// Neon de-interleaving loads and stores do the 3 <-> 4 byte regrouping.
+auto b64_encode_neon(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const uint8x16x4_t table = vld1q_u8_x4(reinterpret_cast<const uint8_t *>(b64_alphabet));
+    const auto mask = vdupq_n_u8(0x3f);
+    std::size_t pos = 0;
+    for (; pos + 48 <= len; pos += 48, out += 64) {
+        const auto data = vld3q_u8(in + pos);
+        uint8x16x4_t index;
+        index.val[0] = vshrq_n_u8(data.val[0], 2);
+        index.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(data.val[0], 4), vshrq_n_u8(data.val[1], 4)), mask);
+        index.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(data.val[1], 2), vshrq_n_u8(data.val[2], 6)), mask);
+        index.val[3] = vandq_u8(data.val[2], mask);
+        uint8x16x4_t text;
+        for (int part = 0; part < 4; ++part)
+            text.val[part] = vqtbl4q_u8(table, index.val[part]);
+        vst4q_u8(reinterpret_cast<uint8_t *>(out), text);
+    }
+    return pos;
+}
+
+auto b64_decode_neon(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    const uint8x16x4_t low = vld1q_u8_x4(b64_lookup.data());
+    const uint8x16x4_t high = vld1q_u8_x4(b64_lookup.data() + 64);
+    std::size_t pos = 0;
+    for (; pos + 64 <= len; pos += 64, out += 48) {
+        auto text = vld4q_u8(reinterpret_cast<const uint8_t *>(in + pos));
+        auto bad = vdupq_n_u8(0);
+        for (int part = 0; part < 4; ++part) {
+            const auto ch = text.val[part];
+            auto value = vqtbx4q_u8(vqtbl4q_u8(low, ch), high, veorq_u8(ch, vdupq_n_u8(0x40)));
+            value = vorrq_u8(value, vcgeq_u8(ch, vdupq_n_u8(0x80)));
+            bad = vorrq_u8(bad, value);
+            text.val[part] = value;
+        }
+        if (vmaxvq_u8(bad) > 63) break;
+
+        uint8x16x3_t data;
+        data.val[0] = vorrq_u8(vshlq_n_u8(text.val[0], 2), vshrq_n_u8(text.val[1], 4));
+        data.val[1] = vorrq_u8(vshlq_n_u8(text.val[1], 4), vshrq_n_u8(text.val[2], 2));
+        data.val[2] = vorrq_u8(vshlq_n_u8(text.val[2], 6), text.val[3]);
+        vst3q_u8(out, data);
+    }
+    return pos;
+}
+
+auto hex_encode_neon(const uint8_t *in, std::size_t len, char *out) noexcept -> std::size_t {
+    const auto digits = vld1q_u8(reinterpret_cast<const uint8_t *>(hex_alphabet));
+    std::size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16, out += 32) {
+        const auto data = vld1q_u8(in + pos);
+        uint8x16x2_t text;
+        text.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(data, 4));
+        text.val[1] = vqtbl1q_u8(digits, vandq_u8(data, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<uint8_t *>(out), text);
+    }
+    return pos;
+}
+
+auto hex_decode_neon(const char *in, std::size_t len, uint8_t *out) noexcept -> std::size_t {
+    std::size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32, out += 16) {
+        const auto text = vld2q_u8(reinterpret_cast<const uint8_t *>(in + pos));
+        uint8x16_t nibbles[2];
+        auto valid = vdupq_n_u8(0xff);
+        for (int part = 0; part < 2; ++part) {
+            const auto digit = vsubq_u8(text.val[part], vdupq_n_u8('0'));
+            const auto alpha = vsubq_u8(vorrq_u8(text.val[part], vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+            const auto is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+            const auto is_alpha = vcleq_u8(alpha, vdupq_n_u8(5));
+            valid = vandq_u8(valid, vorrq_u8(is_digit, is_alpha));
+            nibbles[part] = vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+        }
+        if (vminvq_u8(valid) == 0) break;
+        vst1q_u8(out, vorrq_u8(vshlq_n_u8(nibbles[0], 4), nibbles[1]));
+    }
+    return pos;
+}
+
+// Only the ascii block fast path is vectorized for Neon.
+auto utf8_validate_neon(const uint8_t *in, std::size_t len) noexcept -> std::size_t {
+    std::size_t pos = 0;
+    while (pos + 16 <= len && vmaxvq_u8(vld1q_u8(in + pos)) < 0x80)
+        pos += 16;
+    return pos;
+}
+
+// Narrowing shift packs the compare into four bits per byte.
+auto find_neon(const char *in, std::size_t len, const char *delim, std::size_t size) noexcept -> std::size_t {
+    const auto first = vdupq_n_u8(uint8_t(delim[0]));
+    const auto last = vdupq_n_u8(uint8_t(delim[size - 1]));
+    const auto *bytes = reinterpret_cast<const uint8_t *>(in);
+    std::size_t pos = 0;
+    for (; pos + size - 1 + 16 <= len; pos += 16) {
+        const auto match = vandq_u8(vceqq_u8(vld1q_u8(bytes + pos), first), vceqq_u8(vld1q_u8(bytes + pos + size - 1), last));
+        auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+        for (; mask; mask &= ~(uint64_t{0xF} << (unsigned(std::countr_zero(mask)) & ~3U))) {
+            const auto at = pos + unsigned(std::countr_zero(mask)) / 4;
+            if (size <= 2 || !std::memcmp(in + at + 1, delim + 1, size - 2)) return at;
+        }
+    }
+    return pos;
+}
+
+auto select_finder() noexcept -> finder_t {
+    return find_neon;
+}
+
+auto select_codec() noexcept -> codec_t {
+    return {b64_encode_neon, b64_decode_neon, hex_encode_neon, hex_decode_neon, utf8_validate_neon};
+}
+#else
+auto select_finder() noexcept -> finder_t {
+    return scalar_find;
+}
+
+auto select_codec() noexcept -> codec_t {
+    return {scalar_encode, scalar_decode, scalar_encode, scalar_decode, scalar_validate};
+}
+#endif
+
+// Crc32c tables, slicing by eight for the portable path, and operators that
+// shift a crc past a run of zeros, which join three hardware streams into
+// one. The zeros operators follow Mark Adler's crc32c code.
+using crc_t = uint32_t (*)(uint32_t, const uint8_t *, std::size_t) noexcept;
+
+constexpr uint32_t crc_poly = 0x82f63b78;
+constexpr std::size_t crc_long = 8192;
+constexpr std::size_t crc_short = 256;
+
+using crc_matrix = std::array<uint32_t, 32>;
+using crc_table = std::array<std::array<uint32_t, 256>, 4>;
+
+constexpr auto crc_slices = [] {
+    std::array<std::array<uint32_t, 256>, 8> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        auto crc = n;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ crc_poly : crc >> 1;
+        table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+        for (std::size_t slice = 1; slice < 8; ++slice)
+            table[slice][n] = (table[slice - 1][n] >> 8) ^ table[0][table[slice - 1][n] & 0xff];
+    }
+    return table;
+}();
+
+constexpr auto gf2_times(const crc_matrix& mat, uint32_t vec) {
+    uint32_t sum{0};
+    for (std::size_t row = 0; vec; vec >>= 1, ++row) {
+        if (vec & 1) sum ^= mat[row];
+    }
+    return sum;
+}
+
+constexpr auto gf2_square(const crc_matrix& mat) {
+    crc_matrix square{};
+    for (std::size_t row = 0; row < 32; ++row)
+        square[row] = gf2_times(mat, mat[row]);
+    return square;
+}
+
+// Operator for len zero bytes, where len is a power of two.
+constexpr auto crc_zeros(std::size_t len) {
+    crc_matrix odd{};
+    odd[0] = crc_poly;
+    for (std::size_t row = 1; row < 32; ++row)
+        odd[row] = uint32_t(1) << (row - 1);
+    auto even = gf2_square(odd);
+    odd = gf2_square(even);
+    crc_matrix op{};
+    for (;;) {
+        even = gf2_square(odd);
+        len >>= 1;
+        if (!len) {
+            op = even;
+            break;
+        }
+        odd = gf2_square(even);
+        len >>= 1;
+        if (!len) {
+            op = odd;
+            break;
+        }
+    }
+
+    crc_table table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        for (std::size_t byte = 0; byte < 4; ++byte)
+            table[byte][n] = gf2_times(op, n << (byte * 8));
+    }
+    return table;
+}
+
+[[maybe_unused]] constexpr auto crc_shift(const crc_table& zeros, uint32_t crc) noexcept {
+    return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^ zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+[[maybe_unused]] constexpr auto crc_long_zeros = crc_zeros(crc_long);
+[[maybe_unused]] constexpr auto crc_short_zeros = crc_zeros(crc_short);
+
+auto crc32c_table(uint32_t crc, const uint8_t *in, std::size_t len) noexcept -> uint32_t {
+    const auto& table = crc_slices;
+    for (; len >= 8; in += 8, len -= 8) {
+        uint64_t word{0};
+        std::memcpy(&word, in, sizeof(word));
+        if constexpr (std::endian::native == std::endian::big) word = __builtin_bswap64(word);
+        crc ^= uint32_t(word);
+        const auto high = uint32_t(word >> 32);
+        crc = table[7][crc & 0xff] ^ table[6][(crc >> 8) & 0xff] ^ table[5][(crc >> 16) & 0xff] ^ table[4][crc >> 24] ^
+              table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^ table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+    }
+    for (; len; --len)
+        crc = (crc >> 8) ^ table[0][(crc ^ *in++) & 0xff];
+    return crc;
+}
+
+#if defined(BUSUTO_SIMD_X86)
+__attribute__((target("sse4.2"))) inline auto crc_word_sse42(uint64_t crc, const uint8_t *in) noexcept -> uint64_t {
+    uint64_t word{0};
+    std::memcpy(&word, in, sizeof(word));
+    return _mm_crc32_u64(crc, word);
+}
+
+// The crc instruction takes three cycles but issues every cycle, so three
+// independent streams keep it busy.
+__attribute__((target("sse4.2"))) auto crc32c_sse42(uint32_t crc, const uint8_t *in, std::size_t len) noexcept -> uint32_t {
+    uint64_t crc0 = crc;
+    for (const auto block : {crc_long, crc_short}) {
+        const auto& zeros = block == crc_long ? crc_long_zeros : crc_short_zeros;
+        for (; len >= block * 3; in += block * 2, len -= block * 3) {
+            uint64_t crc1{0}, crc2{0};
+            for (const auto *end = in + block; in < end; in += 8) {
+                crc0 = crc_word_sse42(crc0, in);
+                crc1 = crc_word_sse42(crc1, in + block);
+                crc2 = crc_word_sse42(crc2, in + block * 2);
+            }
+            crc0 = crc_shift(zeros, uint32_t(crc0)) ^ crc1;
+            crc0 = crc_shift(zeros, uint32_t(crc0)) ^ crc2;
+        }
+    }
+    for (; len >= 8; in += 8, len -= 8)
+        crc0 = crc_word_sse42(crc0, in);
+    auto result = uint32_t(crc0);
+    for (; len; --len)
+        result = _mm_crc32_u8(result, *in++);
+    return result;
+}
+
+auto select_crc() noexcept -> crc_t {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) return crc32c_sse42;
+    return crc32c_table;
+}
+#elif defined(BUSUTO_CRC_ARM)
+inline auto crc_word_arm(uint32_t crc, const uint8_t *in) noexcept {
+    uint64_t word{0};
+    std::memcpy(&word, in, sizeof(word));
+    return __crc32cd(crc, word);
+}
+
+auto crc32c_arm(uint32_t crc, const uint8_t *in, std::size_t len) noexcept -> uint32_t {
+    for (const auto block : {crc_long, crc_short}) {
+        const auto& zeros = block == crc_long ? crc_long_zeros : crc_short_zeros;
+        for (; len >= block * 3; in += block * 2, len -= block * 3) {
+            uint32_t crc1{0}, crc2{0};
+            for (const auto *end = in + block; in < end; in += 8) {
+                crc = crc_word_arm(crc, in);
+                crc1 = crc_word_arm(crc1, in + block);
+                crc2 = crc_word_arm(crc2, in + block * 2);
+            }
+            crc = crc_shift(zeros, crc) ^ crc1;
+            crc = crc_shift(zeros, crc) ^ crc2;
+        }
+    }
+    for (; len >= 8; in += 8, len -= 8)
+        crc = crc_word_arm(crc, in);
+    for (; len; --len)
+        crc = __crc32cb(crc, *in++);
+    return crc;
+}
+
+auto select_crc() noexcept -> crc_t {
+    return crc32c_arm;
+}
+#else
+auto select_crc() noexcept -> crc_t {
+    return crc32c_table;
+}
+#endif
+
+// Kernels are picked on first use rather than by namespace scope statics,
+// so static initializers elsewhere can call these at any time.
+auto codec() noexcept -> const codec_t& {
+    static const codec_t kernels = select_codec();
+    return kernels;
+}
+
+auto finder() noexcept -> finder_t {
+    static const finder_t kernel = select_finder();
+    return kernel;
+}
+
+auto crc_kernel() noexcept -> crc_t {
+    static const crc_t kernel = select_crc();
+    return kernel;
+}
+} // end namespace
+
+auto util::crc32c(const void *data, std::size_t len, uint32_t crc) noexcept -> uint32_t {
+    return ~crc_kernel()(~crc, static_cast<const uint8_t *>(data), len);
+}
+
+auto util::find_delimiter(std::string_view text, std::string_view delim, std::size_t from) noexcept -> std::size_t {
+    const auto size = delim.size();
+    if (!size || from > text.size() || text.size() - from < size) return std::string_view::npos;
+    const auto *in = text.data();
+    const auto len = text.size();
+    if (size == 1) {
+        const auto *found = static_cast<const char *>(std::memchr(in + from, delim[0], len - from));
+        return found ? std::size_t(found - in) : std::string_view::npos;
+    }
+
+    auto pos = from + finder()(in + from, len - from, delim.data(), size);
+    while (pos + size <= len) {
+        const auto *found = static_cast<const char *>(std::memchr(in + pos, delim[0], len - size + 1 - pos));
+        if (!found) break;
+        pos = std::size_t(found - in);
+        if (!std::memcmp(found, delim.data(), size)) return pos;
+        ++pos;
+    }
+    return std::string_view::npos;
+}
+
+auto util::is_utf8(const std::byte *data, std::size_t len) -> bool {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    const auto from = codec().validate_utf8(bytes, len);
+    return from != npos && validate_utf8(bytes + from, len - from);
+}
+
 auto util::is_utf8(const std::span<const std::byte>& data) -> bool {
     return is_utf8(data.data(), data.size());
 }
@@ -71,22 +824,57 @@ auto util::is_utf8(const std::string_view& view) -> bool {
     return is_utf8(reinterpret_cast<const std::byte *>(view.data()), view.size());
 }
 
-auto util::encode_b64(std::span<const std::byte> input) -> std::string {
-    static constexpr char alphabet[] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+auto util::utf8_validator::update(const void *data, std::size_t len) noexcept -> bool {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    if (!valid_) return false;
+    if (held_) {
+        std::size_t used = 0;
+        while (held_ < need_ && used < len) {
+            if ((bytes[used] & 0xC0) != 0x80) return valid_ = false;
+            partial_[held_++] = bytes[used++];
+        }
+
+        if (held_ < need_) return true;
+        if (!validate_utf8(partial_, need_)) return valid_ = false;
+        held_ = need_ = 0;
+        bytes += used;
+        len -= used;
+    }
+
+    const auto tail = partial_tail(bytes, len);
+    const auto from = codec().validate_utf8(bytes, len - tail);
+    if (from == npos || !validate_utf8(bytes + from, len - tail - from)) return valid_ = false;
+    if (tail) {
+        std::memcpy(partial_, bytes + len - tail, tail);
+        held_ = uint8_t(tail);
+        need_ = uint8_t(sequence_length(partial_[0]));
+    }
+    return true;
+}
 
-    std::string out;
+auto util::b64_decoded_size(std::string_view in) noexcept -> std::size_t {
+    if (in.size() % 4) return 0;
+    std::size_t pad = 0;
+    if (!in.empty() && in.back() == '=') ++pad;
+    if (in.size() > 1 && in[in.size() - 2] == '=') ++pad;
+    return in.size() / 4 * 3 - pad;
+}
+
+auto util::encode_b64(std::span<const std::byte> input, std::span<char> out) -> std::size_t {
     const auto *data = reinterpret_cast<const uint8_t *>(input.data());
     const std::size_t len = input.size();
-    out.reserve(((len + 2) / 3) * 4);
+    const auto size = b64_encoded_size(len);
+    if (out.size() < size) throw range{"Base64 output too small"};
 
-    std::size_t i = 0;
+    auto *text = out.data();
+    std::size_t i = codec().encode_b64(data, len, text);
+    text += i / 3 * 4;
     while (i + 2 < len) {
         const uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
-        out.push_back(alphabet[(triple >> 18) & 0x3F]);
-        out.push_back(alphabet[(triple >> 12) & 0x3F]);
-        out.push_back(alphabet[(triple >> 6) & 0x3F]);
-        out.push_back(alphabet[triple & 0x3F]);
+        *text++ = b64_alphabet[(triple >> 18) & 0x3F];
+        *text++ = b64_alphabet[(triple >> 12) & 0x3F];
+        *text++ = b64_alphabet[(triple >> 6) & 0x3F];
+        *text++ = b64_alphabet[triple & 0x3F];
         i += 3;
     }
 
@@ -94,67 +882,99 @@ auto util::encode_b64(std::span<const std::byte> input) -> std::string {
         uint32_t triple = data[i] << 16;
         if (i + 1 < len) triple |= data[i + 1] << 8;
 
-        out.push_back(alphabet[(triple >> 18) & 0x3F]);
-        out.push_back(alphabet[(triple >> 12) & 0x3F]);
-        out.push_back(i + 1 < len ? alphabet[(triple >> 6) & 0x3F] : '=');
-        out.push_back('=');
+        *text++ = b64_alphabet[(triple >> 18) & 0x3F];
+        *text++ = b64_alphabet[(triple >> 12) & 0x3F];
+        *text++ = i + 1 < len ? b64_alphabet[(triple >> 6) & 0x3F] : '=';
+        *text++ = '=';
     }
+    return size;
+}
+
+auto util::encode_b64(std::span<const std::byte> input) -> std::string {
+    std::string out(b64_encoded_size(input.size()), '\0');
+    encode_b64(input, out);
     return out;
 }
 
-auto util::encode_hex(std::span<const std::byte> input) -> std::string {
-    constexpr char hex[] = "0123456789ABCDEF";
-    std::string out;
-    out.reserve(input.size() * 2);
-    for (const auto& b : input) {
-        auto val = std::to_integer<uint8_t>(b);
-        out.push_back(hex[val >> 4]);
-        out.push_back(hex[val & 0x0F]);
+auto util::encode_hex(std::span<const std::byte> input, std::span<char> out) -> std::size_t {
+    const auto *data = reinterpret_cast<const uint8_t *>(input.data());
+    const auto size = hex_encoded_size(input.size());
+    if (out.size() < size) throw range{"Hex output too small"};
+
+    auto *text = out.data();
+    std::size_t i = codec().encode_hex(data, input.size(), text);
+    text += i * 2;
+    for (; i < input.size(); ++i) {
+        *text++ = hex_alphabet[data[i] >> 4];
+        *text++ = hex_alphabet[data[i] & 0x0F];
     }
+    return size;
+}
+
+auto util::encode_hex(std::span<const std::byte> input) -> std::string {
+    std::string out(hex_encoded_size(input.size()), '\0');
+    encode_hex(input, out);
     return out;
 }
 
-auto util::decode_b64(const std::string& in) -> std::vector<std::byte> {
-    std::vector<std::byte> out;
+// Padding is only accepted at the end of the final quad.
+auto util::decode_b64(std::string_view in, std::span<std::byte> out) -> std::size_t {
     const std::size_t len = in.size();
     if (len % 4 != 0) throw invalid{"Invalid base64 length"};
+    const auto size = b64_decoded_size(in);
+    if (out.size() < size) throw range{"Base64 output too small"};
 
-    for (std::size_t i = 0; i < len; i += 4) {
+    auto *data = reinterpret_cast<uint8_t *>(out.data());
+    std::size_t i = len > 4 ? codec().decode_b64(in.data(), len - 4, data) : 0;
+    data += i / 4 * 3;
+    for (; i < len; i += 4) {
         uint32_t val = 0;
         int pad = 0;
-        for (int j = 0; j < 4; ++j) {
+        for (std::size_t j = 0; j < 4; ++j) {
             const char c = in[i + j];
-            if (c == '=') {
+            if (c == '=' && i + 4 == len && j >= 2) {
                 val <<= 6;
                 ++pad;
             } else {
                 const uint8_t v = b64_lookup[static_cast<unsigned char>(c)];
-                if (v == 0xFF) throw invalid{"Invalid base64 character"};
+                if (v == 0xFF || pad) throw invalid{"Invalid base64 character"};
                 val = (val << 6) | v;
             }
         }
-        if (pad < 3) out.push_back(std::byte{static_cast<uint8_t>(val >> 16)});
-        if (pad < 2) out.push_back(std::byte{static_cast<uint8_t>((val >> 8) & 0xFF)});
-        if (pad < 1) out.push_back(std::byte{static_cast<uint8_t>(val & 0xFF)});
+        *data++ = static_cast<uint8_t>(val >> 16);
+        if (pad < 2) *data++ = static_cast<uint8_t>((val >> 8) & 0xFF);
+        if (pad < 1) *data++ = static_cast<uint8_t>(val & 0xFF);
     }
+    return size;
+}
 
+auto util::decode_b64(const std::string& in) -> std::vector<std::byte> {
+    std::vector<std::byte> out(b64_decoded_size(in));
+    decode_b64(std::string_view(in), out);
     return out;
 }
 
-auto util::decode_hex(const std::string& in) -> std::vector<std::byte> {
+auto util::decode_hex(std::string_view in, std::span<std::byte> out) -> std::size_t {
     if (in.size() % 2 != 0)
         throw invalid{"Hex string must have even length"};
+    const auto size = hex_decoded_size(in.size());
+    if (out.size() < size) throw range{"Hex output too small"};
 
-    std::vector<std::byte> out;
-    out.reserve(in.size() / 2);
-
-    for (std::size_t i = 0; i < in.size(); i += 2) {
+    auto *data = reinterpret_cast<uint8_t *>(out.data());
+    std::size_t i = codec().decode_hex(in.data(), in.size(), data);
+    data += i / 2;
+    for (; i < in.size(); i += 2) {
         const uint8_t hi = hex_lookup[static_cast<unsigned char>(in[i])];
         const uint8_t lo = hex_lookup[static_cast<unsigned char>(in[i + 1])];
         if (hi == 0xFF || lo == 0xFF)
             throw invalid{"Invalid hex character"};
-        out.push_back(std::byte{static_cast<uint8_t>((hi << 4) | lo)});
+        *data++ = static_cast<uint8_t>((hi << 4) | lo);
     }
+    return size;
+}
 
+auto util::decode_hex(const std::string& in) -> std::vector<std::byte> {
+    std::vector<std::byte> out(hex_decoded_size(in.size()));
+    decode_hex(std::string_view(in), out);
     return out;
 }
@@ -15,8 +15,15 @@
 #include <cstring>
 #include <cstddef>
 #include <string_view>
+#include <memory_resource>
+#include <atomic>
+#include <memory>
 #include <bit>
 
+#ifndef BUSUTO_BYTES_INLINE
+#define BUSUTO_BYTES_INLINE 64 // NOLINT
+#endif
+
 namespace busuto::util {
 template <typename T>
 concept PointerTo = std::is_pointer_v<T>;
@@ -44,6 +51,103 @@ auto encode_b64(std::span<const std::byte> input) -> std::string;
 auto decode_b64(const std::string& in) -> std::vector<std::byte>;
 auto decode_hex(const std::string& in) -> std::vector<std::byte>;
 
+// Codecs into caller storage return the size used and throw range if the
+// output is too small; the sizes can be found in advance.
+auto encode_hex(std::span<const std::byte> input, std::span<char> out) -> std::size_t;
+auto encode_b64(std::span<const std::byte> input, std::span<char> out) -> std::size_t;
+auto decode_b64(std::string_view in, std::span<std::byte> out) -> std::size_t;
+auto decode_hex(std::string_view in, std::span<std::byte> out) -> std::size_t;
+auto b64_decoded_size(std::string_view in) noexcept -> std::size_t;
+
+constexpr auto b64_encoded_size(std::size_t len) noexcept {
+    return ((len + 2) / 3) * 4;
+}
+
+constexpr auto hex_encoded_size(std::size_t len) noexcept {
+    return len * 2;
+}
+
+constexpr auto hex_decoded_size(std::size_t len) noexcept {
+    return len / 2;
+}
+
+// Validates utf8 that arrives in chunks, such as successive stream buffer
+// reads. Only a sequence cut off at the end of a chunk is carried over.
+class utf8_validator final {
+public:
+    utf8_validator() noexcept = default;
+
+    explicit operator bool() const noexcept { return valid_; }
+    auto operator!() const noexcept { return !valid_; }
+
+    auto update(const void *data, std::size_t len) noexcept -> bool;
+
+    auto update(std::string_view text) noexcept {
+        return update(text.data(), text.size());
+    }
+
+    auto update(std::span<const std::byte> data) noexcept {
+        return update(data.data(), data.size());
+    }
+
+    // Valid and not waiting for the rest of a sequence.
+    auto complete() const noexcept {
+        return valid_ && !held_;
+    }
+
+    void reset() noexcept {
+        valid_ = true;
+        held_ = need_ = 0;
+    }
+
+private:
+    uint8_t partial_[4]{};
+    uint8_t held_{0}, need_{0};
+    bool valid_{true};
+};
+
+// Offset of the first delimiter at or after from, or npos. Uses vector
+// compares of the first and last delimiter bytes where available.
+auto find_delimiter(std::string_view text, std::string_view delim, std::size_t from = 0) noexcept -> std::size_t;
+
+// Searches text that grows between calls, such as a stream buffer being
+// refilled, so bytes already found not to start a delimiter are skipped.
+// Results are relative to where the text starts, and the memory of what
+// was scanned is dropped when the start or the delimiter changes.
+class delimiter_search final {
+public:
+    auto find(const char *text, std::size_t size, std::string_view delim) noexcept {
+        if (text != text_ || delim != std::string_view(key_, keysize_)) {
+            text_ = text;
+            scanned_ = 0;
+            keysize_ = delim.size() <= sizeof(key_) ? delim.size() : 0;
+            std::memcpy(key_, delim.data(), keysize_);
+            if (!keysize_) text_ = nullptr;
+        }
+
+        const auto pos = find_delimiter({text, size}, delim, scanned_);
+        if (pos == std::string_view::npos && size >= delim.size())
+            scanned_ = std::max(scanned_, size - delim.size() + 1);
+        return pos;
+    }
+
+    // Text moved in memory without any of it being consumed.
+    void moved(const char *from, const char *to) noexcept {
+        if (text_ && text_ == from) text_ = to;
+    }
+
+    void reset() noexcept {
+        text_ = nullptr;
+        scanned_ = 0;
+    }
+
+private:
+    const char *text_{nullptr};
+    std::size_t scanned_{0};
+    char key_[16]{};
+    std::size_t keysize_{0};
+};
+
 constexpr auto big_endian() {
     return std::endian::native == std::endian::big;
 }
@@ -86,6 +190,214 @@ static inline auto swap64(uint64_t value) -> uint64_t {
 #endif
 }
 
+// Castagnoli crc of data, continuing from the crc of what came before it,
+// so a frame may be checked in pieces. Uses the sse4.2 or armv8 crc
+// instructions where available, with three streams at once over large
+// buffers, and a slicing by eight table otherwise.
+auto crc32c(const void *data, std::size_t len, uint32_t crc = 0) noexcept -> uint32_t;
+
+inline auto crc32c(std::span<const std::byte> data, uint32_t crc = 0) noexcept {
+    return crc32c(data.data(), data.size(), crc);
+}
+
+inline auto crc32c(std::string_view text, uint32_t crc = 0) noexcept {
+    return crc32c(text.data(), text.size(), crc);
+}
+
+class crc32c_t final {
+public:
+    explicit crc32c_t(uint32_t crc = 0) noexcept : crc_(crc) {}
+
+    void update(const void *data, std::size_t len) noexcept {
+        crc_ = crc32c(data, len, crc_);
+    }
+
+    void update(std::span<const std::byte> data) noexcept {
+        update(data.data(), data.size());
+    }
+
+    void update(std::string_view text) noexcept {
+        update(text.data(), text.size());
+    }
+
+    auto value() const noexcept { return crc_; }
+    void reset(uint32_t crc = 0) noexcept { crc_ = crc; }
+
+private:
+    uint32_t crc_{0};
+};
+
+// Fast non-cryptographic 64 bit hash, in the style of wyhash, that mixes
+// with full 64 x 64 to 128 bit multiplies. Words are read little endian,
+// so a hash is the same on every host. It is meant for tables and sharding;
+// keys chosen by an attacker need a secret seed. Updates in pieces hash
+// the same as the whole at once.
+class hash64_t final {
+public:
+    explicit hash64_t(uint64_t seed = 0) noexcept {
+        reset(seed);
+    }
+
+    void update(const void *data, std::size_t len) noexcept {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        total_ += len;
+        if (held_ + len <= stripe) {
+            if (len) std::memcpy(buf_ + held_, bytes, len);
+            held_ += len;
+            return;
+        }
+
+        // a stripe is only mixed once more follows it, as the tail of the
+        // hash reads back into the last one
+        if (held_) {
+            const auto fill = stripe - held_;
+            std::memcpy(buf_ + held_, bytes, fill);
+            bytes += fill;
+            len -= fill;
+            mix_stripe(buf_);
+            std::memcpy(last_, buf_ + stripe - sizeof(last_), sizeof(last_));
+            held_ = 0;
+        }
+        if (len > stripe) {
+            for (; len > stripe; bytes += stripe, len -= stripe)
+                mix_stripe(bytes);
+            std::memcpy(last_, bytes - sizeof(last_), sizeof(last_));
+        }
+        std::memcpy(buf_, bytes, len);
+        held_ = len;
+    }
+
+    void update(std::span<const std::byte> data) noexcept {
+        update(data.data(), data.size());
+    }
+
+    void update(std::string_view text) noexcept {
+        update(text.data(), text.size());
+    }
+
+    auto value() const noexcept -> uint64_t {
+        if (total_ <= stripe) return hash(buf_, held_, seed_);
+        uint8_t tail[sizeof(last_) + stripe];
+        std::memcpy(tail, last_, sizeof(last_));
+        std::memcpy(tail + sizeof(last_), buf_, held_);
+        return finish(tail + sizeof(last_), held_, state_[0] ^ state_[1] ^ state_[2], total_);
+    }
+
+    void reset(uint64_t seed = 0) noexcept {
+        seed_ = seed;
+        state_[0] = state_[1] = state_[2] = seed ^ mix(seed ^ key0, key1);
+        total_ = held_ = 0;
+    }
+
+    static auto hash(const void *data, std::size_t len, uint64_t seed = 0) noexcept -> uint64_t {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        seed ^= mix(seed ^ key0, key1);
+        if (len <= 16) {
+            uint64_t a{0}, b{0};
+            if (len >= 4) {
+                const auto mid = (len >> 3) << 2;
+                a = (read4(bytes) << 32) | read4(bytes + mid);
+                b = (read4(bytes + len - 4) << 32) | read4(bytes + len - 4 - mid);
+            } else if (len) {
+                a = (uint64_t(bytes[0]) << 16) | (uint64_t(bytes[len >> 1]) << 8) | bytes[len - 1];
+            }
+            return avalanche(a, b, seed, len);
+        }
+
+        auto left = len;
+        if (left > stripe) {
+            uint64_t state[3] = {seed, seed, seed};
+            for (; left > stripe; bytes += stripe, left -= stripe)
+                mix_stripe(state, bytes);
+            seed = state[0] ^ state[1] ^ state[2];
+        }
+        return finish(bytes, left, seed, len);
+    }
+
+private:
+    static constexpr std::size_t stripe = 48;
+    static constexpr uint64_t key0 = 0xa0761d6478bd642fULL;
+    static constexpr uint64_t key1 = 0xe7037ed1a0b428dbULL;
+    static constexpr uint64_t key2 = 0x8ebc6af09c88c6e3ULL;
+    static constexpr uint64_t key3 = 0x589965cc75374cc3ULL;
+
+    uint64_t seed_{0};
+    uint64_t state_[3]{};
+    std::size_t total_{0}, held_{0};
+    uint8_t buf_[stripe]{};
+    uint8_t last_[16]{};
+
+    static void mum(uint64_t& a, uint64_t& b) noexcept {
+#ifdef __SIZEOF_INT128__
+        const auto product = __uint128_t(a) * b;
+        a = uint64_t(product);
+        b = uint64_t(product >> 64);
+#else
+        const auto ha = a >> 32, hb = b >> 32, la = uint32_t(a), lb = uint32_t(b);
+        const auto hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+        const auto mid = (ll >> 32) + uint32_t(hl) + uint32_t(lh);
+        a = (mid << 32) | uint32_t(ll);
+        b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+#endif
+    }
+
+    static auto mix(uint64_t a, uint64_t b) noexcept -> uint64_t {
+        mum(a, b);
+        return a ^ b;
+    }
+
+    static auto read8(const uint8_t *bytes) noexcept -> uint64_t {
+        uint64_t value{0};
+        std::memcpy(&value, bytes, sizeof(value));
+        if constexpr (std::endian::native == std::endian::big) value = __builtin_bswap64(value);
+        return value;
+    }
+
+    static auto read4(const uint8_t *bytes) noexcept -> uint64_t {
+        uint32_t value{0};
+        std::memcpy(&value, bytes, sizeof(value));
+        if constexpr (std::endian::native == std::endian::big) value = __builtin_bswap32(value);
+        return value;
+    }
+
+    static void mix_stripe(uint64_t *state, const uint8_t *bytes) noexcept {
+        state[0] = mix(read8(bytes) ^ key1, read8(bytes + 8) ^ state[0]);
+        state[1] = mix(read8(bytes + 16) ^ key2, read8(bytes + 24) ^ state[1]);
+        state[2] = mix(read8(bytes + 32) ^ key3, read8(bytes + 40) ^ state[2]);
+    }
+
+    void mix_stripe(const uint8_t *bytes) noexcept {
+        mix_stripe(state_, bytes);
+    }
+
+    // Mixes what is left after the stripes, 1 to 48 bytes; the last
+    // 16 are read where they end, which may reach back into a stripe.
+    static auto finish(const uint8_t *bytes, std::size_t left, uint64_t seed, std::size_t len) noexcept -> uint64_t {
+        for (; left > 16; bytes += 16, left -= 16)
+            seed = mix(read8(bytes) ^ key1, read8(bytes + 8) ^ seed);
+        return avalanche(read8(bytes + left - 16), read8(bytes + left - 8), seed, len);
+    }
+
+    static auto avalanche(uint64_t a, uint64_t b, uint64_t seed, std::size_t len) noexcept -> uint64_t {
+        a ^= key1;
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ key0 ^ len, b ^ key1);
+    }
+};
+
+inline auto hash64(const void *data, std::size_t len, uint64_t seed = 0) noexcept {
+    return hash64_t::hash(data, len, seed);
+}
+
+inline auto hash64(std::span<const std::byte> data, uint64_t seed = 0) noexcept {
+    return hash64_t::hash(data.data(), data.size(), seed);
+}
+
+inline auto hash64(std::string_view text, uint64_t seed = 0) noexcept {
+    return hash64_t::hash(text.data(), text.size(), seed);
+}
+
 template <readable_binary Binary>
 inline auto binary_ptr(Binary obj) {
     return reinterpret_cast<std::byte *>(obj.data());
@@ -143,162 +455,296 @@ static inline auto to_byte(std::byte *data) {
     return reinterpret_cast<uint8_t *>(data);
 }
 
-class byte_array {
+// Byte array with an allocator, so that message buffers can come from an
+// arena or any std::pmr memory resource. Short arrays are held inline, and
+// longer ones are kept in a reference counted block that copies and slices
+// share until one of them is written. Non-const access detaches first, and
+// pins the storage it hands out, so later copies and slices get their own
+// bytes rather than seeing writes made through an earlier pointer or span.
+template <typename Alloc = std::allocator<std::byte>>
+class basic_byte_array {
 public:
+    using allocator_type = Alloc;
     using reference = std::byte&;
     using pointer = std::byte *;
     using const_reference = const std::byte&;
     using size_type = std::size_t;
     using value_type = std::byte;
-    using iterator = typename std::vector<std::byte>::iterator;
-    using const_iterator = typename std::vector<std::byte>::const_iterator;
-    using reverse_iterator = typename std::vector<std::byte>::reverse_iterator;
-    using const_reverse_iterator = typename std::vector<std::byte>::const_reverse_iterator;
+    using iterator = std::byte *;
+    using const_iterator = const std::byte *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-    constexpr byte_array() = default;
+    static constexpr std::size_t inline_size = BUSUTO_BYTES_INLINE;
 
-    constexpr byte_array(const void *data, std::size_t size) : buffer_{static_cast<const std::byte *>(data), static_cast<const std::byte *>(data) + size} {}
+    basic_byte_array() noexcept = default;
 
-    constexpr explicit byte_array(std::size_t size) : buffer_(size) {}
+    explicit basic_byte_array(const Alloc& alloc) noexcept : alloc_(alloc) {}
 
-    constexpr explicit byte_array(std::span<const std::byte> view) : buffer_{view.begin(), view.end()} {}
+    basic_byte_array(const void *data, std::size_t size, const Alloc& alloc = Alloc()) : alloc_(alloc) {
+        assign(static_cast<const std::byte *>(data), size);
+    }
+
+    explicit basic_byte_array(std::size_t size, const Alloc& alloc = Alloc()) : alloc_(alloc) {
+        resize(size);
+    }
+
+    explicit basic_byte_array(std::span<const std::byte> view, const Alloc& alloc = Alloc()) : alloc_(alloc) {
+        assign(view.data(), view.size());
+    }
+
+    explicit basic_byte_array(const std::u8string& s, const Alloc& alloc = Alloc()) : alloc_(alloc) {
+        assign(reinterpret_cast<const std::byte *>(s.data()), s.size());
+    }
 
-    explicit byte_array(const std::u8string& s) : buffer_(reinterpret_cast<const std::byte *>(s.data()), reinterpret_cast<const std::byte *>(s.data()) + s.size()) {}
+    basic_byte_array(const char *cstr, std::size_t size, const Alloc& alloc = Alloc()) : alloc_(alloc) {
+        assign(reinterpret_cast<const std::byte *>(cstr), size);
+    }
+
+    basic_byte_array(const basic_byte_array& from, const Alloc& alloc) : alloc_(alloc) {
+        share(from);
+    }
 
-    byte_array(const char *cstr, std::size_t size) : buffer_{reinterpret_cast<const std::byte *>(cstr), reinterpret_cast<const std::byte *>(cstr) + size} {}
+    basic_byte_array(const basic_byte_array& from) : alloc_(traits::select_on_container_copy_construction(from.alloc_)) {
+        share(from);
+    }
 
-    constexpr byte_array(const byte_array&) = default;
-    constexpr auto operator=(const byte_array&) -> byte_array& = default;
-    constexpr byte_array(byte_array&&) noexcept = default;
-    constexpr auto operator=(byte_array&&) noexcept -> byte_array& = default;
+    basic_byte_array(basic_byte_array&& from) noexcept : alloc_(std::move(from.alloc_)) {
+        take(from);
+    }
+
+    ~basic_byte_array() {
+        release();
+    }
 
-    constexpr operator std::string() const {
+    auto operator=(const basic_byte_array& from) -> basic_byte_array& {
+        if (this == &from) return *this;
+        if constexpr (traits::propagate_on_container_copy_assignment::value) {
+            if (alloc_ != from.alloc_) {
+                release();
+                data_ = inline_;
+                size_ = 0;
+            }
+            alloc_ = from.alloc_;
+        }
+        share(from);
+        return *this;
+    }
+
+    auto operator=(basic_byte_array&& from) noexcept(traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) -> basic_byte_array& {
+        if (this == &from) return *this;
+        if constexpr (traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) {
+            release();
+            if constexpr (traits::propagate_on_container_move_assignment::value)
+                alloc_ = std::move(from.alloc_);
+            take(from);
+        } else {
+            if (alloc_ == from.alloc_) {
+                release();
+                take(from);
+            } else
+                assign(from.data_, from.size_);
+        }
+        return *this;
+    }
+
+    operator std::string() const {
         return to_hex();
     }
 
     explicit operator bool() const noexcept { return !empty(); }
-    constexpr auto operator!() const noexcept { return empty(); }
+    auto operator!() const noexcept { return empty(); }
 
-    constexpr auto operator==(const byte_array& other) const noexcept -> bool {
-        return buffer_ == other.buffer_;
+    template <typename Other>
+    auto operator==(const basic_byte_array<Other>& other) const noexcept -> bool {
+        return std::ranges::equal(span(), other.span());
     }
 
-    constexpr auto operator!=(const byte_array& other) const noexcept -> bool {
+    template <typename Other>
+    auto operator!=(const basic_byte_array<Other>& other) const noexcept -> bool {
         return !(*this == other);
     }
 
-    auto operator^=(const byte_array& other) noexcept -> byte_array& {
+    auto operator^=(const basic_byte_array& other) -> basic_byte_array& {
         if (empty() || other.empty()) return *this;
         std::size_t count = std::min(size(), other.size());
-        auto tp = buffer_.data();
-        auto fp = other.buffer_.data();
+        auto tp = writable();
+        auto fp = other.data();
         while (count--) {
             *(tp++) ^= *(fp++);
         }
         return *this;
     }
 
-    auto operator&=(const byte_array& other) noexcept -> byte_array& {
+    auto operator&=(const basic_byte_array& other) -> basic_byte_array& {
         if (empty() || other.empty()) return *this;
         std::size_t count = std::min(size(), other.size());
-        auto tp = buffer_.data();
-        auto fp = other.buffer_.data();
+        auto tp = writable();
+        auto fp = other.data();
         while (count--) {
             *(tp++) &= *(fp++);
         }
         return *this;
     }
 
-    auto operator|=(const byte_array& other) noexcept -> byte_array& {
+    auto operator|=(const basic_byte_array& other) -> basic_byte_array& {
         if (empty() || other.empty()) return *this;
         std::size_t count = std::min(size(), other.size());
-        auto tp = buffer_.data();
-        auto fp = other.buffer_.data();
+        auto tp = writable();
+        auto fp = other.data();
         while (count--) {
             *(tp++) |= *(fp++);
         }
         return *this;
     }
 
-    auto operator+=(const byte_array& other) noexcept -> byte_array& {
+    template <typename Other>
+    auto operator+=(const basic_byte_array<Other>& other) -> basic_byte_array& {
         append(other);
         return *this;
     }
 
-    auto operator+(const byte_array& other) const noexcept {
-        auto result = *this;
+    template <typename Other>
+    auto operator+(const basic_byte_array<Other>& other) const {
+        basic_byte_array result(get_allocator());
+        result.reserve(size() + other.size());
+        result.append(*this);
         result.append(other);
         return result;
     }
 
+    auto get_allocator() const noexcept { return alloc_; }
+
     auto u8data() const noexcept -> const uint8_t * {
         return reinterpret_cast<const uint8_t *>(data());
     }
 
-    auto u8data() noexcept -> uint8_t * {
+    auto u8data() -> uint8_t * {
         return reinterpret_cast<uint8_t *>(data());
     }
 
-    constexpr auto data() const noexcept -> const std::byte * { return buffer_.data(); }
-    constexpr auto data() noexcept -> std::byte * { return buffer_.data(); }
-    constexpr auto size() const noexcept -> std::size_t { return buffer_.size(); }
-    constexpr auto capacity() const noexcept -> std::size_t { return buffer_.capacity(); }
+    auto data() const noexcept -> const std::byte * { return data_; }
+    auto size() const noexcept -> std::size_t { return size_; }
 
-    constexpr auto span() const noexcept -> std::span<const std::byte> {
-        return std::span<const std::byte>{buffer_.data(), buffer_.size()};
+    auto data() -> std::byte * {
+        auto ptr = writable();
+        pinned_ = block_ != nullptr;
+        return ptr;
     }
 
-    auto span_mut() noexcept -> std::span<std::byte> {
-        return std::span<std::byte>{buffer_.data(), buffer_.size()};
+    // Bytes that can be written in place, none while shared.
+    auto capacity() const noexcept -> std::size_t {
+        if (!block_) return std::size_t(inline_ + inline_size - data_);
+        if (!unique()) return size_;
+        return std::size_t(block_->bytes() + block_->capacity - data_);
     }
 
-    auto view() const noexcept -> std::string_view {
-        return std::string_view{reinterpret_cast<const char *>(buffer_.data()), buffer_.size()};
+    // Storage is shared with a copy or slice.
+    auto shared() const noexcept {
+        return !unique();
     }
 
-    constexpr void swap(byte_array& other) noexcept {
-        buffer_.swap(other.buffer_);
+    // Mutable pointers were taken, so copies will not share the storage.
+    auto pinned() const noexcept {
+        return pinned_;
     }
 
-    void remove_prefix(std::size_t n) {
-        if (n >= buffer_.size()) {
-            buffer_.clear();
-        } else {
-            buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::vector<std::byte>::difference_type>(n));
-        }
+    // Own the bytes in a private block before they are written.
+    void detach() {
+        if (!unique()) reallocate(size_);
+    }
+
+    auto span() const noexcept -> std::span<const std::byte> {
+        return std::span<const std::byte>{data_, size_};
     }
 
-    void remove_suffix(std::size_t n) {
-        if (n >= buffer_.size()) {
-            buffer_.clear();
+    auto span_mut() -> std::span<std::byte> {
+        return std::span<std::byte>{data(), size_};
+    }
+
+    auto view() const noexcept -> std::string_view {
+        return std::string_view{reinterpret_cast<const char *>(data_), size_};
+    }
+
+    // Storage only changes hands when both allocators can free it, and
+    // unequal allocators that do not propagate swap copies of the bytes.
+    void swap(basic_byte_array& other) noexcept(traits::propagate_on_container_swap::value || traits::is_always_equal::value) {
+        if (this == &other) return;
+        if constexpr (traits::propagate_on_container_swap::value) {
+            basic_byte_array temp(std::move(other));
+            other.alloc_ = alloc_;
+            other.take(*this);
+            alloc_ = temp.alloc_;
+            take(temp);
         } else {
-            buffer_.resize(buffer_.size() - n);
+            if (alloc_ == other.alloc_) {
+                basic_byte_array temp(std::move(other));
+                other.take(*this);
+                take(temp);
+                return;
+            }
+            basic_byte_array temp(other.alloc_);
+            temp.assign(data_, size_);
+            assign(other.data_, other.size_);
+            other.release();
+            other.take(temp);
         }
     }
 
+    // Drops leading bytes without moving the rest, even when shared.
+    void remove_prefix(std::size_t n) noexcept {
+        n = std::min(n, size_);
+        data_ += n;
+        size_ -= n;
+    }
+
+    void remove_suffix(std::size_t n) noexcept {
+        size_ -= std::min(n, size_);
+    }
+
     void append(const void *src, std::size_t n) {
-        const auto *p = static_cast<const std::byte *>(src);
-        buffer_.insert(buffer_.end(), p, p + n);
+        if (!n) return;
+        auto from = static_cast<const std::byte *>(src);
+        if (from >= data_ && from < data_ + size_) {
+            const auto offset = from - data_;
+            grow(size_ + n);
+            from = data_ + offset;
+        } else
+            grow(size_ + n);
+        std::memmove(data_ + size_, from, n);
+        size_ += n;
     }
 
-    void append(const byte_array& other) {
-        if (!other.empty())
-            buffer_.insert(buffer_.end(), other.data(), other.data() + other.size());
+    template <typename Other>
+    void append(const basic_byte_array<Other>& other) {
+        append(other.data(), other.size());
     }
 
-    constexpr auto begin() noexcept -> std::vector<std::byte>::iterator { return buffer_.begin(); }
-    constexpr auto end() noexcept -> std::vector<std::byte>::iterator { return buffer_.end(); }
+    auto begin() -> iterator { return data(); }
+    auto end() -> iterator { return data() + size_; }
 
-    constexpr auto begin() const noexcept -> std::vector<std::byte>::const_iterator { return buffer_.begin(); }
-    constexpr auto end() const noexcept -> std::vector<std::byte>::const_iterator { return buffer_.end(); }
+    auto begin() const noexcept -> const_iterator { return data_; }
+    auto end() const noexcept -> const_iterator { return data_ + size_; }
 
-    constexpr auto empty() const noexcept -> bool { return buffer_.empty(); }
+    auto empty() const noexcept -> bool { return !size_; }
 
-    auto slice(std::size_t start = 0, std::size_t end = std::numeric_limits<std::size_t>::max()) const -> byte_array {
+    // Slices longer than the inline size share the block without copying.
+    auto slice(std::size_t start = 0, std::size_t end = std::numeric_limits<std::size_t>::max()) const -> basic_byte_array {
         const auto actual_end = std::min(end, size());
         if (start > actual_end)
             throw range{"Invalid slice range"};
-        return byte_array{data() + start, actual_end - start};
+
+        basic_byte_array result(get_allocator());
+        const auto count = actual_end - start;
+        if (!block_ || pinned_ || count <= inline_size) {
+            result.assign(data_ + start, count);
+            return result;
+        }
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+        result.block_ = block_;
+        result.data_ = data_ + start;
+        result.size_ = count;
+        return result;
     }
 
     auto subspan(std::size_t offset, std::size_t count = std::numeric_limits<std::size_t>::max()) const -> std::span<const std::byte> {
@@ -315,56 +761,83 @@ public:
         return std::string_view{reinterpret_cast<const char *>(data()) + offset, actual_end - offset};
     }
 
-    void clear() noexcept { buffer_.clear(); }
-    void resize(std::size_t n) { buffer_.resize(n); }
-    void reserve(std::size_t n) { buffer_.reserve(n); }
-    void shrink_to_fit() { buffer_.shrink_to_fit(); }
-    void push_back(std::byte b) { buffer_.push_back(b); }
-    void pop_back() { buffer_.pop_back(); }
+    void clear() noexcept {
+        if (unique()) {
+            data_ = block_ ? block_->bytes() : inline_;
+        } else {
+            release();
+            data_ = inline_;
+        }
+        size_ = 0;
+    }
+
+    void resize(std::size_t n) {
+        if (n > size_) {
+            grow(n);
+            std::memset(data_ + size_, 0, n - size_);
+        }
+        size_ = n;
+    }
+
+    void reserve(std::size_t n) {
+        if (!unique() || n > capacity())
+            reallocate(std::max(n, size_));
+    }
 
-    auto operator[](std::size_t i) -> std::byte& { return buffer_[i]; }
-    constexpr auto operator[](std::size_t i) const -> const std::byte& { return buffer_[i]; }
-    auto front() -> std::byte& { return buffer_.front(); }
-    auto back() -> std::byte& { return buffer_.back(); }
-    constexpr auto front() const -> const std::byte& { return buffer_.front(); }
-    constexpr auto back() const -> const std::byte& { return buffer_.back(); }
+    void shrink_to_fit() {
+        if (block_ && capacity() > size_) reallocate(size_);
+    }
+
+    void push_back(std::byte b) {
+        grow(size_ + 1);
+        data_[size_++] = b;
+    }
+
+    void pop_back() noexcept { --size_; }
+
+    auto operator[](std::size_t i) -> std::byte& { return data()[i]; }
+    auto operator[](std::size_t i) const noexcept -> const std::byte& { return data_[i]; }
+    auto front() -> std::byte& { return data()[0]; }
+    auto back() -> std::byte& { return data()[size_ - 1]; }
+    auto front() const noexcept -> const std::byte& { return data_[0]; }
+    auto back() const noexcept -> const std::byte& { return data_[size_ - 1]; }
 
     auto c_str() const -> const char * {
-        return reinterpret_cast<const char *>(buffer_.data());
+        return reinterpret_cast<const char *>(data_);
     }
 
     void fill(std::byte value) {
-        std::ranges::fill(buffer_, value);
+        std::ranges::fill(std::span<std::byte>{writable(), size_}, value);
     }
 
     void replace(std::byte from, std::byte to) {
-        std::ranges::replace(buffer_, from, to);
+        std::ranges::replace(std::span<std::byte>{writable(), size_}, from, to);
     }
 
     void reverse() {
-        std::ranges::reverse(buffer_);
+        std::ranges::reverse(std::span<std::byte>{writable(), size_});
     }
 
     auto to_u8vector() const -> std::vector<uint8_t> {
-        std::vector<uint8_t> out(buffer_.size());
-        std::ranges::transform(buffer_, out.begin(), [](std::byte b) { return std::to_integer<uint8_t>(b); });
+        std::vector<uint8_t> out(size_);
+        std::ranges::transform(span(), out.begin(), [](std::byte b) { return std::to_integer<uint8_t>(b); });
         return out;
     }
 
-    constexpr auto to_string() const -> std::string {
+    auto to_string() const -> std::string {
         return to_hex();
     }
 
     auto to_u8string() const -> std::u8string {
-        const auto *p = reinterpret_cast<const char8_t *>(buffer_.data());
-        return std::u8string{p, buffer_.size()};
+        const auto *p = reinterpret_cast<const char8_t *>(data_);
+        return std::u8string{p, size_};
     }
 
-    constexpr auto to_hex() const -> std::string {
+    auto to_hex() const -> std::string {
         constexpr char hex[] = "0123456789ABCDEF";
         std::string out;
         out.reserve(size() * 2);
-        for (const auto& b : buffer_) {
+        for (const auto& b : span()) {
             auto val = std::to_integer<unsigned char>(b);
             out.push_back(hex[val >> 4]);
             out.push_back(hex[val & 0x0F]);
@@ -373,14 +846,191 @@ public:
     }
 
 private:
-    std::vector<std::byte> buffer_;
+    template <typename>
+    friend class basic_byte_array;
+
+    // Header of a shared block; the bytes follow it.
+    struct block_t {
+        std::atomic<std::size_t> refs;
+        std::size_t capacity;
+
+        explicit block_t(std::size_t size) noexcept : refs(1), capacity(size) {}
+
+        auto bytes() noexcept {
+            return reinterpret_cast<std::byte *>(this + 1);
+        }
+    };
 
-    friend void swap(byte_array& a, byte_array& b) noexcept {
+    using traits = std::allocator_traits<Alloc>;
+    using block_alloc = typename traits::template rebind_alloc<block_t>;
+    using block_traits = std::allocator_traits<block_alloc>;
+
+    std::byte *data_{inline_};
+    std::size_t size_{0};
+    block_t *block_{nullptr};
+    bool pinned_{false};
+    [[no_unique_address]] Alloc alloc_{};
+    alignas(std::max_align_t) std::byte inline_[inline_size];
+
+    friend void swap(basic_byte_array& a, basic_byte_array& b) noexcept(noexcept(a.swap(b))) {
         a.swap(b);
     }
+
+    auto unique() const noexcept -> bool {
+        return !block_ || block_->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    // Detached bytes for our own writes, which hand out nothing to pin.
+    auto writable() -> std::byte * {
+        detach();
+        return data_;
+    }
+
+    auto allocate(std::size_t size) -> block_t * {
+        block_alloc alloc(alloc_);
+        const auto units = 1 + (size + sizeof(block_t) - 1) / sizeof(block_t);
+        auto block = block_traits::allocate(alloc, units);
+        return std::construct_at(block, (units - 1) * sizeof(block_t));
+    }
+
+    void release() noexcept {
+        auto block = std::exchange(block_, nullptr);
+        if (!block || block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        block_alloc alloc(alloc_);
+        const auto units = 1 + block->capacity / sizeof(block_t);
+        std::destroy_at(block);
+        block_traits::deallocate(alloc, block, units);
+    }
+
+    // Moves the bytes into private storage of at least the given size.
+    void reallocate(std::size_t size) {
+        auto block = size > inline_size ? allocate(size) : nullptr;
+        auto to = block ? block->bytes() : inline_;
+        std::memmove(to, data_, size_);
+        release();
+        block_ = block;
+        data_ = to;
+        pinned_ = false;
+    }
+
+    void grow(std::size_t size) {
+        if (unique() && size <= capacity()) return;
+        if (unique() && size <= inline_size && !block_) {
+            reallocate(size); // compact inline storage
+            return;
+        }
+        reallocate(std::max(size, size_ * 2));
+    }
+
+    void assign(const std::byte *from, std::size_t size) {
+        if (unique() && size <= capacity()) {
+            if (size) std::memmove(data_, from, size);
+            size_ = size;
+            return;
+        }
+        if (unique() && !block_ && size <= inline_size) {
+            std::memmove(inline_, from, size);
+            data_ = inline_;
+            size_ = size;
+            return;
+        }
+        auto block = size > inline_size ? allocate(size) : nullptr;
+        auto to = block ? block->bytes() : inline_;
+        std::memcpy(to, from, size);
+        release();
+        block_ = block;
+        data_ = to;
+        size_ = size;
+        pinned_ = false;
+    }
+
+    // Copies share a block unless short, or the allocators differ.
+    template <typename Other>
+    void share(const basic_byte_array<Other>& from) {
+        if constexpr (std::is_same_v<Other, Alloc>) {
+            if (from.block_ && !from.pinned_ && from.size_ > inline_size && alloc_ == from.alloc_) {
+                if (block_ == from.block_) {
+                    data_ = from.data_;
+                    size_ = from.size_;
+                    return;
+                }
+                from.block_->refs.fetch_add(1, std::memory_order_relaxed);
+                release();
+                block_ = from.block_;
+                data_ = from.data_;
+                size_ = from.size_;
+                pinned_ = false;
+                return;
+            }
+        }
+        assign(from.data_, from.size_);
+    }
+
+    // Takes the storage of another, whose allocator is already ours.
+    void take(basic_byte_array& from) noexcept {
+        if (from.block_) {
+            block_ = std::exchange(from.block_, nullptr);
+            data_ = from.data_;
+        } else {
+            std::memcpy(inline_, from.data_, from.size_);
+            data_ = inline_;
+        }
+        pinned_ = std::exchange(from.pinned_, false);
+        size_ = std::exchange(from.size_, 0);
+        from.data_ = from.inline_;
+    }
 };
 
-inline auto operator<<(std::ostream& out, const byte_array& bytes) -> std::ostream& {
+using byte_array = basic_byte_array<>;
+
+namespace pmr {
+using byte_array = basic_byte_array<std::pmr::polymorphic_allocator<std::byte>>;
+} // namespace pmr
+
+template <typename A>
+concept allocator_type = requires(A alloc) {
+    typename A::value_type;
+    alloc.allocate(std::size_t(1));
+};
+
+// Arena for one request or message. Allocations are pointer bumps from an
+// inline block and then from larger chunks of the upstream resource, and
+// reset releases them all at once.
+template <std::size_t S = 4096>
+class arena final {
+public:
+    explicit arena(std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept : resource_(initial_, S, upstream) {}
+
+    arena(const arena&) = delete;
+    auto operator=(const arena&) -> arena& = delete;
+
+    operator std::pmr::memory_resource *() noexcept { return &resource_; }
+    auto resource() noexcept -> std::pmr::memory_resource * { return &resource_; }
+
+    template <typename T = std::byte>
+    auto allocator() noexcept {
+        return std::pmr::polymorphic_allocator<T>(&resource_);
+    }
+
+    auto bytes(std::size_t size = 0) {
+        return pmr::byte_array(size, allocator());
+    }
+
+    auto string(std::string_view text = {}) {
+        return std::pmr::string(text, allocator<char>());
+    }
+
+    void reset() noexcept {
+        resource_.release();
+    }
+
+private:
+    alignas(std::max_align_t) std::byte initial_[S];
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+template <typename Alloc>
+inline auto operator<<(std::ostream& out, const basic_byte_array<Alloc>& bytes) -> std::ostream& {
     if (is(bytes))
         out << bytes.to_hex();
     else
@@ -393,7 +1043,20 @@ inline auto to_byte_span(const Binary& obj) {
     return byte_span(reinterpret_cast<const std::byte *>(obj.data()), obj.size());
 }
 
-constexpr auto to_string(const byte_array& ba) {
+// Hash of binary keys, such as byte arrays, for unordered maps and the
+// dictionary_t. Transparent, so maps keyed by byte arrays can be searched
+// with spans and string views of the same bytes.
+struct binary_hash {
+    using is_transparent = void;
+
+    template <util::readable_binary Binary>
+    auto operator()(const Binary& bin) const noexcept {
+        return std::size_t(util::hash64(bin.data(), bin.size()));
+    }
+};
+
+template <typename Alloc>
+constexpr auto to_string(const basic_byte_array<Alloc>& ba) {
     return ba.to_hex();
 }
 
@@ -415,6 +1078,63 @@ static inline auto from_b64(const std::string& in) {
     return byte_array(util::decode_b64(in));
 }
 
+// Decodes into an existing byte_array, reusing its storage.
+template <typename Alloc>
+inline auto from_hex(std::string_view in, basic_byte_array<Alloc>& out) {
+    out.resize(util::hex_decoded_size(in.size()));
+    return util::decode_hex(in, out.span_mut());
+}
+
+template <typename Alloc>
+inline auto from_b64(std::string_view in, basic_byte_array<Alloc>& out) {
+    out.resize(util::b64_decoded_size(in));
+    return util::decode_b64(in, out.span_mut());
+}
+
+template <util::readable_binary Binary>
+inline auto to_b64(const Binary& bin, std::span<char> out) {
+    return util::encode_b64(to_byte_span(bin), out);
+}
+
+template <util::readable_binary Binary>
+inline auto to_hex(const Binary& bin, std::span<char> out) {
+    return util::encode_hex(to_byte_span(bin), out);
+}
+
+// Codecs into strings and byte arrays using a caller allocator, such as
+// one from an arena.
+template <util::readable_binary Binary, allocator_type Alloc>
+inline auto to_hex(const Binary& bin, const Alloc& alloc) {
+    using chars = typename std::allocator_traits<Alloc>::template rebind_alloc<char>;
+    std::basic_string<char, std::char_traits<char>, chars> out(util::hex_encoded_size(bin.size()), '\0', chars(alloc));
+    util::encode_hex(to_byte_span(bin), std::span<char>(out.data(), out.size()));
+    return out;
+}
+
+template <util::readable_binary Binary, allocator_type Alloc>
+inline auto to_b64(const Binary& bin, const Alloc& alloc) {
+    using chars = typename std::allocator_traits<Alloc>::template rebind_alloc<char>;
+    std::basic_string<char, std::char_traits<char>, chars> out(util::b64_encoded_size(bin.size()), '\0', chars(alloc));
+    out.resize(util::encode_b64(to_byte_span(bin), std::span<char>(out.data(), out.size())));
+    return out;
+}
+
+template <allocator_type Alloc>
+inline auto from_hex(std::string_view in, const Alloc& alloc) {
+    using bytes = typename std::allocator_traits<Alloc>::template rebind_alloc<std::byte>;
+    basic_byte_array<bytes> out{bytes(alloc)};
+    from_hex(in, out);
+    return out;
+}
+
+template <allocator_type Alloc>
+inline auto from_b64(std::string_view in, const Alloc& alloc) {
+    using bytes = typename std::allocator_traits<Alloc>::template rebind_alloc<std::byte>;
+    basic_byte_array<bytes> out{bytes(alloc)};
+    out.resize(from_b64(in, out));
+    return out;
+}
+
 template <typename T>
 requires(
 std::is_trivially_constructible_v<T> &&
@@ -426,15 +1146,10 @@ inline auto make_binary(const T& obj) {
 } // namespace busuto
 
 namespace std {
-template <>
-struct hash<busuto::byte_array> {
-    auto operator()(const busuto::byte_array& b) const noexcept {
-        if (!is(b))
-            return std::size_t(0);
-        const auto *bytes = b.data();
-        return std::hash<std::string_view>{}(std::string_view(
-        reinterpret_cast<const char *>(bytes),
-        b.size()));
+template <typename Alloc>
+struct hash<busuto::basic_byte_array<Alloc>> {
+    auto operator()(const busuto::basic_byte_array<Alloc>& b) const noexcept {
+        return busuto::binary_hash{}(b);
     }
 };
 } // namespace std
@@ -6,6 +6,7 @@
 #include "binary.hpp"
 #include <istream>
 #include <ostream>
+#include <span>
 
 namespace busuto::util {
 class memorybuf final : public std::streambuf {
@@ -56,18 +57,26 @@ public:
         return {};
     }
 
+    // Offset of the next delimiter in unread input, or npos.
+    auto zb_find(std::string_view delim = "\r\n") const noexcept {
+        return util::find_delimiter({gptr(), static_cast<std::size_t>(egptr() - gptr())}, delim);
+    }
+
+    // Free output space to format into in place, and then commit.
+    auto zb_space() noexcept -> std::span<char> {
+        return {pptr(), static_cast<std::size_t>(epptr() - pptr())};
+    }
+
+    void zb_commit(std::size_t n) noexcept {
+        pbump(static_cast<int>(n));
+    }
+
     auto zb_getview(std::string_view delim = "\r\n") -> std::string_view {
         auto *start = gptr();
-        auto *end = start;
-        while (true) {
-            auto avail = static_cast<size_t>(egptr() - end);
-            if (avail < delim.size()) return {};
-            if (std::string_view(end, delim.size()) == delim) {
-                gbump(static_cast<int>((end - start) + delim.size()));
-                return {start, static_cast<std::size_t>(end - start)};
-            }
-            ++end;
-        }
+        const auto pos = zb_find(delim);
+        if (pos == std::string_view::npos) return {};
+        gbump(static_cast<int>(pos + delim.size()));
+        return {start, pos};
     }
 
 private:
@@ -105,6 +114,7 @@ public:
     auto is_open() const noexcept { return buf_.readable(); }
     auto getbody(size_t n) { return buf_.zb_getbody(n); }
     auto getview(std::string_view delim = "\r\n") { return buf_.zb_getview(delim); }
+    auto find(std::string_view delim = "\r\n") const noexcept { return buf_.zb_find(delim); }
 
     template <util::readable_binary Binary>
     explicit input_buffer(const Binary& bin) : std::istream(&buf_) {
@@ -130,6 +140,8 @@ public:
     }
 
     auto is_open() const noexcept { return buf_.writable(); }
+    auto space(std::size_t /* want */ = 1) noexcept { return buf_.zb_space(); }
+    void commit(std::size_t n) noexcept { buf_.zb_commit(n); }
 
     template <util::writable_binary Binary>
     explicit output_buffer(Binary& bin) : std::ostream(&buf_) {
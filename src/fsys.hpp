@@ -9,11 +9,36 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <cstring>
 #include <dirent.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#endif
+
+#ifndef BUSUTO_SCAN_BUFFER
+#define BUSUTO_SCAN_BUFFER 65536 // NOLINT
+#endif
+
+#ifndef BUSUTO_WALK_HANDLES
+#define BUSUTO_WALK_HANDLES 256 // NOLINT
+#endif
 
 #if defined(__OpenBSD__)
-#define stat64 stat   // NOLINT
-#define fstat64 fstat // NOLINT
+#define stat64 stat       // NOLINT
+#define fstat64 fstat     // NOLINT
+#define fstatat64 fstatat // NOLINT
 #endif
 
 namespace busuto::fsys {
@@ -35,6 +60,51 @@ concept prefix_predicate =
 std::invocable<F, const dirent_t> &&
 std::convertible_to<std::invoke_result_t<F, const dirent_t>, bool>;
 
+// parallel walk options; without stat the d_type is trusted when known
+struct walk_t {
+    bool stat{true};
+    bool follow{false};
+    unsigned depth{std::numeric_limits<unsigned>::max()};
+};
+
+// Entry view handed to parallel walk predicates. The name and parent
+// are only valid during the call; handle is the parent directory for
+// use with openat or fstatat.
+class walk_entry final {
+public:
+    walk_entry(int handle, std::string_view parent, std::string_view name, unsigned char type, unsigned depth, const struct stat64 *info) noexcept : handle_(handle), depth_(depth), type_(type), parent_(parent), name_(name), info_(info) {}
+
+    auto handle() const noexcept { return handle_; }
+    auto depth() const noexcept { return depth_; }
+    auto type() const noexcept { return type_; }
+    auto name() const noexcept { return name_; }
+    auto parent() const noexcept { return parent_; }
+    auto info() const noexcept { return info_; }
+    auto is_directory() const noexcept { return type_ == DT_DIR; }
+    auto is_regular() const noexcept { return type_ == DT_REG; }
+    auto is_symlink() const noexcept { return type_ == DT_LNK; }
+    auto path() const { return path_t(parent_) / path_t(name_); }
+
+private:
+    using path_t = std::filesystem::path;
+
+    int handle_{-1};
+    unsigned depth_{0};
+    unsigned char type_{DT_UNKNOWN};
+    std::string_view parent_, name_;
+    const struct stat64 *info_{nullptr};
+};
+
+template <typename F>
+concept walk_predicate =
+std::invocable<F, const walk_entry&> &&
+std::convertible_to<std::invoke_result_t<F, const walk_entry&>, bool>;
+
+template <typename Executor>
+concept walk_executor = requires(Executor& exec) {
+    { exec.dispatch([] {}) } -> std::convertible_to<bool>;
+};
+
 // lightweight alternative to filesystem dir
 class dir_t final {
 public:
@@ -81,31 +151,267 @@ private:
             ::closedir(std::exchange(dir_, nullptr));
     }
 };
-} // namespace busuto::fsys
 
-namespace busuto {
-template <fsys::file_predicate Func>
-inline auto scan_stream(std::istream& input, Func func) {
-    std::string line;
+// read-only mapping of a regular file, empty if it cannot be mapped
+class map_t final {
+public:
+    constexpr map_t() = default;
+    map_t(const map_t&) = delete;
+    auto operator=(const map_t&) -> map_t& = delete;
+
+    map_t(map_t&& from) noexcept : data_(std::exchange(from.data_, nullptr)), size_(std::exchange(from.size_, 0)) {}
+
+    explicit map_t(int handle, bool sequential = true) noexcept {
+#if __has_include(<sys/mman.h>)
+        struct stat64 info {};
+        if (handle < 0 || fstat64(handle, &info) || !S_ISREG(info.st_mode) || info.st_size <= 0) return;
+        auto map = ::mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, handle, 0);
+        if (map == MAP_FAILED) return; // NOLINT
+        data_ = static_cast<const char *>(map);
+        size_ = std::size_t(info.st_size);
+        if (sequential)
+            ::madvise(map, size_, MADV_SEQUENTIAL);
+#else
+        (void)handle;
+        (void)sequential;
+#endif
+    }
+
+    ~map_t() { release(); }
+
+    auto operator=(map_t&& from) noexcept -> map_t& {
+        release();
+        data_ = std::exchange(from.data_, nullptr);
+        size_ = std::exchange(from.size_, 0);
+        return *this;
+    }
+
+    constexpr operator bool() const noexcept { return data_ != nullptr; }
+    constexpr auto operator!() const noexcept { return data_ == nullptr; }
+    constexpr auto data() const noexcept { return data_; }
+    constexpr auto size() const noexcept { return size_; }
+    constexpr auto view() const noexcept { return std::string_view(data_, size_); }
+
+private:
+    const char *data_{nullptr};
+    std::size_t size_{0};
+
+    void release() noexcept {
+#if __has_include(<sys/mman.h>)
+        if (data_)
+            ::munmap(const_cast<char *>(std::exchange(data_, nullptr)), size_);
+#endif
+        size_ = 0;
+    }
+};
+
+// Reads raw directory entries from an open directory handle, calling
+// visit with each name and d_type other than dot entries. Names are nul
+// terminated views into the read buffer.
+template <typename Visit>
+inline void read_entries(int handle, Visit visit) {
+#if defined(__linux__) && defined(SYS_getdents64)
+    alignas(8) char buffer[32768];
+    for (;;) {
+        const auto got = ::syscall(SYS_getdents64, handle, buffer, sizeof(buffer));
+        if (got <= 0) return;
+        for (long pos = 0; pos < got;) {
+            // linux_dirent64: ino, off, reclen, type, then the name
+            unsigned short reclen{0};
+            std::memcpy(&reclen, buffer + pos + 16, sizeof(reclen));
+            const auto type = static_cast<unsigned char>(buffer[pos + 18]);
+            const std::string_view name(buffer + pos + 19);
+            pos += reclen;
+            if (name != "." && name != "..")
+                visit(name, type);
+        }
+    }
+#else
+    dir_t dir(::dup(handle));
+    while (auto entry = dir.get()) {
+        const std::string_view name(entry->d_name);
+        if (name != "." && name != "..")
+            visit(name, static_cast<unsigned char>(entry->d_type));
+    }
+#endif
+}
+
+// Shared state of a parallel walk. Each directory is a task; it opens
+// children relative to its own handle while few handles are held, and by
+// full path otherwise, so wide trees cannot exhaust descriptors.
+template <walk_executor Executor, walk_predicate Func>
+class walker final : public std::enable_shared_from_this<walker<Executor, Func>> {
+public:
+    walker(Executor& exec, Func& func, const walk_t& options) noexcept : exec_(exec), func_(func), options_(options) {}
+
+    void start(const std::string& root) {
+        pending_.fetch_add(1);
+        visit(nullptr, root, 0);
+        for (auto count = pending_.load(); count; count = pending_.load())
+            pending_.wait(count);
+        if (error_) std::rethrow_exception(error_);
+    }
+
+    auto count() const noexcept { return count_.load(); }
+
+private:
+    using parent_t = std::shared_ptr<const int>;
+
+    Executor& exec_;
+    Func& func_;
+    walk_t options_;
+    std::atomic<std::size_t> pending_{0}, count_{0};
+    std::atomic<unsigned> held_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex lock_;
+    std::exception_ptr error_;
+
+    void visit(const parent_t& parent, const std::string& path, unsigned depth) noexcept {
+        const auto self = this->shared_from_this(); // alive past the notify
+        try {
+            if (!stop_) scan(parent, path, depth);
+        } catch (...) {
+            const std::lock_guard lock(lock_);
+            if (!error_) error_ = std::current_exception();
+            stop_ = true;
+        }
+
+        if (pending_.fetch_sub(1) == 1)
+            pending_.notify_all();
+    }
+
+    auto open(const parent_t& parent, const std::string& path) const noexcept {
+        constexpr auto flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+        if (!parent) return ::open(path.c_str(), flags);
+        const auto slash = path.rfind('/');
+        return ::openat(*parent, path.c_str() + (slash == std::string::npos ? 0 : slash + 1), flags);
+    }
+
+    void scan(const parent_t& parent, const std::string& path, unsigned depth) {
+        const int fd = open(parent, path);
+        if (fd < 0) return;
+        held_.fetch_add(1);
+        const parent_t self(new int(fd), [walk = this->shared_from_this()](const int *handle) {
+            ::close(*handle);
+            walk->held_.fetch_sub(1);
+            delete handle;
+        });
+
+        read_entries(fd, [&](std::string_view name, unsigned char type) {
+            if (stop_) return;
+            struct stat64 info {};
+            const struct stat64 *stat = nullptr;
+            if ((options_.stat || type == DT_UNKNOWN) && !fstatat64(fd, name.data(), &info, AT_SYMLINK_NOFOLLOW)) {
+                stat = &info;
+                type = mode_type(info.st_mode);
+            }
+
+            const walk_entry entry(fd, path, name, type, depth, stat);
+            if (func_(entry)) count_.fetch_add(1, std::memory_order_relaxed);
+            if (depth + 1 >= options_.depth) return;
+            if (type == DT_DIR || (type == DT_LNK && options_.follow && is_dir(fd, name)))
+                descend(self, path + "/" + std::string(name), depth + 1);
+        });
+    }
+
+    void descend(const parent_t& parent, std::string path, unsigned depth) {
+        auto hold = held_.load() < BUSUTO_WALK_HANDLES ? parent : parent_t{};
+        pending_.fetch_add(1);
+        auto self = this->shared_from_this();
+        if (exec_.dispatch([self, hold, path, depth] { self->visit(hold, path, depth); })) return;
+        visit(hold, path, depth);
+    }
+
+    static auto is_dir(int fd, std::string_view name) noexcept -> bool {
+        struct stat64 info {};
+        return !fstatat64(fd, name.data(), &info, 0) && S_ISDIR(info.st_mode);
+    }
+
+    static constexpr auto mode_type(mode_t mode) noexcept -> unsigned char {
+        if (S_ISDIR(mode)) return DT_DIR;
+        if (S_ISREG(mode)) return DT_REG;
+        if (S_ISLNK(mode)) return DT_LNK;
+        if (S_ISFIFO(mode)) return DT_FIFO;
+        if (S_ISSOCK(mode)) return DT_SOCK;
+        if (S_ISCHR(mode)) return DT_CHR;
+        if (S_ISBLK(mode)) return DT_BLK;
+        return DT_UNKNOWN;
+    }
+};
+
+// Splits text into lines without copying; memchr does the vectorized
+// newline search. Like getline, a final unterminated line is included.
+template <file_predicate Func>
+inline auto scan_lines(std::string_view text, Func& func) {
     std::size_t count{0};
-    while (std::getline(input, line)) {
-        if (!func(line)) break;
+    while (!text.empty()) {
+        const auto *end = static_cast<const char *>(std::memchr(text.data(), '\n', text.size()));
+        const auto len = end ? std::size_t(end - text.data()) : text.size();
+        if (!func(text.substr(0, len))) break;
         ++count;
+        text.remove_prefix(end ? len + 1 : len);
     }
     return count;
 }
 
-template <fsys::file_predicate Func>
-inline auto scan_file(const fsys::path& path, Func func) {
-    std::fstream input(path);
-    std::string line;
+// Scans lines from a reader with a large buffer, copying only the lines
+// that straddle two reads.
+template <typename Reader, file_predicate Func>
+inline auto scan_reader(Reader reader, Func& func) {
+    std::vector<char> buffer(BUSUTO_SCAN_BUFFER);
+    std::string carry;
     std::size_t count{0};
-    while (std::getline(input, line)) {
-        if (!func(line)) break;
-        ++count;
+    for (;;) {
+        const auto got = reader(buffer.data(), buffer.size());
+        if (got <= 0) break;
+        std::string_view text(buffer.data(), std::size_t(got));
+        while (!text.empty()) {
+            const auto *end = static_cast<const char *>(std::memchr(text.data(), '\n', text.size()));
+            if (!end) {
+                carry.append(text);
+                break;
+            }
+
+            auto line = text.substr(0, std::size_t(end - text.data()));
+            text.remove_prefix(line.size() + 1);
+            if (!carry.empty()) {
+                carry.append(line);
+                line = carry;
+            }
+
+            const bool more = func(line);
+            carry.clear();
+            if (!more) return count;
+            ++count;
+        }
     }
+
+    if (!carry.empty() && func(std::string_view(carry))) ++count;
     return count;
 }
+} // namespace busuto::fsys
+
+namespace busuto {
+template <fsys::file_predicate Func>
+inline auto scan_stream(std::istream& input, Func func) {
+    return fsys::scan_reader([&input](char *buf, std::size_t size) -> std::streamsize {
+        if (!input.read(buf, std::streamsize(size)) && !input.eof()) return -1;
+        return input.gcount();
+    }, func);
+}
+
+// Regular files are mapped and scanned in place, while pipes and other
+// special files are read through a large buffer.
+template <fsys::file_predicate Func>
+inline auto scan_file(const fsys::path& path, Func func) {
+    const auto input = make_handle(path.string(), O_RDONLY | O_CLOEXEC);
+    if (!input) return std::size_t(0);
+    const fsys::map_t map(input);
+    if (map) return fsys::scan_lines(map.view(), func);
+    return fsys::scan_reader([&input](char *buf, std::size_t size) {
+        return ::read(input, buf, size);
+    }, func);
+}
 
 template <fsys::directory_predicate Func>
 inline auto scan_directory(const fsys::path& path, Func func) {
@@ -123,6 +429,17 @@ inline auto scan_recursive(const fsys::path& path, Func func) {
     return std::count_if(begin(dir), end(dir), func);
 }
 
+// Walks a tree in parallel on an executor such as service::pool, counting
+// entries the predicate accepts. The predicate may be called from many
+// threads at once, and the caller waits, so it should not be a worker
+// of the same executor.
+template <fsys::walk_executor Executor, fsys::walk_predicate Func>
+inline auto scan_parallel(Executor& exec, const fsys::path& path, Func func, const fsys::walk_t& options = {}) {
+    auto walk = std::make_shared<fsys::walker<Executor, Func>>(exec, func, options);
+    walk->start(path.string());
+    return walk->count();
+}
+
 template <fsys::prefix_predicate Func>
 inline auto scan_prefix(const std::string& path, Func func) {
     std::size_t count = 0;
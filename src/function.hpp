@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "common.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#ifndef BUSUTO_TASK_SIZE
+#define BUSUTO_TASK_SIZE 48 // NOLINT
+#endif
+
+namespace busuto::util {
+template <typename Signature, std::size_t S = BUSUTO_TASK_SIZE>
+class inplace_function;
+
+// Move-only callable that keeps small captures in inline storage. Callables
+// that are too large, over-aligned, or that may throw on move fall back to
+// the heap, so moving a function is always noexcept.
+template <typename R, typename... Args, std::size_t S>
+class inplace_function<R(Args...), S> final {
+public:
+    template <typename F>
+    static constexpr bool fits_v = sizeof(F) <= S &&
+                                   alignof(F) <= alignof(std::max_align_t) &&
+                                   std::is_nothrow_move_constructible_v<F>;
+
+    inplace_function() noexcept = default;
+
+    // cppcheck-suppress noExplicitConstructor
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template <typename F>
+    requires(!std::is_same_v<std::remove_cvref_t<F>, inplace_function> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    // cppcheck-suppress noExplicitConstructor
+    inplace_function(F&& func) { // NOLINT
+        emplace<std::decay_t<F>>(std::forward<F>(func));
+    }
+
+    inplace_function(inplace_function&& other) noexcept {
+        move_from(other);
+    }
+
+    inplace_function(const inplace_function&) = delete;
+    auto operator=(const inplace_function&) -> inplace_function& = delete;
+
+    ~inplace_function() {
+        reset();
+    }
+
+    auto operator=(inplace_function&& other) noexcept -> inplace_function& {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    auto operator=(std::nullptr_t) noexcept -> inplace_function& {
+        reset();
+        return *this;
+    }
+
+    template <typename F>
+    requires(!std::is_same_v<std::remove_cvref_t<F>, inplace_function> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    auto operator=(F&& func) -> inplace_function& {
+        reset();
+        emplace<std::decay_t<F>>(std::forward<F>(func));
+        return *this;
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+    auto operator!() const noexcept { return ops_ == nullptr; }
+
+    auto operator()(Args... args) const -> R {
+        if (!ops_) throw std::bad_function_call();
+        return ops_->invoke(const_cast<std::byte *>(storage_), std::forward<Args>(args)...);
+    }
+
+    auto is_inline() const noexcept {
+        return ops_ && ops_->local;
+    }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    void swap(inplace_function& other) noexcept {
+        inplace_function temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    static constexpr auto capacity() noexcept { return S; }
+
+private:
+    static_assert(S >= sizeof(void *), "inline storage must hold a pointer");
+
+    struct ops_t {
+        R (*invoke)(void *, Args&&...);
+        void (*move)(void *, void *) noexcept;
+        void (*destroy)(void *) noexcept;
+        bool local;
+    };
+
+    template <typename F>
+    static constexpr ops_t local_ops{
+    [](void *self, Args&&...args) -> R {
+        return std::invoke(*static_cast<F *>(self), std::forward<Args>(args)...);
+    },
+    [](void *to, void *from) noexcept {
+        auto *ptr = static_cast<F *>(from);
+        ::new (to) F(std::move(*ptr));
+        ptr->~F();
+    },
+    [](void *self) noexcept {
+        static_cast<F *>(self)->~F();
+    },
+    true};
+
+    template <typename F>
+    static constexpr ops_t heap_ops{
+    [](void *self, Args&&...args) -> R {
+        return std::invoke(**static_cast<F **>(self), std::forward<Args>(args)...);
+    },
+    [](void *to, void *from) noexcept {
+        *static_cast<F **>(to) = std::exchange(*static_cast<F **>(from), nullptr);
+    },
+    [](void *self) noexcept {
+        delete *static_cast<F **>(self);
+    },
+    false};
+
+    alignas(std::max_align_t) std::byte storage_[S]{};
+    const ops_t *ops_{nullptr};
+
+    template <typename F, typename From>
+    void emplace(From&& func) {
+        if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F>) {
+            if (func == nullptr) return;
+        }
+
+        if constexpr (fits_v<F>) {
+            ::new (static_cast<void *>(storage_)) F(std::forward<From>(func));
+            ops_ = &local_ops<F>;
+        } else {
+            *reinterpret_cast<F **>(storage_) = new F(std::forward<From>(func));
+            ops_ = &heap_ops<F>;
+        }
+    }
+
+    void move_from(inplace_function& other) noexcept {
+        if (!other.ops_) return;
+        other.ops_->move(storage_, other.storage_);
+        ops_ = std::exchange(other.ops_, nullptr);
+    }
+};
+
+template <typename R, typename... Args, std::size_t S>
+inline void swap(inplace_function<R(Args...), S>& lhs, inplace_function<R(Args...), S>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+} // namespace busuto::util
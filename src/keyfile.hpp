@@ -4,21 +4,25 @@
 #pragma once
 
 #include "strings.hpp"
+#include "atomic.hpp"
+#include "fsys.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <span>
 
 namespace busuto::util {
 class keyfile {
 public:
-    using keys = std::unordered_map<std::string, std::string>;
+    using keys = strings::string_map<std::string>;
     using reference = keys&;
     using const_reference = const keys&;
     using size_type = std::size_t;
     using value_type = keys;
-    using iterator = std::unordered_map<std::string, keys>::const_iterator;
+    using iterator = strings::string_map<keys>::const_iterator;
 
     keyfile() noexcept : ptr_(std::make_shared<keyfile::data>()) {}
     explicit keyfile(const std::initializer_list<std::string>& paths) noexcept : ptr_(std::make_shared<keyfile::data>()) {
@@ -26,37 +30,42 @@ public:
             ptr_->load(path);
     }
 
-    auto operator[](const std::string& id) -> auto& {
+    auto operator[](std::string_view id) -> auto& {
         return ptr_->fetch(id);
     }
 
-    auto operator[](const std::string& id) const -> const auto& {
+    auto operator[](std::string_view id) const -> const auto& {
         return ptr_->fetch(id);
     }
 
-    auto at(const std::string& id = "_") const {
+    auto at(std::string_view id = "_") const {
         return ptr_->fetch(id);
     }
 
-    auto get_or(const std::string& id, const std::string& or_else = "_") const {
+    auto get_or(std::string_view id, std::string_view or_else = "_") const {
         if (!ptr_->contains(id))
             return ptr_->fetch(or_else);
         return ptr_->fetch(id);
     }
 
-    auto keyset(const std::string& id = "_") -> auto& {
+    auto keyset(std::string_view id = "_") -> auto& {
         return ptr_->fetch(id);
     }
 
-    auto contains(const std::string& id) const {
+    auto contains(std::string_view id) const {
         return ptr_ ? ptr_->contains(id) : false;
     }
 
+    // Value of one key without copying the section, empty if not found.
+    auto value(std::string_view id, std::string_view key) const -> std::string_view {
+        return ptr_ ? ptr_->value(id, key) : std::string_view{};
+    }
+
     auto operator!() const {
         return !ptr_;
     }
 
-    void remove(const std::string& id) {
+    void remove(std::string_view id) {
         if (ptr_)
             ptr_->remove(id);
     }
@@ -67,6 +76,11 @@ public:
         return *this;
     }
 
+    // Like load, but reports if the file could be read.
+    auto try_load(const std::string& path) {
+        return ptr_ ? ptr_->load(path) : false;
+    }
+
     auto load(const std::string& id, const std::initializer_list<std::pair<std::string, std::string>>& list) -> auto& {
         auto& group = ptr_->fetch(strings::to_lower(id));
         for (const auto& [key, value] : list)
@@ -133,64 +147,108 @@ private:
             return sections.cend();
         }
 
-        auto contains(const std::string& id) const -> bool {
+        auto contains(std::string_view id) const -> bool {
             return sections.contains(id);
         }
 
-        void remove(const std::string& id) {
-            sections.erase(id);
+        void remove(std::string_view id) {
+            auto it = sections.find(id);
+            if (it != sections.end())
+                sections.erase(it);
         }
 
-        auto fetch(const std::string& id) -> keys& {
-            return sections[id];
+        auto fetch(std::string_view id) -> keys& {
+            auto it = sections.find(id);
+            if (it == sections.end())
+                it = sections.try_emplace(std::string(id)).first;
+            return it->second;
         }
 
+        auto value(std::string_view id, std::string_view key) const -> std::string_view {
+            auto group = sections.find(id);
+            if (group == sections.end()) return {};
+            auto it = group->second.find(key);
+            if (it == group->second.end()) return {};
+            return it->second;
+        }
+
+        // Regular files are mapped and parsed in one pass; names are lowered
+        // into a reused buffer, so only stored keys and values allocate.
         auto load(const std::string& path) -> bool {
-            const std::string_view whitespace(" \t\n\r");
-            std::ifstream file(path);
-            if (!file.is_open()) return false;
-            std::string buffer;
-            std::string section = "_";
-            while (std::getline(file, buffer)) {
-                auto input = std::string_view(buffer);
+            const auto input = make_handle(path, O_RDONLY | O_CLOEXEC);
+            if (!input) return false;
+            const fsys::map_t map(input);
+            if (map) {
+                parse(map.view());
+                return true;
+            }
+
+            std::string text;
+            char buf[8192];
+            for (ssize_t got{0}; (got = ::read(input, buf, sizeof(buf))) > 0;)
+                text.append(buf, std::size_t(got));
+            parse(text);
+            return true;
+        }
+
+        void parse(std::string_view text) {
+            constexpr std::string_view whitespace(" \t\n\r");
+            std::string name, section("_");
+            keys *group = nullptr;
+            while (!text.empty()) {
+                const auto *end = static_cast<const char *>(std::memchr(text.data(), '\n', text.size()));
+                const auto len = end ? std::size_t(end - text.data()) : text.size();
+                auto input = text.substr(0, len);
+                text.remove_prefix(end ? len + 1 : len);
+
                 auto first = input.find_first_not_of(whitespace);
-                if (first == std::string::npos) continue;
+                if (first == std::string_view::npos) continue;
                 input.remove_prefix(first);
                 auto last = input.find_last_not_of(whitespace);
-                if (last != std::string::npos)
+                if (last != std::string_view::npos)
                     input.remove_suffix(input.size() - last - 1);
 
-                if (!input.empty() && input[0] == '[' && input.back() == ']') {
-                    section = strings::to_lower(input.substr(1, input.size() - 2));
+                if (input[0] == '[' && input.back() == ']') {
+                    strings::lower_into(section, input.substr(1, input.size() - 2));
+                    group = nullptr;
                     continue;
                 }
 
-                if (input.empty() || !isalnum(input[0])) continue;
+                if (!isalnum(static_cast<unsigned char>(input[0]))) continue;
                 auto pos = input.find_first_of('=');
-
-                if (pos < 1 || pos == std::string::npos) continue;
+                if (pos < 1 || pos == std::string_view::npos) continue;
                 auto key = input.substr(0, pos);
                 auto value = input.substr(++pos);
                 last = key.find_last_not_of(whitespace);
-                if (last != std::string::npos)
+                if (last != std::string_view::npos)
                     key.remove_suffix(key.size() - last - 1);
 
                 pos = value.find_first_not_of(whitespace);
-                if (pos != std::string::npos)
+                if (pos != std::string_view::npos)
                     value.remove_prefix(pos);
-                sections[section][strings::to_lower(key)] = std::string(value);
+                else
+                    value = {};
+
+                if (!group)
+                    group = &fetch(section);
+                strings::lower_into(name, key);
+                auto it = group->find(name);
+                if (it != group->end())
+                    it->second.assign(value);
+                else
+                    group->try_emplace(name, value);
             }
-            return true;
         }
 
         auto save(const std::string& path) -> bool {
             std::ofstream out(path, std::ios::binary);
             if (!out.is_open()) return false;
-            for (auto const& [key, value] : sections["_"]) {
+            const auto& global = fetch("_");
+            for (auto const& [key, value] : global) {
                 if (!value.empty())
                     out << key << " = " << value << std::endl;
             }
-            if (!sections["_"].empty())
+            if (!global.empty())
                 out << std::endl;
             for (auto const& [id, keys] : sections) {
                 if (id == "_") continue;
@@ -206,10 +264,193 @@ private:
         }
 
     private:
-        std::unordered_map<std::string, std::unordered_map<std::string, std::string>> sections;
+        strings::string_map<keys> sections;
     };
     std::shared_ptr<data> ptr_;
 };
+
+// Frozen copy of a keyfile in one flat table sorted by section and key,
+// with every string held in a single arena and repeated section and key
+// names stored once. Lookups take string views and never allocate.
+class keyfile_snapshot final {
+public:
+    struct entry_t {
+        std::string_view section;
+        std::string_view key;
+        std::string_view value;
+    };
+
+    using iterator = const entry_t *;
+
+    keyfile_snapshot() = default;
+
+    explicit keyfile_snapshot(const keyfile& from) {
+        // offsets into the arena until it is complete and cannot move
+        struct pending_t {
+            std::size_t section, key, value, section_size, key_size, value_size;
+        };
+
+        if (!from) return;
+        std::unordered_map<std::string_view, std::size_t> interned;
+        std::vector<std::pair<std::size_t, std::size_t>> sections;
+        std::vector<pending_t> pending;
+        std::string arena;
+        auto intern = [&](std::string_view text) {
+            auto [it, added] = interned.try_emplace(text, arena.size());
+            if (added) arena += text;
+            return it->second;
+        };
+
+        for (const auto& [id, keys] : from) {
+            const auto section = intern(id);
+            sections.emplace_back(section, id.size());
+            for (const auto& [key, value] : keys) {
+                pending.push_back({section, intern(key), arena.size(), id.size(), key.size(), value.size()});
+                arena += value;
+            }
+        }
+
+        arena_ = std::make_unique<char[]>(arena.size() + 1);
+        std::memcpy(arena_.get(), arena.data(), arena.size());
+        const auto *base = arena_.get();
+        for (const auto& [offset, size] : sections)
+            sections_.push_back({{base + offset, size}, 0, 0});
+        entries_.reserve(pending.size());
+        for (const auto& item : pending)
+            entries_.push_back({{base + item.section, item.section_size}, {base + item.key, item.key_size}, {base + item.value, item.value_size}});
+
+        std::ranges::sort(sections_, {}, &section_t::id);
+        std::ranges::sort(entries_, [](const entry_t& lhs, const entry_t& rhs) {
+            return lhs.section < rhs.section || (lhs.section == rhs.section && lhs.key < rhs.key);
+        });
+
+        std::size_t pos = 0;
+        for (auto& section : sections_) {
+            while (pos < entries_.size() && entries_[pos].section < section.id)
+                ++pos;
+            section.first = pos;
+            while (pos < entries_.size() && entries_[pos].section == section.id)
+                ++pos;
+            section.last = pos;
+        }
+    }
+
+    keyfile_snapshot(const keyfile_snapshot&) = delete;
+    auto operator=(const keyfile_snapshot&) -> keyfile_snapshot& = delete;
+
+    auto size() const noexcept { return entries_.size(); }
+    auto empty() const noexcept { return entries_.empty(); }
+    auto begin() const noexcept -> iterator { return entries_.data(); }
+    auto end() const noexcept -> iterator { return entries_.data() + entries_.size(); }
+
+    auto contains(std::string_view id) const noexcept {
+        return locate(id) != nullptr;
+    }
+
+    // Keys of one section in key order, empty if there is no such section.
+    auto keyset(std::string_view id = "_") const noexcept -> std::span<const entry_t> {
+        const auto *section = locate(id);
+        if (!section) return {};
+        return {entries_.data() + section->first, section->last - section->first};
+    }
+
+    auto find(std::string_view id, std::string_view key) const noexcept -> const entry_t * {
+        const auto keys = keyset(id);
+        const auto it = std::ranges::lower_bound(keys, key, {}, &entry_t::key);
+        if (it == keys.end() || it->key != key) return nullptr;
+        return &*it;
+    }
+
+    auto get(std::string_view id, std::string_view key, std::string_view or_else = {}) const noexcept {
+        const auto *entry = find(id, key);
+        return entry ? entry->value : or_else;
+    }
+
+private:
+    struct section_t {
+        std::string_view id;
+        std::size_t first, last;
+    };
+
+    std::unique_ptr<char[]> arena_;
+    std::vector<section_t> sections_;
+    std::vector<entry_t> entries_;
+
+    auto locate(std::string_view id) const noexcept -> const section_t * {
+        const auto it = std::ranges::lower_bound(sections_, id, {}, &section_t::id);
+        if (it == sections_.end() || it->id != id) return nullptr;
+        return &*it;
+    }
+};
+
+// Configuration published as immutable snapshots. Loading builds a new
+// snapshot off to the side and swaps it in atomically; readers hold an
+// epoch guard instead of a lock, and a replaced snapshot is reclaimed once
+// no reader can still see it.
+class keyfile_config final {
+public:
+    class reader_t final {
+    public:
+        explicit reader_t(const std::atomic<const keyfile_snapshot *>& from) noexcept : ptr_(from.load(std::memory_order_acquire)) {}
+
+        reader_t(const reader_t&) = delete;
+        auto operator=(const reader_t&) -> reader_t& = delete;
+
+        auto operator->() const noexcept { return ptr_; }
+        auto operator*() const noexcept -> const keyfile_snapshot& { return *ptr_; }
+        auto get() const noexcept { return ptr_; }
+
+    private:
+        const atomic::epoch::guard_t guard_;
+        const keyfile_snapshot *ptr_;
+    };
+
+    keyfile_config() : current_(new keyfile_snapshot()) {}
+
+    explicit keyfile_config(const std::initializer_list<std::string>& paths) : keyfile_config() {
+        load(paths);
+    }
+
+    keyfile_config(const keyfile_config&) = delete;
+    auto operator=(const keyfile_config&) -> keyfile_config& = delete;
+
+    ~keyfile_config() {
+        delete current_.load();
+    }
+
+    // Readers must not outlive the config; the guard is taken before the
+    // pointer is read so the snapshot cannot be reclaimed under it.
+    auto snapshot() const noexcept {
+        return reader_t(current_);
+    }
+
+    auto version() const noexcept {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    // Publishes only if every file could be read.
+    auto load(const std::initializer_list<std::string>& paths) -> bool {
+        keyfile keys;
+        for (const auto& path : paths) {
+            if (!keys.try_load(path)) return false;
+        }
+        publish(keys);
+        return true;
+    }
+
+    void publish(const keyfile& from) {
+        auto next = std::make_unique<keyfile_snapshot>(from);
+        const std::lock_guard lock(writer_);
+        auto *old = current_.exchange(next.release(), std::memory_order_acq_rel);
+        version_.fetch_add(1, std::memory_order_release);
+        atomic::epoch::retire(const_cast<keyfile_snapshot *>(old));
+    }
+
+private:
+    std::atomic<const keyfile_snapshot *> current_;
+    std::atomic<uint64_t> version_{0};
+    std::mutex writer_;
+};
 } // namespace busuto::util
 
 namespace busuto {
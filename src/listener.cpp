@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "listener.hpp"
+
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+
+#if __has_include(<linux/filter.h>)
+#include <linux/filter.h>
+#endif
+
+using namespace busuto;
+
+listener::listener(const address_t& addr, accept_t handler, const options_t& options) : addr_(addr), handler_(std::move(handler)), options_(options) {
+    const auto count = options_.shards ? options_.shards : thread::concurrency(0);
+    for (unsigned shard = 0; shard < count; ++shard) {
+        auto so = make_socket(addr_.family(), SOCK_STREAM);
+        if (!so) throw std::system_error(errno, std::generic_category(), "listener socket");
+        const int on = 1;
+        ::setsockopt(so, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+        if (::setsockopt(so, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) && count > 1)
+            throw std::system_error(errno, std::generic_category(), "listener reuseport");
+#else
+        if (count > 1) throw std::system_error(ENOTSUP, std::generic_category(), "listener reuseport");
+#endif
+        if (::bind(so, addr_.data(), addr_.size()))
+            throw std::system_error(errno, std::generic_category(), "listener bind");
+
+        // later shards share the port the kernel picked for the first
+        if (!shard) {
+            socklen_t len = addr_.max();
+            ::getsockname(so, addr_.data(), &len);
+        }
+
+        if (::listen(so, options_.backlog))
+            throw std::system_error(errno, std::generic_category(), "listener listen");
+        ::fcntl(so, F_SETFL, ::fcntl(so, F_GETFL) | O_NONBLOCK);
+        sockets_.push_back(std::move(so));
+    }
+
+    if (options_.steer && count > 1)
+        steer();
+}
+
+auto listener::steer() noexcept -> bool {
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(SKF_AD_CPU)
+    if (sockets_.empty()) return false;
+    struct sock_filter code[] = {
+    {BPF_LD | BPF_W | BPF_ABS, 0, 0, uint32_t(SKF_AD_OFF + SKF_AD_CPU)},
+    {BPF_ALU | BPF_MOD | BPF_K, 0, 0, uint32_t(sockets_.size())},
+    {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog prog{};
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    steered_ = ::setsockopt(sockets_.front(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0;
+    return steered_;
+#else
+    return false;
+#endif
+}
+
+void listener::start() {
+    if (running_.exchange(true)) return;
+    if (::pipe(wake_)) {
+        running_ = false;
+        throw std::system_error(errno, std::generic_category(), "listener wakeup");
+    }
+    threads_.reserve(sockets_.size());
+    for (unsigned shard = 0; shard < shards(); ++shard)
+        threads_.emplace_back(&listener::accept_loop, this, shard);
+}
+
+void listener::stop() noexcept {
+    if (!running_.exchange(false)) return;
+    const char wake = 0;
+    [[maybe_unused]] auto sent = ::write(wake_[1], &wake, 1);
+    for (auto& thread : threads_) {
+        if (thread.joinable())
+            thread.join();
+    }
+    threads_.clear();
+    ::close(wake_[0]);
+    ::close(wake_[1]);
+    wake_[0] = wake_[1] = -1;
+}
+
+void listener::accept_loop(unsigned shard) noexcept {
+    if (options_.pin)
+        this_thread::affinity(shard);
+
+    // a spare descriptor, given up to accept and shed a connection when the
+    // process runs out, since the backlog would keep poll readable.
+    auto reserve = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    const int so = sockets_[shard];
+    struct pollfd pfd[2] = {{so, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+    const auto backoff = [&pfd] {
+        ::poll(&pfd[1], 1, 100);
+    };
+
+    while (running_.load(std::memory_order_acquire)) {
+        if (::poll(pfd, 2, -1) < 0 && errno != EINTR) break;
+        if (pfd[1].revents) break;
+        if (!(pfd[0].revents & POLLIN)) continue;
+
+        // drain the backlog before polling again
+        for (;;) {
+            address_t peer;
+            socklen_t len = peer.max();
+#ifdef SOCK_CLOEXEC
+            const auto client = ::accept4(so, peer.data(), &len, SOCK_CLOEXEC);
+#else
+            const auto client = ::accept(so, peer.data(), &len);
+#endif
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                // accept fails for want of a descriptor before it looks at
+                // the backlog, so the backlog is drained once a shed fails
+                if ((errno == EMFILE || errno == ENFILE) && reserve >= 0) {
+                    ::close(reserve);
+                    const auto shed = ::accept(so, nullptr, nullptr);
+                    if (shed >= 0) {
+                        ::close(shed);
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    reserve = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                    if (shed >= 0) continue;
+                    break;
+                }
+
+                // without a reserve, or on other errors, wait rather than spin
+                if (reserve < 0)
+                    reserve = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                backoff();
+                break;
+            }
+
+            accepted_.fetch_add(1, std::memory_order_relaxed);
+            try {
+                handler_(client, peer, shard);
+            } catch (...) { // NOLINT
+            }
+        }
+    }
+
+    if (reserve >= 0)
+        ::close(reserve);
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "sockets.hpp"
+#include "threads.hpp"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace busuto {
+// Sharded listener: one SO_REUSEPORT socket per shard bound to the same
+// address, each with its own accept loop pinned to a core. Accepted
+// descriptors are handed to the handler on the accepting shard's thread,
+// so they can go straight to that core's worker or event loop. The handler
+// owns the descriptor once called, and must close it even if it throws.
+class listener final {
+public:
+    using accept_t = std::function<void(int so, const address_t& peer, unsigned shard)>;
+
+    struct options_t {
+        unsigned shards{0}; // 0 for one per cpu
+        int backlog{SOMAXCONN};
+        bool pin{true};   // pin shard n to cpu n
+        bool steer{true}; // steer connections to the shard of their cpu
+    };
+
+    listener(const address_t& addr, accept_t handler, const options_t& options);
+    listener(const address_t& addr, accept_t handler) : listener(addr, std::move(handler), options_t{}) {}
+    listener(const listener&) = delete;
+    auto operator=(const listener&) -> listener& = delete;
+
+    ~listener() {
+        stop();
+    }
+
+    explicit operator bool() const noexcept { return !sockets_.empty(); }
+    auto operator!() const noexcept { return sockets_.empty(); }
+
+    auto shards() const noexcept { return unsigned(sockets_.size()); }
+    auto handle(unsigned shard) const noexcept { return sockets_.at(shard).get(); }
+    auto steered() const noexcept { return steered_; }
+    auto accepted() const noexcept { return accepted_.load(std::memory_order_relaxed); }
+
+    // Connections shed because the process was out of descriptors.
+    auto dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    // Local address, with the port picked by the kernel if bound to 0.
+    auto address() const noexcept { return addr_; }
+
+    void start();
+    void stop() noexcept;
+
+    // Attaches a classic bpf program to the reuseport group that picks the
+    // socket by receiving cpu modulo shards; false if unsupported.
+    auto steer() noexcept -> bool;
+
+private:
+    address_t addr_;
+    accept_t handler_;
+    options_t options_;
+    std::vector<handle_t> sockets_;
+    std::vector<std::thread> threads_;
+    int wake_[2]{-1, -1};
+    bool steered_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> accepted_{0}, dropped_{0};
+
+    void accept_loop(unsigned shard) noexcept;
+};
+} // namespace busuto
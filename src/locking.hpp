@@ -4,6 +4,9 @@
 #pragma once
 
 #include "threads.hpp"
+#include "atomic.hpp"
+
+#include <exception>
 
 namespace busuto::lock {
 template <typename T>
@@ -40,6 +43,43 @@ private:
     mutable std::shared_mutex lock_;
 };
 
+// Read-copy-update: readers see the current version without locking, and
+// writers copy it, modify the copy, and publish it. A replaced version is
+// reclaimed through the shared epoch scheme once no reader can see it.
+template <typename T>
+class rcu {
+public:
+    template <typename... Args>
+    explicit rcu(Args&&...args) : data_(new T(std::forward<Args>(args)...)) {}
+
+    rcu(const rcu&) = delete;
+    auto operator=(const rcu&) -> rcu& = delete;
+
+    ~rcu() {
+        delete data_.load();
+    }
+
+    // Waits until versions replaced so far have no readers left.
+    static void synchronize() {
+        atomic::epoch::synchronize();
+    }
+
+protected:
+    std::atomic<T *> data_;
+
+    void publish(T *next) {
+        auto *old = data_.exchange(next, std::memory_order_acq_rel);
+        atomic::epoch::retire(old);
+    }
+
+private:
+    template <typename U>
+    friend class rcu_reader;
+    template <typename U>
+    friend class rcu_writer;
+    mutable std::mutex lock_;
+};
+
 template <typename U>
 class exclusive_ptr final : public std::unique_lock<std::mutex> {
 public:
@@ -200,4 +240,91 @@ public:
 private:
     U *ptr_{nullptr};
 };
+
+template <typename U>
+class rcu_reader final {
+public:
+    rcu_reader() = delete;
+    rcu_reader(const rcu_reader&) = delete;
+    auto operator=(const rcu_reader&) -> rcu_reader& = delete;
+
+    // The guard is entered before the pointer is loaded.
+    explicit rcu_reader(const rcu<U>& obj) : ptr_(obj.data_.load(std::memory_order_acquire)) {}
+
+    ~rcu_reader() = default;
+
+    auto operator->() const -> const U * {
+        return ptr_;
+    }
+
+    auto operator*() const -> const U& {
+        return *ptr_;
+    }
+
+    template <typename I>
+    auto operator[](const I& index) const -> decltype(std::declval<const U&>()[index]) {
+        return ptr_->operator[](index);
+    }
+
+    template <typename I>
+    auto at(const I& index) const {
+        return ptr_->at(index);
+    }
+
+private:
+    const atomic::epoch::guard_t guard_;
+    const U *ptr_{nullptr};
+};
+
+// Writers are serialized and work on a private copy that is published when
+// the writer goes out of scope, unless it was cancelled or the scope is
+// left by an exception, so a half-made change is never seen.
+template <typename U>
+class rcu_writer final {
+public:
+    rcu_writer() = delete;
+    rcu_writer(const rcu_writer&) = delete;
+    auto operator=(const rcu_writer&) -> rcu_writer& = delete;
+
+    explicit rcu_writer(rcu<U>& obj) : lock_(obj.lock_), obj_(obj), copy_(std::make_unique<U>(*obj.data_.load(std::memory_order_acquire))) {}
+
+    ~rcu_writer() {
+        if (std::uncaught_exceptions() > unwinding_) return;
+        try {
+            commit();
+        } catch (...) { // NOLINT
+        }
+    }
+
+    auto operator->() {
+        if (!copy_) throw error("rcu writer error");
+        return copy_.get();
+    }
+
+    auto operator*() -> U& {
+        if (!copy_) throw error("rcu writer error");
+        return *copy_;
+    }
+
+    template <typename I>
+    auto operator[](const I& index) -> decltype(std::declval<U&>()[index]) {
+        if (!copy_) throw error("rcu writer error");
+        return copy_->operator[](index);
+    }
+
+    void commit() {
+        if (!copy_) return;
+        obj_.publish(copy_.release());
+    }
+
+    void cancel() noexcept {
+        copy_.reset();
+    }
+
+private:
+    const std::lock_guard<std::mutex> lock_;
+    rcu<U>& obj_;
+    std::unique_ptr<U> copy_;
+    const int unwinding_{std::uncaught_exceptions()};
+};
 } // namespace busuto::lock
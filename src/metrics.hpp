@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "common.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#ifndef BUSUTO_CACHE_LINE
+#define BUSUTO_CACHE_LINE 64 // NOLINT
+#endif
+
+namespace busuto::metrics {
+using clock_t = std::chrono::steady_clock;
+
+#ifdef BUSUTO_NO_METRICS
+inline constexpr bool enabled = false;
+#else
+inline constexpr bool enabled = true;
+#endif
+
+// Bucket n counts durations below 2^n nanoseconds, the last holds the rest.
+inline constexpr std::size_t buckets = 40;
+
+// Point in time copy of a histogram.
+struct histogram_t {
+    std::array<uint64_t, buckets> counts{};
+    uint64_t count{0};
+    uint64_t total{0}; // nanoseconds
+
+    auto mean() const noexcept {
+        return std::chrono::nanoseconds(count ? total / count : 0);
+    }
+
+    // Upper bound of the bucket holding the given fraction of samples.
+    auto percentile(double fraction) const noexcept {
+        const auto target = uint64_t(double(count) * fraction);
+        uint64_t seen{0};
+        for (std::size_t pos = 0; pos < buckets; ++pos) {
+            seen += counts[pos];
+            if (seen > target || (seen == count && counts[pos]))
+                return std::chrono::nanoseconds(int64_t(1) << pos);
+        }
+        return std::chrono::nanoseconds(0);
+    }
+
+    auto operator+=(const histogram_t& other) noexcept -> histogram_t& {
+        for (std::size_t pos = 0; pos < buckets; ++pos)
+            counts[pos] += other.counts[pos];
+        count += other.count;
+        total += other.total;
+        return *this;
+    }
+};
+
+struct task_stats_t {
+    uint64_t dispatched{0};
+    uint64_t completed{0};
+    uint64_t external{0}; // dispatched from threads that are not workers
+    histogram_t wait; // time queued before running
+    histogram_t run;  // time spent running
+
+    auto pending() const noexcept {
+        return dispatched > completed ? dispatched - completed : 0;
+    }
+};
+
+struct timer_stats_t {
+    uint64_t fired{0};
+    histogram_t lateness; // fire time past expiry
+    histogram_t run;
+};
+
+#ifndef BUSUTO_NO_METRICS
+// Updated with relaxed atomics; intended to have one writer per instance.
+class histogram final {
+public:
+    void record(std::chrono::nanoseconds elapsed) noexcept {
+        const auto ns = uint64_t(std::max(elapsed.count(), decltype(elapsed.count())(0)));
+        const auto slot = std::min(std::size_t(std::bit_width(ns)), buckets - 1);
+        counts_[slot].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void collect(histogram_t& into) const noexcept {
+        for (std::size_t pos = 0; pos < buckets; ++pos) {
+            const auto count = counts_[pos].load(std::memory_order_relaxed);
+            into.counts[pos] += count;
+            into.count += count;
+        }
+        into.total += total_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, buckets> counts_{};
+    std::atomic<uint64_t> total_{0};
+};
+
+// When a task was queued; empty when metrics are compiled out.
+struct stamp_t {
+    clock_t::time_point when{};
+};
+
+inline auto stamp() noexcept {
+    return stamp_t{clock_t::now()};
+}
+
+// Per worker counters for a task queue or pool. Slot count is for tasks
+// dispatched from threads that are not workers.
+class task_metrics final {
+public:
+    task_metrics() = default;
+    explicit task_metrics(std::size_t workers) : slots_(std::make_unique<slot_t[]>(workers + 1)), count_(workers + 1) {}
+
+    void dispatched(std::size_t worker) noexcept {
+        if (slots_) slot(worker).dispatched.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto started(std::size_t worker, const stamp_t& queued) noexcept {
+        const auto now = stamp();
+        if (slots_) slot(worker).wait.record(now.when - queued.when);
+        return now;
+    }
+
+    void finished(std::size_t worker, const stamp_t& started) noexcept {
+        if (!slots_) return;
+        auto& counters = slot(worker);
+        counters.run.record(clock_t::now() - started.when);
+        counters.completed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto snapshot() const noexcept {
+        task_stats_t stats;
+        for (std::size_t pos = 0; pos < count_; ++pos) {
+            stats.dispatched += slots_[pos].dispatched.load(std::memory_order_relaxed);
+            stats.completed += slots_[pos].completed.load(std::memory_order_relaxed);
+            slots_[pos].wait.collect(stats.wait);
+            slots_[pos].run.collect(stats.run);
+        }
+        if (count_) stats.external = slots_[count_ - 1].dispatched.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct alignas(BUSUTO_CACHE_LINE) slot_t {
+        std::atomic<uint64_t> dispatched{0}, completed{0};
+        histogram wait, run;
+    };
+
+    std::unique_ptr<slot_t[]> slots_;
+    std::size_t count_{0};
+
+    auto slot(std::size_t worker) noexcept -> slot_t& {
+        return slots_[std::min(worker, count_ - 1)];
+    }
+};
+
+class timer_metrics final {
+public:
+    auto fired(const clock_t::time_point& expires) noexcept {
+        const auto now = stamp();
+        lateness_.record(now.when - expires);
+        fired_.fetch_add(1, std::memory_order_relaxed);
+        return now;
+    }
+
+    void finished(const stamp_t& started) noexcept {
+        run_.record(clock_t::now() - started.when);
+    }
+
+    auto snapshot() const noexcept {
+        timer_stats_t stats;
+        stats.fired = fired_.load(std::memory_order_relaxed);
+        lateness_.collect(stats.lateness);
+        run_.collect(stats.run);
+        return stats;
+    }
+
+private:
+    std::atomic<uint64_t> fired_{0};
+    histogram lateness_, run_;
+};
+#else
+struct stamp_t {};
+
+inline auto stamp() noexcept {
+    return stamp_t{};
+}
+
+class task_metrics final {
+public:
+    task_metrics() = default;
+    explicit task_metrics(std::size_t /* workers */) noexcept {}
+    void dispatched(std::size_t /* worker */) noexcept {}
+    auto started(std::size_t /* worker */, const stamp_t& /* queued */) noexcept { return stamp_t{}; }
+    void finished(std::size_t /* worker */, const stamp_t& /* started */) noexcept {}
+    auto snapshot() const noexcept { return task_stats_t{}; }
+};
+
+class timer_metrics final {
+public:
+    auto fired(const clock_t::time_point& /* expires */) noexcept { return stamp_t{}; }
+    void finished(const stamp_t& /* started */) noexcept {}
+    auto snapshot() const noexcept { return timer_stats_t{}; }
+};
+#endif
+} // namespace busuto::metrics
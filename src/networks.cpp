@@ -3,10 +3,93 @@
 
 #include "networks.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
 #include <net/if.h>
+#include <poll.h>
+
+#if __has_include(<linux/rtnetlink.h>)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
 
 using namespace busuto;
 
+namespace {
+auto any_address(const std::string& id, uint16_t port, int family, address_t& out) -> bool {
+    if (id == "[*]" && family == AF_UNSPEC) {
+        out.family_if(AF_INET6);
+        out.port(port);
+        return true;
+    }
+    if (id == "*") {
+        if (family == AF_UNSPEC)
+            family = AF_INET;
+        out.family_if(family);
+        out.port(port);
+        return true;
+    }
+    if ((family == AF_INET || family == AF_UNSPEC) && id.find('.') != std::string_view::npos) {
+        out = socket::address::from_string(id, port);
+        return true;
+    }
+    if ((family == AF_INET6 || family == AF_UNSPEC) && id.find(':') != std::string_view::npos) {
+        out = socket::address::from_string(id, port);
+        return true;
+    }
+    return false;
+}
+
+auto make_address(int family, const void *data, unsigned index) noexcept {
+    socket::storage_t store{};
+    if (family == AF_INET) {
+        auto *in = reinterpret_cast<struct sockaddr_in *>(&store);
+        in->sin_family = AF_INET;
+        std::memcpy(&in->sin_addr, data, sizeof(in->sin_addr));
+    } else {
+        auto *in6 = reinterpret_cast<struct sockaddr_in6 *>(&store);
+        in6->sin6_family = AF_INET6;
+        std::memcpy(&in6->sin6_addr, data, sizeof(in6->sin6_addr));
+        if (IN6_IS_ADDR_LINKLOCAL(&in6->sin6_addr)) in6->sin6_scope_id = index;
+    }
+    return socket::address(store);
+}
+
+auto same(const socket::interfaces::interface_t& a, const socket::interfaces::interface_t& b) {
+    if (a.flags != b.flags || a.name != b.name || a.addrs.size() != b.addrs.size()) return false;
+    for (std::size_t pos = 0; pos < a.addrs.size(); ++pos) {
+        if (a.addrs[pos].prefix != b.addrs[pos].prefix || !(a.addrs[pos].addr == b.addrs[pos].addr)) return false;
+    }
+    return true;
+}
+
+auto on_subnet(const struct sockaddr *addr, const socket::interfaces::ifaddr_t& entry) {
+    const auto family = entry.addr.family();
+    if (family != addr->sa_family) return false;
+    const uint8_t *from{nullptr}, *to{nullptr};
+    unsigned bits{0};
+    if (family == AF_INET) {
+        from = reinterpret_cast<const uint8_t *>(&socket::in4_cast(addr)->sin_addr);
+        to = reinterpret_cast<const uint8_t *>(&socket::in4_cast(entry.addr.data())->sin_addr);
+        bits = std::min(entry.prefix, 32U);
+    } else if (family == AF_INET6) {
+        from = socket::in6_cast(addr)->sin6_addr.s6_addr;
+        to = socket::in6_cast(entry.addr.data())->sin6_addr.s6_addr;
+        bits = std::min(entry.prefix, 128U);
+    } else
+        return false;
+    if (!bits) return false;
+    if (std::memcmp(from, to, bits / 8) != 0) return false;
+    if (bits % 8 == 0) return true;
+    const auto mask = uint8_t(0xff << (8 - bits % 8));
+    return (from[bits / 8] & mask) == (to[bits / 8] & mask);
+}
+} // end namespace
+
 auto socket::networks::find(std::string_view id, int family, bool multicast) const noexcept -> iface_t {
     for (auto entry = list_; entry != nullptr; entry = entry->ifa_next) {
         if (multicast && !(entry->ifa_flags & IFF_MULTICAST)) continue;
@@ -50,22 +133,7 @@ auto socket::networks::find(const struct sockaddr *from) const noexcept -> iface
 
 auto busuto::bind_address(const networks_t& nets, const std::string& id, uint16_t port, int family, bool multicast) -> address_t {
     address_t any;
-    if (id == "[*]" && family == AF_UNSPEC) {
-        any.family_if(AF_INET6);
-        any.port(port);
-        return any;
-    }
-    if (id == "*") {
-        if (family == AF_UNSPEC)
-            family = AF_INET;
-        any.family_if(family);
-        any.port(port);
-        return any;
-    }
-    if ((family == AF_INET || family == AF_UNSPEC) && id.find('.') != std::string_view::npos)
-        return socket::address::from_string(id, port);
-    if ((family == AF_INET6 || family == AF_UNSPEC) && id.find(':') != std::string_view::npos)
-        return socket::address::from_string(id, port);
+    if (any_address(id, port, family, any)) return any;
     auto ifa = nets.find(id, family, multicast);
     if (ifa && ifa->ifa_addr) {
         socket::address a(ifa->ifa_addr);
@@ -84,3 +152,363 @@ auto busuto::multicast_index(const networks_t& nets, const std::string& id, int
     }
     return 0U;
 }
+
+socket::interfaces::interfaces() {
+#ifdef NETLINK_ROUTE
+    netlink_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (netlink_ < 0) throw std::system_error(errno, std::generic_category(), "interfaces netlink");
+    struct sockaddr_nl local{};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (::bind(netlink_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local))) {
+        const auto err = errno;
+        ::close(netlink_);
+        throw std::system_error(err, std::generic_category(), "interfaces bind");
+    }
+#endif
+    // subscribed first, so nothing that changes during the load is missed
+    if (!load(table_)) {
+        const auto err = errno;
+        if (netlink_ > -1) ::close(netlink_);
+        throw std::system_error(err, std::generic_category(), "interfaces load");
+    }
+}
+
+socket::interfaces::~interfaces() {
+    if (netlink_ > -1) ::close(netlink_);
+}
+
+auto socket::interfaces::key_hash::operator()(const key_t& key) const noexcept -> std::size_t {
+    uint64_t upper{0}, lower{0};
+    std::memcpy(&upper, key.bytes.data(), sizeof(upper));
+    std::memcpy(&lower, key.bytes.data() + sizeof(upper), sizeof(lower));
+    return std::size_t((upper * 0x9e3779b97f4a7c15ULL) ^ std::rotl(lower, 29) ^ uint64_t(key.family));
+}
+
+auto socket::interfaces::make_key(const struct sockaddr *addr) noexcept -> key_t {
+    key_t key;
+    if (!addr) return key;
+    key.family = addr->sa_family;
+    if (key.family == AF_INET)
+        std::memcpy(key.bytes.data(), &in4_cast(addr)->sin_addr, 4);
+    else if (key.family == AF_INET6)
+        std::memcpy(key.bytes.data(), &in6_cast(addr)->sin6_addr, 16);
+    return key;
+}
+
+// Only keys still pointing at the old entry are dropped, in case another
+// interface has taken the name or an address since.
+void socket::interfaces::replace(table_t& table, const entry_t& from, const entry_t& to) {
+    if (from) {
+        auto name = table.by_name.find(from->name);
+        if (name != table.by_name.end() && name->second == from->index) table.by_name.erase(name);
+        for (const auto& entry : from->addrs) {
+            auto addr = table.by_addr.find(make_key(entry.addr.data()));
+            if (addr != table.by_addr.end() && addr->second == from->index) table.by_addr.erase(addr);
+        }
+        if (!to) table.by_index.erase(from->index);
+    }
+    if (to) {
+        table.by_index[to->index] = to;
+        if (!to->name.empty()) table.by_name[to->name] = to->index;
+        for (const auto& entry : to->addrs)
+            table.by_addr[make_key(entry.addr.data())] = to->index;
+    }
+}
+
+void socket::interfaces::apply(table_t& table, const void *msg, changes_t& changes) {
+#ifdef NETLINK_ROUTE
+    const auto *head = static_cast<const struct nlmsghdr *>(msg);
+    const auto type = head->nlmsg_type;
+    if (type == RTM_NEWLINK || type == RTM_DELLINK) {
+        const auto *info = static_cast<const struct ifinfomsg *>(NLMSG_DATA(head));
+        const auto index = unsigned(info->ifi_index);
+        const auto found = table.by_index.find(index);
+        const auto old = found != table.by_index.end() ? found->second : entry_t{};
+        if (type == RTM_DELLINK) {
+            if (!old) return;
+            replace(table, old, nullptr);
+            changes.emplace_back(change_t::removed, old);
+            return;
+        }
+
+        std::string_view name;
+        auto len = int(IFLA_PAYLOAD(head));
+        for (auto *attr = IFLA_RTA(info); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+            if (attr->rta_type == IFLA_IFNAME) name = static_cast<const char *>(RTA_DATA(attr));
+        }
+        if (old && old->flags == info->ifi_flags && (name.empty() || old->name == name)) return;
+        auto next = old ? std::make_shared<interface_t>(*old) : std::make_shared<interface_t>();
+        next->index = index;
+        next->flags = info->ifi_flags;
+        if (!name.empty()) next->name = name;
+        replace(table, old, next);
+        changes.emplace_back(old ? change_t::changed : change_t::added, std::move(next));
+        return;
+    }
+
+    if (type != RTM_NEWADDR && type != RTM_DELADDR) return;
+    const auto *info = static_cast<const struct ifaddrmsg *>(NLMSG_DATA(head));
+    if (info->ifa_family != AF_INET && info->ifa_family != AF_INET6) return;
+    const void *local{nullptr}, *remote{nullptr};
+    auto len = int(IFA_PAYLOAD(head));
+    for (auto *attr = IFA_RTA(info); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+        if (attr->rta_type == IFA_LOCAL) local = RTA_DATA(attr);
+        if (attr->rta_type == IFA_ADDRESS) remote = RTA_DATA(attr);
+    }
+
+    // the local address, as on a point to point link it is not the same
+    const auto *data = local ? local : remote;
+    if (!data) return;
+    const auto index = unsigned(info->ifa_index);
+    const ifaddr_t addr{make_address(info->ifa_family, data, index), info->ifa_prefixlen};
+    const auto found = table.by_index.find(index);
+    const auto old = found != table.by_index.end() ? found->second : entry_t{};
+    if (!old && type == RTM_DELADDR) return;
+
+    auto next = old ? std::make_shared<interface_t>(*old) : std::make_shared<interface_t>();
+    auto pos = std::find_if(next->addrs.begin(), next->addrs.end(), [&](const ifaddr_t& entry) {
+        return entry.addr == addr.addr;
+    });
+    if (type == RTM_DELADDR) {
+        if (pos == next->addrs.end()) return;
+        next->addrs.erase(pos);
+    } else if (pos == next->addrs.end())
+        next->addrs.push_back(addr);
+    else if (pos->prefix != addr.prefix)
+        pos->prefix = addr.prefix;
+    else
+        return;
+
+    if (!old) {
+        char name[IF_NAMESIZE]{};
+        next->index = index;
+        if (::if_indextoname(index, name)) next->name = name;
+    }
+    replace(table, old, next);
+    changes.emplace_back(old ? change_t::changed : change_t::added, std::move(next));
+#else
+    (void)table;
+    (void)msg;
+    (void)changes;
+#endif
+}
+
+// Dumps links and then addresses over a socket of its own, so replies are
+// never mixed with events.
+auto socket::interfaces::load(table_t& table) -> bool {
+    changes_t ignored;
+#ifdef NETLINK_ROUTE
+    const auto fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) return false;
+    auto dump = [&](uint16_t type, uint32_t sequence) {
+        struct {
+            struct nlmsghdr head;
+            struct rtgenmsg gen;
+        } request{};
+        request.head.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg));
+        request.head.nlmsg_type = type;
+        request.head.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.head.nlmsg_seq = sequence;
+        request.gen.rtgen_family = AF_UNSPEC;
+        if (::send(fd, &request, request.head.nlmsg_len, 0) < 0) return false;
+
+        alignas(struct nlmsghdr) char buf[32768];
+        for (;;) {
+            const auto got = ::recv(fd, buf, sizeof(buf), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            auto len = int(got);
+            for (auto *head = reinterpret_cast<struct nlmsghdr *>(buf); NLMSG_OK(head, len); head = NLMSG_NEXT(head, len)) {
+                if (head->nlmsg_type == NLMSG_DONE) return true;
+                if (head->nlmsg_type == NLMSG_ERROR) return false;
+                apply(table, head, ignored);
+            }
+        }
+    };
+    const auto result = dump(RTM_GETLINK, 1) && dump(RTM_GETADDR, 2);
+    const auto err = errno;
+    ::close(fd);
+    errno = err;
+    return result;
+#else
+    struct ifaddrs *list{nullptr};
+    if (::getifaddrs(&list)) return false;
+    std::unordered_map<unsigned, std::shared_ptr<interface_t>> found;
+    for (auto *entry = list; entry; entry = entry->ifa_next) {
+        if (!entry->ifa_name) continue;
+        const auto index = ::if_nametoindex(entry->ifa_name);
+        if (!index) continue;
+        auto& item = found[index];
+        if (!item) {
+            item = std::make_shared<interface_t>();
+            item->index = index;
+            item->name = entry->ifa_name;
+            item->flags = entry->ifa_flags;
+        }
+        if (!entry->ifa_addr || (entry->ifa_addr->sa_family != AF_INET && entry->ifa_addr->sa_family != AF_INET6)) continue;
+        unsigned prefix{0};
+        if (entry->ifa_netmask) {
+            const auto key = make_key(entry->ifa_netmask);
+            for (const auto byte : key.bytes)
+                prefix += unsigned(std::popcount(byte));
+        }
+        item->addrs.push_back({address(entry->ifa_addr), prefix});
+    }
+    ::freeifaddrs(list);
+    for (auto& [index, item] : found)
+        replace(table, nullptr, item);
+    return true;
+#endif
+}
+
+// Reloads the whole table, as after events were lost, and reports what
+// differs from before.
+auto socket::interfaces::resync() -> changes_t {
+    table_t fresh;
+    if (!load(fresh)) return {};
+    changes_t changes;
+    const std::lock_guard lock(lock_);
+    for (const auto& [index, old] : table_.by_index) {
+        if (!fresh.by_index.contains(index)) changes.emplace_back(change_t::removed, old);
+    }
+    for (const auto& [index, entry] : fresh.by_index) {
+        const auto found = table_.by_index.find(index);
+        if (found == table_.by_index.end())
+            changes.emplace_back(change_t::added, entry);
+        else if (!same(*found->second, *entry))
+            changes.emplace_back(change_t::changed, entry);
+    }
+    table_ = std::move(fresh);
+    return changes;
+}
+
+auto socket::interfaces::update(int timeout) -> std::size_t {
+    changes_t changes;
+#ifdef NETLINK_ROUTE
+    if (timeout) {
+        struct pollfd pfd = {.fd = netlink_, .events = POLLIN, .revents = 0};
+        ::poll(&pfd, 1, timeout);
+    }
+
+    auto overrun = false;
+    alignas(struct nlmsghdr) char buf[32768];
+    for (;;) {
+        const auto got = ::recv(netlink_, buf, sizeof(buf), MSG_DONTWAIT);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && errno == ENOBUFS) {
+            overrun = true;
+            continue;
+        }
+        if (got <= 0) break;
+        auto len = int(got);
+        const std::lock_guard lock(lock_);
+        for (auto *head = reinterpret_cast<struct nlmsghdr *>(buf); NLMSG_OK(head, len); head = NLMSG_NEXT(head, len))
+            apply(table_, head, changes);
+    }
+    if (overrun) {
+        auto more = resync();
+        changes.insert(changes.end(), more.begin(), more.end());
+    }
+#else
+    (void)timeout;
+    changes = resync();
+#endif
+    notify(changes);
+    return changes.size();
+}
+
+auto socket::interfaces::find(std::string_view name) const -> entry_t {
+    const std::shared_lock lock(lock_);
+    const auto found = table_.by_name.find(name);
+    if (found == table_.by_name.end()) return {};
+    const auto entry = table_.by_index.find(found->second);
+    return entry != table_.by_index.end() ? entry->second : entry_t{};
+}
+
+auto socket::interfaces::find(unsigned index) const -> entry_t {
+    const std::shared_lock lock(lock_);
+    const auto entry = table_.by_index.find(index);
+    return entry != table_.by_index.end() ? entry->second : entry_t{};
+}
+
+auto socket::interfaces::find(const struct sockaddr *addr) const -> entry_t {
+    if (!addr) return {};
+    const std::shared_lock lock(lock_);
+    const auto found = table_.by_addr.find(make_key(addr));
+    if (found != table_.by_addr.end()) {
+        const auto entry = table_.by_index.find(found->second);
+        if (entry != table_.by_index.end()) return entry->second;
+    }
+    for (const auto& [index, entry] : table_.by_index) {
+        for (const auto& item : entry->addrs) {
+            if (on_subnet(addr, item)) return entry;
+        }
+    }
+    return {};
+}
+
+auto socket::interfaces::list() const -> std::vector<entry_t> {
+    std::vector<entry_t> entries;
+    {
+        const std::shared_lock lock(lock_);
+        entries.reserve(table_.by_index.size());
+        for (const auto& [index, entry] : table_.by_index)
+            entries.push_back(entry);
+    }
+    std::ranges::sort(entries, {}, &interface_t::index);
+    return entries;
+}
+
+auto socket::interfaces::size() const -> std::size_t {
+    const std::shared_lock lock(lock_);
+    return table_.by_index.size();
+}
+
+auto socket::interfaces::subscribe(notify_t notify) -> unsigned {
+    const std::lock_guard lock(notify_lock_);
+    notify_.emplace_back(++subscribers_, std::move(notify));
+    return subscribers_;
+}
+
+void socket::interfaces::unsubscribe(unsigned id) {
+    const std::lock_guard lock(notify_lock_);
+    std::erase_if(notify_, [id](const auto& entry) { return entry.first == id; });
+}
+
+// Subscribers are called without locks held, so they may look up, and
+// subscribe or unsubscribe.
+void socket::interfaces::notify(const changes_t& changes) {
+    if (changes.empty()) return;
+    std::vector<std::pair<unsigned, notify_t>> targets;
+    {
+        const std::lock_guard lock(notify_lock_);
+        targets = notify_;
+    }
+    for (const auto& [change, entry] : changes) {
+        for (const auto& [id, target] : targets)
+            target(change, *entry);
+    }
+}
+
+auto busuto::bind_address(const interfaces_t& nets, const std::string& id, uint16_t port, int family, bool multicast) -> address_t {
+    address_t any;
+    if (any_address(id, port, family, any)) return any;
+    const auto entry = nets.find(std::string_view(id));
+    if (!entry || (multicast && !entry->is_multicast())) return any;
+    const auto *addr = entry->find(family);
+    if (!addr) return any;
+    address_t result(*addr);
+    result.port(port);
+    return result;
+}
+
+auto busuto::multicast_index(const interfaces_t& nets, const std::string& id, int family) -> unsigned {
+    if (id == "*" && (family == AF_INET || family == AF_UNSPEC)) return ~0U;
+    const auto entry = nets.find(std::string_view(id));
+    if (!entry || !entry->is_multicast()) return 0U;
+    const auto *addr = entry->find(family);
+    if (!addr) return 0U;
+    if (addr->family() == AF_INET) return ~0U;
+    return entry->index;
+}
@@ -6,7 +6,16 @@
 #include "sockets.hpp"
 #include "sync.hpp"
 
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <ifaddrs.h>
+#include <net/if.h>
 
 namespace busuto::socket {
 using iface_t = struct ifaddrs *;
@@ -108,13 +117,120 @@ protected:
         }
     }
 };
+
+// Live table of network interfaces, kept current from routing netlink
+// events rather than by taking new snapshots. Interfaces are found by name,
+// index, or address through hash tables, and are shared as immutable
+// entries that an update replaces, so an entry stays valid while it is
+// held. Events are applied when update is called, such as when a reactor
+// finds the handle readable, and subscribers then hear of each change.
+// Other systems reload from getifaddrs on update instead.
+class interfaces final {
+public:
+    struct ifaddr_t {
+        address addr;
+        unsigned prefix{0};
+    };
+
+    struct interface_t {
+        unsigned index{0};
+        unsigned flags{0};
+        std::string name;
+        std::vector<ifaddr_t> addrs;
+
+        auto is_up() const noexcept { return (flags & IFF_UP) != 0; }
+        auto is_multicast() const noexcept { return (flags & IFF_MULTICAST) != 0; }
+
+        // First address of a family, or of either inet family if unspec.
+        auto find(int family = AF_UNSPEC) const noexcept -> const address * {
+            for (const auto& entry : addrs) {
+                const auto kind = entry.addr.family();
+                if (kind == family || (family == AF_UNSPEC && (kind == AF_INET || kind == AF_INET6))) return &entry.addr;
+            }
+            return nullptr;
+        }
+    };
+
+    enum class change_t : uint8_t { added, changed, removed };
+
+    using entry_t = std::shared_ptr<const interface_t>;
+    using notify_t = std::function<void(change_t, const interface_t&)>;
+
+    interfaces();
+    interfaces(const interfaces&) = delete;
+    auto operator=(const interfaces&) -> interfaces& = delete;
+    ~interfaces();
+
+    // Descriptor that becomes readable when events are pending.
+    auto handle() const noexcept { return netlink_; }
+
+    // Applies pending events, waiting up to timeout milliseconds for the
+    // first, and returns how many changes it made.
+    auto update(int timeout = 0) -> std::size_t;
+
+    auto find(std::string_view name) const -> entry_t;
+    auto find(unsigned index) const -> entry_t;
+
+    // Owner of an address, or else the interface on its subnet.
+    auto find(const struct sockaddr *addr) const -> entry_t;
+
+    auto list() const -> std::vector<entry_t>;
+    auto size() const -> std::size_t;
+
+    auto subscribe(notify_t notify) -> unsigned;
+    void unsubscribe(unsigned id);
+
+private:
+    struct key_t {
+        int family{AF_UNSPEC};
+        std::array<uint8_t, 16> bytes{};
+
+        auto operator==(const key_t&) const -> bool = default;
+    };
+
+    struct key_hash {
+        auto operator()(const key_t& key) const noexcept -> std::size_t;
+    };
+
+    struct name_hash {
+        using is_transparent = void;
+        auto operator()(std::string_view name) const noexcept -> std::size_t { return std::hash<std::string_view>{}(name); }
+    };
+
+    struct table_t {
+        std::unordered_map<unsigned, entry_t> by_index;
+        std::unordered_map<std::string, unsigned, name_hash, std::equal_to<>> by_name;
+        std::unordered_map<key_t, unsigned, key_hash> by_addr;
+    };
+
+    using changes_t = std::vector<std::pair<change_t, entry_t>>;
+
+    mutable std::shared_mutex lock_;
+    table_t table_;
+    std::mutex notify_lock_;
+    std::vector<std::pair<unsigned, notify_t>> notify_;
+    unsigned subscribers_{0};
+    int netlink_{-1};
+
+    static auto make_key(const struct sockaddr *addr) noexcept -> key_t;
+    static void replace(table_t& table, const entry_t& from, const entry_t& to);
+    static void apply(table_t& table, const void *msg, changes_t& changes);
+    auto load(table_t& table) -> bool;
+    auto resync() -> changes_t;
+    void notify(const changes_t& changes);
+};
 } // namespace busuto::socket
 
 namespace busuto {
 using networks_t = socket::networks;
+using interfaces_t = socket::interfaces;
 
 auto bind_address(const networks_t& nets, const std::string& id, uint16_t port = 0, int family = AF_UNSPEC, bool multicast = false) -> address_t;
 
 auto multicast_index(const networks_t& nets, const std::string& id, int family = AF_UNSPEC) -> unsigned;
 
+auto bind_address(const interfaces_t& nets, const std::string& id, uint16_t port = 0, int family = AF_UNSPEC, bool multicast = false) -> address_t;
+
+auto multicast_index(const interfaces_t& nets, const std::string& id, int family = AF_UNSPEC) -> unsigned;
+
 } // namespace busuto
@@ -8,6 +8,9 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <atomic>
+#include <cstring>
+#include <span>
 
 namespace busuto {
 inline constexpr auto GENERIC_DATETIME = "%c";
@@ -133,4 +136,120 @@ inline auto iso_time(const std::tm& current) {
 inline auto iso_time(const std::time_t& current) {
     return iso_datetime(current).substr(11, 8);
 }
+
+// Formats wall clock time stamps, such as for log lines. Each thread keeps
+// the text of the current second, and only the fraction is written again
+// until the second changes, so strftime and the time zone lock in
+// localtime run once a second rather than for every stamp. A fraction
+// follows the seconds field, ahead of any zone. The coarse clock is
+// cheaper to read, but only advances each scheduler tick.
+class timestamp final {
+public:
+    enum class precision : uint8_t { seconds = 0, millis = 3, micros = 6, nanos = 9 };
+
+    explicit timestamp(const char *fmt = ISO_DATETIME, precision digits = precision::millis, bool local = true, bool coarse = false) noexcept : id_(next_id()), digits_(uint8_t(digits)), local_(local), coarse_(coarse) {
+        const std::string_view text(fmt ? fmt : "");
+        auto pos = text.find("%S");
+        if (pos == std::string_view::npos) {
+            pos = text.size();
+            digits_ = 0;
+        } else
+            pos += 2;
+        copy(head_, text.substr(0, pos));
+        copy(tail_, text.substr(pos));
+    }
+
+    auto now() const noexcept {
+        timespec when{};
+#ifdef CLOCK_REALTIME_COARSE
+        clock_gettime(coarse_ ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME, &when);
+#else
+        clock_gettime(CLOCK_REALTIME, &when);
+#endif
+        return when;
+    }
+
+    // Formats into caller storage, truncated to fit, and returns the size.
+    auto format(std::span<char> to, const timespec& when) const noexcept -> std::size_t {
+        auto& slot = cache(id_);
+        if (slot.id != id_ || slot.second != when.tv_sec) refresh(slot, when.tv_sec);
+
+        char fraction[10];
+        std::size_t digits{0};
+        if (digits_) {
+            static constexpr unsigned scale[] = {1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1};
+            auto value = unsigned(when.tv_nsec) / scale[digits_];
+            fraction[0] = '.';
+            for (auto pos = unsigned(digits_); pos; --pos) {
+                fraction[pos] = char('0' + (value % 10));
+                value /= 10;
+            }
+            digits = digits_ + 1U;
+        }
+
+        std::size_t used{0};
+        auto put = [&](const char *from, std::size_t size) {
+            size = std::min(size, to.size() - used);
+            std::memcpy(to.data() + used, from, size);
+            used += size;
+        };
+        put(slot.text, slot.head);
+        put(fraction, digits);
+        put(slot.text + slot.head, slot.tail);
+        return used;
+    }
+
+    auto format(std::span<char> to) const noexcept {
+        return format(to, now());
+    }
+
+    auto to_string() const {
+        char text[sizeof(cache_t::text) + 10];
+        return std::string(text, format(text));
+    }
+
+    auto to_string(const timespec& when) const {
+        char text[sizeof(cache_t::text) + 10];
+        return std::string(text, format(text, when));
+    }
+
+private:
+    struct cache_t {
+        uint64_t id{0};
+        std::time_t second{0};
+        std::size_t head{0}, tail{0};
+        char text[96]{};
+    };
+
+    uint64_t id_;
+    uint8_t digits_;
+    bool local_, coarse_;
+    char head_[64]{}, tail_[32]{};
+
+    // Ids are never reused, so a stale slot can not match a new stamp.
+    static auto next_id() noexcept -> uint64_t {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static auto cache(uint64_t id) noexcept -> cache_t& {
+        thread_local cache_t slots[4];
+        return slots[id & 3];
+    }
+
+    template <std::size_t N>
+    static void copy(char (&to)[N], std::string_view from) noexcept {
+        const auto size = std::min(from.size(), N - 1);
+        std::memcpy(to, from.data(), size);
+        to[size] = 0;
+    }
+
+    void refresh(cache_t& slot, std::time_t second) const noexcept {
+        const auto current = local_ ? system::local_time(second) : system::gmt_time(second);
+        slot.id = id_;
+        slot.second = second;
+        slot.head = *head_ ? std::strftime(slot.text, sizeof(slot.text), head_, &current) : 0;
+        slot.tail = *tail_ ? std::strftime(slot.text + slot.head, sizeof(slot.text) - slot.head, tail_, &current) : 0;
+    }
+};
 } // namespace busuto
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "service.hpp"
+#include "sync.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace busuto::parallel {
+// Shared by the caller and the pool tasks helping it. Each claim takes a
+// share of what is left, so early chunks are large and the tail is split
+// finely for balance, never below the grain. Helpers that start after the
+// work is claimed find nothing to do and never touch the caller's body.
+class work_t final {
+public:
+    using invoke_t = void (*)(void *, std::size_t, std::size_t);
+
+    work_t(std::size_t count, std::size_t grain, std::size_t parties, void *body, invoke_t invoke) noexcept : count_(count), grain_(grain), parties_(parties), body_(body), invoke_(invoke), left_(count) {}
+
+    void work() noexcept {
+        std::size_t begin{}, end{};
+        while (claim(begin, end)) {
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    invoke_(body_, begin, end);
+                } catch (...) {
+                    const std::lock_guard lock(lock_);
+                    if (!error_) error_ = std::current_exception();
+                    failed_.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (left_.fetch_sub(end - begin, std::memory_order_acq_rel) == end - begin) {
+                done_.store(1, std::memory_order_release);
+                sync::wake_word(done_);
+            }
+        }
+    }
+
+    // Waits for chunks other threads claimed, then rethrows the first error.
+    void wait() {
+        while (!done_.load(std::memory_order_acquire))
+            sync::wait_word(done_, 0);
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    const std::size_t count_, grain_, parties_;
+    void *const body_;
+    const invoke_t invoke_;
+    std::atomic<std::size_t> next_{0}, left_;
+    std::atomic<uint32_t> done_{0};
+    std::atomic<bool> failed_{false};
+    std::mutex lock_;
+    std::exception_ptr error_;
+
+    auto claim(std::size_t& begin, std::size_t& end) noexcept -> bool {
+        auto pos = next_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (pos >= count_) return false;
+            const auto size = std::min(count_ - pos, std::max(grain_, (count_ - pos) / (2 * parties_)));
+            if (next_.compare_exchange_weak(pos, pos + size, std::memory_order_relaxed)) {
+                begin = pos;
+                end = pos + size;
+                return true;
+            }
+        }
+    }
+};
+
+// Runs body(begin, end) over index chunks of [0, count) on the pool and the
+// calling thread together. The caller always helps, so this also works from
+// inside a pool task, or with a pool that is not running at all.
+template <typename Body>
+void run(service::pool& pool, std::size_t count, std::size_t grain, Body& body) {
+    if (!count) return;
+    const auto workers = pool.size();
+    const auto parties = workers + 1;
+    if (!grain) grain = std::max(std::size_t(1), count / (parties * 8));
+    if (!workers || count <= grain) {
+        body(std::size_t(0), count);
+        return;
+    }
+
+    auto invoke = [](void *from, std::size_t begin, std::size_t end) {
+        (*static_cast<Body *>(from))(begin, end);
+    };
+
+    auto work = std::make_shared<work_t>(count, grain, parties, &body, invoke);
+    const auto helpers = std::min(workers, (count + grain - 1) / grain - 1);
+    for (std::size_t helper = 0; helper < helpers; ++helper) {
+        if (!pool.dispatch([work] { work->work(); })) break;
+    }
+    work->work();
+    work->wait();
+}
+} // namespace busuto::parallel
+
+namespace busuto {
+template <typename R>
+concept parallel_range = std::ranges::random_access_range<R> && std::ranges::sized_range<R>;
+
+// Calls func(index) for each index in [first, last).
+template <typename Func>
+requires std::invocable<Func&, std::size_t>
+void parallel_for(service::pool& pool, std::size_t first, std::size_t last, Func&& func, std::size_t grain = 0) {
+    if (last <= first) return;
+    auto body = [&func, first](std::size_t begin, std::size_t end) {
+        for (auto pos = begin; pos < end; ++pos)
+            func(first + pos);
+    };
+    parallel::run(pool, last - first, grain, body);
+}
+
+// Calls func(element) for each element of a random access range.
+template <parallel_range Range, typename Func>
+requires std::invocable<Func&, std::ranges::range_reference_t<Range>>
+void parallel_for(service::pool& pool, Range&& range, Func&& func, std::size_t grain = 0) {
+    auto from = std::ranges::begin(range);
+    auto body = [&func, from](std::size_t begin, std::size_t end) {
+        for (auto pos = begin; pos < end; ++pos)
+            func(from[std::ranges::range_difference_t<Range>(pos)]);
+    };
+    parallel::run(pool, std::size_t(std::ranges::size(range)), grain, body);
+}
+
+// Stores func(element) for each element through a random access output.
+template <parallel_range Range, std::random_access_iterator Out, typename Func>
+requires std::invocable<Func&, std::ranges::range_reference_t<Range>>
+auto parallel_transform(service::pool& pool, Range&& range, Out out, Func&& func, std::size_t grain = 0) {
+    using diff_t = std::ranges::range_difference_t<Range>;
+    auto from = std::ranges::begin(range);
+    auto body = [&func, from, out](std::size_t begin, std::size_t end) {
+        for (auto pos = begin; pos < end; ++pos)
+            out[std::iter_difference_t<Out>(pos)] = func(from[diff_t(pos)]);
+    };
+    const auto size = std::size_t(std::ranges::size(range));
+    parallel::run(pool, size, grain, body);
+    return out + std::iter_difference_t<Out>(size);
+}
+
+// Folds map(element) with an associative op. Chunk results are combined in
+// range order, so op need not be commutative.
+template <parallel_range Range, typename T, typename Op, typename Map = std::identity>
+auto parallel_reduce(service::pool& pool, Range&& range, T init, Op op, Map map = {}, std::size_t grain = 0) -> T {
+    using diff_t = std::ranges::range_difference_t<Range>;
+    const auto size = std::size_t(std::ranges::size(range));
+    if (!size) return init;
+
+    auto from = std::ranges::begin(range);
+    std::mutex lock;
+    std::vector<std::pair<std::size_t, T>> partials;
+    auto body = [&](std::size_t begin, std::size_t end) {
+        T local = std::invoke(map, from[diff_t(begin)]);
+        for (auto pos = begin + 1; pos < end; ++pos)
+            local = op(std::move(local), std::invoke(map, from[diff_t(pos)]));
+        const std::lock_guard guard(lock);
+        partials.emplace_back(begin, std::move(local));
+    };
+    parallel::run(pool, size, grain, body);
+
+    std::ranges::sort(partials, {}, &std::pair<std::size_t, T>::first);
+    for (auto& [begin, value] : partials)
+        init = op(std::move(init), std::move(value));
+    return init;
+}
+
+// Inclusive scan, so out[n] holds init combined with elements 0 thru n. The
+// range is split into one block per party, reduced, and then scanned again
+// from each block's offset.
+template <parallel_range Range, std::random_access_iterator Out, typename T, typename Op = std::plus<>>
+auto parallel_scan(service::pool& pool, Range&& range, Out out, T init, Op op = {}, std::size_t grain = 0) {
+    using diff_t = std::ranges::range_difference_t<Range>;
+    using out_t = std::iter_difference_t<Out>;
+    const auto size = std::size_t(std::ranges::size(range));
+    if (!size) return out;
+
+    auto from = std::ranges::begin(range);
+    if (!grain) grain = std::max(std::size_t(1), size / ((pool.size() + 1) * 4));
+    const auto blocks = (size + grain - 1) / grain;
+    std::vector<T> sums(blocks, init);
+    parallel_for(pool, 0, blocks, [&](std::size_t block) {
+        const auto begin = block * grain, end = std::min(size, begin + grain);
+        T local = from[diff_t(begin)];
+        for (auto pos = begin + 1; pos < end; ++pos)
+            local = op(std::move(local), from[diff_t(pos)]);
+        sums[block] = std::move(local);
+    }, 1);
+
+    // sums become the offset each block starts from
+    for (auto& sum : sums)
+        init = op(init, std::exchange(sum, init));
+
+    parallel_for(pool, 0, blocks, [&](std::size_t block) {
+        const auto begin = block * grain, end = std::min(size, begin + grain);
+        T local = sums[block];
+        for (auto pos = begin; pos < end; ++pos) {
+            local = op(std::move(local), from[diff_t(pos)]);
+            out[out_t(pos)] = local;
+        }
+    }, 1);
+    return out + out_t(size);
+}
+
+template <typename Func>
+requires std::invocable<Func&, std::size_t>
+void parallel_for(std::size_t first, std::size_t last, Func&& func, std::size_t grain = 0) {
+    parallel_for(system_pool, first, last, std::forward<Func>(func), grain);
+}
+
+template <parallel_range Range, typename Func>
+void parallel_for(Range&& range, Func&& func, std::size_t grain = 0) {
+    parallel_for(system_pool, std::forward<Range>(range), std::forward<Func>(func), grain);
+}
+
+template <parallel_range Range, std::random_access_iterator Out, typename Func>
+auto parallel_transform(Range&& range, Out out, Func&& func, std::size_t grain = 0) {
+    return parallel_transform(system_pool, std::forward<Range>(range), out, std::forward<Func>(func), grain);
+}
+
+template <parallel_range Range, typename T, typename Op, typename Map = std::identity>
+auto parallel_reduce(Range&& range, T init, Op op, Map map = {}, std::size_t grain = 0) -> T {
+    return parallel_reduce(system_pool, std::forward<Range>(range), std::move(init), std::move(op), std::move(map), grain);
+}
+
+template <parallel_range Range, std::random_access_iterator Out, typename T, typename Op = std::plus<>>
+auto parallel_scan(Range&& range, Out out, T init, Op op = {}, std::size_t grain = 0) {
+    return parallel_scan(system_pool, std::forward<Range>(range), out, std::move(init), std::move(op), grain);
+}
+} // namespace busuto
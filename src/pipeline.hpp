@@ -6,6 +6,8 @@
 #include "threads.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <utility>
 
 namespace busuto::system {
 template <typename T, std::size_t S>
@@ -63,12 +65,8 @@ public:
         lock_t lock(lock_);
         while (!closed_) {
             if (count_ < S) {
-                data_[tail_] = std::move(data);
-                tail_ = (tail_ + 1) % S;
-                if (count_++ == 0) { // notify no longer empty
-                    output_.notify_one();
-                    this->notify(true);
-                }
+                put(std::move(data));
+                output_.notify_one();
                 return true;
             }
             full(lock);
@@ -80,12 +78,8 @@ public:
         lock_t lock(lock_);
         while (!closed_) {
             if (count_ < S) {
-                data_[tail_] = data;
-                tail_ = (tail_ + 1) % S;
-                if (count_++ == 0) { // notify no longer empty
-                    output_.notify_one();
-                    this->notify(true);
-                }
+                put(data);
+                output_.notify_one();
                 return true;
             }
             full(lock);
@@ -93,17 +87,50 @@ public:
         return false;
     }
 
+    // Moves the whole range in, waiting only when the pipeline fills.
+    // Returns how many were queued, which is short only if closed.
+    template <typename Iter>
+    auto push_range(Iter first, Iter last) -> std::size_t {
+        lock_t lock(lock_);
+        std::size_t total{0}, pending{0};
+        while (!closed_ && first != last) {
+            if (count_ < S) {
+                put(std::move(*first));
+                ++first;
+                ++total;
+                ++pending;
+                continue;
+            }
+            wakeup(std::exchange(pending, 0));
+            full(lock);
+        }
+        wakeup(pending);
+        return total;
+    }
+
+    // Non-blocking; does not apply the full policy of derived pipelines.
+    auto try_push(T&& data) {
+        const guard_t lock(lock_);
+        if (closed_ || count_ >= S) return false;
+        put(std::move(data));
+        output_.notify_one();
+        return true;
+    }
+
+    auto try_push(const T& data) {
+        const guard_t lock(lock_);
+        if (closed_ || count_ >= S) return false;
+        put(data);
+        output_.notify_one();
+        return true;
+    }
+
     auto pull(T& out) {
         lock_t lock(lock_);
         while (!closed_) {
             if (count_ > 0) {
-                out = std::move(data_[head_]);
-                clear_item(data_[head_], false); // moved...
-                head_ = (head_ + 1) % S;
-                if (count_-- == S) // notify push when no longer full...
-                    input_.notify_one();
-                if (!count_) // notify clears when emptied
-                    this->notify(false);
+                take(out);
+                input_.notify_one(); // wake any producer waiting for room
                 return true;
             }
             wait(lock);
@@ -111,6 +138,39 @@ public:
         return false;
     }
 
+    auto try_pull(T& out) {
+        const guard_t lock(lock_);
+        if (closed_ || !count_) return false;
+        take(out);
+        input_.notify_one();
+        return true;
+    }
+
+    auto pull_for(T& out, std::chrono::milliseconds timeout) {
+        lock_t lock(lock_);
+        if (!output_.wait_for(lock, timeout, [&] { return closed_ || count_ > 0; }) || closed_) return false;
+        take(out);
+        input_.notify_one();
+        return true;
+    }
+
+    // Moves up to max items into out under one lock, waiting up to timeout
+    // for the first one. Returns how many were taken.
+    template <typename Out>
+    auto pull_batch(Out out, std::size_t max, std::chrono::milliseconds timeout) -> std::size_t {
+        lock_t lock(lock_);
+        if (!output_.wait_for(lock, timeout, [&] { return closed_ || count_ > 0; })) return 0;
+        return drain(out, max);
+    }
+
+    template <typename Out>
+    auto pull_batch(Out out, std::size_t max) -> std::size_t {
+        lock_t lock(lock_);
+        while (!closed_ && !count_)
+            wait(lock);
+        return drain(out, max);
+    }
+
     template <typename Func>
     requires std::invocable<Func, const T&>
     auto peek(Func func) const -> bool {
@@ -173,6 +233,46 @@ protected:
         }
     }
 
+    template <typename Item>
+    void put(Item&& data) {
+        data_[tail_] = std::forward<Item>(data);
+        tail_ = (tail_ + 1) % S;
+        if (count_++ == 0) // notify no longer empty
+            this->notify(true);
+    }
+
+    template <typename Out>
+    void take(Out&& out) {
+        out = std::move(data_[head_]);
+        clear_item(data_[head_], false); // moved...
+        head_ = (head_ + 1) % S;
+        if (!--count_) // notify clears when emptied
+            this->notify(false);
+    }
+
+    void wakeup(std::size_t pending) {
+        if (pending > 1)
+            output_.notify_all();
+        else if (pending)
+            output_.notify_one();
+    }
+
+    template <typename Out>
+    auto drain(Out& out, std::size_t max) -> std::size_t {
+        if (closed_) return 0;
+        std::size_t total{0};
+        for (; total < max && count_ > 0; ++total) {
+            take(*out);
+            ++out;
+        }
+
+        if (total > 1)
+            input_.notify_all();
+        else if (total)
+            input_.notify_one();
+        return total;
+    }
+
     auto drop_head(bool notify = true) {
         if (!count_) return false;
         clear_item(data_[head_], true);
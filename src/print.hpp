@@ -7,9 +7,12 @@
 #include "sockets.hpp"
 #include "system.hpp"
 #include "binary.hpp"
+#include "buffer.hpp"
+#include "safe.hpp"
 #include "fsys.hpp"
 
 #include <format>
+#include <span>
 
 namespace busuto {
 template <class... Args>
@@ -32,6 +35,58 @@ auto print(Stream&& out, std::string_view fmt, Args&&...args) -> Stream& { // NO
     return out;
 }
 
+// What formatting into a fixed buffer wrote, and what the whole text
+// needed. Text that does not fit is truncated rather than allocated.
+struct format_result final {
+    std::size_t size{0};
+    std::size_t needed{0};
+
+    explicit operator bool() const noexcept { return size == needed; }
+    auto operator!() const noexcept { return size != needed; }
+    auto truncated() const noexcept { return size < needed; }
+};
+
+// Anything that lends its free output space to format into in place, such
+// as output and format buffers, system streams, and logger streams.
+template <typename T>
+concept format_target = requires(T& to, std::size_t size) {
+    { to.space(size) } -> std::convertible_to<std::span<char>>;
+    to.commit(size);
+};
+
+// Format strings are checked at compile time, and nothing is allocated.
+template <typename... Args>
+auto format_to(std::span<char> to, std::format_string<Args...> fmt, Args&&...args) {
+    const auto [out, needed] = std::format_to_n(to.data(), std::ptrdiff_t(to.size()), fmt, std::forward<Args>(args)...);
+    return format_result{std::size_t(out - to.data()), std::size_t(needed)};
+}
+
+// Appends at the end of what the target holds. A stream that is short of
+// space flushes pending output and formats again before truncating.
+template <typename Target, typename... Args>
+requires format_target<std::remove_reference_t<Target>>
+auto format_to(Target&& to, std::format_string<Args...> fmt, Args&&...args) {
+    auto space = to.space(1);
+    auto result = format_to(space, fmt, std::forward<Args>(args)...);
+    if (result.truncated()) {
+        auto more = to.space(result.needed);
+        if (more.size() > space.size() || more.data() != space.data())
+            result = format_to(more, fmt, std::forward<Args>(args)...); // NOLINT
+    }
+    to.commit(result.size);
+    return result;
+}
+
+template <std::size_t S, typename... Args>
+auto format_to(stringbuf<S>& to, std::format_string<Args...> fmt, Args&&...args) {
+    const auto used = to.size();
+    return to.apply([&](char *data, std::size_t size) {
+        const auto result = format_to(std::span<char>(data + used, size - used), fmt, std::forward<Args>(args)...);
+        data[used + result.size] = 0;
+        return result;
+    });
+}
+
 #ifdef NDEBUG
 template <typename... Args>
 void debug(std::string_view fmt, Args&&...args) {} // NOLINT
@@ -70,13 +125,27 @@ struct formatter<busuto::fsys::path, char> { // NOLINT
     }
 };
 
+// Formats the current time through the per thread cache.
 template <>
-struct formatter<busuto::byte_array, char> {
+struct formatter<busuto::timestamp, char> {
+    static constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    auto format(const busuto::timestamp& stamp, std::format_context& ctx) const { // NOLINT
+        char text[128];
+        const auto size = stamp.format(text);
+        return std::copy_n(text, size, ctx.out());
+    }
+};
+
+template <typename Alloc>
+struct formatter<busuto::basic_byte_array<Alloc>, char> {
     static constexpr auto parse(std::format_parse_context& ctx) {
         return ctx.begin();
     }
 
-    auto format(const busuto::byte_array& b, std::format_context& ctx) const { // NOLINT
+    auto format(const busuto::basic_byte_array<Alloc>& b, std::format_context& ctx) const { // NOLINT
         if (!is(b))
             return std::format_to(ctx.out(), "nil");
         return std::format_to(ctx.out(), "{}", b.to_hex());
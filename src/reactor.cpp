@@ -0,0 +1,414 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "reactor.hpp"
+
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define BUSUTO_URING // NOLINT
+#endif
+
+using namespace busuto;
+
+struct service::reactor::source_t {
+    int fd{-1};
+    unsigned events{0};
+    callback_t handler;
+    period_t timeout{0};
+    uint64_t key{0};
+    timer_id timer{0};
+    bool busy{false};
+    bool active{true};
+};
+
+class service::reactor::backend {
+public:
+    struct event_t {
+        uint64_t key;
+        unsigned events;
+    };
+
+    backend() = default;
+    backend(const backend&) = delete;
+    auto operator=(const backend&) -> backend& = delete;
+    virtual ~backend() = default;
+
+    virtual auto add(int fd, unsigned events, uint64_t key) -> bool = 0;
+    virtual auto rearm(int fd, unsigned events, uint64_t key) -> bool = 0;
+    virtual void remove(int fd, uint64_t key) = 0;
+    virtual auto modify(int fd, unsigned events, uint64_t prior, uint64_t key, bool arm) -> bool = 0;
+    virtual void wait(std::vector<event_t>& out, int timeout) = 0;
+};
+
+namespace {
+constexpr uint64_t wake_key = 0;
+constexpr std::size_t batch_events = 128;
+
+class epoll_backend final : public service::reactor::backend {
+public:
+    epoll_backend() : epoll_(epoll_create1(EPOLL_CLOEXEC)) {
+        if (epoll_ < 0) throw error("epoll unavailable");
+    }
+
+    ~epoll_backend() final {
+        ::close(epoll_);
+    }
+
+    auto add(int fd, unsigned events, uint64_t key) -> bool final {
+        return control(EPOLL_CTL_ADD, fd, events, key);
+    }
+
+    auto rearm(int fd, unsigned events, uint64_t key) -> bool final {
+        return control(EPOLL_CTL_MOD, fd, events, key);
+    }
+
+    void remove(int fd, uint64_t /* key */) final {
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    // A busy source is already disarmed and is re-armed when it finishes.
+    auto modify(int fd, unsigned events, uint64_t /* prior */, uint64_t key, bool arm) -> bool final {
+        return !arm || control(EPOLL_CTL_MOD, fd, events, key);
+    }
+
+    void wait(std::vector<event_t>& out, int timeout) final {
+        epoll_event events[batch_events];
+        const auto count = epoll_wait(epoll_, events, int(batch_events), timeout);
+        for (auto pos = 0; pos < count; ++pos)
+            out.push_back({events[pos].data.u64, events[pos].events});
+    }
+
+private:
+    int epoll_{-1};
+
+    auto control(int op, int fd, unsigned events, uint64_t key) const -> bool {
+        epoll_event event{};
+        event.events = events | EPOLLONESHOT;
+        event.data.u64 = key;
+        return epoll_ctl(epoll_, op, fd, &event) == 0;
+    }
+};
+
+#ifdef BUSUTO_URING
+// Poll requests submitted through raw io_uring syscalls. Each POLL_ADD is
+// one-shot already, which matches how the reactor re-arms sources.
+class uring_backend final : public service::reactor::backend {
+public:
+    explicit uring_backend(unsigned entries = 256) {
+        io_uring_params params{};
+        ring_ = int(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_ < 0) throw error("io_uring unavailable");
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+            ::close(ring_);
+            throw error("io_uring too old");
+        }
+
+        ring_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring_map_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQES));
+        if (ring_map_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            release();
+            throw error("io_uring mapping failed");
+        }
+
+        auto base = static_cast<char *>(ring_map_);
+        sq_head_ = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+    }
+
+    ~uring_backend() final {
+        release();
+    }
+
+    auto add(int fd, unsigned events, uint64_t key) -> bool final {
+        return rearm(fd, events, key);
+    }
+
+    auto rearm(int fd, unsigned events, uint64_t key) -> bool final {
+        const std::lock_guard lock(lock_);
+        auto sqe = next_sqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = events;
+        sqe->user_data = key;
+        return submit();
+    }
+
+    void remove(int /* fd */, uint64_t key) final {
+        const std::lock_guard lock(lock_);
+        auto sqe = next_sqe();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = key;
+        sqe->user_data = ignore_key;
+        submit();
+    }
+
+    auto modify(int fd, unsigned events, uint64_t prior, uint64_t key, bool arm) -> bool final {
+        remove(fd, prior);
+        return !arm || rearm(fd, events, key);
+    }
+
+    void wait(std::vector<event_t>& out, int timeout) final {
+        if (!reap(out)) {
+            if (timeout >= 0) {
+                const std::lock_guard lock(lock_);
+                timeout_.tv_sec = timeout / 1000;
+                timeout_.tv_nsec = (timeout % 1000) * 1000000L;
+                auto sqe = next_sqe();
+                sqe->opcode = IORING_OP_TIMEOUT;
+                sqe->fd = -1;
+                sqe->addr = reinterpret_cast<uint64_t>(&timeout_);
+                sqe->len = 1;
+                sqe->off = 1; // also completes on any other completion
+                sqe->user_data = ignore_key;
+                submit();
+            }
+            syscall(__NR_io_uring_enter, ring_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            reap(out);
+        }
+    }
+
+private:
+    static constexpr uint64_t ignore_key = ~uint64_t{0};
+
+    int ring_{-1};
+    void *ring_map_{MAP_FAILED};
+    io_uring_sqe *sqes_{static_cast<io_uring_sqe *>(MAP_FAILED)};
+    std::size_t ring_size_{0}, sqes_size_{0};
+    unsigned *sq_head_{nullptr}, *sq_tail_{nullptr}, *sq_array_{nullptr};
+    unsigned *cq_head_{nullptr}, *cq_tail_{nullptr};
+    unsigned sq_mask_{0}, sq_entries_{0}, cq_mask_{0}, pending_{0};
+    io_uring_cqe *cqes_{nullptr};
+    __kernel_timespec timeout_{};
+    std::mutex lock_;
+
+    void release() noexcept {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (ring_map_ != MAP_FAILED) munmap(ring_map_, ring_size_);
+        if (ring_ > -1) ::close(ring_);
+    }
+
+    // Caller holds lock; flushes the queue when the kernel has not caught up.
+    auto next_sqe() -> io_uring_sqe * {
+        auto tail = *sq_tail_;
+        while (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+            submit();
+
+        const auto index = tail & sq_mask_;
+        auto sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        return sqe;
+    }
+
+    auto submit() -> bool {
+        const auto result = syscall(__NR_io_uring_enter, ring_, pending_, 0, 0, nullptr, 0);
+        if (result < 0) return false;
+        pending_ -= unsigned(result);
+        return true;
+    }
+
+    auto reap(std::vector<event_t>& out) -> bool {
+        auto head = *cq_head_;
+        const auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        const auto found = head != tail;
+        for (; head != tail; ++head) {
+            const auto& cqe = cqes_[head & cq_mask_];
+            if (cqe.user_data != ignore_key && cqe.res >= 0)
+                out.push_back({cqe.user_data, unsigned(cqe.res)});
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return found;
+    }
+};
+#endif
+} // namespace
+
+service::reactor::reactor(engine_t engine, dispatch_t dispatch) : dispatch_(std::move(dispatch)) {
+#ifdef BUSUTO_URING
+    if (engine == uring) {
+        try {
+            engine_ = std::make_unique<uring_backend>();
+            kind_ = uring;
+        } catch (const std::exception&) {
+            engine_.reset();
+        }
+    }
+#endif
+    if (!engine_)
+        engine_ = std::make_unique<epoll_backend>();
+    engine_->add(wakeup_.handle(), readable, wake_key);
+}
+
+service::reactor::reactor(tasks& queue, engine_t engine) : reactor(engine, [&queue](task_t task) { return queue.dispatch(std::move(task)); }) {}
+
+service::reactor::reactor(pool& workers, engine_t engine) : reactor(engine, [&workers](task_t task) { return workers.dispatch(std::move(task)); }) {}
+
+service::reactor::~reactor() {
+    shutdown();
+    const std::lock_guard lock(lock_);
+    for (auto& [fd, src] : sources_)
+        src->active = false;
+    sources_.clear();
+}
+
+auto service::reactor::add(int fd, unsigned events, callback_t handler, const period_t& timeout) -> bool {
+    if (fd < 0 || !handler) return false;
+    const std::lock_guard lock(lock_);
+    if (sources_.contains(fd)) return false;
+    auto src = std::make_shared<source_t>();
+    src->fd = fd;
+    src->events = events;
+    src->handler = std::move(handler);
+    src->timeout = timeout;
+    src->key = src->timer = next_key(fd);
+    if (!engine_->add(fd, events, src->key)) return false;
+    if (timeout.count() > 0)
+        timeouts_.arm({src->timer, timeout, timer_clock::now() + timeout, {}});
+    sources_.emplace(fd, std::move(src));
+    wakeup_.signal(); // loop may need a shorter wait for the new timeout
+    return true;
+}
+
+auto service::reactor::modify(int fd, unsigned events) -> bool {
+    const std::lock_guard lock(lock_);
+    auto it = sources_.find(fd);
+    if (it == sources_.end()) return false;
+    auto& src = it->second;
+    const auto prior = std::exchange(src->key, next_key(fd));
+    src->events = events;
+    return engine_->modify(fd, events, prior, src->key, !src->busy);
+}
+
+auto service::reactor::remove(int fd) -> bool {
+    const std::lock_guard lock(lock_);
+    auto it = sources_.find(fd);
+    if (it == sources_.end()) return false;
+    auto& src = it->second;
+    src->active = false;
+    engine_->remove(fd, src->key);
+    if (auto entry = timeouts_.find(src->timer); entry)
+        timeouts_.erase(*entry);
+    sources_.erase(it);
+    return true;
+}
+
+auto service::reactor::contains(int fd) const -> bool {
+    const std::lock_guard lock(lock_);
+    return sources_.contains(fd);
+}
+
+auto service::reactor::size() const -> std::size_t {
+    const std::lock_guard lock(lock_);
+    return sources_.size();
+}
+
+auto service::reactor::next_key(int fd) noexcept -> uint64_t {
+    if (++serial_ == 0) ++serial_;
+    return (uint64_t(serial_) << 32U) | uint32_t(fd);
+}
+
+auto service::reactor::run_once(int timeout) -> std::size_t {
+    {
+        const std::lock_guard lock(lock_);
+        const auto when = timeouts_.wakeup();
+        if (when != timer_clock::time_point::max()) {
+            const auto delay = std::chrono::ceil<std::chrono::milliseconds>(when - timer_clock::now()).count();
+            const auto wait = int(std::max<decltype(delay)>(delay, 0));
+            timeout = timeout < 0 ? wait : std::min(timeout, wait);
+        }
+    }
+
+    std::vector<backend::event_t> events;
+    events.reserve(batch_events);
+    engine_->wait(events, timeout);
+
+    std::vector<std::pair<source_p, unsigned>> ready;
+    std::unique_lock lock(lock_);
+    const auto now = timer_clock::now();
+    for (const auto& [key, revents] : events) {
+        if (key == wake_key) {
+            wakeup_.clear();
+            engine_->rearm(wakeup_.handle(), readable, wake_key);
+            continue;
+        }
+
+        auto it = sources_.find(int(uint32_t(key)));
+        if (it == sources_.end() || it->second->key != key || it->second->busy) continue;
+        auto& src = it->second;
+        src->busy = true;
+        if (auto entry = timeouts_.find(src->timer); entry)
+            timeouts_.rearm(*entry, now + src->timeout);
+        ready.emplace_back(src, revents);
+    }
+
+    while (auto entry = timeouts_.expired(now)) {
+        timeouts_.rearm(*entry, now + entry->period);
+        auto it = sources_.find(int(uint32_t(entry->id)));
+        if (it == sources_.end() || it->second->busy) continue;
+        it->second->busy = true;
+        ready.emplace_back(it->second, expired);
+    }
+    lock.unlock();
+
+    for (const auto& [src, revents] : ready)
+        deliver(src, revents);
+    return ready.size();
+}
+
+// A refused dispatch, from a full or stopped queue, runs the callback here
+// instead, since the source is only re-armed after its callback.
+void service::reactor::deliver(const source_p& src, unsigned events) {
+    auto task = [this, src, events] {
+        try {
+            src->handler(src->fd, events);
+        } catch (const std::exception& e) {
+            errors_(e);
+        } catch (...) {
+            errors_(std::runtime_error("reactor handler failed"));
+        }
+        finish(src);
+    };
+
+    if (!dispatch_ || !dispatch_(task_t(task)))
+        task();
+}
+
+void service::reactor::finish(const source_p& src) {
+    const std::lock_guard lock(lock_);
+    src->busy = false;
+    if (src->active)
+        engine_->rearm(src->fd, src->events, src->key);
+}
+
+void service::reactor::startup() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this] {
+        while (running_)
+            run_once(-1);
+    });
+}
+
+void service::reactor::shutdown() {
+    if (!running_.exchange(false)) return;
+    wakeup_.signal();
+    if (thread_.joinable())
+        thread_.join();
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "service.hpp"
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace busuto::service {
+// Readiness event loop over epoll, or io_uring poll requests when asked for
+// and available. Sources are armed one-shot and re-armed after their
+// callback returns, so a source is never handled by two threads at once.
+// Callbacks run on the loop thread, or are dispatched to a tasks queue or
+// pool, falling back to the loop thread when the dispatch is refused;
+// dispatched callbacks must finish before the reactor is destroyed.
+class reactor final {
+public:
+    using callback_t = std::function<void(int, unsigned)>;
+    using dispatch_t = std::function<bool(task_t)>;
+    using period_t = std::chrono::milliseconds;
+
+    enum class engine_t { epoll, uring };
+    static constexpr auto epoll = engine_t::epoll;
+    static constexpr auto uring = engine_t::uring;
+
+    static constexpr unsigned readable = POLLIN;
+    static constexpr unsigned writable = POLLOUT;
+    static constexpr unsigned failed = POLLERR;
+    static constexpr unsigned hangup = POLLHUP;
+    static constexpr unsigned expired = 1U << 30;
+
+    class backend; // engine interface, see reactor.cpp
+
+    explicit reactor(engine_t engine = epoll, dispatch_t dispatch = nullptr);
+    explicit reactor(tasks& queue, engine_t engine = epoll);
+    explicit reactor(pool& workers, engine_t engine = epoll);
+    ~reactor();
+
+    reactor(const reactor&) = delete;
+    auto operator=(const reactor&) -> reactor& = delete;
+
+    explicit operator bool() const noexcept { return engine_ != nullptr; }
+    auto operator!() const noexcept { return engine_ == nullptr; }
+
+    auto engine() const noexcept { return kind_; }
+
+    // Handler exceptions are passed here, as tasks and pools do; those not
+    // derived from std::exception arrive as a runtime_error.
+    auto errors(error_t handler) -> auto& {
+        if (running_) throw std::runtime_error("cannot modify running reactor");
+        errors_ = handler;
+        return *this;
+    }
+
+    // Timeout is an idle period; the callback gets expired if no event
+    // arrives within it, and the timeout restarts on every event.
+    auto add(int fd, unsigned events, callback_t handler, const period_t& timeout = period_t(0)) -> bool;
+    auto modify(int fd, unsigned events) -> bool;
+    auto remove(int fd) -> bool;
+    auto contains(int fd) const -> bool;
+    auto size() const -> std::size_t;
+
+    // Waits up to timeout msecs (-1 forever) and returns events dispatched.
+    auto run_once(int timeout = -1) -> std::size_t;
+    void startup();
+    void shutdown();
+
+private:
+    struct source_t;
+    using source_p = std::shared_ptr<source_t>;
+
+    engine_t kind_{epoll};
+    std::unique_ptr<backend> engine_;
+    dispatch_t dispatch_;
+    error_t errors_{[](const std::exception& e) {}};
+    mutable std::mutex lock_;
+    std::unordered_map<int, source_p> sources_;
+    timer_wheel timeouts_;
+    uint32_t serial_{0};
+    system::notify_t wakeup_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    auto next_key(int fd) noexcept -> uint64_t;
+    void deliver(const source_p& src, unsigned events);
+    void finish(const source_p& src);
+};
+} // namespace busuto::service
@@ -5,6 +5,7 @@
 
 #include <semaphore>
 #include <chrono>
+#include <thread>
 
 using namespace busuto;
 
@@ -63,3 +64,123 @@ auto socket::lookup(const socket::name_t& name, int family, int type, int protoc
     }
     return socket::service(list);
 }
+
+auto resolver_cache::resolve(const socket::name_t& name, int family, int type, int protocol, int timeout) -> std::shared_future<result_t> {
+    key_t key{name.first, name.second, family, type, protocol};
+    std::promise<result_t> promise;
+    std::shared_future<result_t> result;
+    {
+        const std::lock_guard lock(lock_);
+        auto entry = cache_.find(key);
+        if (entry != cache_.end()) {
+            if (entry->second.pending()) {
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+                return entry->second.result;
+            }
+            if (clock_t::now() < entry->second.expires) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return entry->second.result;
+            }
+            cache_.erase(entry);
+        }
+
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        if (cache_.size() >= limit_)
+            evict();
+        result = promise.get_future().share();
+        cache_.emplace(key, entry_t{result});
+    }
+
+    auto acquired = true;
+    if (timeout < 0)
+        resolvers.acquire();
+    else if (!timeout)
+        acquired = resolvers.try_acquire();
+    else
+        acquired = resolvers.try_acquire_for(std::chrono::milliseconds(timeout));
+
+    // waiters that joined this lookup see the same failure
+    auto fail = [&](const std::exception_ptr& error) {
+        forget(key);
+        promise.set_exception(error);
+    };
+
+    if (!acquired) {
+        fail(std::make_exception_ptr(resolver_timeout()));
+        throw resolver_timeout();
+    }
+
+    pending_.add(1);
+    try {
+        std::thread([this, key, promise = std::move(promise)]() mutable {
+            const sync::semaphore_scope scope(resolvers);
+            const sync::group_scope done(pending_);
+            try {
+                auto found = std::make_shared<const socket::service>(lookup_({key.host, key.service}, key.family, key.type, key.protocol));
+                complete(key, !found->empty());
+                promise.set_value(std::move(found));
+            } catch (...) {
+                // a lookup that threw did not find the name missing
+                forget(key);
+                promise.set_exception(std::current_exception());
+            }
+        }).detach();
+    } catch (...) {
+        resolvers.release();
+        pending_.release();
+        fail(std::current_exception());
+        throw;
+    }
+    return result;
+}
+
+void resolver_cache::complete(const key_t& key, bool found) noexcept {
+    const std::lock_guard lock(lock_);
+    auto entry = cache_.find(key);
+    if (entry == cache_.end() || !entry->second.pending()) return;
+    const auto ttl = found ? positive_ : negative_;
+    if (ttl.count() <= 0)
+        cache_.erase(entry);
+    else
+        entry->second.expires = clock_t::now() + ttl;
+}
+
+void resolver_cache::forget(const key_t& key) noexcept {
+    const std::lock_guard lock(lock_);
+    auto entry = cache_.find(key);
+    if (entry != cache_.end() && entry->second.pending())
+        cache_.erase(entry);
+}
+
+void resolver_cache::clear() noexcept {
+    const std::lock_guard lock(lock_);
+    std::erase_if(cache_, [](const auto& item) {
+        return !item.second.pending();
+    });
+}
+
+auto resolver_cache::sweep() noexcept -> std::size_t {
+    const std::lock_guard lock(lock_);
+    const auto now = clock_t::now();
+    return std::erase_if(cache_, [now](const auto& item) {
+        return !item.second.pending() && item.second.expires <= now;
+    });
+}
+
+// Drops expired entries, then the one expiring soonest if still full.
+// Entries with lookups in flight are kept so their waiters still coalesce.
+void resolver_cache::evict() noexcept {
+    const auto now = clock_t::now();
+    std::erase_if(cache_, [now](const auto& item) {
+        return !item.second.pending() && item.second.expires <= now;
+    });
+
+    if (cache_.size() < limit_) return;
+    auto oldest = cache_.end();
+    for (auto entry = cache_.begin(); entry != cache_.end(); ++entry) {
+        if (!entry->second.pending() && (oldest == cache_.end() || entry->second.expires < oldest->second.expires))
+            oldest = entry;
+    }
+    if (oldest != cache_.end())
+        cache_.erase(oldest);
+}
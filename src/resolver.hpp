@@ -8,11 +8,18 @@
 
 #include <semaphore>
 #include <future>
+#include <functional>
+#include <memory>
+#include <map>
 
 #ifndef BUSUTO_RESOLVER_COUNT
 #define BUSUTO_RESOLVER_COUNT 8 // NOLINT
 #endif
 
+#ifndef BUSUTO_RESOLVER_CACHE
+#define BUSUTO_RESOLVER_CACHE 1024 // NOLINT
+#endif
+
 namespace busuto::socket {
 using name_t = std::pair<std::string, std::string>;
 using addr_t = std::pair<const struct sockaddr *, socklen_t>;
@@ -225,4 +232,69 @@ inline auto defer_resolver(const socket::addr_t& info, int flags = 0) {
         return socket::lookup(info, flags);
     });
 }
+
+// Caches resolved names for a positive ttl and failed lookups for a negative
+// ttl. A lookup that throws is not cached, so the next request retries it.
+// Concurrent requests for a name already being looked up share the one
+// in-flight lookup rather than each calling getaddrinfo.
+class resolver_cache final {
+public:
+    using result_t = std::shared_ptr<const socket::service>;
+    using lookup_t = std::function<socket::service(const socket::name_t&, int, int, int)>;
+
+    explicit resolver_cache(std::chrono::seconds positive = std::chrono::seconds(60), std::chrono::seconds negative = std::chrono::seconds(5), std::size_t limit = BUSUTO_RESOLVER_CACHE, lookup_t lookup = lookup_t(socket_lookup)) : positive_(positive), negative_(negative), limit_(limit), lookup_(std::move(lookup)) {}
+
+    resolver_cache(const resolver_cache&) = delete;
+    auto operator=(const resolver_cache&) -> resolver_cache& = delete;
+
+    auto resolve(const socket::name_t& name, int family = AF_UNSPEC, int type = SOCK_STREAM, int protocol = 0, int timeout = -1) -> std::shared_future<result_t>;
+    void clear() noexcept;
+    auto sweep() noexcept -> std::size_t;
+
+    auto lookup(const socket::name_t& name, int family = AF_UNSPEC, int type = SOCK_STREAM, int protocol = 0, int timeout = -1) {
+        return resolve(name, family, type, protocol, timeout).get();
+    }
+
+    auto size() const noexcept {
+        const std::lock_guard lock(lock_);
+        return cache_.size();
+    }
+
+    auto hits() const noexcept { return hits_.load(std::memory_order_relaxed); }
+    auto misses() const noexcept { return misses_.load(std::memory_order_relaxed); }
+    auto coalesced() const noexcept { return coalesced_.load(std::memory_order_relaxed); }
+
+private:
+    using clock_t = std::chrono::steady_clock;
+
+    struct key_t {
+        std::string host, service;
+        int family{AF_UNSPEC}, type{SOCK_STREAM}, protocol{0};
+
+        auto operator<=>(const key_t&) const = default;
+    };
+
+    struct entry_t {
+        std::shared_future<result_t> result;
+        clock_t::time_point expires{clock_t::time_point::max()};
+
+        auto pending() const noexcept { return expires == clock_t::time_point::max(); }
+    };
+
+    mutable std::mutex lock_;
+    std::map<key_t, entry_t> cache_;
+    std::chrono::seconds positive_, negative_;
+    std::size_t limit_;
+    lookup_t lookup_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, coalesced_{0};
+    sync::wait_group pending_; // destroyed first, waits for lookups
+
+    static auto socket_lookup(const socket::name_t& name, int family, int type, int protocol) -> socket::service {
+        return socket::lookup(name, family, type, protocol);
+    }
+
+    void complete(const key_t& key, bool found) noexcept;
+    void forget(const key_t& key) noexcept;
+    void evict() noexcept;
+};
 } // namespace busuto
@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "ring.hpp"
+
+#include <bit>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace busuto;
+
+namespace {
+constexpr uint64_t ring_magic = 0x62757375746f7231ULL;
+constexpr uint32_t busy = 0, ready = 1, discard = 2;
+constexpr std::size_t control_size = 4096;
+} // end namespace
+
+// Shared state at the start of the mapping. Each index has its own cache
+// line so the reader and writers do not contend for them.
+struct system::shm_ring::control_t {
+    uint64_t magic{ring_magic};
+    uint64_t capacity{0};
+    uint32_t multi{0};
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    alignas(64) std::atomic<uint32_t> lock{0};
+    std::atomic<uint32_t> waiting{0};
+};
+
+// Written under the reservation lock before head moves past it, so the
+// reader never sees a header that is not yet set.
+struct system::shm_ring::header_t {
+    uint32_t state;
+    uint32_t length; // whole record, 16 byte aligned
+    uint32_t size;   // payload
+    uint32_t spare;
+};
+
+system::shm_ring::shm_ring(std::size_t capacity, bool multi) {
+    // shared between processes, so the atomics must not hide a lock
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free);
+    static_assert(sizeof(control_t) <= control_size);
+    capacity_ = std::bit_ceil(std::max(capacity, std::size_t(4096)));
+#ifdef MFD_CLOEXEC
+    auto memfd = ::memfd_create("busuto-ring", MFD_CLOEXEC);
+#else
+    auto memfd = -1;
+    errno = ENOTSUP;
+#endif
+    if (memfd < 0) throw std::system_error(errno, std::generic_category(), "ring memfd");
+    if (::ftruncate(memfd, off_t(control_size + capacity_))) {
+        const auto err = errno;
+        ::close(memfd);
+        throw std::system_error(err, std::generic_category(), "ring size");
+    }
+
+    auto eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventfd < 0) {
+        const auto err = errno;
+        ::close(memfd);
+        throw std::system_error(err, std::generic_category(), "ring eventfd");
+    }
+
+    auto map = ::mmap(nullptr, control_size + capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (map == MAP_FAILED) { // NOLINT
+        const auto err = errno;
+        ::close(memfd);
+        ::close(eventfd);
+        throw std::system_error(err, std::generic_category(), "ring map");
+    }
+
+    control_ = new (map) control_t;
+    control_->capacity = capacity_;
+    control_->multi = multi ? 1 : 0;
+    ring_ = static_cast<std::byte *>(map) + control_size;
+    memfd_ = memfd;
+    eventfd_ = eventfd;
+}
+
+auto system::shm_ring::attach(int memfd, int eventfd) -> shm_ring {
+    struct stat info{};
+    if (::fstat(memfd, &info) || std::size_t(info.st_size) <= control_size)
+        throw std::system_error(EINVAL, std::generic_category(), "ring attach");
+
+    const auto size = std::size_t(info.st_size);
+    auto map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (map == MAP_FAILED) // NOLINT
+        throw std::system_error(errno, std::generic_category(), "ring map");
+
+    auto control = static_cast<control_t *>(map);
+    if (control->magic != ring_magic || control->capacity + control_size != size) {
+        ::munmap(map, size);
+        throw std::system_error(EINVAL, std::generic_category(), "ring attach");
+    }
+
+    shm_ring ring;
+    ring.control_ = control;
+    ring.ring_ = static_cast<std::byte *>(map) + control_size;
+    ring.capacity_ = control->capacity;
+    ring.memfd_ = memfd;
+    ring.eventfd_ = eventfd;
+    return ring;
+}
+
+system::shm_ring::shm_ring(shm_ring&& from) noexcept : control_(std::exchange(from.control_, nullptr)), ring_(std::exchange(from.ring_, nullptr)), capacity_(std::exchange(from.capacity_, 0)), memfd_(std::exchange(from.memfd_, -1)), eventfd_(std::exchange(from.eventfd_, -1)) {}
+
+system::shm_ring::~shm_ring() {
+    if (control_)
+        ::munmap(control_, control_size + capacity_);
+    if (memfd_ > -1) ::close(memfd_);
+    if (eventfd_ > -1) ::close(eventfd_);
+}
+
+auto system::shm_ring::at(uint64_t pos) const noexcept -> header_t * {
+    return reinterpret_cast<header_t *>(ring_ + (pos & (capacity_ - 1)));
+}
+
+auto system::shm_ring::multi() const noexcept -> bool {
+    return control_ && control_->multi;
+}
+
+auto system::shm_ring::used() const noexcept -> std::size_t {
+    if (!control_) return 0;
+    return std::size_t(control_->head.load(std::memory_order_acquire) - control_->tail.load(std::memory_order_acquire));
+}
+
+// A record that would cross the end of the ring is put at the start
+// instead, after a discarded filler, so every record is contiguous.
+auto system::shm_ring::reserve(std::size_t size) noexcept -> reserved_t {
+    const auto length = (sizeof(header_t) + size + 15) & ~std::size_t(15);
+    if (!control_ || length > capacity_ / 2) return {};
+
+    const auto locked = control_->multi != 0;
+    if (locked) {
+        for (unsigned spins = 0; control_->lock.exchange(1, std::memory_order_acquire); ++spins) {
+            if (spins > 64) std::this_thread::yield();
+        }
+    }
+
+    const auto pos = control_->head.load(std::memory_order_relaxed);
+    const auto room = capacity_ - std::size_t(pos & (capacity_ - 1));
+    const auto fill = length > room ? room : 0;
+    if (pos + fill + length - control_->tail.load(std::memory_order_acquire) > capacity_) {
+        if (locked) control_->lock.store(0, std::memory_order_release);
+        return {};
+    }
+
+    if (fill)
+        *at(pos) = {discard, uint32_t(fill), 0, 0};
+    auto header = at(pos + fill);
+    *header = {busy, uint32_t(length), uint32_t(size), 0};
+    control_->head.store(pos + fill + length, std::memory_order_release);
+    if (locked) control_->lock.store(0, std::memory_order_release);
+    return {this, reinterpret_cast<std::byte *>(header + 1), size};
+}
+
+void system::shm_ring::commit(std::byte *data, std::size_t used) noexcept {
+    auto header = reinterpret_cast<header_t *>(data) - 1;
+    header->size = uint32_t(used);
+    std::atomic_ref(header->state).store(ready, std::memory_order_seq_cst);
+    if (control_->waiting.load(std::memory_order_seq_cst)) {
+        uint64_t one = 1;
+        (void)!::write(eventfd_, &one, sizeof(one));
+    }
+}
+
+void system::shm_ring::cancel(std::byte *data) noexcept {
+    auto header = reinterpret_cast<header_t *>(data) - 1;
+    std::atomic_ref(header->state).store(discard, std::memory_order_seq_cst);
+    if (control_->waiting.load(std::memory_order_seq_cst)) {
+        uint64_t one = 1;
+        (void)!::write(eventfd_, &one, sizeof(one));
+    }
+}
+
+// Skips cancelled records and fillers on the way to a committed one.
+auto system::shm_ring::peek() noexcept -> header_t * {
+    if (!control_) return nullptr;
+    for (;;) {
+        const auto pos = control_->tail.load(std::memory_order_relaxed);
+        if (pos == control_->head.load(std::memory_order_acquire)) return nullptr;
+        auto header = at(pos);
+        const auto state = std::atomic_ref(header->state).load(std::memory_order_seq_cst);
+        if (state == busy) return nullptr;
+        if (state == ready) return header;
+        control_->tail.store(pos + header->length, std::memory_order_release);
+    }
+}
+
+auto system::shm_ring::front() noexcept -> std::span<const std::byte> {
+    auto header = peek();
+    if (!header) return {};
+    return {reinterpret_cast<const std::byte *>(header + 1), header->size};
+}
+
+void system::shm_ring::pop() noexcept {
+    auto header = peek();
+    if (header)
+        control_->tail.store(control_->tail.load(std::memory_order_relaxed) + header->length, std::memory_order_release);
+}
+
+auto system::shm_ring::wait(int timeout) noexcept -> bool {
+    if (peek()) return true;
+    if (!control_ || !timeout) return false;
+
+    // a wakeup may be left over from a commit that needed none, so wake
+    // ups are checked against the ring until the deadline
+    const auto deadline = steady_time() + std::chrono::milliseconds(std::max(timeout, 0));
+    control_->waiting.store(1, std::memory_order_seq_cst);
+    auto found = peek() != nullptr;
+    while (!found) {
+        const auto remaining = timeout < 0 ? -1 : get_timeout(deadline);
+        if (!remaining) break;
+        struct pollfd pfd = {.fd = eventfd_, .events = POLLIN};
+        if (::poll(&pfd, 1, remaining) > 0) {
+            uint64_t count{0};
+            (void)!::read(eventfd_, &count, sizeof(count));
+        }
+        found = peek() != nullptr;
+    }
+    control_->waiting.store(0, std::memory_order_relaxed);
+    return found;
+}
+
+auto system::shm_ring::inherit() const noexcept -> bool {
+    if (memfd_ < 0 || eventfd_ < 0) return false;
+    return ::fcntl(memfd_, F_SETFD, 0) == 0 && ::fcntl(eventfd_, F_SETFD, 0) == 0;
+}
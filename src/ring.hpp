@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "system.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace busuto::system {
+// Ring of variable length records in a shared memory file, for passing
+// records between processes without copying them. It is created in one
+// process and reaches others by inheriting its two handles across a fork,
+// or a spawn once inherit has been called, and attaching to them. A writer
+// reserves space in the ring, fills it in place, and commits it, and the
+// one reader takes committed records in order from the front. Several
+// writers may share a multi producer ring. A short lock covers only the
+// reservation, and never the copy into it. A reader asleep in wait is woken
+// through an eventfd, which writers signal only when the reader is waiting.
+class shm_ring final {
+public:
+    class reserved_t final {
+    public:
+        reserved_t() = default;
+        reserved_t(const reserved_t&) = delete;
+        auto operator=(const reserved_t&) -> reserved_t& = delete;
+
+        reserved_t(reserved_t&& from) noexcept : ring_(std::exchange(from.ring_, nullptr)), data_(from.data_), size_(from.size_) {}
+
+        ~reserved_t() { cancel(); }
+
+        auto operator=(reserved_t&& from) noexcept -> reserved_t& {
+            if (this == &from) return *this;
+            cancel();
+            ring_ = std::exchange(from.ring_, nullptr);
+            data_ = from.data_;
+            size_ = from.size_;
+            return *this;
+        }
+
+        explicit operator bool() const noexcept { return ring_ != nullptr; }
+        auto operator!() const noexcept { return ring_ == nullptr; }
+
+        auto data() const noexcept { return data_; }
+        auto size() const noexcept { return size_; }
+        auto span() const noexcept { return std::span<std::byte>(data_, size_); }
+
+        // Publishes the record, which may be shorter than reserved.
+        void commit(std::size_t used = std::size_t(-1)) noexcept {
+            if (ring_) std::exchange(ring_, nullptr)->commit(data_, std::min(used, size_));
+        }
+
+        // Drops the record; the reader skips it.
+        void cancel() noexcept {
+            if (ring_) std::exchange(ring_, nullptr)->cancel(data_);
+        }
+
+    private:
+        friend class shm_ring;
+
+        shm_ring *ring_{nullptr};
+        std::byte *data_{nullptr};
+        std::size_t size_{0};
+
+        reserved_t(shm_ring *ring, std::byte *data, std::size_t size) noexcept : ring_(ring), data_(data), size_(size) {}
+    };
+
+    // Creates a ring holding capacity bytes, rounded up to a power of two.
+    explicit shm_ring(std::size_t capacity, bool multi = false);
+
+    // Attaches to the handles of a ring created by another process, which
+    // the new ring owns.
+    static auto attach(int memfd, int eventfd) -> shm_ring;
+
+    shm_ring(shm_ring&& from) noexcept;
+    shm_ring(const shm_ring&) = delete;
+    auto operator=(const shm_ring&) -> shm_ring& = delete;
+    ~shm_ring();
+
+    explicit operator bool() const noexcept { return control_ != nullptr; }
+    auto operator!() const noexcept { return control_ == nullptr; }
+
+    // Space for a record, or empty if the ring is too full.
+    auto reserve(std::size_t size) noexcept -> reserved_t;
+
+    auto push(const void *data, std::size_t size) noexcept {
+        auto record = reserve(size);
+        if (!record) return false;
+        std::memcpy(record.data(), data, size);
+        record.commit();
+        return true;
+    }
+
+    auto push(std::string_view text) noexcept {
+        return push(text.data(), text.size());
+    }
+
+    // The oldest committed record; only one reader may use these.
+    auto empty() noexcept { return peek() == nullptr; }
+    auto front() noexcept -> std::span<const std::byte>;
+    void pop() noexcept;
+
+    // Waits up to timeout milliseconds, or forever if negative, for a record.
+    auto wait(int timeout = -1) noexcept -> bool;
+
+    // Clears close on exec so the handles survive into a spawned program.
+    auto inherit() const noexcept -> bool;
+
+    auto memfd() const noexcept { return memfd_; }
+    auto handle() const noexcept { return eventfd_; }
+    auto capacity() const noexcept { return capacity_; }
+    auto multi() const noexcept -> bool;
+
+    // Bytes reserved and not yet consumed.
+    auto used() const noexcept -> std::size_t;
+
+private:
+    struct control_t;
+    struct header_t;
+
+    control_t *control_{nullptr};
+    std::byte *ring_{nullptr};
+    std::size_t capacity_{0};
+    int memfd_{-1}, eventfd_{-1};
+
+    shm_ring() = default;
+    auto peek() noexcept -> header_t *;
+    void commit(std::byte *data, std::size_t used) noexcept;
+    void cancel(std::byte *data) noexcept;
+    auto at(uint64_t pos) const noexcept -> header_t *;
+};
+} // namespace busuto::system
@@ -149,6 +149,15 @@ public:
         return *this;
     }
 
+    auto append(std::string_view from) -> stringbuf& {
+        if (from.size() > S - size_) throw range("stringbuf full");
+        if (!from.empty())
+            memcpy(data_ + size_, from.data(), from.size());
+        size_ += from.size();
+        data_[size_] = 0;
+        return *this;
+    }
+
     auto operator+=(char ch) -> stringbuf& {
         if (size_ == S) throw range("stringbuf full");
         data_[size_++] = ch;
@@ -228,10 +237,10 @@ public:
         return data_[size_ - 1];
     }
 
-    constexpr auto begin() const -> char * { return data_; }
-    constexpr auto end() const -> char * { return data_ + size_; }
+    constexpr auto begin() const -> const char * { return data_; }
+    constexpr auto end() const -> const char * { return data_ + size_; }
     constexpr auto data() noexcept -> char * { return data_; }
-    constexpr auto data() const noexcept -> char * { return data_; }
+    constexpr auto data() const noexcept -> const char * { return data_; }
     constexpr auto size() const noexcept { return size_; }
     constexpr auto capacity() const noexcept { return S; }
     constexpr auto empty() const noexcept { return !size_; }
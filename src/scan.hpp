@@ -7,9 +7,18 @@
 
 #include <string_view>
 #include <string>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <cctype>
 #include <cmath>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
 
 namespace busuto::scan {
 constexpr std::string_view hex_digits = "0123456789abcdef";
@@ -105,6 +114,263 @@ constexpr auto get_double(std::string_view& input, std::uint64_t max = 214748364
     }
     return number;
 }
+
+// Result of converting one field of a batch, since a record is parsed
+// without throwing so that one bad field does not lose the rest.
+enum class field_error : uint8_t { none = 0, empty, invalid, range, missing };
+
+// Digits in eight bytes loaded first byte lowest. Each byte is xor'd with
+// '0' so digits become 0 thru 9, and any byte then 10 or more sets its high
+// bit without carrying into the next one.
+inline auto digit_count(uint64_t chunk) noexcept -> unsigned {
+    constexpr uint64_t high = 0x8080808080808080ULL;
+    const auto value = chunk ^ 0x3030303030303030ULL;
+    const auto other = (((value & ~high) + 0x7676767676767676ULL) | value) & high;
+    return unsigned(std::countr_zero(other)) / 8;
+}
+
+// Value of eight digit bytes already xor'd with '0', with the first in the
+// lowest byte, combined pairwise in three multiply steps.
+inline auto digit_lanes(uint64_t value) noexcept -> uint64_t {
+    value = (value * 10 + (value >> 8)) & 0x00ff00ff00ff00ffULL;
+    value = (value * 100 + (value >> 16)) & 0x0000ffff0000ffffULL;
+    return (value * 10000 + (value >> 32)) & 0xffffffffULL;
+}
+
+// Value of the first count digits of a chunk.
+inline auto digit_value(uint64_t chunk, unsigned count) noexcept -> uint64_t {
+    if (!count) return 0;
+    return digit_lanes((chunk ^ 0x3030303030303030ULL) << (8 * (8 - count)));
+}
+
+inline auto load_chunk(const char *text) noexcept -> uint64_t {
+    uint64_t chunk{0};
+    std::memcpy(&chunk, text, sizeof(chunk));
+    if constexpr (std::endian::native == std::endian::big)
+        chunk = __builtin_bswap64(chunk);
+    return chunk;
+}
+
+// Bytes past size are cleared, so they never read as digits. A field may be
+// loaded wide if limit, the end of what may be read, such as the end of its
+// record, leaves room. Otherwise it is gathered a byte at a time.
+inline auto load_chunk(const char *text, std::size_t size, const char *limit) noexcept -> uint64_t {
+    if (size >= sizeof(uint64_t)) return load_chunk(text);
+    if (limit - text >= std::ptrdiff_t(sizeof(uint64_t))) return load_chunk(text) & ((uint64_t(1) << (8 * size)) - 1);
+    uint64_t chunk{0};
+    for (std::size_t pos = 0; pos < size; ++pos)
+        chunk |= uint64_t(static_cast<unsigned char>(text[pos])) << (8 * pos);
+    return chunk;
+}
+
+// Count of digits at the front of text.
+inline auto skip_digits(const char *text, std::size_t size, const char *limit) noexcept {
+    std::size_t pos{0};
+    while (pos < size) {
+        const auto count = digit_count(load_chunk(text + pos, size - pos, limit));
+        pos += count;
+        if (count < 8) break;
+    }
+    return pos;
+}
+
+// Value of text that must be all decimal digits, eight at a time. The last
+// chunk is loaded to end with the text, overlapping digits already taken.
+inline auto get_digits(std::string_view text, uint64_t& result, const char *limit = nullptr) noexcept -> field_error {
+    static constexpr uint64_t scale[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    const auto size = text.size();
+    const auto data = text.data();
+    if (!size) return field_error::empty;
+    if (size < 8) {
+        const auto chunk = load_chunk(data, size, std::max(limit, data + size));
+        if (digit_count(chunk) < size) return field_error::invalid;
+        result = digit_value(chunk, unsigned(size));
+        return field_error::none;
+    }
+
+    uint64_t value{0};
+    std::size_t pos{0};
+    for (; size - pos > 8; pos += 8) {
+        const auto chunk = load_chunk(data + pos);
+        if (digit_count(chunk) < 8) return field_error::invalid;
+        if (__builtin_mul_overflow(value, scale[8], &value) || __builtin_add_overflow(value, digit_lanes(chunk ^ 0x3030303030303030ULL), &value)) return field_error::range;
+    }
+
+    const auto rest = unsigned(size - pos);
+    const auto chunk = load_chunk(data + size - 8);
+    if (digit_count(chunk) < 8) return field_error::invalid;
+    const auto tail = digit_lanes((chunk ^ 0x3030303030303030ULL) & (~uint64_t(0) << (8 * (8 - rest))));
+    if (__builtin_mul_overflow(value, scale[rest], &value) || __builtin_add_overflow(value, tail, &value)) return field_error::range;
+    result = value;
+    return field_error::none;
+}
+
+template <std::unsigned_integral T = unsigned>
+inline auto to_unsigned(std::string_view field, T& out, T max = std::numeric_limits<T>::max(), const char *limit = nullptr) noexcept {
+    uint64_t value{0};
+    const auto error = get_digits(field, value, limit);
+    if (error != field_error::none) return error;
+    if (value > max) return field_error::range;
+    out = T(value);
+    return field_error::none;
+}
+
+template <std::signed_integral T = int>
+inline auto to_integer(std::string_view field, T& out, T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max(), const char *limit = nullptr) noexcept {
+    if (field.empty()) return field_error::empty;
+    const auto negative = field.front() == '-';
+    if (negative || field.front() == '+') field.remove_prefix(1);
+    uint64_t value{0};
+    const auto error = get_digits(field, value, limit);
+    if (error != field_error::none) return error == field_error::empty ? field_error::invalid : error;
+    if (value > uint64_t(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0)) return field_error::range;
+    const auto signed_value = negative ? int64_t(0 - value) : int64_t(value);
+    if (signed_value < int64_t(min) || signed_value > int64_t(max)) return field_error::range;
+    out = T(signed_value);
+    return field_error::none;
+}
+
+template <std::unsigned_integral T = unsigned>
+inline auto to_hex(std::string_view field, T& out) noexcept {
+    consume_prefix(field, "0x");
+    if (field.empty()) return field_error::empty;
+    if (field.size() > sizeof(T) * 2) return field_error::range;
+    const auto value = get_hex(field, unsigned(field.size()));
+    if (!field.empty()) return field_error::invalid;
+    out = T(value);
+    return field_error::none;
+}
+
+// A mantissa of up to nineteen digits that fits a double is scaled exactly
+// by a power of ten. Anything else is left to from_chars, which also
+// rounds correctly, but is slower to start.
+template <std::floating_point T = double>
+inline auto to_decimal(std::string_view field, T& out, const char *limit = nullptr) noexcept {
+    static constexpr double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    static constexpr uint64_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000, 10000000000, 100000000000, 1000000000000, 10000000000000, 100000000000000, 1000000000000000, 10000000000000000, 100000000000000000, 1000000000000000000, 10000000000000000000ULL};
+    if (field.empty()) return field_error::empty;
+    const auto negative = field.front() == '-';
+    if (negative || field.front() == '+') field.remove_prefix(1);
+    const auto data = field.data();
+    const auto size = field.size();
+    limit = std::max(limit, data + size);
+
+    const auto whole = skip_digits(data, size, limit);
+    std::size_t fraction{0}, pos{whole};
+    if (pos < size && data[pos] == '.') {
+        fraction = skip_digits(data + pos + 1, size - pos - 1, limit);
+        pos += fraction + 1;
+    }
+    if (!whole && !fraction) return field_error::invalid;
+
+    int exponent{0};
+    if (pos < size) {
+        if ((data[pos] | 0x20) != 'e') return field_error::invalid;
+        auto power = field.substr(pos + 1);
+        const auto minus = !power.empty() && power.front() == '-';
+        if (minus || (!power.empty() && power.front() == '+')) power.remove_prefix(1);
+        uint64_t value{0};
+        const auto error = get_digits(power, value, limit);
+        if (error != field_error::none) return error == field_error::range ? error : field_error::invalid;
+        if (value > 9999) return field_error::range;
+        exponent = minus ? -int(value) : int(value);
+    }
+
+    uint64_t upper{0}, lower{0};
+    if (whole) get_digits(field.substr(0, whole), upper, limit);
+    if (fraction) get_digits(field.substr(whole + 1, fraction), lower, limit);
+    exponent -= int(fraction);
+
+    double value{0};
+    const auto mantissa = upper * powers[std::min(fraction, std::size_t(19))] + lower;
+    if (whole + fraction <= 19 && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+        value = exponent < 0 ? double(mantissa) / scale[-exponent] : double(mantissa) * scale[exponent];
+    else {
+        const auto [end, err] = std::from_chars(data, data + size, value);
+        if (err == std::errc::result_out_of_range) return field_error::range;
+        if (err != std::errc() || end != data + size) return field_error::invalid;
+    }
+    if (std::isinf(value) || std::isinf(T(value))) return field_error::range;
+    out = T(negative ? -value : value);
+    return field_error::none;
+}
+
+inline auto to_bool(std::string_view field, bool& out) noexcept {
+    if (field.empty()) return field_error::empty;
+    if (field.size() > 5) return field_error::invalid;
+    char text[5]{};
+    for (std::size_t pos = 0; pos < field.size(); ++pos)
+        text[pos] = char(std::tolower(static_cast<unsigned char>(field[pos])));
+    const std::string_view lower(text, field.size());
+    if (lower == "true" || lower == "yes" || lower == "on" || lower == "t" || lower == "y") {
+        out = true;
+        return field_error::none;
+    }
+    if (lower == "false" || lower == "no" || lower == "off" || lower == "f" || lower == "n") {
+        out = false;
+        return field_error::none;
+    }
+    return field_error::invalid;
+}
+
+// Converts one field by the type of its target. Views refer into the
+// record, so they are only valid as long as it is. Numbers may be read in
+// chunks up to limit, when the field is part of a larger buffer.
+template <typename T>
+inline auto to_field(std::string_view field, T& out, const char *limit = nullptr) noexcept -> field_error {
+    if constexpr (std::is_same_v<T, bool>)
+        return to_bool(field, out);
+    else if constexpr (std::unsigned_integral<T>)
+        return to_unsigned(field, out, std::numeric_limits<T>::max(), limit);
+    else if constexpr (std::signed_integral<T>)
+        return to_integer(field, out, std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), limit);
+    else if constexpr (std::floating_point<T>)
+        return to_decimal(field, out, limit);
+    else if constexpr (std::is_same_v<T, std::string_view>) {
+        out = field;
+        return field_error::none;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        try {
+            out.assign(field);
+        } catch (...) {
+            return field_error::range;
+        }
+        return field_error::none;
+    } else
+        static_assert(sizeof(T) == 0, "unsupported field type");
+}
+
+// Outcome of a batch, with an error for each target field, and how many
+// fields the record actually held, which may be more than were wanted.
+template <std::size_t N>
+struct fields_t {
+    std::array<field_error, N> errors{};
+    std::size_t count{0};
+
+    explicit operator bool() const noexcept { return failed() == N; }
+    auto operator!() const noexcept { return failed() != N; }
+    auto operator[](std::size_t index) const noexcept { return errors[index]; }
+
+    // Index of the first field in error, or N if there were none.
+    auto failed() const noexcept -> std::size_t {
+        for (std::size_t pos = 0; pos < N; ++pos) {
+            if (errors[pos] != field_error::none) return pos;
+        }
+        return N;
+    }
+};
+
+// Takes the next field from the front of a record, and clears more after
+// the last one.
+inline auto next_field(std::string_view& record, char delim, bool& more) noexcept {
+    const auto end = static_cast<const char *>(std::memchr(record.data(), delim, record.size()));
+    more = end != nullptr;
+    if (!end) return std::exchange(record, std::string_view{});
+    const auto size = std::size_t(end - record.data());
+    const auto field = record.substr(0, size);
+    record.remove_prefix(size + 1);
+    return field;
+}
 } // namespace busuto::scan
 
 namespace busuto {
@@ -247,4 +513,68 @@ inline auto parse_bool(std::string_view input) -> bool {
     if (text == "n") return false;
     throw invalid("Invalid bool value");
 }
+
+// Splits a delimited record and converts each field into the matching
+// target in one pass. Targets past the end of the record are missing and
+// left unchanged.
+template <typename... Ts>
+inline auto parse_record(std::string_view record, char delim, Ts&... out) noexcept {
+    scan::fields_t<sizeof...(Ts)> result;
+    const auto limit = record.data() + record.size();
+    auto more = !record.empty();
+    std::size_t index{0};
+    auto next = [&](auto& target) {
+        if (!more) {
+            result.errors[index++] = scan::field_error::missing;
+            return;
+        }
+        result.errors[index++] = scan::to_field(scan::next_field(record, delim, more), target, limit);
+        ++result.count;
+    };
+    (next(out), ...);
+    while (more) {
+        scan::next_field(record, delim, more);
+        ++result.count;
+    }
+    return result;
+}
+
+// A tuple of targets, such as std::tie of the members of a struct.
+template <typename... Ts>
+inline auto parse_record(std::string_view record, char delim, std::tuple<Ts...>&& out) noexcept {
+    return std::apply([&](auto&... targets) { return parse_record(record, delim, targets...); }, out);
+}
+
+template <typename... Ts>
+inline auto parse_record(std::string_view record, char delim, std::tuple<Ts...>& out) noexcept {
+    return std::apply([&](auto&... targets) { return parse_record(record, delim, targets...); }, out);
+}
+
+// Fields already split, such as from split_view.
+template <typename... Ts>
+inline auto parse_fields(std::span<const std::string_view> fields, Ts&... out) noexcept {
+    scan::fields_t<sizeof...(Ts)> result;
+    result.count = fields.size();
+    std::size_t index{0};
+    auto next = [&](auto& target) {
+        result.errors[index] = index < fields.size() ? scan::to_field(fields[index], target) : scan::field_error::missing;
+        ++index;
+    };
+    (next(out), ...);
+    return result;
+}
+
+// One column of many records at once, with an error per value. Returns
+// how many converted.
+template <typename T>
+inline auto parse_column(std::span<const std::string_view> fields, std::span<T> out, std::span<scan::field_error> errors = {}) noexcept {
+    const auto count = std::min(fields.size(), out.size());
+    std::size_t good{0};
+    for (std::size_t pos = 0; pos < count; ++pos) {
+        const auto error = scan::to_field(fields[pos], out[pos]);
+        if (pos < errors.size()) errors[pos] = error;
+        if (error == scan::field_error::none) ++good;
+    }
+    return good;
+}
 } // namespace busuto
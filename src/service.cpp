@@ -7,6 +7,9 @@
 #include <sys/ioctl.h>
 #endif
 
+#include <bit>
+#include <iostream>
+#include <limits>
 #include <fcntl.h>
 
 using namespace busuto;
@@ -16,6 +19,282 @@ busuto::service::logger busuto::system_logger;
 busuto::service::timer busuto::system_timer;
 busuto::service::pool busuto::system_pool;
 
+namespace {
+constexpr auto never = std::numeric_limits<uint64_t>::max();
+
+// First set bit at or after from in a slot occupancy bitmap, or -1.
+auto scan_slots(const uint64_t *map, unsigned from, unsigned slots) noexcept -> int {
+    for (auto word = from / 64; word < slots / 64; ++word) {
+        auto bits = map[word];
+        if (word == from / 64)
+            bits &= ~uint64_t{0} << (from % 64);
+        if (bits) return int(word * 64 + unsigned(std::countr_zero(bits)));
+    }
+    return -1;
+}
+} // namespace
+
+auto service::timer_wheel::arm(entry_t&& entry) -> entry_t& {
+    node_t *node = free_;
+    if (node)
+        free_ = node->next;
+    else
+        node = &nodes_.emplace_back();
+
+    static_cast<entry_t&>(*node) = std::move(entry);
+    index_[node->id] = node;
+    place(node);
+    return *node;
+}
+
+void service::timer_wheel::rearm(entry_t& entry, const timepoint_t& expires) noexcept {
+    auto node = static_cast<node_t *>(&entry);
+    unlink(node);
+    node->expires = expires;
+    place(node);
+}
+
+void service::timer_wheel::erase(entry_t& entry) noexcept {
+    auto node = static_cast<node_t *>(&entry);
+    unlink(node);
+    index_.erase(node->id);
+    node->task = nullptr;
+    node->where = unused;
+    node->next = std::exchange(free_, node);
+}
+
+auto service::timer_wheel::expired(const timepoint_t& now) noexcept -> entry_t * {
+    if (!ready_ && now > base_)
+        advance(uint64_t(std::chrono::floor<std::chrono::milliseconds>(now - base_).count()));
+    return ready_;
+}
+
+auto service::timer_wheel::wakeup() const noexcept -> timepoint_t {
+    if (ready_) return base_;
+    const auto tick = next_tick();
+    if (tick == never) return timepoint_t::max();
+    return base_ + std::chrono::milliseconds(tick);
+}
+
+void service::timer_wheel::clear() noexcept {
+    for (auto& level : wheel_)
+        std::ranges::fill(level, nullptr);
+    for (auto& level : occupied_)
+        std::ranges::fill(level, 0);
+    ready_ = overflow_ = free_ = nullptr;
+    index_.clear();
+    nodes_.clear();
+}
+
+auto service::timer_wheel::head(int where) noexcept -> node_t *& {
+    if (where == ready) return ready_;
+    if (where == overflow) return overflow_;
+    return wheel_[unsigned(where) / slots][unsigned(where) % slots];
+}
+
+// Next tick worth visiting: a due slot, or a level boundary to cascade.
+auto service::timer_wheel::next_tick() const noexcept -> uint64_t {
+    for (unsigned level = 0; level < levels; ++level) {
+        const auto shift = bits * level;
+        const auto current = unsigned(now_ >> shift) & (slots - 1);
+        if (current + 1 >= slots) continue;
+        const auto slot = scan_slots(occupied_[level], current + 1, slots);
+        if (slot < 0) continue;
+        return ((now_ >> (shift + bits)) << (shift + bits)) | (uint64_t(slot) << shift);
+    }
+
+    if (overflow_) return ((now_ >> (bits * levels)) + 1) << (bits * levels);
+    return never;
+}
+
+void service::timer_wheel::link(node_t *node, int where) noexcept {
+    auto& list = head(where);
+    node->where = where;
+    node->prev = nullptr;
+    node->next = list;
+    if (list)
+        list->prev = node;
+    list = node;
+    if (where >= 0)
+        occupied_[unsigned(where) / slots][(unsigned(where) % slots) / 64] |= uint64_t{1} << (unsigned(where) % 64);
+}
+
+void service::timer_wheel::unlink(node_t *node) noexcept {
+    auto& list = head(node->where);
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        list = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+    if (!list && node->where >= 0)
+        occupied_[unsigned(node->where) / slots][(unsigned(node->where) % slots) / 64] &= ~(uint64_t{1} << (unsigned(node->where) % 64));
+    node->prev = node->next = nullptr;
+}
+
+// An entry lives on the finest level whose higher bits match the current
+// tick, so a slot is always ahead of the level's current position.
+void service::timer_wheel::place(node_t *node) noexcept {
+    const auto delta = node->expires - base_;
+    const auto tick = delta.count() > 0 ? uint64_t(std::chrono::ceil<std::chrono::milliseconds>(delta).count()) : 0;
+    if (tick <= now_) {
+        link(node, ready);
+        return;
+    }
+
+    for (unsigned level = 0; level < levels; ++level) {
+        const auto shift = bits * (level + 1);
+        if ((tick >> shift) != (now_ >> shift)) continue;
+        link(node, int(level * slots + (unsigned(tick >> (bits * level)) & (slots - 1))));
+        return;
+    }
+    link(node, overflow);
+}
+
+void service::timer_wheel::replace(node_t *list) noexcept {
+    while (list) {
+        auto next = list->next;
+        list->prev = list->next = nullptr;
+        place(list);
+        list = next;
+    }
+}
+
+void service::timer_wheel::advance(uint64_t target) noexcept {
+    while (now_ < target) {
+        const auto tick = next_tick();
+        if (tick > target) {
+            now_ = target;
+            return;
+        }
+
+        now_ = tick;
+        if (overflow_ && !(now_ & ((uint64_t{1} << (bits * levels)) - 1)))
+            replace(std::exchange(overflow_, nullptr));
+
+        // cascade coarser levels first, since they may refill finer ones
+        for (auto level = levels - 1; level > 0; --level) {
+            if (now_ & ((uint64_t{1} << (bits * level)) - 1)) continue;
+            const auto slot = unsigned(now_ >> (bits * level)) & (slots - 1);
+            const auto where = int(level * slots + slot);
+            auto list = std::exchange(head(where), nullptr);
+            occupied_[level][slot / 64] &= ~(uint64_t{1} << (slot % 64));
+            replace(list);
+        }
+
+        const auto slot = unsigned(now_) & (slots - 1);
+        auto list = std::exchange(wheel_[0][slot], nullptr);
+        occupied_[0][slot / 64] &= ~(uint64_t{1} << (slot % 64));
+        while (list) {
+            auto next = list->next;
+            link(list, ready);
+            list = next;
+        }
+    }
+}
+
+service::logger::~logger() {
+    stop();
+}
+
+void service::logger::start(overflow_t policy) {
+    if (async_.load()) return;
+    if (!ring_)
+        ring_ = std::make_unique<ring_t>();
+    policy_ = policy;
+    stopping_.store(false);
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&logger::write, this);
+    async_.store(true, std::memory_order_release);
+}
+
+// Drains everything queued before returning to synchronous logging. Posts
+// already past their check of async_ are waited for, so the writer still
+// takes them, and a post blocked on a full ring is never left behind.
+void service::logger::stop() {
+    if (!async_.exchange(false)) return;
+    while (posters_.load() > 0)
+        std::this_thread::yield();
+    stopping_.store(true);
+    wakeup_.fetch_add(1, std::memory_order_release);
+    wakeup_.notify_one();
+    if (writer_.joinable())
+        writer_.join();
+}
+
+void service::logger::flush() noexcept {
+    const auto target = posted_.load(std::memory_order_acquire);
+    for (auto done = written_.load(std::memory_order_acquire); done < target && running_.load(std::memory_order_acquire); done = written_.load(std::memory_order_acquire))
+        written_.wait(done);
+}
+
+auto service::logger::post(unsigned level, int type, const char *prefix, std::string_view text, bool fatal) noexcept -> bool {
+    posters_.fetch_add(1);
+    if (!async_.load()) {
+        posters_.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    while (!ring_->emplace(level, type, prefix, text)) {
+        if (policy_ == overflow_t::drop && !fatal) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            posters_.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+        wakeup_.fetch_add(1, std::memory_order_release);
+        wakeup_.notify_one();
+        std::this_thread::yield();
+    }
+
+    posted_.fetch_add(1, std::memory_order_release);
+    wakeup_.fetch_add(1, std::memory_order_release);
+    wakeup_.notify_one();
+    posters_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// Writer thread: takes records a batch at a time, so stderr gets one write
+// per batch rather than one locked, flushed write per record.
+void service::logger::write() noexcept {
+    auto batch = std::make_unique<record_t[]>(BUSUTO_LOG_BATCH);
+    std::string out;
+    for (;;) {
+        const auto seq = wakeup_.load(std::memory_order_acquire);
+        const auto count = ring_->pop_n(batch.get(), BUSUTO_LOG_BATCH);
+        if (!count) {
+            if (stopping_.load()) break;
+            wakeup_.wait(seq, std::memory_order_acquire);
+            continue;
+        }
+
+        out.clear();
+        try {
+            const std::lock_guard lock(locker_);
+            for (std::size_t pos = 0; pos < count; ++pos) {
+                const auto& record = batch[pos];
+                const std::string_view text(record.text, record.size);
+#ifdef USE_SYSLOG
+                if (opened_)
+                    ::syslog(record.type, "%.*s", int(text.size()), text.data());
+#endif
+                notify_(std::string(text), record.prefix);
+                if (verbose_ < record.level) continue;
+                out += record.prefix;
+                out += ": ";
+                out += text;
+                out += '\n';
+            }
+            if (!out.empty())
+                std::cerr.write(out.data(), std::streamsize(out.size())).flush();
+        } catch (...) { // NOLINT
+        }
+
+        written_.fetch_add(count, std::memory_order_release);
+        written_.notify_all();
+    }
+    running_.store(false, std::memory_order_release);
+}
+
 auto busuto::is_service() noexcept -> bool {
     return getpid() == 1 || getppid() == 1 || getuid() == 0;
 }
@@ -6,13 +6,19 @@
 #include "threads.hpp"
 #include "system.hpp"
 #include "output.hpp"
+#include "function.hpp"
+#include "atomic.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 
 #include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <deque>
 #include <map>
 #include <queue>
 #include <ranges>
+#include <unordered_map>
 
 #if __has_include(<syslog.h>)
 #define USE_SYSLOG
@@ -37,15 +43,47 @@ constexpr auto LOG_PID = 0;
 #endif
 #endif
 
+#ifndef BUSUTO_LOG_RECORD
+#define BUSUTO_LOG_RECORD 480 // NOLINT
+#endif
+
+#ifndef BUSUTO_LOG_QUEUE
+#define BUSUTO_LOG_QUEUE 1024 // NOLINT
+#endif
+
+#ifndef BUSUTO_LOG_BATCH
+#define BUSUTO_LOG_BATCH 64 // NOLINT
+#endif
+
 namespace busuto::service {
 using notify_t = void (*)(const std::string&, const char *type);
 using error_t = void (*)(const std::exception&);
-using task_t = std::function<void()>;
+using task_t = util::inplace_function<void(), BUSUTO_TASK_SIZE>;
+
+// A queued task and when it was queued, for wait time metrics.
+struct job_t {
+    task_t task;
+    [[no_unique_address]] metrics::stamp_t queued{metrics::stamp()};
+};
 
+// Task queue served by one thread. Tasks can be posted to weighted lanes,
+// which are served by smooth weighted round robin so that no lane starves,
+// and may carry a deadline or a coalescing key. A task still queued at its
+// deadline is dropped, or given to the expired handler. A task posted with
+// the key of one still queued replaces it, keeping its place in line.
 class tasks {
 public:
     using timeout_strategy = std::function<std::chrono::milliseconds()>;
     using shutdown_strategy = std::function<void()>;
+    using expired_strategy = std::function<void(task_t&)>;
+    using timepoint_t = std::chrono::steady_clock::time_point;
+
+    struct post_t {
+        unsigned lane{0};
+        timepoint_t deadline{timepoint_t::max()};
+        uint64_t key{0};     // 0 never coalesces
+        std::size_t max{0};  // limit for the lane, 0 for none
+    };
 
     explicit tasks(timeout_strategy timeout = &default_timeout, shutdown_strategy shutdown = []() {}) noexcept : timeout_(std::move(timeout)), shutdown_(std::move(shutdown)) {}
 
@@ -69,17 +107,37 @@ public:
     auto priority(task_t task) {
         std::unique_lock lock(mutex_);
         if (!running_) return false;
-        tasks_.push_front(std::move(task));
+        lanes_.front().items.push_front({{std::move(task)}});
+        ++pending_;
+        metrics_.dispatched(0);
         lock.unlock();
         cvar_.notify_one();
         return true;
     }
 
     auto dispatch(task_t task, std::size_t max = 0) {
+        return post(std::move(task), {.max = max});
+    }
+
+    auto post(task_t task, const post_t& options) -> bool {
         const std::lock_guard lock(mutex_);
         if (!running_) return false;
-        if (max && tasks_.size() >= max) return false;
-        tasks_.push_back(std::move(task));
+        if (options.key) {
+            auto it = keys_.find(options.key);
+            if (it != keys_.end()) {
+                it->second->job.task = std::move(task);
+                it->second->deadline = options.deadline;
+                ++coalesced_;
+                return true;
+            }
+        }
+
+        auto& lane = lanes_[std::min(std::size_t(options.lane), lanes_.size() - 1)];
+        if (options.max && lane.items.size() >= options.max) return false;
+        auto& item = lane.items.emplace_back(job_t{std::move(task)}, options.deadline, options.key);
+        if (options.key) keys_[options.key] = &item;
+        ++pending_;
+        metrics_.dispatched(0);
         cvar_.notify_one();
         return true;
     }
@@ -128,20 +186,56 @@ public:
         return *this;
     }
 
+    auto expired(expired_strategy handler) -> auto& {
+        const std::lock_guard lock(mutex_);
+        if (running_) throw std::runtime_error("cannot modify running task queue");
+        expired_ = std::move(handler);
+        return *this;
+    }
+
+    // Lane weights, lane 0 first; a lane with weight w is picked w times
+    // for each time a lane of weight 1 is when both have work.
+    auto lanes(std::initializer_list<unsigned> weights) -> auto& {
+        const std::lock_guard lock(mutex_);
+        if (running_) throw std::runtime_error("cannot modify running task queue");
+        if (pending_) throw std::runtime_error("cannot change lanes of queued tasks");
+        lanes_.clear();
+        for (auto weight : weights)
+            lanes_.emplace_back().weight = std::max(weight, 1U);
+        if (lanes_.empty())
+            lanes_.emplace_back();
+        return *this;
+    }
+
+    auto placement(thread::placement_t where) -> auto& {
+        const std::lock_guard lock(mutex_);
+        if (running_) throw std::runtime_error("cannot modify running task queue");
+        placement_ = std::move(where);
+        return *this;
+    }
+
     void clear() noexcept {
         const std::lock_guard lock(mutex_);
-        tasks_.clear();
+        for (auto& lane : lanes_)
+            lane.items.clear();
+        keys_.clear();
+        pending_ = 0;
     }
 
     auto empty() const noexcept {
         const std::lock_guard lock(mutex_);
         if (!running_) return true;
-        return tasks_.empty();
+        return !pending_;
     }
 
     auto size() const noexcept {
         const std::lock_guard lock(mutex_);
-        return tasks_.size();
+        return pending_;
+    }
+
+    auto size(unsigned lane) const noexcept -> std::size_t {
+        const std::lock_guard lock(mutex_);
+        return lane < lanes_.size() ? lanes_[lane].items.size() : 0;
     }
 
     auto active() const noexcept {
@@ -149,38 +243,107 @@ public:
         return running_;
     }
 
+    // Tasks replaced by a later one with the same key.
+    auto coalesced() const noexcept {
+        const std::lock_guard lock(mutex_);
+        return coalesced_;
+    }
+
+    // Tasks that reached their deadline while queued.
+    auto expired() const noexcept {
+        const std::lock_guard lock(mutex_);
+        return expired_count_;
+    }
+
+    auto metrics() const noexcept {
+        return metrics_.snapshot();
+    }
+
 protected:
+    struct item_t {
+        job_t job;
+        timepoint_t deadline{timepoint_t::max()};
+        uint64_t key{0};
+    };
+
+    struct lane_t {
+        std::deque<item_t> items;
+        unsigned weight{1};
+        int64_t current{0};
+    };
+
     timeout_strategy timeout_{default_timeout};
     shutdown_strategy shutdown_{[]() {}};
     error_t errors_{[](const std::exception& e) {}};
-    std::deque<task_t> tasks_;
+    expired_strategy expired_;
+    std::deque<lane_t> lanes_ = std::deque<lane_t>(1);
+    std::unordered_map<uint64_t, item_t *> keys_;
+    std::size_t pending_{0};
+    uint64_t coalesced_{0}, expired_count_{0};
+    metrics::task_metrics metrics_{1};
     mutable std::mutex mutex_;
     std::condition_variable cvar_;
     std::thread thread_;
+    thread::placement_t placement_;
     volatile bool running_{false};
 
     static auto default_timeout() -> std::chrono::milliseconds {
         return std::chrono::minutes(1);
     }
 
+    // Smooth weighted round robin over the lanes that have work.
+    auto select() noexcept -> lane_t& {
+        if (lanes_.size() == 1) return lanes_.front();
+        lane_t *best{nullptr};
+        int64_t total{0};
+        for (auto& lane : lanes_) {
+            if (lane.items.empty()) continue;
+            lane.current += lane.weight;
+            total += lane.weight;
+            if (!best || lane.current > best->current) best = &lane;
+        }
+        best->current -= total;
+        return *best;
+    }
+
     void process() noexcept {
+        placement_.apply();
         for (;;) {
             std::unique_lock lock(mutex_);
             if (!running_) break;
-            if (tasks_.empty())
+            if (!pending_)
                 cvar_.wait_for(lock, timeout_());
 
-            if (tasks_.empty()) continue;
-            try {
-                auto func(std::move(tasks_.front()));
-                tasks_.pop_front();
+            if (!pending_) continue;
+            auto& lane = select();
+            auto item(std::move(lane.items.front()));
+            lane.items.pop_front();
+            if (item.key) keys_.erase(item.key);
+            --pending_;
 
-                // unlock before running task
+            if (item.deadline != timepoint_t::max() && std::chrono::steady_clock::now() > item.deadline) {
+                ++expired_count_;
                 lock.unlock();
-                func();
+                metrics_.finished(0, metrics_.started(0, item.job.queued));
+                if (!expired_) continue;
+                try {
+                    expired_(item.job.task);
+                } catch (const std::exception& e) {
+                    errors_(e);
+                }
+                continue;
+            }
+
+            // unlock before running task
+            lock.unlock();
+            const auto started = metrics_.started(0, item.job.queued);
+            try {
+                BUSUTO_TRACE_SPAN("task", "tasks");
+                item.job.task();
             } catch (const std::exception& e) {
                 errors_(e);
             }
+            metrics_.finished(0, started);
         }
 
         // run shutdown strategy in this context before joining...
@@ -188,9 +351,128 @@ protected:
     }
 };
 
-class timer {
+using timer_id = uint64_t;
+using timer_clock = std::chrono::steady_clock;
+
+struct timer_entry {
+    timer_id id{0};
+    std::chrono::milliseconds period{0};
+    timer_clock::time_point expires;
+    task_t task;
+};
+
+// Ordered tree timer backend with exact expiry and O(log n) arming.
+class timer_tree final {
 public:
-    using id_t = uint64_t;
+    using entry_t = timer_entry;
+    using timepoint_t = timer_clock::time_point;
+
+    auto arm(entry_t&& entry) -> entry_t& {
+        const auto id = entry.id;
+        auto it = timers_.emplace(entry.expires, std::move(entry));
+        index_[id] = it;
+        return it->second;
+    }
+
+    auto find(timer_id id) noexcept -> entry_t * {
+        auto it = index_.find(id);
+        return it == index_.end() ? nullptr : &it->second->second;
+    }
+
+    void rearm(entry_t& entry, const timepoint_t& expires) {
+        auto& pos = index_.at(entry.id);
+        auto node = timers_.extract(pos);
+        node.key() = expires;
+        node.mapped().expires = expires;
+        pos = timers_.insert(std::move(node));
+    }
+
+    void erase(entry_t& entry) {
+        auto it = index_.find(entry.id);
+        timers_.erase(it->second);
+        index_.erase(it);
+    }
+
+    auto expired(const timepoint_t& now) noexcept -> entry_t * {
+        if (timers_.empty() || timers_.begin()->first > now) return nullptr;
+        return &timers_.begin()->second;
+    }
+
+    auto wakeup() const noexcept {
+        return timers_.empty() ? timepoint_t::max() : timers_.begin()->first;
+    }
+
+    void clear() noexcept {
+        index_.clear();
+        timers_.clear();
+    }
+
+    auto size() const noexcept { return index_.size(); }
+    auto empty() const noexcept { return index_.empty(); }
+
+private:
+    using map_t = std::multimap<timepoint_t, entry_t>;
+    map_t timers_;
+    std::unordered_map<timer_id, map_t::iterator> index_;
+};
+
+// Hashed hierarchical timing wheel with millisecond ticks. Arm, re-arm and
+// cancel are O(1); entries only move when a coarser wheel level rolls over
+// into the one below it. Expiry is rounded up to the next tick.
+class timer_wheel final {
+public:
+    using entry_t = timer_entry;
+    using timepoint_t = timer_clock::time_point;
+
+    timer_wheel() noexcept = default;
+    timer_wheel(const timer_wheel&) = delete;
+    auto operator=(const timer_wheel&) -> auto& = delete;
+
+    auto arm(entry_t&& entry) -> entry_t&;
+    void rearm(entry_t& entry, const timepoint_t& expires) noexcept;
+    void erase(entry_t& entry) noexcept;
+    auto expired(const timepoint_t& now) noexcept -> entry_t *;
+    auto wakeup() const noexcept -> timepoint_t;
+    void clear() noexcept;
+
+    auto find(timer_id id) noexcept -> entry_t * {
+        auto it = index_.find(id);
+        return it == index_.end() ? nullptr : it->second;
+    }
+
+    auto size() const noexcept { return index_.size(); }
+    auto empty() const noexcept { return index_.empty(); }
+
+private:
+    static constexpr unsigned bits = 8, slots = 1U << bits, levels = 4;
+    static constexpr int ready = -1, overflow = -2, unused = -3;
+
+    struct node_t : entry_t {
+        node_t *prev{nullptr}, *next{nullptr};
+        int where{unused};
+    };
+
+    timepoint_t base_{timer_clock::now()};
+    uint64_t now_{0};
+    node_t *wheel_[levels][slots]{};
+    uint64_t occupied_[levels][slots / 64]{};
+    node_t *ready_{nullptr}, *overflow_{nullptr}, *free_{nullptr};
+    std::deque<node_t> nodes_;
+    std::unordered_map<timer_id, node_t *> index_;
+
+    auto head(int where) noexcept -> node_t *&;
+    auto next_tick() const noexcept -> uint64_t;
+    void link(node_t *node, int where) noexcept;
+    void unlink(node_t *node) noexcept;
+    void place(node_t *node) noexcept;
+    void replace(node_t *list) noexcept;
+    void advance(uint64_t target) noexcept;
+};
+
+template <typename Queue>
+class basic_timer {
+public:
+    using id_t = timer_id;
     using period_t = std::chrono::milliseconds;
     using timepoint_t = std::chrono::steady_clock::time_point;
 
@@ -200,12 +482,12 @@ public:
     static constexpr period_t hour = minute * 60;
     static constexpr period_t day = hour * 24;
 
-    explicit timer(error_t handler = [](const std::exception& e) {}) noexcept : errors_(std::move(handler)) {}
+    explicit basic_timer(error_t handler = [](const std::exception& e) {}) noexcept : errors_(std::move(handler)) {}
 
-    timer(const timer&) = delete;
-    auto operator=(const timer&) -> auto& = delete;
+    basic_timer(const basic_timer&) = delete;
+    auto operator=(const basic_timer&) -> auto& = delete;
 
-    ~timer() {
+    ~basic_timer() {
         shutdown();
     }
 
@@ -217,10 +499,16 @@ public:
         return stop_.load();
     }
 
+    auto placement(thread::placement_t where) -> auto& {
+        if (thread_.joinable()) throw std::runtime_error("cannot modify running timer");
+        placement_ = std::move(where);
+        return *this;
+    }
+
     void startup(task_t init = [] {}) noexcept {
         if (!thread_.joinable()) {
-            startup_ = init;
-            thread_ = std::thread(&timer::run, this);
+            startup_ = std::move(init);
+            thread_ = std::thread(&basic_timer::run, this);
         }
     }
 
@@ -235,11 +523,7 @@ public:
     }
 
     auto at(const timepoint_t& expires, task_t task) {
-        const std::lock_guard lock(lock_);
-        const auto id = next_++;
-        timers_.emplace(expires, std::make_tuple(id, period_t(0), task));
-        cond_.notify_all();
-        return id;
+        return arm(expires, zero, std::move(task));
     }
 
     auto at(time_t expires, task_t task) {
@@ -252,53 +536,34 @@ public:
     }
 
     auto once(const period_t period, task_t task) {
-        const auto expires = std::chrono::steady_clock::now() + period;
-        const std::lock_guard lock(lock_);
-        const auto id = next_++;
-        timers_.emplace(expires, std::make_tuple(id, period_t(0), task));
-        cond_.notify_all();
-        return id;
+        return arm(std::chrono::steady_clock::now() + period, zero, std::move(task));
     }
 
     auto once(uint32_t period, task_t task) {
-        return once(std::chrono::milliseconds(period), task);
+        return once(std::chrono::milliseconds(period), std::move(task));
     }
 
     auto periodic(uint32_t period, task_t task, uint32_t shorten = 0U) {
         const auto expires = std::chrono::steady_clock::now() + std::chrono::milliseconds(period - shorten);
-        const std::lock_guard lock(lock_);
-        const auto id = next_++;
-        timers_.emplace(expires, std::make_tuple(id, period, task));
-        cond_.notify_all();
-        return id;
+        return arm(expires, period_t(period), std::move(task));
     }
 
     auto periodic(const period_t& period, task_t task, const period_t& shorten = zero) {
-        const auto expires = std::chrono::steady_clock::now() + period - shorten;
-        const std::lock_guard lock(lock_);
-        const auto id = next_++;
-        timers_.emplace(expires, std::make_tuple(id, period, task));
-        cond_.notify_all();
-        return id;
+        return arm(std::chrono::steady_clock::now() + period - shorten, period, std::move(task));
     }
 
     auto repeats(id_t tid) const {
         const std::lock_guard lock(lock_);
-        auto match = std::ranges::find_if(timers_, [&](const auto& pair) {
-            const auto& [id, period, task] = pair.second;
-            return id == tid;
-        });
-        return (match != timers_.end()) ? std::get<1>(match->second) : zero;
+        auto entry = const_cast<Queue&>(timers_).find(tid);
+        return entry ? entry->period : zero;
     }
 
     auto repeats(id_t tid, const period_t& period) {
         const std::lock_guard lock(lock_);
-        for (auto& it : timers_) {
-            if (std::get<0>(it.second) != tid) continue;
-            std::get<1>(it.second) = period;
-            return true;
-        }
-        return false;
+        auto entry = timers_.find(tid);
+        if (!entry) return false;
+        entry->period = period;
+        return true;
     }
 
     auto finish(id_t tid) {
@@ -307,29 +572,22 @@ public:
 
     auto cancel(id_t tid) {
         const std::lock_guard lock(lock_);
-        for (auto it = timers_.begin(); it != timers_.end(); ++it) {
-            if (std::get<0>(it->second) == tid) {
-                timers_.erase(it);
-                cond_.notify_all();
-                return true;
-            }
-        }
-        return false;
+        auto entry = timers_.find(tid);
+        if (!entry) return false;
+        timers_.erase(*entry);
+        cond_.notify_all();
+        return true;
     }
 
     auto contains(id_t id) const noexcept {
         const std::lock_guard lock(lock_);
-        return std::ranges::any_of(timers_, [&](const auto& pair) {
-            return std::get<0>(pair.second) == id;
-        });
+        return const_cast<Queue&>(timers_).find(id) != nullptr;
     }
 
     auto finishes(id_t id) const noexcept {
         const std::lock_guard lock(lock_);
-        for (const auto& [expires, item] : timers_) {
-            if (std::get<0>(item) == id) return expires;
-        }
-        return timepoint_t::min();
+        auto entry = const_cast<Queue&>(timers_).find(id);
+        return entry ? entry->expires : timepoint_t::min();
     }
 
     void clear() noexcept {
@@ -348,60 +606,56 @@ public:
         return timers_.empty();
     }
 
+    auto metrics() const noexcept {
+        return metrics_.snapshot();
+    }
+
     auto reset(id_t tid, const period_t& offset = zero, const period_t& interval = zero) {
         const std::lock_guard lock(lock_);
-        auto it = std::ranges::find_if(timers_, [&](const auto& pair) {
-            const auto& [id, period, task] = pair.second;
-            return tid == id;
-        });
-        if (it != timers_.end()) {
-            auto& [id, period, task] = it->second;
-            const auto expires = std::chrono::steady_clock::now() + offset;
-            if (interval != zero)
-                period = interval;
-
-            timers_.erase(it);
-            timers_.emplace(expires, std::make_tuple(id, period, task));
-            cond_.notify_all();
-            return true;
-        }
-        return false;
+        auto entry = timers_.find(tid);
+        if (!entry) return false;
+        if (interval != zero)
+            entry->period = interval;
+        timers_.rearm(*entry, std::chrono::steady_clock::now() + offset);
+        cond_.notify_all();
+        return true;
     }
 
     auto refresh(id_t tid) {
         const std::lock_guard lock(lock_);
-        for (auto it = timers_.begin(); it != timers_.end(); ++it) {
-            const auto& [id, period, task] = it->second;
-            if (tid == id) {
-                auto result = true;
-                if (period == zero) return false;
-                const auto current = std::chrono::steady_clock::now();
-                const auto expires = current + period;
-                const auto when = it->first;
-                timers_.erase(it);
-                if (when > current) { // if hasnt expired, refresh...
-                    result = true;
-                    timers_.emplace(expires, std::make_tuple(id, period, task));
-                }
-                cond_.notify_all();
-                return result;
-            }
-        }
-        return false;
+        auto entry = timers_.find(tid);
+        if (!entry || entry->period == zero) return false;
+        const auto current = std::chrono::steady_clock::now();
+        if (entry->expires > current) // if hasnt expired, refresh...
+            timers_.rearm(*entry, current + entry->period);
+        else
+            timers_.erase(*entry);
+        cond_.notify_all();
+        return true;
     }
 
 protected:
-    using timer_t = std::tuple<id_t, period_t, task_t>;
     error_t errors_{[](const std::exception& e) {}};
-    std::multimap<timepoint_t, timer_t> timers_;
+    Queue timers_;
     mutable std::mutex lock_;
     std::condition_variable cond_;
     std::thread thread_;
     std::atomic<bool> stop_{false};
     task_t startup_{[] {}};
+    thread::placement_t placement_;
     id_t next_{0};
+    metrics::timer_metrics metrics_;
+
+    auto arm(const timepoint_t& expires, const period_t& period, task_t task) {
+        const std::lock_guard lock(lock_);
+        const auto id = next_++;
+        timers_.arm({id, period, expires, std::move(task)});
+        cond_.notify_all();
+        return id;
+    }
 
     void run() noexcept {
+        placement_.apply();
         startup_();
         for (;;) {
             std::unique_lock lock(lock_);
@@ -411,38 +665,57 @@ protected:
             if (stop_) break;
             if (timers_.empty()) continue;
 
-            auto it = timers_.begin();
-            auto expires = it->first;
-            const auto now = std::chrono::steady_clock::now();
-            if (expires <= now) {
-                const auto item(std::move(it->second));
-                const auto& [id, period, task] = item;
-                timers_.erase(it);
-                if (period != zero) {
-                    expires += period;
-                    timers_.emplace(expires, std::make_tuple(id, period, task));
-                }
+            auto entry = timers_.expired(std::chrono::steady_clock::now());
+            if (entry) {
+                // periodic timers keep their entry; the task is moved out
+                // while running and restored unless cancelled meanwhile.
+                const auto id = entry->id;
+                const auto started = metrics_.fired(entry->expires);
+                auto task = std::move(entry->task);
+                if (entry->period != zero)
+                    timers_.rearm(*entry, entry->expires + entry->period);
+                else
+                    timers_.erase(*entry);
                 lock.unlock();
                 try {
+                    BUSUTO_TRACE_SPAN("timer", "timer");
                     task();
                 } catch (const std::exception& e) {
                     errors_(e);
                 }
+                metrics_.finished(started);
+                lock.lock();
+                if (entry = timers_.find(id); entry && !entry->task)
+                    entry->task = std::move(task);
                 continue;
             }
-            cond_.wait_until(lock, expires);
+            cond_.wait_until(lock, timers_.wakeup());
         }
     }
 };
 
+using timer = basic_timer<timer_tree>;
+using wheel_timer = basic_timer<timer_wheel>;
+
 class pool {
 public:
+    enum class mode_t { shared, stealing };
+
+    static constexpr auto shared = mode_t::shared;
+    static constexpr auto stealing = mode_t::stealing;
+
     pool() = default;
     pool(const pool&) = delete;
     auto operator=(const pool&) -> auto& = delete;
 
+    explicit pool(mode_t mode) noexcept : mode_(mode) {}
+
     explicit pool(std::size_t count, task_t init = [] {}) {
-        start(count, init);
+        start(count, std::move(init));
+    }
+
+    pool(std::size_t count, mode_t mode, task_t init = [] {}) : mode_(mode) {
+        start(count, std::move(init));
     }
 
     ~pool() {
@@ -464,6 +737,18 @@ public:
         return workers_.size();
     }
 
+    auto mode() const noexcept {
+        return mode_;
+    }
+
+    // Takes effect when the pool is next started.
+    auto placement(thread::placement_t where) -> auto& {
+        const std::lock_guard lock(mutex_);
+        if (started_) throw std::runtime_error("cannot modify running pool");
+        placement_ = std::move(where);
+        return *this;
+    }
+
     void resize(std::size_t count) {
         drain();
         if (count) start(count);
@@ -480,35 +765,55 @@ public:
         started_ = true;
         workers_.clear();
         workers_.reserve(count);
-        startup_ = init;
+        startup_ = std::move(init);
+        metrics_ = metrics::task_metrics(count);
+        count_ = count;
+        if (mode_ == stealing) {
+            locals_ = std::make_unique<local_t[]>(count);
+            for (std::size_t i = 0; i < count; ++i)
+                workers_.emplace_back(&pool::steal_worker, this, i);
+            return;
+        }
+
         for (std::size_t i = 0; i < count; ++i) {
-            workers_.emplace_back([this] {
+            workers_.emplace_back([this, i, count] {
+                current_ = this;
+                worker_ = i;
+                placement_.apply(i, count);
                 startup_();
                 while (true) {
-                    std::function<void()> task;
                     std::unique_lock lock(mutex_);
                     cvar_.wait(lock, [this] {
                         return !accepting_ || !tasks_.empty();
                     });
 
-                    if (!accepting_ && tasks_.empty()) return;
-                    task = std::move(tasks_.front());
+                    if (!accepting_ && tasks_.empty()) break;
+                    auto job = std::move(tasks_.front());
                     tasks_.pop();
                     lock.unlock();
-                    task();
+                    run(i, job);
                 }
+                current_ = nullptr;
             });
         }
     }
 
     auto dispatch(task_t task) {
+        if (mode_ == stealing) return steal_dispatch(std::move(task));
         const std::lock_guard lock(mutex_);
         if (!accepting_) return false;
-        tasks_.push(std::move(task));
+        tasks_.push({std::move(task)});
+        metrics_.dispatched(slot());
         cvar_.notify_one();
         return true;
     }
 
+    // Counters survive drain but restart when the pool is started again.
+    auto metrics() const noexcept {
+        const std::lock_guard lock(mutex_);
+        return metrics_.snapshot();
+    }
+
     void startup() noexcept {
         start();
     }
@@ -518,13 +823,28 @@ public:
     }
 
 protected:
+    // per-worker deque, owner works the back (lifo), thieves take the front
+    struct alignas(64) local_t {
+        std::mutex lock;
+        std::deque<job_t> tasks;
+    };
+
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
+    std::queue<job_t> tasks_;
     mutable std::mutex mutex_;
     std::condition_variable cvar_;
     task_t startup_{[] {}};
+    thread::placement_t placement_;
     std::atomic<bool> accepting_{false};
     volatile bool started_{false};
+    mode_t mode_{shared};
+    std::unique_ptr<local_t[]> locals_;
+    std::size_t count_{0};
+    std::atomic<std::size_t> pending_{0}, idle_{0}, next_{0};
+    metrics::task_metrics metrics_;
+
+    static inline thread_local const pool *current_{nullptr};
+    static inline thread_local std::size_t worker_{0};
 
     void drain() noexcept {
         std::unique_lock lock(mutex_);
@@ -540,25 +860,149 @@ protected:
 
         lock.lock();
         workers_.clear();
+        locals_.reset();
         started_ = false;
     }
+
+    // metrics slot of the calling thread, past the workers if not one
+    auto slot() const noexcept -> std::size_t {
+        return current_ == this ? worker_ : count_;
+    }
+
+    void run(std::size_t index, job_t& job) {
+        const auto started = metrics_.started(index, job.queued);
+        BUSUTO_TRACE_SPAN("task", "pool");
+        job.task();
+        metrics_.finished(index, started);
+    }
+
+    static auto random_victim() noexcept -> std::size_t {
+        static thread_local std::uint64_t seed = std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1U;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return static_cast<std::size_t>(seed);
+    }
+
+    void wakeup() {
+        // pairs with idle_ increment in sleeping worker so wakeups are not lost
+        if (idle_.load() == 0) return;
+        const std::lock_guard lock(mutex_);
+        cvar_.notify_one();
+    }
+
+    auto steal_dispatch(task_t task) -> bool {
+        // reserve before checking accepting_ so drain waits for this task
+        pending_.fetch_add(1);
+        if (!accepting_) {
+            pending_.fetch_sub(1);
+            const std::lock_guard lock(mutex_);
+            cvar_.notify_all();
+            return false;
+        }
+
+        auto& local = (current_ == this) ? locals_[worker_] : locals_[next_.fetch_add(1, std::memory_order_relaxed) % count_];
+        metrics_.dispatched(slot());
+        std::unique_lock lock(local.lock);
+        local.tasks.push_back({std::move(task)});
+        lock.unlock();
+        wakeup();
+        return true;
+    }
+
+    // Rebuilds a worker deque from the placed worker, so its storage is
+    // first touched on that worker's node.
+    static void localize(local_t& local) {
+        std::deque<job_t> tasks;
+        const std::lock_guard lock(local.lock);
+        std::ranges::move(local.tasks, std::back_inserter(tasks));
+        local.tasks.swap(tasks);
+    }
+
+    auto pop_local(std::size_t index, job_t& task) -> bool {
+        auto& local = locals_[index];
+        const std::lock_guard lock(local.lock);
+        if (local.tasks.empty()) return false;
+        task = std::move(local.tasks.back());
+        local.tasks.pop_back();
+        return true;
+    }
+
+    auto steal(std::size_t index, job_t& task) -> bool {
+        const auto start = random_victim();
+        for (std::size_t pos = 0; pos < count_; ++pos) {
+            const auto victim = (start + pos) % count_;
+            if (victim == index) continue;
+            auto& local = locals_[victim];
+            const std::unique_lock lock(local.lock, std::try_to_lock);
+            if (!lock.owns_lock() || local.tasks.empty()) continue;
+            task = std::move(local.tasks.front());
+            local.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void steal_worker(std::size_t index) {
+        current_ = this;
+        worker_ = index;
+        if (placement_) {
+            placement_.apply(index, count_);
+            localize(locals_[index]);
+        }
+        startup_();
+        while (true) {
+            job_t job;
+            if (pop_local(index, job) || steal(index, job)) {
+                pending_.fetch_sub(1);
+                run(index, job);
+                continue;
+            }
+
+            std::unique_lock lock(mutex_);
+            idle_.fetch_add(1);
+            cvar_.wait(lock, [this] {
+                return !accepting_ || pending_.load() > 0;
+            });
+            idle_.fetch_sub(1);
+            if (!accepting_ && pending_.load() == 0) break;
+        }
+        current_ = nullptr;
+    }
 };
 
 class logger final {
 public:
-    class stream final : public std::ostringstream {
+    // What an async logger does when its ring is full. Fatal records always
+    // block so they are never lost.
+    enum class overflow_t { drop, block };
+
+    class stream final : public std::ostream {
     public:
         stream(const stream&) = delete;
 
+        // Free record space to format into in place, and then commit.
+        auto space(std::size_t want = 1) { return buf_.space(want); }
+        void commit(std::size_t n) noexcept { buf_.commit(n); }
+
         ~stream() final {
+            const auto text = buf_.text();
+            if (from_.post(level_, type_, prefix_, text, exit_ != 0)) {
+                if (exit_) {
+                    from_.flush();
+                    std::quick_exit(exit_);
+                }
+                return;
+            }
+
             const std::lock_guard lock(from_.locker_);
 #ifdef USE_SYSLOG
             if (from_.opened_)
-                ::syslog(type_, "%s", str().c_str());
+                ::syslog(type_, "%.*s", int(text.size()), text.data());
 #endif
-            from_.notify_(str(), prefix_);
+            from_.notify_(std::string(text), prefix_);
             if (from_.verbose_ >= level_)
-                std::cerr << prefix_ << ": " << str() << std::endl;
+                std::cerr << prefix_ << ": " << text << std::endl;
             if (exit_)
                 std::quick_exit(exit_);
         }
@@ -566,8 +1010,47 @@ public:
     private:
         friend class logger;
 
-        stream(unsigned level, int type, const char *prefix, logger& from, int ex = 0) : from_(from), level_{level}, type_{type}, prefix_{prefix}, exit_{ex} {}
+        // Formats into storage inside the stream, so a record that fits
+        // never touches the heap. Longer text spills into a string.
+        class record_buf final : public std::streambuf {
+        public:
+            record_buf() noexcept { setp(data_, data_ + sizeof(data_)); }
+
+            // Spills what is held when less than want is free.
+            auto space(std::size_t want) -> std::span<char> {
+                if (std::size_t(epptr() - pptr()) < want && pptr() != data_) {
+                    spill_.append(data_, std::size_t(pptr() - data_));
+                    setp(data_, data_ + sizeof(data_));
+                }
+                return {pptr(), std::size_t(epptr() - pptr())};
+            }
+
+            void commit(std::size_t n) noexcept { pbump(int(n)); }
+
+            auto text() -> std::string_view {
+                const auto used = std::size_t(pptr() - data_);
+                if (spill_.empty()) return {data_, used};
+                spill_.append(data_, used);
+                setp(data_, data_ + sizeof(data_));
+                return spill_;
+            }
+
+        private:
+            char data_[BUSUTO_LOG_RECORD];
+            std::string spill_;
+
+            auto overflow(int_type ch) -> int_type final {
+                spill_.append(data_, std::size_t(pptr() - data_));
+                setp(data_, data_ + sizeof(data_));
+                if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                    spill_ += traits_type::to_char_type(ch);
+                return traits_type::not_eof(ch);
+            }
+        };
+
+        stream(unsigned level, int type, const char *prefix, logger& from, int ex = 0) : std::ostream(&buf_), from_(from), level_{level}, type_{type}, prefix_{prefix}, exit_{ex} {}
 
+        record_buf buf_;
         logger& from_;
         unsigned level_;
         int type_;
@@ -575,6 +1058,11 @@ public:
         int exit_{0};
     };
 
+    logger() = default;
+    logger(const logger&) = delete;
+    auto operator=(const logger&) -> logger& = delete;
+    ~logger();
+
     auto verbose() const noexcept {
         return verbose_;
     }
@@ -588,6 +1076,20 @@ public:
         notify_ = notify;
     }
 
+    // Records are queued to a writer thread until stop. Text beyond
+    // BUSUTO_LOG_RECORD is truncated in async mode.
+    void start(overflow_t policy = overflow_t::block);
+    void stop();
+    void flush() noexcept;
+
+    auto is_async() const noexcept {
+        return async_.load(std::memory_order_relaxed);
+    }
+
+    auto dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
 #ifdef USE_SYSLOG
     void open(const char *id, int level = LOG_INFO, int facility = LOG_DAEMON, int flags = LOG_CONS | LOG_NDELAY) {
         ::openlog(id, flags, facility);
@@ -635,15 +1137,53 @@ public:
     }
 
 private:
+    struct record_t {
+        unsigned level{0};
+        int type{0};
+        const char *prefix{nullptr};
+        std::size_t size{0};
+        char text[BUSUTO_LOG_RECORD];
+
+        record_t() noexcept = default;
+        record_t(unsigned lvl, int kind, const char *from, std::string_view msg) noexcept : level(lvl), type(kind), prefix(from), size(std::min(msg.size(), sizeof(text))) {
+            std::memcpy(text, msg.data(), size);
+        }
+
+        record_t(const record_t& from) noexcept : level(from.level), type(from.type), prefix(from.prefix), size(from.size) {
+            std::memcpy(text, from.text, size);
+        }
+
+        auto operator=(const record_t& from) noexcept -> record_t& {
+            level = from.level;
+            type = from.type;
+            prefix = from.prefix;
+            size = from.size;
+            std::memmove(text, from.text, size);
+            return *this;
+        }
+    };
+
+    using ring_t = atomic::queue_t<record_t, BUSUTO_LOG_QUEUE>;
+
     notify_t notify_{[](const std::string& str, const char *type) {}};
     unsigned verbose_{1};
     std::mutex locker_;
 #ifdef USE_SYSLOG
     bool opened_{false};
 #endif
+    std::unique_ptr<ring_t> ring_;
+    std::thread writer_;
+    overflow_t policy_{overflow_t::block};
+    std::atomic<bool> async_{false}, stopping_{false}, running_{false};
+    std::atomic<uint32_t> wakeup_{0}, posters_{0};
+    std::atomic<uint64_t> posted_{0}, written_{0}, dropped_{0};
+
+    // Returns false when not async, so the caller writes synchronously.
+    auto post(unsigned level, int type, const char *prefix, std::string_view text, bool fatal) noexcept -> bool;
+    void write() noexcept;
 };
 
-inline void parallel(std::size_t count, task_t task) {
+inline void parallel(std::size_t count, const std::function<void()>& task) {
     count = thread::concurrency(count);
     std::vector<std::thread> threads;
     threads.reserve(count);
@@ -15,6 +15,28 @@ constexpr auto is_zero(const void *addr, std::size_t size) -> bool {
     }
     return true;
 }
+
+#ifdef BUSUTO_NO_MMSG
+auto recvmmsg(int so, struct mmsghdr *msgs, unsigned count, int flags, void *) -> int {
+    unsigned total = 0;
+    while (total < count) {
+        auto len = ::recvmsg(so, &msgs[total].msg_hdr, total ? flags | MSG_DONTWAIT : flags);
+        if (len < 0) return total ? int(total) : -1;
+        msgs[total++].msg_len = unsigned(len);
+    }
+    return int(total);
+}
+
+auto sendmmsg(int so, struct mmsghdr *msgs, unsigned count, int flags) -> int {
+    unsigned total = 0;
+    while (total < count) {
+        auto len = ::sendmsg(so, &msgs[total].msg_hdr, flags);
+        if (len < 0) return total ? int(total) : -1;
+        msgs[total++].msg_len = unsigned(len);
+    }
+    return int(total);
+}
+#endif
 } // end namespace
 
 void socket::address::assign(const struct sockaddr *from) noexcept {
@@ -179,3 +201,141 @@ auto socket::is_any(const struct sockaddr *sa) -> bool {
         return false;
     }
 }
+
+socket::datagram::datagram(handle_t so, std::size_t count, std::size_t size) : so_(std::move(so)), count_(std::max(count, std::size_t(1))), size_(size), pool_(std::make_unique<std::byte[]>(count_ * size_)), recv_(count_), send_(count_), vecs_(count_), outs_(count_), control_(count_), outctl_(count_), peers_(count_), targets_(count_), segments_(count_) {
+    packets_.reserve(count_);
+    for (std::size_t pos = 0; pos < count_; ++pos) {
+        vecs_[pos].iov_base = pool_.get() + pos * size_;
+        vecs_[pos].iov_len = size_;
+        auto& hdr = recv_[pos].msg_hdr;
+        hdr.msg_iov = &vecs_[pos];
+        hdr.msg_iovlen = 1;
+    }
+}
+
+auto socket::datagram::gro(bool enable) noexcept -> bool {
+#ifdef UDP_GRO
+    const int value = enable ? 1 : 0;
+    if (::setsockopt(so_, IPPROTO_UDP, UDP_GRO, &value, sizeof(value)) == 0) return true;
+    error_ = errno;
+#else
+    error_ = ENOTSUP;
+#endif
+    return false;
+}
+
+auto socket::datagram::receive(int timeout) noexcept -> std::size_t {
+    packets_.clear();
+    auto flags = MSG_DONTWAIT;
+    if (timeout >= 0) {
+        struct pollfd pfd{so_, POLLIN, 0};
+        const auto ready = ::poll(&pfd, 1, timeout);
+        if (ready <= 0) {
+            error_ = ready ? errno : 0;
+            return 0;
+        }
+    } else {
+#ifdef BUSUTO_NO_MMSG
+        flags = 0;
+#else
+        flags = MSG_WAITFORONE;
+#endif
+    }
+
+    for (std::size_t pos = 0; pos < count_; ++pos) {
+        auto& hdr = recv_[pos].msg_hdr;
+        hdr.msg_name = peers_[pos].data();
+        hdr.msg_namelen = peers_[pos].max();
+        hdr.msg_control = control_[pos].data;
+        hdr.msg_controllen = sizeof(control_[pos].data);
+        hdr.msg_flags = 0;
+    }
+
+    const auto got = recvmmsg(so_, recv_.data(), unsigned(count_), flags, nullptr);
+    if (got < 0) {
+        error_ = errno;
+        return 0;
+    }
+
+    error_ = 0;
+    for (std::size_t pos = 0; pos < std::size_t(got); ++pos) {
+        auto& hdr = recv_[pos].msg_hdr;
+        auto data = static_cast<const std::byte *>(vecs_[pos].iov_base);
+        auto len = std::min(std::size_t(recv_[pos].msg_len), size_);
+        std::size_t segment = len;
+#ifdef UDP_GRO
+        for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int value{0};
+                std::memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+                if (value > 0) segment = std::size_t(value);
+            }
+        }
+#endif
+        // a coalesced message is a run of segment sized datagrams, the
+        // last of which may be short
+        do {
+            const auto part = std::min(segment, len);
+            packets_.push_back({{data, part}, &peers_[pos]});
+            data += part;
+            len -= part;
+        } while (len);
+    }
+    return packets_.size();
+}
+
+auto socket::datagram::queue(const address& peer, std::span<const std::byte> data, uint16_t segment) noexcept -> bool {
+    if (queued_ >= count_) return false;
+    const auto pos = queued_++;
+    targets_[pos] = peer;
+    segments_[pos] = segment;
+    outs_[pos].iov_base = const_cast<std::byte *>(data.data());
+    outs_[pos].iov_len = data.size();
+
+    auto& hdr = send_[pos].msg_hdr;
+    hdr = {};
+    hdr.msg_name = targets_[pos].data();
+    hdr.msg_namelen = targets_[pos].size();
+    hdr.msg_iov = &outs_[pos];
+    hdr.msg_iovlen = 1;
+#ifdef UDP_SEGMENT
+    if (segment && segment < data.size()) {
+        hdr.msg_control = outctl_[pos].data;
+        hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+        auto cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = IPPROTO_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        std::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+    }
+#else
+    (void)segment;
+#endif
+    return true;
+}
+
+// A message the kernel refuses is skipped so one bad peer does not stall
+// the rest of the batch; the error is kept.
+auto socket::datagram::flush() noexcept -> std::size_t {
+    std::size_t sent{0}, pos{0};
+    error_ = 0;
+    while (pos < queued_) {
+        const auto count = sendmmsg(so_, &send_[pos], unsigned(queued_ - pos), 0);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            error_ = errno;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            ++pos;
+            continue;
+        }
+        sent += std::size_t(count);
+        pos += std::size_t(count);
+    }
+
+    const auto last = std::exchange(queued_, 0);
+    for (; pos < last; ++pos) {
+        const address peer = targets_[pos];
+        queue(peer, {static_cast<const std::byte *>(outs_[pos].iov_base), outs_[pos].iov_len}, segments_[pos]);
+    }
+    return sent;
+}
@@ -10,7 +10,9 @@
 #include <cstring>
 #include <ostream>
 #include <memory>
+#include <span>
 #include <utility>
+#include <vector>
 #include <sys/types.h>
 #include <fcntl.h>
 #include <sys/socket.h>
@@ -22,6 +24,18 @@
 #include <arpa/inet.h>
 #include <poll.h>
 
+#if __has_include(<netinet/udp.h>)
+#include <netinet/udp.h>
+#endif
+
+#ifndef MSG_WAITFORONE
+#define BUSUTO_NO_MMSG
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned msg_len;
+};
+#endif
+
 #ifndef IPV6_ADD_MEMBERSHIP
 #define IPV6_ADD_MEMBERSHIP IP_ADD_MEMBERSHIP
 #endif
@@ -288,6 +302,84 @@ inline auto operator>>(std::istream& in, address& addr) -> std::istream& {
 }
 } // namespace busuto::socket
 
+namespace busuto::socket {
+// Batched datagram io. One receive fills up to count messages from a
+// reusable buffer pool with a single recvmmsg, and queued sends go out in
+// one sendmmsg on flush. With udp gro and gso a single message carries a
+// run of datagrams of one segment size; buffers should then be 64k.
+class datagram final {
+public:
+    struct packet_t {
+        std::span<const std::byte> data;
+        const address *peer{nullptr};
+    };
+
+#if defined(UDP_SEGMENT) && defined(UDP_GRO)
+    static constexpr bool offload = true;
+#else
+    static constexpr bool offload = false;
+#endif
+
+    explicit datagram(handle_t so, std::size_t count = 32, std::size_t size = 2048);
+    datagram(const datagram&) = delete;
+    auto operator=(const datagram&) -> datagram& = delete;
+
+    explicit operator bool() const noexcept { return static_cast<bool>(so_); }
+    auto operator!() const noexcept { return !so_; }
+
+    auto handle() const noexcept { return so_.get(); }
+    auto error() const noexcept { return error_; }
+    auto capacity() const noexcept { return count_; }
+    auto buffer_size() const noexcept { return size_; }
+
+    auto packets() const noexcept { return std::span<const packet_t>(packets_); }
+    auto begin() const noexcept { return packets_.cbegin(); }
+    auto end() const noexcept { return packets_.cend(); }
+    auto size() const noexcept { return packets_.size(); }
+    auto empty() const noexcept { return packets_.empty(); }
+    auto pending() const noexcept { return queued_; }
+
+    // Ask the kernel to coalesce received datagrams; false if unsupported.
+    auto gro(bool enable = true) noexcept -> bool;
+
+    // Waits up to timeout ms (-1 forever) and returns the packets received.
+    // Packet views stay valid until the next receive.
+    auto receive(int timeout = -1) noexcept -> std::size_t;
+
+    // Queues data for peer without copying it, so data must stay valid
+    // until flush. A segment size sends data as gso datagrams of that size.
+    // Returns false if the batch is full.
+    auto queue(const address& peer, std::span<const std::byte> data, uint16_t segment = 0) noexcept -> bool;
+
+    template <typename Binary>
+    requires requires(const Binary& bin) { std::as_bytes(std::span(bin)); }
+    auto queue(const address& peer, const Binary& data, uint16_t segment = 0) noexcept {
+        return queue(peer, std::as_bytes(std::span(data)), segment);
+    }
+
+    // Sends everything queued and returns the messages sent. Messages left
+    // when a non-blocking socket would block stay queued.
+    auto flush() noexcept -> std::size_t;
+
+private:
+    struct alignas(struct cmsghdr) control_t {
+        char data[CMSG_SPACE(sizeof(int))];
+    };
+
+    handle_t so_;
+    int error_{0};
+    std::size_t count_, size_;
+    std::size_t queued_{0};
+    std::unique_ptr<std::byte[]> pool_;
+    std::vector<struct mmsghdr> recv_, send_;
+    std::vector<struct iovec> vecs_, outs_;
+    std::vector<control_t> control_, outctl_;
+    std::vector<address> peers_, targets_;
+    std::vector<uint16_t> segments_;
+    std::vector<packet_t> packets_;
+};
+} // namespace busuto::socket
+
 namespace busuto {
 using address_t = socket::address;
 
@@ -305,10 +397,7 @@ namespace std {
 template <>
 struct hash<busuto::socket::address> {
     auto operator()(const busuto::socket::address& a) const noexcept {
-        const auto *bytes = reinterpret_cast<const std::byte *>(a.data());
-        return std::hash<std::string_view>{}(std::string_view(
-        reinterpret_cast<const char *>(bytes),
-        a.size()));
+        return std::size_t(busuto::util::hash64(a.data(), a.size()));
     }
 };
 } // namespace std
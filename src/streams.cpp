@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "streams.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+using system::buffer_pool;
+
+struct shared_t {
+    std::mutex lock;
+    std::array<std::vector<char *>, buffer_pool::classes> free;
+    std::atomic<std::size_t> borrowed{0};
+    std::atomic<std::size_t> idle{0};
+
+    ~shared_t() {
+        for (auto& list : free) {
+            for (auto *buf : list)
+                delete[] buf;
+        }
+    }
+};
+
+auto shared() -> shared_t& {
+    static shared_t pool;
+    return pool;
+}
+
+// Half a cache moves at a time, so a thread that alternates borrowing and
+// returning around a boundary does not bounce on the shared lock.
+void refill(unsigned level, char **into, unsigned& count) {
+    auto& pool = shared();
+    const std::lock_guard lock(pool.lock);
+    auto& list = pool.free[level];
+    while (count < BUSUTO_BUFFER_CACHE / 2 && !list.empty()) {
+        into[count++] = list.back();
+        list.pop_back();
+        pool.idle.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void spill(unsigned level, char **from, unsigned& count, unsigned keep) noexcept {
+    auto& pool = shared();
+    const std::lock_guard lock(pool.lock);
+    auto& list = pool.free[level];
+    while (count > keep) {
+        auto *buf = from[--count];
+        if (list.size() >= BUSUTO_BUFFER_IDLE) {
+            delete[] buf;
+            continue;
+        }
+        try {
+            list.push_back(buf);
+            pool.idle.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+            delete[] buf;
+        }
+    }
+}
+
+struct cache_t {
+    std::array<std::array<char *, BUSUTO_BUFFER_CACHE>, buffer_pool::classes> slots{};
+    std::array<unsigned, buffer_pool::classes> count{};
+
+    cache_t() {
+        shared(); // outlive the caches of every thread
+    }
+
+    ~cache_t() {
+        for (unsigned level = 0; level < buffer_pool::classes; ++level)
+            spill(level, slots[level].data(), count[level], 0);
+    }
+};
+
+thread_local cache_t cache;
+} // end namespace
+
+auto buffer_pool::acquire(unsigned level) -> char * {
+    if (level >= classes) throw range("buffer class");
+    auto& count = cache.count[level];
+    if (!count)
+        refill(level, cache.slots[level].data(), count);
+    shared().borrowed.fetch_add(1, std::memory_order_relaxed);
+    if (count) return cache.slots[level][--count];
+    try {
+        return new char[size(level)];
+    } catch (...) {
+        shared().borrowed.fetch_sub(1, std::memory_order_relaxed);
+        throw;
+    }
+}
+
+void buffer_pool::release(char *buf, unsigned level) noexcept {
+    if (!buf || level >= classes) return;
+    shared().borrowed.fetch_sub(1, std::memory_order_relaxed);
+    auto& count = cache.count[level];
+    if (count >= BUSUTO_BUFFER_CACHE)
+        spill(level, cache.slots[level].data(), count, BUSUTO_BUFFER_CACHE / 2);
+    cache.slots[level][count++] = buf;
+}
+
+auto buffer_pool::borrowed() noexcept -> std::size_t {
+    return shared().borrowed.load(std::memory_order_relaxed);
+}
+
+auto buffer_pool::idle() noexcept -> std::size_t {
+    return shared().idle.load(std::memory_order_relaxed);
+}
+
+void buffer_pool::trim() noexcept {
+    auto& pool = shared();
+    const std::lock_guard lock(pool.lock);
+    for (auto& list : pool.free) {
+        for (auto *buf : list)
+            delete[] buf;
+        pool.idle.fetch_sub(list.size(), std::memory_order_relaxed);
+        list.clear();
+        list.shrink_to_fit();
+    }
+}
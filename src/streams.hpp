@@ -4,28 +4,162 @@
 #pragma once
 
 #include "system.hpp"
+#include "binary.hpp"
 
 #include <cstring>
+#include <cerrno>
+#include <span>
+#include <sys/uio.h>
+
+#if __has_include(<sys/sendfile.h>)
+#include <sys/sendfile.h>
+#endif
+
+#ifndef BUSUTO_IOV_BATCH
+#define BUSUTO_IOV_BATCH 64 // NOLINT
+#endif
+
+#ifndef BUSUTO_BUFFER_MIN
+#define BUSUTO_BUFFER_MIN 1024 // NOLINT
+#endif
+
+#ifndef BUSUTO_BUFFER_CLASSES
+#define BUSUTO_BUFFER_CLASSES 4 // NOLINT
+#endif
+
+#ifndef BUSUTO_BUFFER_CACHE
+#define BUSUTO_BUFFER_CACHE 16 // NOLINT
+#endif
+
+#ifndef BUSUTO_BUFFER_IDLE
+#define BUSUTO_BUFFER_IDLE 256 // NOLINT
+#endif
 
 namespace busuto::system {
+template <typename T>
+concept byte_segment = requires(const T& seg) {
+    { seg.data() } -> std::convertible_to<const void *>;
+    { seg.size() } -> std::convertible_to<std::size_t>;
+} && sizeof(*std::declval<const T&>().data()) == 1;
+
+inline auto make_iovec(const void *data, std::size_t size) noexcept {
+    return iovec{const_cast<void *>(data), size};
+}
+
+template <byte_segment T>
+inline auto make_iovec(const T& seg) noexcept {
+    return make_iovec(static_cast<const void *>(seg.data()), std::size_t(seg.size()));
+}
+
+// Pool of reusable stream buffers in power of four size classes. Each
+// thread keeps a small cache per class so borrowing and returning a buffer
+// usually touches no lock and no heap.
+class buffer_pool final {
+public:
+    static constexpr unsigned classes = BUSUTO_BUFFER_CLASSES;
+
+    static constexpr auto size(unsigned level) noexcept {
+        return std::size_t(BUSUTO_BUFFER_MIN) << (2 * level);
+    }
+
+    static auto acquire(unsigned level) -> char *;
+    static void release(char *buf, unsigned level) noexcept;
+    static auto borrowed() noexcept -> std::size_t;
+    static auto idle() noexcept -> std::size_t;
+    static void trim() noexcept;
+};
+
+// Fixed in object buffers, the storage of a classic streambuf<S>.
 template <std::size_t S>
-class streambuf : public std::streambuf {
+class fixed_buffers final {
+public:
+    auto input() noexcept -> char * { return in_; }
+    auto output() noexcept -> char * { return out_; }
+    constexpr auto input_size() const noexcept { return S; }
+    constexpr auto output_size() const noexcept { return S; }
+    auto grow_input(std::size_t /* used */) noexcept -> char * { return nullptr; }
+    auto grow_output(std::size_t /* used */) noexcept -> char * { return nullptr; }
+    auto release_input() noexcept { return false; }
+    auto release_output() noexcept { return false; }
+
+private:
+    char in_[S]{};
+    char out_[S]{};
+};
+
+// Buffers borrowed from the buffer pool only while data is pending. A
+// stream that fills its buffer moves up a size class, and drops one class
+// each time it goes idle.
+class pooled_buffers final {
 public:
-    explicit streambuf(int fd, close_t fn) : handle_(fd, fn) {
-        setg(inbuf_, inbuf_, inbuf_);
-        setp(outbuf_, outbuf_ + S);
+    pooled_buffers() = default;
+    pooled_buffers(const pooled_buffers&) = delete;
+    auto operator=(const pooled_buffers&) -> pooled_buffers& = delete;
+
+    ~pooled_buffers() {
+        release_input();
+        release_output();
     }
 
-    explicit streambuf(int fd) : handle_(fd) {
-        setg(inbuf_, inbuf_, inbuf_);
-        setp(outbuf_, outbuf_ + S);
+    auto input() -> char * { return borrow(in_); }
+    auto output() -> char * { return borrow(out_); }
+    auto input_size() const noexcept { return buffer_pool::size(in_.level); }
+    auto output_size() const noexcept { return buffer_pool::size(out_.level); }
+    auto grow_input(std::size_t used) -> char * { return grow(in_, used); }
+    auto grow_output(std::size_t used) -> char * { return grow(out_, used); }
+    auto release_input() noexcept -> bool { return release(in_); }
+    auto release_output() noexcept -> bool { return release(out_); }
+
+private:
+    struct slot_t {
+        char *data{nullptr};
+        unsigned level{0};
+    };
+
+    slot_t in_, out_;
+
+    static auto borrow(slot_t& slot) -> char * {
+        if (!slot.data)
+            slot.data = buffer_pool::acquire(slot.level);
+        return slot.data;
+    }
+
+    static auto grow(slot_t& slot, std::size_t used) -> char * {
+        if (slot.level + 1 >= buffer_pool::classes) return nullptr;
+        auto next = buffer_pool::acquire(slot.level + 1);
+        if (slot.data) {
+            std::memcpy(next, slot.data, used);
+            buffer_pool::release(slot.data, slot.level);
+        }
+        slot.data = next;
+        ++slot.level;
+        return next;
+    }
+
+    static auto release(slot_t& slot) noexcept -> bool {
+        if (!slot.data) return false;
+        buffer_pool::release(std::exchange(slot.data, nullptr), slot.level);
+        if (slot.level) --slot.level;
+        return true;
+    }
+};
+
+template <typename Buffers>
+class basic_streambuf : public std::streambuf {
+public:
+    explicit basic_streambuf(int fd, close_t fn) : handle_(fd, fn) {
+        init();
+    }
+
+    explicit basic_streambuf(int fd) : handle_(fd) {
+        init();
     }
 
     auto handle() noexcept -> handle_t& { return handle_; }
     auto zb_data() const noexcept { return gptr(); }
     auto zb_size() const noexcept { return static_cast<std::size_t>(egptr() - gptr()); }
 
-    auto reaable() const noexcept {
+    auto readable() const noexcept {
         return gptr() < egptr() || handle_.readable();
     }
 
@@ -33,6 +167,12 @@ public:
         return handle_.writable();
     }
 
+    // Returns borrowed buffers that hold no pending data.
+    void zb_idle() noexcept {
+        input_idle();
+        output_idle();
+    }
+
     auto zb_getbody(std::size_t n) -> std::string_view {
         while (static_cast<size_t>(egptr() - gptr()) < n) {
             if (zb_underflow() == traits_type::eof()) {
@@ -45,32 +185,18 @@ public:
         return {start, n};
     }
 
+    // Each refill resumes the delimiter search where the last one stopped.
     auto zb_getview(std::string_view delim = "\r\n") -> std::string_view {
-        while (true) {
+        if (delim.empty()) return {};
+        for (;;) {
             auto *start = gptr();
-            auto *end = start;
-            while (true) {
-                auto avail = static_cast<size_t>(egptr() - end);
-                if (avail < delim.size()) {
-                    if (avail == 0) {
-                        if (zb_underflow() == traits_type::eof()) return {};
-                        break;
-                    }
-
-                    auto tail = avail;
-                    if (std::string_view(end, tail) == delim.substr(0, tail)) {
-                        if (zb_underflow() == traits_type::eof()) return {};
-                        break;
-                    }
-                    ++end;
-                    continue;
-                }
-                if (std::string_view(end, delim.size()) == delim) {
-                    gbump(static_cast<int>((end - start) + delim.size()));
-                    return {start, end - start};
-                }
-                ++end;
+            const auto pos = scan_.find(start, static_cast<std::size_t>(egptr() - start), delim);
+            if (pos != std::string_view::npos) {
+                scan_.reset();
+                gbump(static_cast<int>(pos + delim.size()));
+                return {start, pos};
             }
+            if (zb_underflow() == traits_type::eof()) return {};
         }
     }
 
@@ -84,26 +210,151 @@ public:
             return false;
 
         auto unread = static_cast<size_t>(end - start);
-        if (unread && start > inbuf_)
-            std::memmove(inbuf_, start, unread);
-        setg(inbuf_, inbuf_, inbuf_ + unread);
-        if (unread >= S) return true;
-        auto n = sys_read(inbuf_ + unread, S - unread);
-        if (n <= 0) return unread > 0;
-        setg(inbuf_, inbuf_, inbuf_ + unread + n);
+        auto *buf = input_area();
+        scan_.reset();
+        if (unread && start > buf)
+            std::memmove(buf, start, unread);
+        setg(buf, buf, buf + unread);
+        if (unread >= buffers_.input_size()) return true;
+        auto n = sys_read(buf + unread, buffers_.input_size() - unread);
+        if (n <= 0) {
+            input_idle();
+            return unread > 0;
+        }
+        setg(buf, buf, buf + unread + n);
         return true;
     }
 
+    // Gathered write of pending output and caller owned segments. Small
+    // totals coalesce into the output buffer, larger ones are written
+    // straight from the segments. Returns how much of the segments went.
+    auto zb_writev(std::span<const iovec> segments) -> std::size_t {
+        std::size_t total = 0;
+        for (const auto& seg : segments)
+            total += seg.iov_len;
+
+        if (!pbase() && total <= buffers_.output_size())
+            output_area();
+
+        if (total <= static_cast<std::size_t>(epptr() - pptr())) {
+            for (const auto& seg : segments) {
+                std::memcpy(pptr(), seg.iov_base, seg.iov_len);
+                pbump(static_cast<int>(seg.iov_len));
+            }
+            return total;
+        }
+
+        if (!handle_.writable()) return 0;
+        auto *base = pbase();
+        const char *out = base;
+        auto pending = static_cast<std::size_t>(pptr() - pbase());
+        std::size_t index = 0, offset = 0, done = 0;
+        for (;;) {
+            while (index < segments.size() && offset == segments[index].iov_len) {
+                ++index;
+                offset = 0;
+            }
+
+            if (!pending && index >= segments.size()) break;
+            iovec vec[BUSUTO_IOV_BATCH];
+            std::size_t used = 0;
+            if (pending)
+                vec[used++] = make_iovec(out, pending);
+            for (auto pos = index; pos < segments.size() && used < BUSUTO_IOV_BATCH; ++pos) {
+                const auto skip = pos == index ? offset : 0;
+                vec[used++] = make_iovec(static_cast<const char *>(segments[pos].iov_base) + skip, segments[pos].iov_len - skip);
+            }
+
+            auto n = sys_writev(vec, used);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+
+            auto written = static_cast<std::size_t>(n);
+            const auto flushed = std::min(written, pending);
+            out += flushed;
+            pending -= flushed;
+            written -= flushed;
+            done += written;
+            while (written) {
+                const auto left = segments[index].iov_len - offset;
+                if (written < left) {
+                    offset += written;
+                    break;
+                }
+                written -= left;
+                offset = 0;
+                ++index;
+            }
+        }
+
+        if (pending && out != base)
+            std::memmove(base, out, pending);
+        setp(base, epptr());
+        pbump(static_cast<int>(pending));
+        output_idle();
+        return done;
+    }
+
+    // Free output space to format into in place, and then commit. When
+    // less than want is free, pending output is flushed to make room.
+    auto zb_space(std::size_t want = 1) -> std::span<char> {
+        if (!pbase()) output_area();
+        if (static_cast<std::size_t>(epptr() - pptr()) < want && pptr() != pbase())
+            make_room();
+        return {pptr(), static_cast<std::size_t>(epptr() - pptr())};
+    }
+
+    void zb_commit(std::size_t n) noexcept {
+        pbump(static_cast<int>(n));
+    }
+
+    // Flushes pending output and sends part of a file without passing it
+    // through the output buffer.
+    auto zb_sendfile(int from, off_t offset, std::size_t count) -> std::size_t {
+        if (sync() != 0) return 0;
+        std::size_t total = 0;
+        while (total < count) {
+            auto n = sys_sendfile(from, offset, count - total);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += static_cast<std::size_t>(n);
+            offset += n;
+        }
+        output_idle();
+        return total;
+    }
+
 protected:
     virtual auto sys_read(void *buf, std::size_t n) -> ssize_t { return ::read(handle_, buf, n); }
     virtual auto sys_write(const void *buf, std::size_t n) -> ssize_t { return ::write(handle_, buf, n); }
+    virtual auto sys_writev(const iovec *vec, std::size_t count) -> ssize_t { return ::writev(handle_, vec, static_cast<int>(count)); }
+
+    // Falls back to reading through the (flushed) output buffer when the
+    // kernel cannot sendfile between these descriptors.
+    virtual auto sys_sendfile(int from, off_t offset, std::size_t n) -> ssize_t {
+#if __has_include(<sys/sendfile.h>)
+        auto where = offset;
+        auto sent = ::sendfile(handle_, from, &where, n);
+        if (sent >= 0 || (errno != EINVAL && errno != ENOSYS)) return sent;
+#endif
+        auto *buf = output_area();
+        auto got = ::pread(from, buf, std::min(n, buffers_.output_size()), offset);
+        if (got <= 0) return got;
+        return sys_write(buf, static_cast<std::size_t>(got));
+    }
 
     auto underflow() -> int_type override {
         if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
         if (!handle_.readable()) return traits_type::eof();
-        ssize_t n = sys_read(inbuf_, S);
-        if (n <= 0) return traits_type::eof();
-        setg(inbuf_, inbuf_, inbuf_ + n);
+        auto *buf = input_area();
+        scan_.reset();
+        ssize_t n = sys_read(buf, buffers_.input_size());
+        if (n <= 0) {
+            setg(buf, buf, buf);
+            input_idle();
+            return traits_type::eof();
+        }
+        setg(buf, buf, buf + n);
         return traits_type::to_int_type(*gptr());
     }
 
@@ -113,34 +364,29 @@ protected:
             return traits_type::eof();
         }
 
-        if (pptr() == epptr() && sync() != 0) return traits_type::eof();
+        if (pptr() == epptr() && !make_room()) return traits_type::eof();
         *pptr() = traits_type::to_char_type(ch);
         pbump(1);
         return ch;
     }
 
     auto sync() -> int override {
-        auto n = pptr() - pbase();
-        if (n == 0) return 0; // nothing to flush
-        if (!handle_.writable()) return -1;
-        auto written = sys_write(pbase(), n);
-        if (written < 0 || written > n) return -1;
-        if (written < n) {
-            std::memmove(outbuf_, pbase() + written, n - written);
-            setp(outbuf_ + (n - written), outbuf_ + S);
-            return -1;
-        }
-
-        setp(outbuf_, outbuf_ + S);
+        if (flush_pending() != 0) return -1;
+        output_idle();
         return 0;
     }
 
     auto xsputn(const char_type *s, std::streamsize count) -> std::streamsize override {
+        if (count >= static_cast<std::streamsize>(buffers_.output_size())) {
+            const auto seg = make_iovec(s, static_cast<std::size_t>(count));
+            return static_cast<std::streamsize>(zb_writev({&seg, 1}));
+        }
+
         std::streamsize written = 0;
         while (written < count) {
             std::streamsize space = epptr() - pptr();
             if (space == 0) {
-                if (sync()) break;
+                if (!make_room()) break;
                 space = epptr() - pptr();
             }
 
@@ -172,36 +418,124 @@ protected:
         return total;
     }
 
+    // Reads more while keeping unread input, moving it to a larger buffer
+    // when it already fills the current one and the storage can grow.
     auto zb_underflow() -> int_type {
         if (!handle_.readable()) return traits_type::eof();
         auto *start = gptr();
-        auto *end = egptr();
-        auto unread = static_cast<size_t>(end - start);
-        if (unread > 0 && start != inbuf_) {
-            std::memmove(inbuf_, start, unread);
+        auto unread = static_cast<size_t>(egptr() - start);
+        auto *buf = input_area();
+        if (unread > 0 && start != buf) {
+            std::memmove(buf, start, unread);
         }
 
-        auto n = sys_read(inbuf_ + unread, S - unread);
-        if (n <= 0) return traits_type::eof();
-        setg(inbuf_, inbuf_, inbuf_ + unread + n);
+        scan_.moved(start, buf);
+        setg(buf, buf, buf + unread);
+        if (unread >= buffers_.input_size()) {
+            auto *from = buf;
+            buf = buffers_.grow_input(unread);
+            if (!buf) return traits_type::eof();
+            scan_.moved(from, buf);
+            setg(buf, buf, buf + unread);
+        }
+
+        auto n = sys_read(buf + unread, buffers_.input_size() - unread);
+        if (n <= 0) {
+            input_idle();
+            return traits_type::eof();
+        }
+        setg(buf, buf, buf + unread + n);
         return traits_type::to_int_type(*gptr());
     }
 
 private:
     handle_t handle_;
-    char inbuf_[S]{};
-    char outbuf_[S]{};
+    Buffers buffers_;
+    util::delimiter_search scan_;
+
+    void init() {
+        if constexpr (std::is_same_v<Buffers, pooled_buffers>) {
+            setg(nullptr, nullptr, nullptr);
+            setp(nullptr, nullptr);
+        } else {
+            setg(buffers_.input(), buffers_.input(), buffers_.input());
+            setp(buffers_.output(), buffers_.output() + buffers_.output_size());
+        }
+    }
+
+    auto input_area() -> char * {
+        if (!eback()) {
+            auto *buf = buffers_.input();
+            setg(buf, buf, buf);
+        }
+        return eback();
+    }
+
+    auto output_area() -> char * {
+        if (!pbase()) {
+            auto *buf = buffers_.output();
+            setp(buf, buf + buffers_.output_size());
+        }
+        return pbase();
+    }
+
+    void input_idle() noexcept {
+        if (gptr() == egptr() && buffers_.release_input())
+            setg(nullptr, nullptr, nullptr);
+    }
+
+    void output_idle() noexcept {
+        if (pptr() == pbase() && buffers_.release_output())
+            setp(nullptr, nullptr);
+    }
+
+    // Writes pending output: 0 when all of it went, 1 when some is left
+    // because the descriptor would block, and -1 on error.
+    auto flush_pending() -> int {
+        auto n = pptr() - pbase();
+        if (n == 0) return 0; // nothing to flush
+        if (!handle_.writable()) return -1;
+        auto written = sys_write(pbase(), n);
+        if (written < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        if (written > n) return -1;
+        auto *base = pbase();
+        setp(base, epptr());
+        if (written < n) {
+            std::memmove(base, base + written, n - written);
+            pbump(static_cast<int>(n - written));
+            return 1;
+        }
+        return 0;
+    }
+
+    // Makes room in a full put area. A buffer that keeps filling before it
+    // is synced moves up a class when the storage can grow, keeping any
+    // output still pending because the descriptor would block.
+    auto make_room() -> bool {
+        if (!pbase()) return output_area() != nullptr;
+        const auto result = flush_pending();
+        if (result < 0) return false;
+        const auto pending = static_cast<std::size_t>(pptr() - pbase());
+        auto *buf = buffers_.grow_output(pending);
+        if (!buf) return result == 0;
+        setp(buf, buf + buffers_.output_size());
+        pbump(static_cast<int>(pending));
+        return true;
+    }
 };
+
+template <std::size_t S>
+using streambuf = basic_streambuf<fixed_buffers<S>>;
 } // namespace busuto::system
 
 namespace busuto {
-template <std::size_t S = 1024>
-class system_stream : public std::iostream {
+template <typename Buffers>
+class basic_stream : public std::iostream {
 public:
-    explicit system_stream(int fd, close_t fn = [](int fd) { ::close(fd); }) : buf_(fd, fn), std::iostream(&buf_) {}
+    explicit basic_stream(int fd, close_t fn = [](int fd) { ::close(fd); }) : std::iostream(&buf_), buf_(fd, fn) {}
 
-    system_stream(const system_stream&) = delete;
-    auto operator=(const system_stream&) -> system_stream& = delete;
+    basic_stream(const basic_stream&) = delete;
+    auto operator=(const basic_stream&) -> basic_stream& = delete;
 
     auto readable() const noexcept {
         return !static_cast<bool>(!buf_.readable() || eof());
@@ -218,8 +552,29 @@ public:
     auto end() const { return buf_.zb_data() + buf_.zb_size(); }
     auto reset(std::size_t size = 0) { return buf_.zb_reset(size); }
     void close() { buf_.handle().close(); }
+    void idle() noexcept { buf_.zb_idle(); }
     auto getbody(size_t n) { return buf_.zb_getbody(n); }
     auto getview(std::string_view delim = "\r\n") { return buf_.zb_getview(delim); }
+    auto sendfile(int from, off_t offset, std::size_t count) { return buf_.zb_sendfile(from, offset, count); }
+    auto space(std::size_t want = 1) { return buf_.zb_space(want); }
+    void commit(std::size_t n) noexcept { buf_.zb_commit(n); }
+
+    auto writev(std::span<const iovec> segments) {
+        std::size_t total = 0;
+        for (const auto& seg : segments)
+            total += seg.iov_len;
+        if (buf_.zb_writev(segments) == total) return true;
+        setstate(std::ios::badbit);
+        return false;
+    }
+
+    // Writes strings, spans, byte_arrays and the like as one gathered write.
+    template <system::byte_segment... Segments>
+    requires(sizeof...(Segments) > 0)
+    auto writev(const Segments&...segments) {
+        const iovec vec[] = {system::make_iovec(segments)...};
+        return writev(std::span<const iovec>(vec));
+    }
 
     template <typename F>
     auto apply(F func)
@@ -229,9 +584,16 @@ public:
     }
 
 private:
-    system::streambuf<S> buf_;
+    system::basic_streambuf<Buffers> buf_;
 };
 
+template <std::size_t S = 1024>
+using system_stream = basic_stream<system::fixed_buffers<S>>;
+
+// Stream whose buffers come from the buffer pool, for large numbers of
+// mostly idle connections.
+using pooled_stream = basic_stream<system::pooled_buffers>;
+
 template <std::size_t S = 1024>
 inline auto make_stream(int fd, close_t fn = [](int fd) { ::close(fd); }) {
     return system_stream<S>(fd, fn);
@@ -6,10 +6,13 @@
 #include "common.hpp"
 
 #include <algorithm>
+#include <array>
 #include <ranges>
 #include <string>
 #include <string_view>
 #include <cstring>
+#include <iterator>
+#include <unordered_map>
 #include <vector>
 
 namespace busuto::strings {
@@ -64,6 +67,28 @@ inline auto to_lower(const S& input) {
     return result;
 }
 
+// Lowers ascii text into a reused buffer, for lookups keyed on lower case.
+inline auto lower_into(std::string& into, std::string_view text) -> std::string& {
+    into.resize(text.size());
+    std::ranges::transform(text, into.begin(), [](char ch) {
+        return (ch >= 'A' && ch <= 'Z') ? char(ch - 'A' + 'a') : ch;
+    });
+    return into;
+}
+
+// Transparent hash, so string keyed unordered maps can be searched with
+// string views or c strings without making a temporary string.
+struct string_hash {
+    using is_transparent = void;
+
+    auto operator()(std::string_view text) const noexcept {
+        return std::hash<std::string_view>{}(text);
+    }
+};
+
+template <typename T>
+using string_map = std::unordered_map<std::string, T, string_hash, std::equal_to<>>;
+
 template <typename S, typename P>
 inline auto starts_case(const S& source, const P& prefix) {
     auto sv_source = to_string_view(source);
@@ -155,63 +180,255 @@ constexpr auto unquote(const S& from, std::string_view pairs = R"(""''{})") {
     return str;
 }
 
+// Lazily splits text on any of the delimiter characters, yielding views into
+// the original text. When max is set the last token holds the remainder.
+class split_view : public std::ranges::view_interface<split_view> {
+public:
+    class iterator {
+    public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+
+        constexpr iterator() = default;
+        constexpr iterator(std::string_view text, std::string_view delim, unsigned max) noexcept : text_(text), delim_(delim), max_(max) {
+            next();
+        }
+
+        constexpr auto operator*() const noexcept { return token_; }
+
+        constexpr auto operator++() noexcept -> iterator& {
+            next();
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept {
+            auto prior = *this;
+            next();
+            return prior;
+        }
+
+        constexpr auto operator==(const iterator& other) const noexcept {
+            return done_ == other.done_ && (done_ || token_.data() == other.token_.data());
+        }
+
+        constexpr auto operator==(std::default_sentinel_t) const noexcept {
+            return done_;
+        }
+
+    private:
+        std::string_view text_, delim_, token_;
+        std::size_t next_{0};
+        unsigned max_{0}, count_{0};
+        bool done_{true};
+
+        constexpr void next() noexcept {
+            if (next_ > text_.size()) {
+                done_ = true;
+                return;
+            }
+
+            done_ = false;
+            auto end = std::string_view::npos;
+            if (!max_ || ++count_ < max_)
+                end = text_.find_first_of(delim_, next_);
+            if (end == std::string_view::npos) {
+                token_ = text_.substr(next_);
+                next_ = text_.size() + 1;
+                return;
+            }
+            token_ = text_.substr(next_, end - next_);
+            next_ = end + 1;
+        }
+    };
+
+    constexpr split_view() = default;
+    constexpr explicit split_view(std::string_view text, std::string_view delim = " ", unsigned max = 0) noexcept : text_(text), delim_(delim), max_(max) {}
+
+    constexpr auto begin() const noexcept { return iterator(text_, delim_, max_); }
+    constexpr auto end() const noexcept { return std::default_sentinel; }
+
+private:
+    std::string_view text_, delim_;
+    unsigned max_{0};
+};
+
+// Lazily yields tokens separated by runs of delimiter characters. A token
+// that opens with a quote pair keeps its quotes and runs to the matching
+// close, so it may hold delimiters.
+class tokenize_view : public std::ranges::view_interface<tokenize_view> {
+public:
+    class iterator {
+    public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+
+        constexpr iterator() = default;
+        constexpr iterator(std::string_view text, std::string_view delim, std::string_view quotes) noexcept : text_(text), delim_(delim), quotes_(quotes) {
+            next();
+        }
+
+        constexpr auto operator*() const noexcept { return token_; }
+
+        constexpr auto operator++() noexcept -> iterator& {
+            next();
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept {
+            auto prior = *this;
+            next();
+            return prior;
+        }
+
+        constexpr auto operator==(const iterator& other) const noexcept {
+            return done_ == other.done_ && (done_ || token_.data() == other.token_.data());
+        }
+
+        constexpr auto operator==(std::default_sentinel_t) const noexcept {
+            return done_;
+        }
+
+    private:
+        std::string_view text_, delim_, quotes_, token_;
+        std::size_t next_{0};
+        bool done_{true};
+
+        constexpr void next() noexcept {
+            const auto start = text_.find_first_not_of(delim_, next_);
+            if (start == std::string_view::npos) {
+                next_ = text_.size();
+                done_ = true;
+                return;
+            }
+
+            done_ = false;
+            auto end = text_.find_first_of(delim_, start);
+            const auto lead = quotes_.find(text_[start]);
+            if (lead != std::string_view::npos && !(lead & 0x01) && lead + 1 < quotes_.size()) {
+                const auto tail = text_.find(quotes_[lead + 1], start + 1);
+                if (tail != std::string_view::npos)
+                    end = tail + 1;
+            }
+
+            if (end == std::string_view::npos)
+                end = text_.size();
+            token_ = text_.substr(start, end - start);
+            next_ = end;
+        }
+    };
+
+    constexpr tokenize_view() = default;
+    constexpr explicit tokenize_view(std::string_view text, std::string_view delim = " ", std::string_view quotes = R"(""''{})") noexcept : text_(text), delim_(delim), quotes_(quotes) {}
+
+    constexpr auto begin() const noexcept { return iterator(text_, delim_, quotes_); }
+    constexpr auto end() const noexcept { return std::default_sentinel; }
+
+private:
+    std::string_view text_, delim_, quotes_;
+};
+
+// Splits into a caller array for a known field count, the last field holding
+// any remainder. Returns the number of fields found; unused fields are empty.
+template <std::size_t N>
+constexpr auto split_into(std::string_view text, std::array<std::string_view, N>& fields, std::string_view delim = " ") noexcept {
+    static_assert(N > 0, "must split into at least one field");
+    std::size_t count{0};
+    for (auto field : split_view(text, delim, unsigned(N)))
+        fields[count++] = field;
+    for (auto pos = count; pos < N; ++pos)
+        fields[pos] = {};
+    return count;
+}
+
 template <typename S = std::string>
 inline auto split(const S& from, std::string_view delim = " ", unsigned max = 0) {
     static_assert(is_string_vector_v<S>, "S must be a string vector type");
-    auto str = to_string_view(from);
     std::vector<S> result;
-    std::size_t current{}, prev{};
-    unsigned count = 0;
-    current = str.find_first_of(delim);
-    while ((!max || ++count < max) && current != std::string_view::npos) {
-        result.emplace_back(str.substr(prev, current - prev));
-        prev = current + 1;
-        current = str.find_first_of(delim, prev);
-    }
-    result.emplace_back(str.substr(prev));
+    for (auto token : split_view(to_string_view(from), delim, max))
+        result.emplace_back(token);
     return result;
 }
 
-template <typename S = std::string>
-constexpr auto join(const std::vector<S>& list, const std::string_view& delim = ",") -> S {
-    static_assert(is_string_type_v<S>, "S must be a string type");
-    S separator{}, result;
+template <typename B>
+concept append_buffer = requires(B& buf, std::string_view text) {
+    buf.append(text);
+};
+
+template <typename B>
+concept write_buffer = !append_buffer<B> && requires(B& buf, const char *text, std::streamsize size) {
+    buf.write(text, size);
+};
+
+template <std::ranges::forward_range R>
+constexpr auto joined_size(const R& list, std::string_view delim = ",") {
+    std::size_t total{0}, count{0};
     for (const auto& str : list) {
-        result = result + separator + str;
+        total += to_string_view(str).size();
+        ++count;
+    }
+    return count ? total + (count - 1) * delim.size() : 0;
+}
+
+template <std::output_iterator<char> Out, std::ranges::input_range R>
+constexpr auto join_to(Out out, const R& list, std::string_view delim = ",") -> Out {
+    std::string_view separator{};
+    for (const auto& str : list) {
+        out = std::ranges::copy(separator, out).out;
+        out = std::ranges::copy(to_string_view(str), out).out;
+        separator = delim;
+    }
+    return out;
+}
+
+// Appends to a string, stringbuf, or anything else with append, reserving
+// the exact total first when the buffer can grow. A stringbuf throws range
+// once it is full.
+template <append_buffer B, std::ranges::input_range R>
+constexpr auto join_to(B& buf, const R& list, std::string_view delim = ",") -> B& {
+    if constexpr (std::ranges::forward_range<R> && requires { buf.reserve(std::size_t{}); })
+        buf.reserve(buf.size() + joined_size(list, delim));
+    std::string_view separator{};
+    for (const auto& str : list) {
+        if (!separator.empty())
+            buf.append(separator);
+        buf.append(to_string_view(str));
+        separator = delim;
+    }
+    return buf;
+}
+
+// Writes to an output stream such as a format_buffer.
+template <write_buffer B, std::ranges::input_range R>
+inline auto join_to(B& buf, const R& list, std::string_view delim = ",") -> B& {
+    std::string_view separator{};
+    for (const auto& str : list) {
+        auto text = to_string_view(str);
+        buf.write(separator.data(), std::streamsize(separator.size()));
+        buf.write(text.data(), std::streamsize(text.size()));
         separator = delim;
     }
+    return buf;
+}
+
+template <typename S = std::string>
+constexpr auto join(const std::vector<S>& list, std::string_view delim = ",") {
+    static_assert(is_string_type_v<S>, "S must be a string type");
+    using result_t = std::conditional_t<append_buffer<S> && std::is_default_constructible_v<S>, S, std::string>;
+    result_t result;
+    join_to(result, list, delim);
     return result;
 }
 
 template <typename S = std::string>
 inline auto tokenize(const S& from, std::string_view delim = " ", std::string_view quotes = R"(""''{})") {
     static_assert(is_string_vector_v<S>, "S must be a string vector type");
-    auto str = to_string_view(from);
     std::vector<S> result;
-    auto current = str.find_first_of(delim);
-    auto prev = str.find_first_not_of(delim);
-    if (prev == std::string_view::npos)
-        prev = 0;
-
-    while (current != std::string_view::npos) {
-        auto lead = quotes.find_first_of(str[prev]);
-        if (lead != std::string_view::npos) {
-            auto tail = str.find_first_of(quotes[lead + 1], prev + 1);
-            if (tail != std::string_view::npos) {
-                current = tail;
-                result.emplace_back(str.substr(prev, current - prev + 1));
-                goto finish; // NOLINT
-            }
-        }
-        result.emplace_back(str.substr(prev, current - prev));
-    finish:
-        prev = str.find_first_not_of(delim, ++current);
-        if (prev == std::string_view::npos)
-            prev = current;
-        current = str.find_first_of(delim, prev);
-    }
-    if (prev < str.size())
-        result.emplace_back(str.substr(prev));
+    for (auto token : tokenize_view(to_string_view(from), delim, quotes))
+        result.emplace_back(token);
     return result;
 }
 
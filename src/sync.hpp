@@ -5,21 +5,121 @@
 
 #include "threads.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <semaphore>
 #include <barrier>
 
+#if defined(__linux__) && __has_include(<linux/futex.h>)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <unistd.h>
+#define BUSUTO_FUTEX
+#endif
+
 namespace busuto::sync {
 using duration = std::chrono::milliseconds;
 
+// Sleeps while a 32 bit word holds a value, until woken. A timed wait is
+// false once the deadline has passed. Waits can also return spuriously.
+inline void wait_word(std::atomic<uint32_t>& word, uint32_t value) noexcept {
+#ifdef BUSUTO_FUTEX
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+    word.wait(value, std::memory_order_acquire);
+#endif
+}
+
+inline auto wait_word(std::atomic<uint32_t>& word, uint32_t value, const timepoint_t& deadline) noexcept -> bool {
+    const auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= left.zero()) return false;
+#ifdef BUSUTO_FUTEX
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    struct timespec when{};
+    when.tv_sec = time_t(ns / 1000000000);
+    when.tv_nsec = long(ns % 1000000000);
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_BITSET_PRIVATE, value, &when, nullptr, FUTEX_BITSET_MATCH_ANY);
+#else
+    if (word.load(std::memory_order_acquire) == value)
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(left, std::chrono::milliseconds(1)));
+#endif
+    return true;
+}
+
+inline void wake_word(std::atomic<uint32_t>& word, bool all = true) noexcept {
+#ifdef BUSUTO_FUTEX
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, nullptr, nullptr, 0);
+#else
+    if (all)
+        word.notify_all();
+    else
+        word.notify_one();
+#endif
+}
+
+// Reusable barrier for a fixed party of threads. Arrivals are one atomic
+// decrement, and only the last arrival of a phase that has threads waiting
+// makes a syscall to wake them.
+class barrier final {
+public:
+    using arrival_token = uint32_t;
+
+    explicit barrier(std::ptrdiff_t count, std::function<void()> completion = {}) : completion_(std::move(completion)), expected_(count), remaining_(count) {}
+
+    barrier(const barrier&) = delete;
+    auto operator=(const barrier&) -> barrier& = delete;
+
+    [[nodiscard]] auto arrive(std::ptrdiff_t count = 1) -> arrival_token {
+        const auto phase = phase_.load(std::memory_order_acquire);
+        if (remaining_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+            if (completion_) completion_();
+            remaining_.store(expected_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            phase_.fetch_add(1, std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_seq_cst))
+                wake_word(phase_);
+        }
+        return phase;
+    }
+
+    void wait(arrival_token phase) const {
+        if (phase_.load(std::memory_order_acquire) != phase) return;
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        while (phase_.load(std::memory_order_seq_cst) == phase)
+            wait_word(phase_, phase);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void arrive_and_wait() {
+        wait(arrive());
+    }
+
+    // Leaves the party for this and every later phase.
+    void arrive_and_drop() {
+        expected_.fetch_sub(1, std::memory_order_relaxed);
+        (void)arrive();
+    }
+
+private:
+    std::function<void()> completion_;
+    std::atomic<std::ptrdiff_t> expected_;
+    std::atomic<std::ptrdiff_t> remaining_;
+    mutable std::atomic<uint32_t> phase_{0};
+    mutable std::atomic<uint32_t> waiters_{0};
+};
+
 template <std::ptrdiff_t Value>
 using semaphore = std::counting_semaphore<Value>;
 
+// Scope for a std::barrier with the given completion, or for a
+// sync::barrier, with either found from the constructor argument.
 template <typename Completion = void (*)()>
 class barrier_scope final {
 public:
-    explicit barrier_scope(std::barrier<Completion>& barrier)
-    requires std::invocable<Completion>
-        : barrier_(&barrier) {}
+    using barrier_type = std::conditional_t<std::is_same_v<Completion, barrier>, barrier, std::barrier<Completion>>;
+
+    explicit barrier_scope(barrier_type& barrier) : barrier_(&barrier) {}
 
     barrier_scope(barrier_scope&& other) noexcept : barrier_(std::exchange(other.barrier_, nullptr)), dropped_(std::exchange(other.dropped_, true)), waited_(std::exchange(other.waited_, true)) {}
 
@@ -56,33 +156,49 @@ public:
     auto operator=(const barrier_scope&) -> barrier_scope& = delete;
 
 private:
-    std::barrier<Completion> *barrier_{nullptr};
+    barrier_type *barrier_{nullptr};
     bool dropped_{false};
     bool waited_{false};
 };
 
+template <typename Completion>
+barrier_scope(std::barrier<Completion>&) -> barrier_scope<Completion>;
+barrier_scope(barrier&) -> barrier_scope<barrier>;
+
+// Auto reset event shared by copies. Signal is one atomic or, and makes a
+// syscall only if a thread is waiting.
 class event final {
 public:
-    explicit event() : bin_(std::make_shared<std::binary_semaphore>(0)) {}
+    explicit event() : state_(std::make_shared<std::atomic<uint32_t>>(0)) {}
 
     void wait() {
-        bin_->acquire();
+        while (!try_wait())
+            sleep(nullptr);
     }
 
     void signal() {
-        bin_->release();
+        if (state_->fetch_or(signaled, std::memory_order_release) >= waiter)
+            wake_word(*state_, false);
     }
 
     auto wait_for(const duration& rel_time) {
-        return bin_->try_acquire_for(rel_time);
+        return wait_until(std::chrono::steady_clock::now() + rel_time);
     }
 
-    auto wait_until(const timepoint_t& abs_time) {
-        return bin_->try_acquire_until(abs_time);
+    auto wait_until(const timepoint_t& abs_time) -> bool {
+        while (!try_wait()) {
+            if (!sleep(&abs_time)) return try_wait();
+        }
+        return true;
     }
 
-    auto try_wait() {
-        return bin_->try_acquire();
+    auto try_wait() -> bool {
+        auto state = state_->load(std::memory_order_relaxed);
+        while (state & signaled) {
+            if (state_->compare_exchange_weak(state, state & ~signaled, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
     }
 
     event(const event&) = default;
@@ -91,7 +207,19 @@ public:
     auto operator=(event&&) noexcept -> event& = default;
 
 private:
-    std::shared_ptr<std::binary_semaphore> bin_;
+    static constexpr uint32_t signaled = 1;
+    static constexpr uint32_t waiter = 2; // count of waiters above the flag
+
+    std::shared_ptr<std::atomic<uint32_t>> state_;
+
+    auto sleep(const timepoint_t *deadline) -> bool {
+        const auto state = state_->fetch_add(waiter, std::memory_order_seq_cst) + waiter;
+        auto result = true;
+        if (!(state & signaled))
+            result = deadline ? wait_word(*state_, state, *deadline) : (wait_word(*state_, state), true);
+        state_->fetch_sub(waiter, std::memory_order_relaxed);
+        return result;
+    }
 };
 
 template <std::ptrdiff_t Value>
@@ -126,9 +254,12 @@ private:
     semaphore<Value> *sem_{nullptr};
 };
 
+// Counts outstanding work with a single atomic word. Add and release take
+// no lock, and releasing the last count makes a syscall only if a thread is
+// waiting.
 class wait_group final {
 public:
-    explicit wait_group(unsigned init = 0) noexcept : count_(init) {}
+    explicit wait_group(unsigned init = 0) noexcept : state_(init & counts) {}
 
     wait_group(const wait_group&) = delete;
     auto operator=(const wait_group&) -> wait_group& = delete;
@@ -150,44 +281,59 @@ public:
     }
 
     void add(unsigned count) noexcept {
-        const std::lock_guard<std::mutex> lock(lock_);
-        count_ += count;
+        state_.fetch_add(count & counts, std::memory_order_relaxed);
     }
 
     auto release() noexcept {
-        const std::lock_guard<std::mutex> lock(lock_);
-        if (count_ == 0) return true;
-        if (--count_ == 0) {
-            cond_.notify_all();
-            return true;
+        auto state = state_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (!(state & counts)) return true;
+            const auto next = (state & counts) == 1 ? 0 : state - 1;
+            if (state_.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                if (next) return false;
+                if (state & waiting)
+                    wake_word(state_);
+                return true;
+            }
         }
-        return false;
     }
 
     void wait() noexcept {
-        std::unique_lock<std::mutex> lock(lock_);
-        cond_.wait(lock, [this] { return count_ == 0; });
+        for (auto state = state_.load(std::memory_order_acquire); state & counts; state = state_.load(std::memory_order_acquire)) {
+            if (prepare(state))
+                wait_word(state_, state);
+        }
     }
 
     auto wait_for(std::chrono::milliseconds timeout) noexcept {
-        std::unique_lock<std::mutex> lock(lock_);
-        return cond_.wait_for(lock, timeout, [this] { return count_ == 0; });
+        return wait_until(std::chrono::steady_clock::now() + timeout);
     }
 
-    auto wait_until(std::chrono::steady_clock::time_point tp) noexcept {
-        std::unique_lock<std::mutex> lock(lock_);
-        return cond_.wait_until(lock, tp, [this] { return count_ == 0; });
+    auto wait_until(std::chrono::steady_clock::time_point tp) noexcept -> bool {
+        for (auto state = state_.load(std::memory_order_acquire); state & counts; state = state_.load(std::memory_order_acquire)) {
+            if (prepare(state) && !wait_word(state_, state, tp))
+                return !(state_.load(std::memory_order_acquire) & counts);
+        }
+        return true;
     }
 
     auto count() const noexcept {
-        const std::lock_guard<std::mutex> lock(lock_);
-        return count_;
+        return unsigned(state_.load(std::memory_order_relaxed) & counts);
     }
 
 private:
-    unsigned count_{0};
-    mutable std::mutex lock_;
-    std::condition_variable cond_;
+    static constexpr uint32_t waiting = 0x80000000U;
+    static constexpr uint32_t counts = ~waiting;
+
+    std::atomic<uint32_t> state_{0};
+
+    // Marks the group as having a waiter before sleeping on state.
+    auto prepare(uint32_t& state) noexcept -> bool {
+        if (state & waiting) return true;
+        if (!state_.compare_exchange_strong(state, state | waiting, std::memory_order_acq_rel)) return false;
+        state |= waiting;
+        return true;
+    }
 };
 
 class group_scope final {
@@ -3,11 +3,53 @@
 
 #include "system.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 using namespace busuto;
 
+namespace {
+enum : int32_t { SPAWNED = 0, EXITED = 1 };
+
+struct request_t {
+    uint32_t args{0};
+    uint32_t env{0};
+    uint32_t fds{0};
+    int32_t targets[zygote_t::max_redirect]{};
+};
+
+void close_from(int fd) noexcept {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 34)
+    if (!::close_range(unsigned(fd), ~0U, 0)) return;
+#elif defined(__FreeBSD__)
+    ::closefrom(fd);
+    return;
+#endif
+    const auto last = std::min(::sysconf(_SC_OPEN_MAX), 65536L);
+    for (; fd < last; ++fd)
+        ::close(fd);
+}
+
+auto next_string(const char *& text, const char *end, std::string& out) -> bool {
+    const auto *at = static_cast<const char *>(std::memchr(text, 0, std::size_t(end - text)));
+    if (!at) return false;
+    out.assign(text, at);
+    text = at + 1;
+    return true;
+}
+
+void report(int fd, int32_t kind, int32_t pid, int32_t value) noexcept {
+    const int32_t message[3] = {kind, pid, value};
+    while (::send(fd, message, sizeof(message), MSG_NOSIGNAL) < 0 && errno == EINTR) {}
+}
+} // end namespace
+
 auto system::is_dir(const std::string& path) noexcept -> bool {
     struct stat ino{};
     if (stat(path.c_str(), &ino))
@@ -110,3 +152,299 @@ void busuto::handle_t::close() noexcept {
         exit_(handle);
     }
 }
+
+auto busuto::spawn_t::run(const system::args_t& args, std::string argv0, const system::args_t& env) const -> pid_t {
+    if (error_) {
+        errno = error_;
+        return -1;
+    }
+    if (args.empty()) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (argv0.empty())
+        argv0 = args[0];
+    auto argv = system::make_argv(args);
+    std::unique_ptr<char *[]> envp;
+    if (!env.empty())
+        envp = system::make_argv(env);
+    pid_t pid{-1};
+    const auto result = posix_spawnp(&pid, argv0.c_str(), &actions_, &attr_, argv.get(), envp ? envp.get() : environ);
+    if (result) {
+        errno = result;
+        return -1;
+    }
+    return pid;
+}
+
+busuto::zygote_t::zygote_t() {
+    int pair[2]{-1, -1};
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair))
+        throw std::system_error(errno, std::generic_category(), "zygote socket");
+    helper_ = ::fork();
+    if (helper_ < 0) {
+        const auto err = errno;
+        ::close(pair[0]);
+        ::close(pair[1]);
+        throw std::system_error(err, std::generic_category(), "zygote fork");
+    }
+    if (!helper_) {
+        ::close(pair[0]);
+        serve(pair[1]);
+    }
+    ::close(pair[1]);
+    socket_ = pair[0];
+}
+
+busuto::zygote_t::~zygote_t() {
+    // the helper exits when it sees the socket close
+    if (socket_ > -1) ::close(socket_);
+    if (helper_ > 0) {
+        while (::waitpid(helper_, nullptr, 0) < 0 && errno == EINTR) {}
+    }
+}
+
+auto busuto::zygote_t::spawn(const system::args_t& args, redirect_t redirect, std::string argv0, const system::args_t& env) -> pid_t {
+    if (socket_ < 0) {
+        errno = EBADF;
+        return -1;
+    }
+    if (args.empty() || redirect.size() > max_redirect) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    request_t head;
+    head.args = uint32_t(args.size());
+    head.env = uint32_t(env.size());
+    head.fds = uint32_t(redirect.size());
+    int fds[max_redirect]{};
+    for (std::size_t pos{0}; const auto& [target, from] : redirect) {
+        if (from < 0) {
+            errno = EBADF;
+            return -1;
+        }
+        head.targets[pos] = target;
+        fds[pos++] = from;
+    }
+
+    std::string body(reinterpret_cast<const char *>(&head), sizeof(head));
+    body.append(argv0.empty() ? args[0] : argv0).push_back(0);
+    for (const auto& arg : args)
+        body.append(arg).push_back(0);
+    for (const auto& var : env)
+        body.append(var).push_back(0);
+    if (body.size() > max_request) {
+        errno = E2BIG;
+        return -1;
+    }
+
+    struct iovec iov = {.iov_base = body.data(), .iov_len = body.size()};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(fds))]{};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (head.fds) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * head.fds);
+        auto *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * head.fds);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * head.fds);
+    }
+
+    // the reply is read under the lock, so no waiter takes it, and exits
+    // read on the way are passed on to waiters
+    const std::lock_guard lock(lock_);
+    while (::sendmsg(socket_, &msg, MSG_NOSIGNAL) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    auto filed = false;
+    const auto passed = [&] {
+        if (!filed) return;
+        if (polling_) wakeup_.signal();
+        cond_.notify_all();
+    };
+    for (;;) {
+        report_t report;
+        if (!receive(report, -1)) {
+            const auto err = errno;
+            passed();
+            errno = err;
+            return -1;
+        }
+        if (report.kind == EXITED) {
+            exits_[report.pid] = report.value;
+            filed = true;
+            continue;
+        }
+        passed();
+        if (report.pid < 0) errno = report.value;
+        return report.pid;
+    }
+}
+
+auto busuto::zygote_t::wait(pid_t pid, int timeout) -> int {
+    const auto deadline = system::steady_time() + std::chrono::milliseconds(std::max(timeout, 0));
+    std::unique_lock lock(lock_);
+    for (;;) {
+        report_t report;
+        auto filed = false;
+        while (receive(report, 0)) {
+            if (report.kind == EXITED) {
+                exits_[report.pid] = report.value;
+                filed = true;
+            }
+        }
+        const auto closed = errno == EPIPE;
+        if (filed) cond_.notify_all();
+        auto found = exits_.find(pid);
+        if (found != exits_.end()) {
+            const auto status = found->second;
+            exits_.erase(found);
+            return status;
+        }
+        if (closed || socket_ < 0) {
+            errno = ECHILD;
+            return -1;
+        }
+
+        const auto remaining = timeout < 0 ? -1 : system::get_timeout(deadline);
+        if (timeout >= 0 && !remaining) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+
+        // another waiter is polling, and wakes us when it files exits
+        if (polling_) {
+            if (timeout < 0)
+                cond_.wait(lock);
+            else
+                cond_.wait_until(lock, deadline);
+            continue;
+        }
+
+        // poll without the lock, so spawns go on while waiting
+        polling_ = true;
+        lock.unlock();
+        struct pollfd pfd[2] = {{.fd = socket_, .events = POLLIN, .revents = 0}, {.fd = wakeup_.handle(), .events = POLLIN, .revents = 0}};
+        ::poll(pfd, 2, remaining);
+        lock.lock();
+        if (pfd[1].revents)
+            wakeup_.clear();
+        polling_ = false;
+        cond_.notify_all();
+    }
+}
+
+auto busuto::zygote_t::receive(report_t& report, int timeout) -> bool {
+    if (timeout) {
+        struct pollfd pfd = {.fd = socket_, .events = POLLIN, .revents = 0};
+        const auto result = ::poll(&pfd, 1, timeout);
+        if (result < 0) return false;
+        if (!result) {
+            errno = EAGAIN;
+            return false;
+        }
+    }
+    for (;;) {
+        const auto got = ::recv(socket_, &report, sizeof(report), MSG_DONTWAIT);
+        if (got < 0 && errno == EINTR) continue;
+        if (!got) errno = EPIPE;
+        return got == sizeof(report);
+    }
+}
+
+// Runs in the helper. Only async signal safe calls are certain after a fork
+// from threads, which is why the helper should be made before any start.
+void busuto::zygote_t::serve(int fd) {
+    if (fd != 3) {
+        ::dup2(fd, 3);
+        fd = 3;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    close_from(4);
+
+    // children are reaped when sigchld interrupts the wait for requests
+    sigset_t block, wake;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    ::sigprocmask(SIG_BLOCK, &block, &wake);
+    sigdelset(&wake, SIGCHLD);
+    struct sigaction act{};
+    act.sa_handler = [](int) {};
+    ::sigaction(SIGCHLD, &act, nullptr);
+
+    std::vector<char> buf(max_request);
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_redirect)];
+    for (;;) {
+        struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+        const auto ready = ::ppoll(&pfd, 1, nullptr, &wake);
+        int status{0};
+        pid_t child{-1};
+        while ((child = ::waitpid(-1, &status, WNOHANG)) > 0)
+            report(fd, EXITED, child, status);
+        if (ready < 1) continue;
+        if (!(pfd.revents & POLLIN)) ::_exit(0);
+
+        struct iovec iov = {.iov_base = buf.data(), .iov_len = buf.size()};
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        const auto got = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) ::_exit(0);
+
+        int fds[max_redirect]{};
+        std::size_t count{0};
+        for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            const auto more = std::min((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int), max_redirect - count);
+            std::memcpy(fds + count, CMSG_DATA(cmsg), more * sizeof(int));
+            count += more;
+        }
+
+        request_t head;
+        auto valid = std::size_t(got) >= sizeof(head);
+        if (valid) std::memcpy(&head, buf.data(), sizeof(head));
+        valid = valid && head.fds == count;
+
+        // passed descriptors move above every target, so no dup2 onto a
+        // target closes one that is still to be used
+        auto floor = 4;
+        for (std::size_t pos = 0; valid && pos < count; ++pos)
+            floor = std::max(floor, head.targets[pos] + 1);
+        for (std::size_t pos = 0; valid && pos < count; ++pos) {
+            if (fds[pos] >= floor) continue;
+            const auto moved = ::fcntl(fds[pos], F_DUPFD_CLOEXEC, floor);
+            ::close(std::exchange(fds[pos], moved));
+        }
+
+        std::string argv0;
+        system::args_t args, env;
+        const auto *text = buf.data() + sizeof(head);
+        const auto *end = buf.data() + got;
+        valid = valid && next_string(text, end, argv0);
+        for (uint32_t pos = 0; valid && pos < head.args; ++pos)
+            valid = next_string(text, end, args.emplace_back());
+        for (uint32_t pos = 0; valid && pos < head.env; ++pos)
+            valid = next_string(text, end, env.emplace_back());
+
+        pid_t pid{-1};
+        auto err = EINVAL;
+        if (valid) {
+            spawn_t spawn;
+            spawn.defaults();
+            for (std::size_t pos = 0; pos < count; ++pos)
+                spawn.redirect(head.targets[pos], fds[pos]);
+            pid = spawn.run(args, argv0, env);
+            err = errno;
+        }
+        for (std::size_t pos = 0; pos < count; ++pos)
+            ::close(fds[pos]);
+        report(fd, SPAWNED, pid, pid < 0 ? err : 0);
+    }
+}
@@ -8,6 +8,12 @@
 #include <chrono>
 #include <string>
 #include <memory>
+#include <vector>
+#include <initializer_list>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <csignal>
 #include <ctime>
 
@@ -17,6 +23,7 @@
 #include <sys/time.h>
 #include <termios.h>
 #include <poll.h>
+#include <spawn.h>
 
 #if __has_include(<sys/eventfd.h>)
 #include <sys/eventfd.h>
@@ -108,7 +115,7 @@ inline auto make_argv(const args_t& args) {
     auto argv = std::make_unique<char *[]>(args.size() + 1);
     for (auto pos = 0U; pos < args.size(); ++pos)
         argv[pos] = const_cast<char *>(args[pos].c_str());
-    argv[args.size() + 1] = nullptr;
+    argv[args.size()] = nullptr;
     return argv;
 }
 
@@ -274,6 +281,158 @@ inline auto at_spawn(const system::args_t& args, std::string argv0, const system
     return child;
 }
 
+// Child setup for spawning without fork. Posix spawn starts the child with
+// vfork semantics, sharing memory until exec, so starting one costs the same
+// however large the parent is. File actions, such as stdio redirection onto
+// a handle, are made in order in the child before exec. An action that
+// fails to queue is kept as the error, and run then fails with it.
+class spawn_t final {
+public:
+    spawn_t() noexcept {
+        posix_spawn_file_actions_init(&actions_);
+        posix_spawnattr_init(&attr_);
+    }
+
+    ~spawn_t() {
+        posix_spawn_file_actions_destroy(&actions_);
+        posix_spawnattr_destroy(&attr_);
+    }
+
+    spawn_t(const spawn_t&) = delete;
+    auto operator=(const spawn_t&) -> spawn_t& = delete;
+
+    explicit operator bool() const noexcept { return error_ == 0; }
+    auto operator!() const noexcept { return error_ != 0; }
+    auto error() const noexcept { return error_; }
+
+    // Child descriptor fd becomes a duplicate of the handle.
+    auto redirect(int fd, const handle_t& to) noexcept -> spawn_t& {
+        return redirect(fd, to.get());
+    }
+
+    auto redirect(int fd, int from) noexcept -> spawn_t& {
+        if (from < 0) return status(EBADF);
+        return status(posix_spawn_file_actions_adddup2(&actions_, from, fd));
+    }
+
+    auto redirect(int fd, const std::string& path, int mode, int perms = 0664) noexcept -> spawn_t& {
+        return status(posix_spawn_file_actions_addopen(&actions_, fd, path.c_str(), mode, mode_t(perms)));
+    }
+
+    auto close(int fd) noexcept -> spawn_t& {
+        return status(posix_spawn_file_actions_addclose(&actions_, fd));
+    }
+
+    auto chdir(const std::string& dir) noexcept -> spawn_t& {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 29)
+        return status(posix_spawn_file_actions_addchdir_np(&actions_, dir.c_str()));
+#else
+        (void)dir;
+        return status(ENOSYS);
+#endif
+    }
+
+    // Default signal actions and an empty signal mask in the child.
+    auto defaults() noexcept -> spawn_t& {
+        sigset_t set;
+        sigfillset(&set);
+        posix_spawnattr_setsigdefault(&attr_, &set);
+        sigemptyset(&set);
+        posix_spawnattr_setsigmask(&attr_, &set);
+        return flags(POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+    }
+
+    auto group(pid_t pgid = 0) noexcept -> spawn_t& {
+        if (status(posix_spawnattr_setpgroup(&attr_, pgid)).error_) return *this;
+        return flags(POSIX_SPAWN_SETPGROUP);
+    }
+
+    // Child leads a new session, detached from the terminal.
+    auto detach() noexcept -> spawn_t& {
+#ifdef POSIX_SPAWN_SETSID
+        return flags(POSIX_SPAWN_SETSID);
+#else
+        return status(ENOSYS);
+#endif
+    }
+
+    // Child pid, or -1 with errno set.
+    auto run(const system::args_t& args, std::string argv0 = {}, const system::args_t& env = {}) const -> pid_t;
+
+private:
+    posix_spawn_file_actions_t actions_{};
+    posix_spawnattr_t attr_{};
+    short flags_{0};
+    int error_{0};
+
+    auto status(int error) noexcept -> spawn_t& {
+        if (error && !error_) error_ = error;
+        return *this;
+    }
+
+    auto flags(int flags) noexcept -> spawn_t& {
+        flags_ = short(flags_ | flags);
+        return status(posix_spawnattr_setflags(&attr_, flags_));
+    }
+};
+
+// Pre-forked helper that spawns children for the parent. Made early, while
+// the parent is small and has no threads, it keeps only stdio and its socket,
+// and forks nothing afterward, so each spawn costs the same however large the
+// parent later grows. Child descriptors are passed to it with each request,
+// and the exits of its children are reported back for wait. The handle is
+// readable when a report is pending.
+class zygote_t final {
+public:
+    using redirect_t = std::initializer_list<std::pair<int, int>>;
+
+    static constexpr std::size_t max_redirect = 16;
+    static constexpr std::size_t max_request = 65536;
+
+    zygote_t();
+    ~zygote_t();
+
+    zygote_t(const zygote_t&) = delete;
+    auto operator=(const zygote_t&) -> zygote_t& = delete;
+
+    explicit operator bool() const noexcept { return socket_ > -1; }
+    auto operator!() const noexcept { return socket_ < 0; }
+    auto handle() const noexcept { return socket_; }
+    auto pid() const noexcept { return helper_; }
+
+    // Each redirect is a child descriptor and the parent descriptor it
+    // becomes. A pid is returned, or -1 with errno set.
+    auto spawn(const system::args_t& args, redirect_t redirect = {}, std::string argv0 = {}, const system::args_t& env = {}) -> pid_t;
+
+    // Wait status of a child of the helper, or -1 with errno set to
+    // ETIMEDOUT when it has not exited in time.
+    auto wait(pid_t pid, int timeout = -1) -> int;
+
+private:
+    struct report_t {
+        int32_t kind{0};
+        int32_t pid{-1};
+        int32_t value{0};
+    };
+
+    // One waiter polls the socket at a time and the rest wait on cond_.
+    // A spawn that files exits while that waiter polls wakes it by wakeup_.
+    std::mutex lock_;
+    std::condition_variable cond_;
+    system::notify_t wakeup_;
+    std::unordered_map<pid_t, int> exits_;
+    bool polling_{false};
+    int socket_{-1};
+    pid_t helper_{-1};
+
+    auto receive(report_t& report, int timeout) -> bool;
+    [[noreturn]] static void serve(int fd);
+};
+
+inline auto at_spawn(const system::args_t& args, std::string argv0, const system::args_t& env, const spawn_t& spawn) {
+    return spawn.run(args, std::move(argv0), env);
+}
+
 inline auto make_handle(const std::string& path, int mode, int perms = 0664) {
     return handle_t(::open(path.c_str(), mode, perms));
 }
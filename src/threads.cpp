@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "threads.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__linux__) && __has_include(<linux/mempolicy.h>)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace busuto;
+
+namespace {
+// Parses a sysfs cpu list such as 0-3,8-11.
+auto parse_cpus(const std::string& list) {
+    thread::cpus_t cpus;
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        char *end{nullptr};
+        const auto first = std::strtoul(list.c_str() + pos, &end, 10);
+        auto last = first;
+        if (end == list.c_str() + pos) break;
+        pos = std::size_t(end - list.c_str());
+        if (pos < list.size() && list[pos] == '-') {
+            last = std::strtoul(list.c_str() + pos + 1, &end, 10);
+            pos = std::size_t(end - list.c_str());
+        }
+        for (auto cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(unsigned(cpu));
+        if (pos < list.size() && list[pos] == ',') ++pos;
+        else break;
+    }
+    return cpus;
+}
+
+auto allowed_cpus() {
+    thread::cpus_t cpus;
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (!sched_getaffinity(0, sizeof(set), &set)) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1U, std::thread::hardware_concurrency()); ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+auto detect() {
+    thread::topology_t topo;
+    const auto allowed = allowed_cpus();
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        const auto name = entry.path().filename().string();
+        if (name.size() < 5 || name.compare(0, 4, "node") || !std::isdigit(name[4])) continue;
+        std::ifstream file(entry.path() / "cpulist");
+        std::string list;
+        if (!std::getline(file, list)) continue;
+        thread::topology_t::node_t node{std::stoi(name.substr(4)), {}};
+        for (auto cpu : parse_cpus(list)) {
+            if (std::ranges::binary_search(allowed, cpu)) node.cpus.push_back(cpu);
+        }
+        if (!node.cpus.empty())
+            topo.nodes.push_back(std::move(node));
+    }
+
+    std::ranges::sort(topo.nodes, {}, &thread::topology_t::node_t::id);
+    if (topo.nodes.empty())
+        topo.nodes.push_back({0, allowed});
+    return topo;
+}
+} // end namespace
+
+auto this_thread::affinity(std::span<const unsigned> cpus) -> bool {
+#if defined(__linux__) && defined(CPU_SET)
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+auto this_thread::name(std::string_view id) -> bool {
+#if defined(__linux__) || defined(__GLIBC__)
+    char buf[16]{};
+    std::memcpy(buf, id.data(), std::min(id.size(), sizeof(buf) - 1));
+    return pthread_setname_np(pthread_self(), buf) == 0;
+#else
+    return false;
+#endif
+}
+
+auto this_thread::node(int id) -> bool {
+#if defined(__linux__) && __has_include(<linux/mempolicy.h>)
+    constexpr auto bits = sizeof(unsigned long) * 8;
+    if (id < 0 || unsigned(id) >= bits * 16) return false;
+    unsigned long mask[16]{};
+    mask[unsigned(id) / bits] = 1UL << (unsigned(id) % bits);
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, (unsigned(id) / bits + 1) * bits) == 0;
+#else
+    return false;
+#endif
+}
+
+auto thread::topology() -> const topology_t& {
+    static const auto topo = detect();
+    return topo;
+}
+
+auto thread::topology_t::spread() const -> cpus_t {
+    cpus_t cpus;
+    for (std::size_t pos = 0;; ++pos) {
+        const auto size = cpus.size();
+        for (const auto& node : nodes) {
+            if (pos < node.cpus.size()) cpus.push_back(node.cpus[pos]);
+        }
+        if (cpus.size() == size) return cpus;
+    }
+}
+
+auto thread::placement_t::select(std::size_t worker) const -> cpus_t {
+    if (!cpus.empty()) return cpus[worker % cpus.size()];
+    if (!topology && node < 0) return {};
+
+    const auto& topo = thread::topology();
+    const auto *local = node >= 0 ? topo.find(node) : nullptr;
+    if (!topology) return local ? local->cpus : cpus_t{};
+
+    const auto list = local ? local->cpus : topo.spread();
+    if (list.empty()) return {};
+    return {list[worker % list.size()]};
+}
+
+auto thread::placement_t::apply(std::size_t worker, std::size_t count) const -> bool {
+    auto result = true;
+    if (!name.empty()) {
+        if (count > 1) {
+            const auto number = std::to_string(worker);
+            result = this_thread::name(name.substr(0, 15 - std::min(number.size(), std::size_t(15))) + number);
+        } else
+            result = this_thread::name(name);
+    }
+
+    const auto set = select(worker);
+    if (!set.empty() && !this_thread::affinity(set))
+        result = false;
+
+    // bound after pinning so the thread's first touches are already local
+    if (node >= 0 && !this_thread::node(node))
+        result = false;
+    return result;
+}
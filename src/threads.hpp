@@ -10,6 +10,10 @@
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <cstring>
 
 #include <sched.h>
@@ -44,6 +48,28 @@ inline auto priority(int priority) -> int {
     return pthread_setschedparam(tid, policy, &sp) == 0;
 }
 
+// Pins the calling thread to one cpu, wrapping past the cpus present.
+inline auto affinity(unsigned cpu) -> bool {
+#if defined(__linux__) && defined(CPU_SET)
+    const auto cpus = std::max(1U, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// Limits the calling thread to a set of cpus.
+auto affinity(std::span<const unsigned> cpus) -> bool;
+
+// Names the calling thread for top and perf, truncated to 15 characters.
+auto name(std::string_view id) -> bool;
+
+// Prefers memory from one numa node for what the calling thread allocates.
+auto node(int id) -> bool;
+
 inline void sleep(unsigned msec) {
     sleep_for(std::chrono::milliseconds(msec));
 }
@@ -56,6 +82,53 @@ inline auto concurrency(unsigned count) {
     return std::min(count, std::thread::hardware_concurrency());
 }
 
+using cpus_t = std::vector<unsigned>;
+
+// Cpus the process may run on, grouped by numa node. Without numa support
+// this is one node holding every allowed cpu.
+struct topology_t {
+    struct node_t {
+        int id{0};
+        cpus_t cpus;
+    };
+
+    std::vector<node_t> nodes;
+
+    auto find(int id) const noexcept -> const node_t * {
+        for (const auto& node : nodes) {
+            if (node.id == id) return &node;
+        }
+        return nullptr;
+    }
+
+    // Every cpu, taking one from each node in turn.
+    auto spread() const -> cpus_t;
+};
+
+auto topology() -> const topology_t&;
+
+// Where a service thread runs and what it is called. Worker n uses cpu set
+// n of cpus, wrapping around. With topology, each worker is pinned to one
+// cpu instead, spread across nodes or taken from the given node. A node
+// alone allows any of its cpus. With a node, memory allocated by the
+// thread is preferred from that node.
+struct placement_t {
+    std::string name;
+    std::vector<cpus_t> cpus;
+    int node{-1};
+    bool topology{false};
+
+    explicit operator bool() const noexcept { return !name.empty() || !cpus.empty() || node >= 0 || topology; }
+    auto operator!() const noexcept { return !bool(*this); }
+
+    // Cpus for a worker, or empty if not placed.
+    auto select(std::size_t worker) const -> cpus_t;
+
+    // Places the calling thread as one of count workers, adding the worker
+    // number to the name when there is more than one.
+    auto apply(std::size_t worker = 0, std::size_t count = 1) const -> bool;
+};
+
 template <typename Func, typename... Args>
 requires std::invocable<Func, Args...>
 inline void parallel_func(std::size_t count, Func&& func, Args&&...args) {
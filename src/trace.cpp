@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#include "trace.hpp"
+#include "atomic.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#ifndef BUSUTO_NO_TRACE
+using namespace busuto;
+
+namespace {
+struct ring_t {
+    atomic::buffer_t<trace::event_t, BUSUTO_TRACE_EVENTS> events;
+    std::atomic_flag reading;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> alive{true};
+    int tid{0};
+    std::string name;
+};
+
+struct registry_t {
+    std::mutex lock;
+    std::vector<std::shared_ptr<ring_t>> rings;
+    uint64_t retired{0}; // dropped by rings already removed
+    int next{0};
+};
+
+// never destroyed, so threads still running at exit can record
+auto registry() -> registry_t& {
+    static auto *rings = new registry_t;
+    return *rings;
+}
+
+struct local_t {
+    std::shared_ptr<ring_t> ring;
+
+    ~local_t() {
+        if (ring) ring->alive.store(false, std::memory_order_release);
+    }
+};
+
+thread_local local_t local;
+std::atomic<system::notify_t *> signaled{nullptr};
+
+auto local_ring() noexcept -> ring_t * {
+    if (local.ring) return local.ring.get();
+    try {
+        auto ring = std::make_shared<ring_t>();
+#if defined(__linux__) || defined(__GLIBC__)
+        char name[16]{};
+        if (!pthread_getname_np(pthread_self(), name, sizeof(name))) ring->name = name;
+#endif
+        auto& reg = registry();
+        const std::lock_guard lock(reg.lock);
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 30)
+        ring->tid = int(::gettid());
+#else
+        ring->tid = ++reg.next;
+#endif
+        reg.rings.push_back(ring);
+        local.ring = std::move(ring);
+    } catch (...) {
+        return nullptr;
+    }
+    return local.ring.get();
+}
+
+void escape(std::string& into, std::string_view text) {
+    for (const auto ch : text) {
+        if (ch == '"' || ch == '\\') {
+            into += '\\';
+            into += ch;
+        } else if (uint8_t(ch) < 0x20)
+            std::format_to(std::back_inserter(into), "\\u{:04x}", unsigned(ch));
+        else
+            into += ch;
+    }
+}
+
+void on_signal(int /* signo */) {
+    if (auto *wakeup = signaled.load(); wakeup) wakeup->signal();
+}
+} // end namespace
+
+// The ring is read under its flag, so the owner only takes the oldest
+// event itself when the exporter is not reading.
+void trace::record(const event_t& event) noexcept {
+    auto *ring = local_ring();
+    if (!ring || ring->events.push(event)) return;
+    if (!ring->reading.test_and_set(std::memory_order_acquire)) {
+        event_t oldest;
+        ring->events.pull(oldest);
+        ring->reading.clear(std::memory_order_release);
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        if (ring->events.push(event)) return;
+    }
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void trace::thread_name(std::string_view name) {
+    auto *ring = local_ring();
+    if (!ring) return;
+    auto& reg = registry();
+    const std::lock_guard lock(reg.lock);
+    ring->name = name;
+}
+
+auto trace::dropped() noexcept -> uint64_t {
+    auto& reg = registry();
+    const std::lock_guard lock(reg.lock);
+    auto total = reg.retired;
+    for (const auto& ring : reg.rings)
+        total += ring->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+auto trace::write_json(std::ostream& out) -> std::size_t {
+    auto& reg = registry();
+    std::vector<std::shared_ptr<ring_t>> rings;
+    std::vector<std::string> names;
+    {
+        const std::lock_guard lock(reg.lock);
+        rings = reg.rings;
+        for (const auto& ring : rings)
+            names.push_back(ring->name);
+    }
+
+    const auto pid = int(::getpid());
+    std::size_t count{0};
+    std::string text;
+    std::vector<event_t> events;
+    events.reserve(BUSUTO_TRACE_EVENTS);
+    out << "{\"traceEvents\":[";
+    auto first = true;
+    auto next = [&] {
+        if (!first) text += ",\n";
+        first = false;
+    };
+    for (std::size_t pos = 0; pos < rings.size(); ++pos) {
+        auto& ring = *rings[pos];
+        while (ring.reading.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+        events.clear();
+        ring.events.pull_bulk(std::back_inserter(events), BUSUTO_TRACE_EVENTS);
+        ring.reading.clear(std::memory_order_release);
+
+        if (!names[pos].empty()) {
+            next();
+            std::format_to(std::back_inserter(text), R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},"args":{{"name":")", pid, ring.tid);
+            escape(text, names[pos]);
+            text += "\"}}";
+        }
+        for (const auto& event : events) {
+            next();
+            text += R"({"name":")";
+            escape(text, event.name ? event.name : "");
+            text += R"(","cat":")";
+            escape(text, event.category ? event.category : "");
+            const auto dur = event.end > event.begin ? event.end - event.begin : 0;
+            std::format_to(std::back_inserter(text), R"(","ph":"X","pid":{},"tid":{},"ts":{}.{:03},"dur":{}.{:03}}})", pid, ring.tid, event.begin / 1000, event.begin % 1000, dur / 1000, dur % 1000);
+            ++count;
+        }
+        out << text;
+        text.clear();
+    }
+    out << "],\"displayTimeUnit\":\"ns\"}\n";
+
+    // rings of threads that have exited go once emptied
+    const std::lock_guard lock(reg.lock);
+    std::erase_if(reg.rings, [&reg](const auto& ring) {
+        if (ring->alive.load(std::memory_order_acquire) || !ring->events.empty()) return false;
+        reg.retired += ring->dropped.load(std::memory_order_relaxed);
+        return true;
+    });
+    return count;
+}
+
+trace::exporter::exporter(int signo, std::string path) : signo_(signo), path_(std::move(path)) {
+    if (!wakeup_.is_open()) throw std::system_error(errno, std::generic_category(), "trace exporter");
+    system::notify_t *none{nullptr};
+    if (!signaled.compare_exchange_strong(none, &wakeup_))
+        throw std::system_error(EBUSY, std::generic_category(), "trace exporter");
+
+    struct sigaction act{};
+    act.sa_handler = on_signal;
+    act.sa_flags = SA_RESTART;
+    sigemptyset(&act.sa_mask);
+    if (::sigaction(signo_, &act, &previous_)) {
+        const auto err = errno;
+        signaled.store(nullptr);
+        throw std::system_error(err, std::generic_category(), "trace exporter");
+    }
+
+    enable();
+    thread_ = std::thread([this] {
+        while (!stop_.load()) {
+            if (!wakeup_.wait(-1)) {
+                if (!wakeup_.is_open()) break;
+                continue;
+            }
+            wakeup_.clear();
+            if (!stop_.load()) write();
+        }
+    });
+}
+
+trace::exporter::~exporter() {
+    enable(false);
+    ::sigaction(signo_, &previous_, nullptr);
+    signaled.store(nullptr);
+    stop_.store(true);
+    wakeup_.signal();
+    if (thread_.joinable()) thread_.join();
+}
+
+auto trace::exporter::write() const -> bool {
+    const std::lock_guard lock(lock_);
+    const auto temp = path_ + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out) return false;
+        write_json(out);
+        out.flush();
+        if (!out) return false;
+    }
+    if (std::rename(temp.c_str(), path_.c_str())) return false;
+    ++exports_;
+    return true;
+}
+#endif
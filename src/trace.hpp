@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#pragma once
+
+#include "system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#ifndef BUSUTO_TRACE_EVENTS
+#define BUSUTO_TRACE_EVENTS 4096 // NOLINT
+#endif
+
+#define BUSUTO_TRACE_JOIN(a, b) a##b
+#define BUSUTO_TRACE_NAME(a, b) BUSUTO_TRACE_JOIN(a, b)
+
+#ifdef BUSUTO_NO_TRACE
+#define BUSUTO_TRACE_SPAN(...) static_cast<void>(0)
+#else
+#define BUSUTO_TRACE_SPAN(...) const busuto::trace::span BUSUTO_TRACE_NAME(trace_span_, __LINE__)(__VA_ARGS__)
+#endif
+
+namespace busuto::trace {
+using clock_t = std::chrono::steady_clock;
+
+#ifdef BUSUTO_NO_TRACE
+inline constexpr bool compiled = false;
+#else
+inline constexpr bool compiled = true;
+#endif
+
+// A completed span. Names and categories are not copied, so they must
+// outlive the export, as string literals do.
+struct event_t {
+    const char *name{nullptr};
+    const char *category{nullptr};
+    uint64_t begin{0}; // nanoseconds of the steady clock
+    uint64_t end{0};
+};
+
+inline auto now() noexcept -> uint64_t {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now().time_since_epoch()).count());
+}
+
+#ifndef BUSUTO_NO_TRACE
+inline std::atomic<bool> active{false};
+
+inline auto enabled() noexcept {
+    return active.load(std::memory_order_relaxed);
+}
+
+inline void enable(bool on = true) noexcept {
+    active.store(on, std::memory_order_relaxed);
+}
+
+// Adds an event to the ring of the calling thread, which is made on first
+// use. A full ring drops its oldest event, so it holds recent history.
+void record(const event_t& event) noexcept;
+
+// Names the calling thread in exports.
+void thread_name(std::string_view name);
+
+// Writes and removes what the rings hold as Chrome trace event json, which
+// Perfetto also reads, and returns how many events were written.
+auto write_json(std::ostream& out) -> std::size_t;
+
+// Events lost because a ring filled before it was read.
+auto dropped() noexcept -> uint64_t;
+
+// Times the scope it lives in, while tracing is enabled. Being off costs a
+// relaxed load, and the span is compiled out with BUSUTO_NO_TRACE.
+class span final {
+public:
+    explicit span(const char *name, const char *category = "busuto") noexcept : name_(name), category_(category), begin_(enabled() ? now() : 0) {}
+
+    ~span() {
+        if (begin_) record({name_, category_, begin_, now()});
+    }
+
+    span(const span&) = delete;
+    auto operator=(const span&) -> span& = delete;
+
+private:
+    const char *name_;
+    const char *category_;
+    uint64_t begin_;
+};
+
+// Exports a trace to a file each time a signal arrives, for dumping from a
+// running service. The handler only wakes a writer thread, which writes a
+// temporary file and renames it over path. Tracing is enabled while it
+// exists, and the previous handler is restored when it goes.
+class exporter final {
+public:
+    exporter(int signo, std::string path);
+    ~exporter();
+
+    exporter(const exporter&) = delete;
+    auto operator=(const exporter&) -> exporter& = delete;
+
+    // Exports now, as the signal would, returning false if it failed.
+    auto write() const -> bool;
+
+    auto exports() const noexcept { return exports_.load(); }
+
+private:
+    int signo_;
+    std::string path_;
+    system::notify_t wakeup_;
+    struct sigaction previous_{};
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    mutable std::mutex lock_;
+    mutable std::atomic<unsigned> exports_{0};
+};
+#else
+inline constexpr auto enabled() noexcept { return false; }
+inline void enable(bool /* on */ = true) noexcept {}
+inline void record(const event_t& /* event */) noexcept {}
+inline void thread_name(std::string_view /* name */) {}
+inline auto dropped() noexcept -> uint64_t { return 0; }
+
+inline auto write_json(std::ostream& out) -> std::size_t {
+    out << "{\"traceEvents\":[]}\n";
+    return 0;
+}
+
+class span final {
+public:
+    explicit span(const char * /* name */, const char * /* category */ = "busuto") noexcept {}
+};
+
+class exporter final {
+public:
+    exporter(int /* signo */, std::string /* path */) noexcept {}
+    auto write() const noexcept { return false; }
+    auto exports() const noexcept { return 0U; }
+};
+#endif
+} // namespace busuto::trace
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "async.hpp"
+
+#include <cassert>
+#include <string>
+#include <sys/socket.h>
+
+using namespace busuto;
+
+namespace {
+int failed{0};
+
+auto square(int value) -> async::task<int> {
+    co_return value * value;
+}
+
+auto sum_squares(int count) -> async::task<int> {
+    int total{0};
+    for (int value = 1; value <= count; ++value)
+        total += co_await square(value);
+    co_return total;
+}
+
+auto failing() -> async::task<> {
+    throw range("failed");
+    co_return;
+}
+
+auto on_pool(service::pool& workers) -> async::task<std::thread::id> {
+    co_await async::resume_on(workers);
+    co_return std::this_thread::get_id();
+}
+
+auto echo(service::reactor& loop, int fd) -> async::task<std::string> {
+    std::string text;
+    char buf[16];
+    while (text.size() < 10) {
+        auto events = co_await async::readable(loop, fd, std::chrono::milliseconds(2000));
+        if (!(events & service::reactor::readable)) break;
+        ssize_t len{0};
+        while ((len = ::read(fd, buf, sizeof(buf))) > 0)
+            text.append(buf, std::size_t(len));
+    }
+    co_return text;
+}
+
+auto idle(service::reactor& loop, int fd) -> async::task<unsigned> {
+    co_return co_await async::readable(loop, fd, std::chrono::milliseconds(10));
+}
+
+auto nap(service::timer& timer, service::pool& workers) -> async::task<int> {
+    co_await async::sleep(timer, std::chrono::milliseconds(5));
+    co_await async::sleep(timer, std::chrono::milliseconds(5), workers);
+    co_return 2;
+}
+
+auto consume(service::reactor& loop, system::notify_pipeline<int, 4>& pipe) -> async::task<int> {
+    int total{0};
+    while (auto item = co_await async::pull(loop, pipe))
+        total += *item;
+    co_return total;
+}
+
+auto lookup(service::pool& workers) -> async::task<bool> {
+    auto found = co_await async::resolve(workers, {"127.0.0.1", "80"}, AF_INET);
+    co_return !found.empty() && found.front()->ai_family == AF_INET;
+}
+
+void test_async_task() {
+    assert(async::sync_wait(square(4)) == 16);
+    assert(async::sync_wait(sum_squares(4)) == 30);
+
+    auto count = 0;
+    try {
+        async::sync_wait(failing());
+    } catch (const range&) {
+        ++count;
+    }
+    assert(count == 1);
+
+    async::task<int> empty;
+    assert(!empty && empty.done());
+    auto pending = square(3);
+    assert(pending && !pending.done());
+    empty = std::move(pending);
+    assert(empty && !pending);
+    async::errors([](const std::exception& e) {
+        assert(dynamic_cast<const range *>(&e));
+        ++failed;
+    });
+    failing().detach();
+    assert(failed == 1);
+}
+
+void test_async_pool() {
+    service::pool workers(2);
+    assert(async::sync_wait(on_pool(workers)) != std::this_thread::get_id());
+    assert(async::sync_wait(lookup(workers)));
+
+    service::timer timer;
+    timer.startup();
+    const auto start = std::chrono::steady_clock::now();
+    assert(async::sync_wait(nap(timer, workers)) == 2);
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(10));
+    timer.shutdown();
+    workers.shutdown();
+}
+
+void test_async_reactor() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) == 0);
+    service::reactor loop;
+    loop.startup();
+
+    std::thread writer([&pair] {
+        assert(::write(pair[1], "hello", 5) == 5);
+        this_thread::sleep(5);
+        assert(::write(pair[1], "world", 5) == 5);
+    });
+    assert(async::sync_wait(echo(loop, pair[0])) == "helloworld");
+    writer.join();
+    assert(!loop.contains(pair[0]));
+    assert(async::sync_wait(idle(loop, pair[0])) == service::reactor::expired);
+
+    system::notify_pipeline<int, 4> pipe;
+    std::thread producer([&pipe] {
+        for (int value = 1; value <= 20; ++value)
+            pipe.push(value);
+        for (int wait = 0; wait < 200 && !pipe.empty(); ++wait)
+            this_thread::sleep(1);
+        pipe.close();
+    });
+    assert(async::sync_wait(consume(loop, pipe)) == 210);
+    producer.join();
+
+    loop.shutdown();
+    ::close(pair[0]);
+    ::close(pair[1]);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_async_task();
+        test_async_pool();
+        test_async_reactor();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
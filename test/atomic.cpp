@@ -5,6 +5,9 @@
 #include "atomic.hpp"
 
 #include <string>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <cassert>
 
 using namespace busuto;
@@ -39,6 +42,205 @@ void test_atomic_dictionary() {
         value = "two two";
     });
     assert(dict.find(2).value() == "two two"); // NOLINT
+    assert(dict[2] == "two two");
+}
+
+void test_atomic_dictionary_growth() {
+    atomic::dictionary_t<int, int> dict;
+    const auto initial = dict.buckets();
+    assert(dict.insert(-1, 0));
+    auto& kept = dict.at(-1);
+    for (int key = 0; key < 5000; ++key)
+        assert(dict.insert(key, key * 2));
+    assert(dict.size() == 5001);
+    assert(dict.buckets() > initial);
+    assert(&dict.at(-1) == &kept);
+    kept = 7;
+    assert(dict.find(-1) == 7);
+    assert(dict.remove(-1));
+    for (int key = 0; key < 5000; ++key)
+        assert(dict.find(key) == key * 2);
+
+    assert(!dict.try_emplace(10, 0));
+    dict.insert_or_assign(10, 11);
+    assert(dict.at(10) == 11);
+    for (int key = 0; key < 5000; key += 2)
+        assert(dict.remove(key));
+    assert(!dict.remove(0));
+    assert(dict.size() == 2500);
+    assert(dict.keys().size() == 2500);
+
+    // retired nodes are returned once no reader can still see them
+    assert(atomic::epoch::pending() > 0);
+    atomic::epoch::synchronize();
+    assert(atomic::epoch::pending() == 0);
+    dict.clear();
+    assert(dict.empty() && !dict.contains(1));
+}
+
+void test_atomic_dictionary_threads() {
+    atomic::dictionary_t<int, int> dict, other;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int id = 0; id < 2; ++id) {
+        readers.emplace_back([&] {
+            while (!done) {
+                for (int key = 0; key < 4000; key += 7) {
+                    auto value = dict.find(key);
+                    assert(!value || *value == key || *value == -key);
+                }
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        for (int key = 0; key < 4000; ++key)
+            dict.insert(key, key);
+        for (int key = 0; key < 4000; key += 3)
+            dict.insert_or_assign(key, -key);
+        for (int key = 0; key < 4000; key += 2)
+            dict.remove(key);
+    });
+
+    for (int key = 4000; key < 8000; ++key)
+        dict.emplace(int(key), int(key));
+    writer.join();
+
+    std::thread swapper([&] {
+        for (int count = 0; count < 1000; ++count)
+            other.swap(dict);
+    });
+    for (int count = 0; count < 1000; ++count)
+        dict.swap(other);
+    swapper.join();
+    done = true;
+    for (auto& thread : readers)
+        thread.join();
+    assert(dict.size() == 6000);
+    assert(dict.find(4001) == 4001 && dict.find(3) == -3 && !dict.contains(6));
+}
+
+void test_atomic_buffer() {
+    atomic::buffer_t<int, 4> buf;
+    assert(buf.push(1));
+    assert(buf.push(2));
+    assert(buf.push(3));
+    assert(buf.full());
+    int value{0};
+    assert(buf.pull(value) && value == 1);
+    assert(buf.pop() == 2);
+    assert(buf.push(4));
+    assert(buf.pop() == 3);
+    assert(buf.pop() == 4);
+    assert(buf.empty());
+
+    atomic::buffer_t<std::unique_ptr<int>, 8> ptrs;
+    std::unique_ptr<int> items[6];
+    for (int count = 0; count < 6; ++count)
+        items[count] = std::make_unique<int>(count);
+    assert(ptrs.push(std::make_unique<int>(-1)));
+    assert(ptrs.push_bulk(&items[0], 6) == 6);
+    assert(ptrs.full() && ptrs.size() == 7);
+    assert(ptrs.push_bulk(&items[0], 1) == 0);
+    assert(*ptrs.pop().value() == -1); // NOLINT
+
+    std::vector<std::unique_ptr<int>> out;
+    assert(ptrs.pull_bulk(std::back_inserter(out), 4) == 4);
+    assert(*out[0] == 0 && *out[3] == 3);
+    assert(ptrs.pull_bulk(std::back_inserter(out), 4) == 2);
+    assert(*out[5] == 5 && ptrs.empty());
+}
+
+void test_atomic_buffer_threads() {
+    constexpr std::size_t items = 20000;
+    atomic::buffer_t<std::size_t, 64> buf;
+    std::thread producer([&buf] {
+        std::size_t batch[5];
+        for (std::size_t value = 0; value < items;) {
+            std::size_t count = std::min<std::size_t>(5, items - value);
+            for (std::size_t pos = 0; pos < count; ++pos)
+                batch[pos] = value + pos;
+            auto sent = (value % 2) ? buf.push_bulk(&batch[0], count) : std::size_t(buf.push(value));
+            if (!sent) std::this_thread::yield();
+            value += sent;
+        }
+    });
+
+    std::size_t expect = 0, batch[7];
+    while (expect < items) {
+        auto count = buf.pull_bulk(&batch[0], 7);
+        if (!count) std::this_thread::yield();
+        for (std::size_t pos = 0; pos < count; ++pos)
+            assert(batch[pos] == expect++);
+    }
+    producer.join();
+    assert(buf.empty());
+}
+
+void test_atomic_queue() {
+    atomic::queue_t<std::unique_ptr<int>, 4> queue;
+    assert(queue.empty());
+    for (int count = 0; count < 4; ++count)
+        assert(queue.push(std::make_unique<int>(count)));
+    assert(queue.full());
+    assert(!queue.push(std::make_unique<int>(4)));
+
+    std::unique_ptr<int> item;
+    assert(queue.try_pop(item) && *item == 0);
+    assert(queue.push(std::make_unique<int>(4)));
+    assert(*queue.pop().value() == 1); // NOLINT
+    assert(queue.size() == 3);
+
+    std::vector<std::unique_ptr<int>> batch;
+    assert(queue.pop_n(std::back_inserter(batch), 8) == 3);
+    assert(*batch[0] == 2 && *batch[2] == 4);
+    assert(!queue.pop());
+    assert(queue.push_n(batch.begin(), batch.size()) == 3);
+    assert(queue.size() == 3);
+}
+
+void test_atomic_queue_threads() {
+    constexpr int producers = 3, items = 5000;
+    atomic::queue_t<int, 64> queue;
+    std::atomic<long> total{0};
+    std::atomic<int> taken{0};
+    std::vector<std::thread> threads;
+    for (int id = 0; id < producers; ++id) {
+        threads.emplace_back([&queue] {
+            for (int value = 1; value <= items;) {
+                if (value % 8 == 0) {
+                    int batch[4] = {value, value + 1, value + 2, value + 3};
+                    auto count = std::min(4, items - value + 1);
+                    auto sent = queue.push_n(&batch[0], std::size_t(count));
+                    value += int(sent);
+                } else if (queue.push(value))
+                    ++value;
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int id = 0; id < 2; ++id) {
+        threads.emplace_back([&] {
+            int batch[8];
+            while (taken.load() < producers * items) {
+                auto count = queue.pop_n(&batch[0], 8);
+                if (!count) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (std::size_t pos = 0; pos < count; ++pos)
+                    total += batch[pos];
+                taken += int(count);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+    assert(queue.empty());
+    assert(total == long(producers) * items * (items + 1) / 2);
 }
 } // namespace
 
@@ -47,6 +249,12 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_atomic_once();
         test_atomic_sequence();
         test_atomic_dictionary();
+        test_atomic_dictionary_growth();
+        test_atomic_dictionary_threads();
+        test_atomic_buffer();
+        test_atomic_buffer_threads();
+        test_atomic_queue();
+        test_atomic_queue_threads();
     } catch (...) {
         return -1;
     }
@@ -3,11 +3,20 @@
 
 #undef NDEBUG
 #include "binary.hpp"
+#include "buffer.hpp"
+#include "atomic.hpp"
 #include <cassert>
+#include <string>
+#include <utility>
+#include <unordered_set>
 
 using namespace busuto;
 
 namespace {
+// kernels must work from static initializers in other translation units
+const auto early_crc = util::crc32c(std::string_view("123456789"));
+const auto early_utf8 = util::is_utf8(std::string_view("static"));
+
 void test_hex_codec() {
     const byte_array src{"hello", 5};
     auto hex = src.to_hex();
@@ -26,9 +35,156 @@ void test_base64_codec() {
     assert(restored == src);
 }
 
+// Plain reference encoder to check the vector kernels against.
+auto reference_b64(const std::vector<std::byte>& data) {
+    constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (std::size_t pos = 0; pos < data.size(); pos += 3) {
+        uint32_t bits = 0;
+        for (std::size_t off = 0; off < 3; ++off)
+            bits = (bits << 8) | (pos + off < data.size() ? std::to_integer<uint32_t>(data[pos + off]) : 0);
+        const auto count = std::min<std::size_t>(3, data.size() - pos) + 1;
+        for (std::size_t off = 0; off < 4; ++off)
+            out += off < count ? alphabet[(bits >> (18 - off * 6)) & 0x3f] : '=';
+    }
+    return out;
+}
+
+void test_codec_kernels() {
+    std::vector<std::byte> data;
+    uint32_t seed = 7;
+    for (std::size_t len = 0; len < 300; ++len) {
+        const auto b64 = util::encode_b64(data);
+        assert(b64 == reference_b64(data));
+        assert(util::decode_b64(b64) == data);
+
+        const auto hex = util::encode_hex(data);
+        assert(hex.size() == len * 2);
+        assert(util::decode_hex(hex) == data);
+        std::string lower;
+        for (auto ch : hex)
+            lower += char(std::tolower(ch));
+        assert(util::decode_hex(lower) == data);
+
+        seed = seed * 1103515245U + 12345U;
+        data.push_back(std::byte(seed >> 16));
+    }
+
+    const byte_array src(data.data(), data.size());
+    char text[util::b64_encoded_size(300)];
+    assert(to_b64(src, text) == sizeof(text));
+    byte_array restored;
+    assert(from_b64({text, sizeof(text)}, restored) == 300 && restored == src);
+
+    char hex[600];
+    assert(to_hex(src, hex) == sizeof(hex));
+    assert(from_hex({hex, sizeof(hex)}, restored) == 300 && restored == src);
+
+    try {
+        char small[8];
+        to_b64(src, small);
+        assert(false && "Should throw on small output");
+    } catch (const std::out_of_range&) {} // NOLINT
+
+    // errors deep inside vector sized blocks still have to be found
+    auto bad = util::encode_b64(data);
+    bad[37] = '*';
+    try {
+        util::decode_b64(bad);
+        assert(false && "Should throw on bad base64");
+    } catch (const std::invalid_argument&) {} // NOLINT
+
+    bad = util::encode_b64(data);
+    bad[20] = '=';
+    try {
+        util::decode_b64(bad);
+        assert(false && "Should throw on early padding");
+    } catch (const std::invalid_argument&) {} // NOLINT
+
+    auto badhex = util::encode_hex(data);
+    badhex[45] = 'g';
+    try {
+        util::decode_hex(badhex);
+        assert(false && "Should throw on bad hex");
+    } catch (const std::invalid_argument&) {} // NOLINT
+}
+
 void test_utf8_utils() {
     assert(util::is_utf8("\xc3\xb1"));
     assert(!util::is_utf8("\xa0\xa1"));
+    assert(!util::is_utf8("\xc0\xaf"));         // overlong
+    assert(!util::is_utf8("\xed\xa0\x80"));     // surrogate
+    assert(!util::is_utf8("\xf4\x90\x80\x80")); // past U+10FFFF
+    assert(util::is_utf8("\xf4\x8f\xbf\xbf"));
+}
+
+// Strict decoding reference to check the vector kernels against.
+auto reference_utf8(const std::string& text) {
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        const auto lead = uint8_t(text[pos]);
+        std::size_t len = 1;
+        uint32_t code = lead;
+        if (lead >= 0x80) {
+            if ((lead & 0xE0) == 0xC0)
+                len = 2, code = lead & 0x1F;
+            else if ((lead & 0xF0) == 0xE0)
+                len = 3, code = lead & 0x0F;
+            else if ((lead & 0xF8) == 0xF0)
+                len = 4, code = lead & 0x07;
+            else
+                return false;
+        }
+
+        if (pos + len > text.size()) return false;
+        for (std::size_t next = 1; next < len; ++next) {
+            const auto byte = uint8_t(text[pos + next]);
+            if ((byte & 0xC0) != 0x80) return false;
+            code = (code << 6) | (byte & 0x3F);
+        }
+
+        if ((len == 2 && code < 0x80) || (len == 3 && code < 0x800) || (len == 4 && code < 0x10000)) return false;
+        if (code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) return false;
+        pos += len;
+    }
+    return true;
+}
+
+void test_utf8_kernels() {
+    const std::string samples[] = {"a", "\xc3\xb1", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xed\x9f\xbf", "\xef\xbf\xbf"};
+    uint32_t seed = 11;
+    auto next = [&seed] {
+        seed = seed * 1103515245U + 12345U;
+        return seed >> 16;
+    };
+
+    for (int round = 0; round < 20000; ++round) {
+        std::string text(next() % 70, 'x');
+        const auto parts = next() % 40;
+        for (unsigned count = 0; count < parts; ++count)
+            text += samples[next() % std::size(samples)];
+        if (round % 2 && !text.empty())
+            text[next() % text.size()] = char(next());
+        assert(util::is_utf8(text) == reference_utf8(text));
+
+        util::utf8_validator stream;
+        const auto split = text.empty() ? 0 : next() % text.size();
+        const auto second = split + (text.size() - split) / 2;
+        stream.update(std::string_view(text).substr(0, split));
+        stream.update(std::string_view(text).substr(split, second - split));
+        stream.update(std::string_view(text).substr(second));
+        assert(stream.complete() == reference_utf8(text));
+    }
+
+    util::utf8_validator stream;
+    const std::string_view euro = "\xe2\x82\xac";
+    for (auto ch : euro)
+        assert(stream.update(&ch, 1));
+    assert(stream.complete());
+    assert(stream.update(euro.substr(0, 2)) && !stream.complete());
+    assert(!stream.update("x") && !stream);
+    stream.reset();
+    assert(stream.complete());
 }
 
 void test_subspan_and_span_mutation() {
@@ -75,6 +231,224 @@ void test_invalid_decode_inputs() {
         assert(false && "Should throw on bad base64");
     } catch (const std::invalid_argument&) {} // NOLINT
 }
+
+void test_find_delimiter() {
+    // check the vector kernels against std search at every offset and tail
+    std::string text(200, 'a');
+    for (const std::string_view delim : {"\n", "\r\n", "\r\n\r\n", "--boundary"}) {
+        for (std::size_t at = 0; at + delim.size() <= text.size(); at += 7) {
+            auto copy = text;
+            copy.replace(at, delim.size(), delim);
+            copy[at + delim.size() / 2] = delim[delim.size() / 2];
+            for (std::size_t len = at; len <= copy.size(); len += 13) {
+                const std::string_view view(copy.data(), len);
+                assert(util::find_delimiter(view, delim) == view.find(delim));
+                assert(util::find_delimiter(view, delim, at / 2) == view.find(delim, at / 2));
+            }
+        }
+    }
+
+    // first and last bytes match without the middle matching
+    const std::string near = std::string(40, '-') + "-boundarz--boundary";
+    assert(util::find_delimiter(near, "--boundary") == near.find("--boundary"));
+    assert(util::find_delimiter("abc", "") == std::string_view::npos);
+    assert(util::find_delimiter("abc", "c", 4) == std::string_view::npos);
+
+    util::delimiter_search search;
+    std::string grow = std::string(100, 'x') + "\r";
+    assert(search.find(grow.data(), grow.size(), "\r\n") == std::string_view::npos);
+    grow += "\nrest";
+    assert(search.find(grow.data(), grow.size(), "\r\n") == 100);
+    assert(search.find(grow.data(), grow.size(), "rest") == 102);
+
+    const std::string_view lines = "first\r\nsecond\r\npartial";
+    input_buffer input(lines.data(), lines.size());
+    assert(input.find() == 5);
+    assert(input.getview() == "first");
+    assert(input.getview() == "second");
+    assert(input.find() == std::string_view::npos);
+    assert(input.getview().empty());
+}
+void test_arena_allocation() {
+    // null upstream proves everything below stays inside the inline block
+    arena<2048> scratch(std::pmr::null_memory_resource());
+    auto bytes = scratch.bytes();
+    bytes += byte_array{"hello", 5};
+    bytes += byte_array{" world", 6};
+    assert(bytes.size() == 11);
+    assert(bytes == byte_array("hello world", 11));
+    assert(bytes.get_allocator().resource() == scratch.resource());
+
+    auto part = bytes.slice(6, 11);
+    assert(part == byte_array("world", 5));
+    assert(part.get_allocator().resource() == scratch.resource());
+
+    auto joined = part + bytes.slice(0, 5);
+    assert(joined.get_allocator().resource() == scratch.resource());
+    assert(joined == byte_array("worldhello", 10));
+
+    auto hex = to_hex(part, scratch.allocator());
+    assert(hex == "776F726C64");
+    assert(hex.get_allocator().resource() == scratch.resource());
+    auto b64 = to_b64(bytes, scratch.allocator<char>());
+    assert(b64 == "aGVsbG8gd29ybGQ=");
+    assert(from_hex(hex, scratch.allocator()) == part);
+    assert(from_b64(b64, scratch.allocator()) == bytes);
+
+    auto text = scratch.string("header");
+    assert(text.get_allocator().resource() == scratch.resource());
+
+    bool exhausted = false;
+    try {
+        auto big = scratch.bytes(4096);
+    } catch (const std::bad_alloc&) {
+        exhausted = true;
+    }
+    assert(exhausted);
+
+    scratch.reset();
+    auto again = scratch.bytes(1024);
+    assert(again.size() == 1024);
+}
+void test_shared_storage() {
+    byte_array key{"0123456789abcdef", 16};
+    assert(key.capacity() == byte_array::inline_size);
+    auto nonce = key.slice(4, 12);
+    assert(!nonce.shared() && nonce.view() == "456789ab");
+
+    std::string text(1000, 'x');
+    text.replace(500, 5, "hello");
+    byte_array frame{text.data(), text.size()};
+    assert(!frame.shared());
+
+    const auto copy = frame;
+    assert(frame.shared() && copy.shared());
+    assert(copy.data() == std::as_const(frame).data());
+
+    auto body = frame.slice(400, 900);
+    assert(body.shared() && body.size() == 500);
+    assert(std::as_const(body).data() == std::as_const(frame).data() + 400);
+    assert(body.subview(100, 5) == "hello");
+
+    body[100] = std::byte('J');
+    assert(!body.shared() && body.subview(100, 5) == "Jello");
+    assert(copy.subview(500, 5) == "hello");
+    assert(frame.subview(500, 5) == "hello");
+
+    frame.remove_prefix(500);
+    assert(frame.shared() && frame.view().substr(0, 5) == "hello");
+    frame.append("!", 1);
+    assert(!frame.shared() && frame.size() == 501 && frame.back() == std::byte('!'));
+    assert(copy.size() == 1000 && !copy.shared());
+
+    // a mutable span taken earlier must not write into a later copy
+    auto writer = frame.span_mut();
+    assert(frame.pinned());
+    const auto later = frame;
+    const auto part = frame.slice(0, 100);
+    assert(!later.shared() && !part.shared() && !frame.shared());
+    writer[0] = std::byte('Y');
+    assert(frame.view()[0] == 'Y' && later.view()[0] == 'h' && part.view()[0] == 'h');
+
+    // unequal allocators exchange bytes, not storage
+    std::pmr::monotonic_buffer_resource left_pool, right_pool;
+    pmr::byte_array left(text.data(), 600, &left_pool);
+    pmr::byte_array right(text.data() + 500, 200, &right_pool);
+    left.swap(right);
+    assert(left.size() == 200 && left.view().substr(0, 5) == "hello");
+    assert(right.size() == 600 && right.view().substr(500, 5) == "hello");
+    assert(left.get_allocator().resource() == &left_pool);
+    assert(right.get_allocator().resource() == &right_pool);
+
+    auto moved = std::move(body);
+    assert(body.empty() && moved.size() == 500); // NOLINT
+    moved.swap(key);
+    assert(moved.view() == "0123456789abcdef" && key.size() == 500);
+    moved.append(moved.data(), moved.size());
+    assert(moved.view() == "0123456789abcdef0123456789abcdef");
+
+    byte_array grown;
+    for (int count = 0; count < 200; ++count)
+        grown.push_back(std::byte(count));
+    assert(grown.size() == 200 && grown[199] == std::byte(199));
+    grown.resize(10);
+    grown.shrink_to_fit();
+    assert(grown.capacity() == byte_array::inline_size && grown[9] == std::byte(9));
+}
+
+void test_crc32c() {
+    assert(util::crc32c(std::string_view("123456789")) == 0xe3069283);
+    assert(early_crc == 0xe3069283 && early_utf8);
+    assert(util::crc32c(std::string_view()) == 0);
+
+    // rfc 3720 vectors
+    std::array<std::byte, 32> block{};
+    assert(util::crc32c(block) == 0x8a9136aa);
+    block.fill(std::byte(0xff));
+    assert(util::crc32c(block) == 0x62a8ab43);
+    for (std::size_t pos = 0; pos < block.size(); ++pos)
+        block[pos] = std::byte(pos);
+    assert(util::crc32c(block) == 0x46dd794e);
+
+    // large enough for three streams of both block sizes; pieces small
+    // enough for one stream must agree with it
+    std::vector<std::byte> frame(3 * 8192 * 2 + 3 * 256 + 77);
+    uint32_t seed = 12345;
+    for (auto& byte : frame) {
+        seed = seed * 1103515245 + 12345;
+        byte = std::byte(seed >> 24);
+    }
+    const auto whole = util::crc32c(frame);
+    util::crc32c_t crc;
+    for (std::size_t pos = 0, step = 1; pos < frame.size(); pos += step, step = step % 700 + 13)
+        crc.update(std::span(frame).subspan(pos, std::min(step, frame.size() - pos)));
+    assert(crc.value() == whole);
+    frame[frame.size() / 2] ^= std::byte(1);
+    assert(util::crc32c(frame) != whole);
+    crc.reset();
+    assert(crc.value() == 0);
+}
+
+void test_hash64() {
+    std::string text;
+    for (int count = 0; count < 300; ++count)
+        text.push_back(char('a' + count % 26 + count / 26));
+
+    // pieces hash as the whole for every length and many splits
+    for (std::size_t len = 0; len <= text.size(); ++len) {
+        const auto view = std::string_view(text).substr(0, len);
+        const auto whole = util::hash64(view, 7);
+        for (std::size_t step : {1, 5, 16, 47, 48, 49, 100}) {
+            util::hash64_t hash(7);
+            for (std::size_t pos = 0; pos < len; pos += step)
+                hash.update(view.substr(pos, step));
+            assert(hash.value() == whole);
+        }
+        if (len) assert(util::hash64(view, 8) != whole);
+    }
+    assert(util::hash64(std::string_view("abc")) != util::hash64(std::string_view("abd")));
+    assert(util::hash64(std::string_view("abcd")) != util::hash64(std::string_view("abce")));
+
+    // flipping any one bit of a short key changes about half the hash
+    const std::string key("0123456789abcdef0123");
+    const auto base = util::hash64(key);
+    for (std::size_t bit = 0; bit < key.size() * 8; ++bit) {
+        auto other = key;
+        other[bit / 8] = char(other[bit / 8] ^ (1 << (bit % 8)));
+        const auto changed = std::popcount(base ^ util::hash64(other));
+        assert(changed > 12 && changed < 52);
+    }
+
+    const byte_array bytes{"frame key", 9};
+    assert(std::hash<byte_array>{}(bytes) == binary_hash{}(std::string_view("frame key")));
+    std::unordered_set<byte_array, binary_hash> keys;
+    keys.insert(bytes);
+    assert(keys.contains(bytes));
+
+    atomic::dictionary_t<byte_array, int, 16, binary_hash> dict;
+    dict.insert_or_assign(bytes, 42);
+    assert(dict.contains(bytes) && dict.find(bytes).value() == 42); // NOLINT
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -85,7 +459,14 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_u8data_and_conversion();
         test_swap_and_slice();
         test_invalid_decode_inputs();
+        test_codec_kernels();
         test_utf8_utils();
+        test_utf8_kernels();
+        test_find_delimiter();
+        test_arena_allocation();
+        test_shared_storage();
+        test_crc32c();
+        test_hash64();
     } catch (...) {
         return -1;
     }
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "fsys.hpp"
+#include "service.hpp"
+
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+auto make_text(std::size_t lines) {
+    std::string text;
+    for (std::size_t count = 0; count < lines; ++count)
+        text += "line " + std::to_string(count) + std::string(count % 50, '.') + "\n";
+    return text;
+}
+
+auto write_file(const fsys::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+}
+
+void test_scan_lines() {
+    std::vector<std::string> lines;
+    auto collect = [&lines](std::string_view line) {
+        lines.emplace_back(line);
+        return true;
+    };
+
+    assert(fsys::scan_lines("a\nbb\n\nccc", collect) == 4);
+    assert(lines.size() == 4 && lines[1] == "bb" && lines[2].empty() && lines[3] == "ccc");
+    lines.clear();
+    assert(fsys::scan_lines("a\n", collect) == 1 && lines[0] == "a");
+
+    int calls{0};
+    auto stop = [&calls](std::string_view) { return ++calls < 2; };
+    assert(fsys::scan_lines("a\nb\nc\n", stop) == 1 && calls == 2);
+}
+
+void test_scan_file() {
+    const auto path = fsys::temp_directory_path() / "busuto-scan-test.txt";
+    const auto text = make_text(20000);
+    write_file(path, text);
+
+    std::size_t bytes{0};
+    auto total = scan_file(path, [&bytes](std::string_view line) {
+        assert(line.starts_with("line ") && !line.ends_with('\n'));
+        bytes += line.size() + 1;
+        return true;
+    });
+    assert(total == 20000 && bytes == text.size());
+    total = scan_file(path, [](std::string_view line) { return !line.starts_with("line 10."); });
+    assert(total == 10);
+
+    // stream reads use the buffered path, with lines straddling reads
+    std::istringstream input(text + "tail");
+    std::string last;
+    bytes = 0;
+    total = scan_stream(input, [&](std::string_view line) {
+        bytes += line.size() + 1;
+        last = line;
+        return true;
+    });
+    assert(total == 20001 && last == "tail" && bytes == text.size() + 5);
+
+    write_file(path, "");
+    assert(scan_file(path, [](std::string_view) { return true; }) == 0);
+    fsys::remove(path);
+    assert(scan_file(path, [](std::string_view) { return true; }) == 0);
+}
+void test_scan_parallel() {
+    const auto root = fsys::temp_directory_path() / "busuto-walk-test";
+    fsys::remove_all(root);
+    std::size_t files{0}, dirs{0};
+    for (int top = 0; top < 6; ++top) {
+        for (int sub = 0; sub < 5; ++sub) {
+            const auto dir = root / std::to_string(top) / std::to_string(sub);
+            fsys::create_directories(dir);
+            for (int file = 0; file < 20; ++file, ++files)
+                write_file(dir / ("f" + std::to_string(file)), "x");
+            ++dirs;
+        }
+        ++dirs;
+    }
+
+    const auto expected = std::size_t(std::count_if(fsys::recursive_directory_iterator(root), fsys::recursive_directory_iterator(), [](const auto&) { return true; }));
+    assert(expected == files + dirs);
+
+    service::pool workers(4);
+    std::atomic<std::size_t> sized{0};
+    auto total = scan_parallel(workers, root, [&sized](const fsys::walk_entry& entry) {
+        assert(entry.handle() >= 0 && !entry.name().empty() && entry.info());
+        if (entry.is_regular() && entry.info()->st_size == 1) ++sized;
+        return true;
+    });
+    assert(total == expected && sized == files);
+
+    total = scan_parallel(workers, root, [](const fsys::walk_entry& entry) {
+        assert(!entry.info() || entry.type() == DT_UNKNOWN);
+        return entry.is_regular() && entry.path().parent_path().filename() == "3";
+    }, {.stat = false});
+    assert(total == 6 * 20);
+
+    total = scan_parallel(workers, root, [](const fsys::walk_entry& entry) { return entry.depth() == 0; }, {.depth = 1});
+    assert(total == 6);
+
+    try {
+        scan_parallel(workers, root, [](const fsys::walk_entry& entry) -> bool {
+            if (entry.name() == "f7") throw range("stop");
+            return true;
+        });
+        assert(false && "Should rethrow predicate errors");
+    } catch (const range&) {} // NOLINT
+
+    workers.shutdown();
+    fsys::remove_all(root);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_scan_lines();
+        test_scan_file();
+        test_scan_parallel();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "function.hpp"
+#include "service.hpp"
+#include <cassert>
+#include <cstdlib>
+
+using namespace busuto;
+
+namespace {
+std::atomic<std::size_t> allocs{0};
+} // namespace
+
+auto operator new(std::size_t size) -> void * {
+    ++allocs;
+    if (auto *ptr = std::malloc(size)) return ptr; // NOLINT
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr); // NOLINT
+}
+
+void operator delete(void *ptr, std::size_t /* size */) noexcept {
+    std::free(ptr); // NOLINT
+}
+
+namespace {
+void test_inline_capture() {
+    int a = 1, b = 2, c = 3;
+    std::string *text = nullptr;
+    const auto prior = allocs.load();
+    util::inplace_function<int()> func([a, b, c, text, p = &a] {
+        return a + b + c + *p + (text ? 1 : 0);
+    });
+    assert(func.is_inline());
+    assert(func() == 7);
+    auto moved = std::move(func);
+    assert(!func);
+    assert(moved() == 7);
+    assert(allocs == prior);
+}
+
+void test_heap_fallback() {
+    std::array<char, 128> big{};
+    big[0] = 'x';
+    util::inplace_function<char(int), 48> func([big](int pos) { return big[pos]; });
+    assert(!func.is_inline());
+    assert(func(0) == 'x');
+}
+
+void test_move_only_capture() {
+    auto ptr = std::make_unique<int>(42);
+    service::task_t task([value = std::move(ptr)] { assert(*value == 42); });
+    assert(task.is_inline());
+    task();
+    task = nullptr;
+    assert(!task);
+}
+
+void test_dispatch_allocations() {
+    std::atomic<int> count{0};
+    service::tasks queue;
+    queue.startup();
+    queue.dispatch([] {}); // warm up deque storage
+    while (!queue.empty())
+        this_thread::sleep(1);
+
+    int a = 0, b = 0;
+    const auto prior = allocs.load();
+    queue.dispatch([&count, &a, &b, x = 1L, y = 2L] { count += static_cast<int>(x + y) + a + b; });
+    assert(allocs == prior);
+    while (count == 0)
+        this_thread::sleep(1);
+    queue.shutdown();
+    assert(count == 3);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_inline_capture();
+        test_heap_fallback();
+        test_move_only_capture();
+        test_dispatch_allocations();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "keyfile.hpp"
+
+#include <cassert>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace busuto;
+
+namespace {
+auto write_config(const std::string& text) {
+    char path[] = "/tmp/busuto-keyfileXXXXXX";
+    auto fd = ::mkstemp(path);
+    assert(fd >= 0);
+    ::close(fd);
+    std::ofstream out(path);
+    out << text;
+    return std::string(path);
+}
+
+void test_keyfile_parse() {
+    const auto path = write_config(
+    "Name = top\r\n"
+    "# comment\n"
+    "  [Server]  \n"
+    "Port= 8080\n"
+    "HOST =  example.com  \r\n"
+    "port = 8081\n"
+    "=ignored\n"
+    "[unused]\n"
+    "[server]\n"
+    "empty =\n"
+    "last = no newline");
+
+    keyfile_t keys;
+    keys.load(path);
+    assert(keys.contains("_") && keys.contains("server") && !keys.contains("unused"));
+    assert(keys.value("_", "name") == "top");
+    assert(keys.value("server", "port") == "8081");
+    assert(keys.value("server", "host") == "example.com");
+    assert(keys.value("server", "last") == "no newline");
+    assert(keys.value("server", "empty").empty() && keys["server"].contains("empty"));
+    assert(keys.value("missing", "port").empty());
+
+    // lookups by view and c string need no temporary string
+    const std::string_view id("server");
+    const char *key = "port";
+    assert(keys.at(id).find(key)->second == "8081");
+    assert(keys.get_or("missing")["name"] == "top");
+    assert(!keys.try_load("/nonexistent/busuto.conf"));
+
+    // saved output parses back to the same keys
+    const auto copy = write_config("");
+    assert(keys.write(copy));
+    keyfile_t again;
+    assert(again.try_load(copy));
+    assert(again.value("server", "host") == "example.com");
+    assert(again.value("_", "name") == "top");
+    assert(again.at("server").size() == keys.at("server").size() - 1); // empty value not saved
+    ::unlink(path.c_str());
+    ::unlink(copy.c_str());
+}
+
+void test_keyfile_snapshot() {
+    keyfile_t keys;
+    keys.load("_", {{"name", "global"}});
+    keys.load("Server", {{"Port", "8080"}, {"host", "localhost"}, {"name", "web"}});
+    keys.load("empty", {});
+
+    const util::keyfile_snapshot snap(keys);
+    assert(snap.size() == 4);
+    assert(snap.contains("server") && snap.contains("empty") && !snap.contains("missing"));
+    assert(snap.get("server", "port") == "8080");
+    assert(snap.get("_", "name") == "global");
+    assert(snap.get("server", "missing", "none") == "none");
+    assert(snap.find("empty", "name") == nullptr);
+    assert(snap.keyset("empty").empty());
+
+    const auto server = snap.keyset("server");
+    assert(server.size() == 3);
+    assert(server[0].key == "host" && server[1].key == "name" && server[2].key == "port");
+
+    // repeated names share one copy in the arena
+    assert(snap.find("_", "name")->key.data() == snap.find("server", "name")->key.data());
+}
+
+void test_keyfile_config() {
+    const auto first = write_config("[server]\nport = 8080\n");
+    const auto second = write_config("[server]\nport = 9090\nhost = example\n");
+    util::keyfile_config config({first});
+    assert(config.version() == 1);
+    assert(config.snapshot()->get("server", "port") == "8080");
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int count = 0; count < 4; ++count) {
+        readers.emplace_back([&] {
+            while (!done) {
+                const auto snap = config.snapshot();
+                const auto port = snap->get("server", "port");
+                assert(port == "8080" || port == "9090");
+            }
+        });
+    }
+
+    for (int count = 0; count < 100; ++count)
+        assert(config.load({(count & 1) ? first : second}));
+    assert(!config.load({"/nonexistent/busuto.conf"}));
+    assert(config.version() == 101);
+    done = true;
+    for (auto& thread : readers)
+        thread.join();
+
+    const auto snap = config.snapshot();
+    assert(snap->get("server", "port") == "8080");
+    assert(!snap->contains("client"));
+    ::unlink(first.c_str());
+    ::unlink(second.c_str());
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_keyfile_parse();
+        test_keyfile_snapshot();
+        test_keyfile_config();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "listener.hpp"
+#include "sync.hpp"
+
+#include <array>
+#include <cassert>
+#include <sys/resource.h>
+
+using namespace busuto;
+
+namespace {
+void test_listener_shards() {
+    std::array<std::atomic<unsigned>, 2> counts{};
+    sync::wait_group pending(8);
+    listener::options_t options;
+    options.shards = 2;
+    listener server(socket::address::from_string("127.0.0.1", 0), [&](int so, const address_t& peer, unsigned shard) {
+        assert(shard < 2 && peer.family() == AF_INET);
+        counts[shard].fetch_add(1);
+        socket::release(so);
+        pending.release();
+    }, options);
+
+    assert(server && server.shards() == 2);
+    assert(server.handle(0) != server.handle(1));
+    const auto addr = server.address();
+    assert(addr.port() != 0);
+
+    server.start();
+    std::vector<handle_t> clients;
+    for (auto count = 0; count < 8; ++count) {
+        auto so = make_socket(AF_INET, SOCK_STREAM);
+        assert(::connect(so, addr.data(), addr.size()) == 0);
+        clients.push_back(std::move(so));
+    }
+
+    assert(pending.wait_for(std::chrono::seconds(5)));
+    server.stop();
+    assert(server.accepted() == 8);
+    assert(counts[0] + counts[1] == 8);
+    server.stop();
+}
+
+void test_listener_descriptors() {
+    struct rlimit saved{};
+    assert(::getrlimit(RLIMIT_NOFILE, &saved) == 0);
+    struct rlimit limit = saved;
+    limit.rlim_cur = 64;
+    assert(::setrlimit(RLIMIT_NOFILE, &limit) == 0);
+
+    std::atomic<unsigned> served{0};
+    listener::options_t options;
+    options.shards = 1;
+    options.pin = false;
+    listener server(socket::address::from_string("127.0.0.1", 0), [&](int so, const address_t&, unsigned) {
+        socket::release(so);
+        served.fetch_add(1);
+    }, options);
+    server.start();
+    this_thread::sleep(50);
+
+    // use up every descriptor, so pending connections have to be shed
+    std::vector<handle_t> clients;
+    for (auto count = 0; count < 2; ++count)
+        clients.push_back(make_socket(AF_INET, SOCK_STREAM));
+    std::vector<int> filler;
+    for (auto fd = ::dup(0); fd >= 0; fd = ::dup(0))
+        filler.push_back(fd);
+    for (auto& so : clients)
+        assert(::connect(so, server.address().data(), server.address().size()) == 0);
+    for (auto count = 0; count < 100 && server.dropped() < 2; ++count)
+        this_thread::sleep(10);
+    assert(server.dropped() == 2 && served == 0);
+
+    for (auto fd : filler)
+        ::close(fd);
+    auto later = make_socket(AF_INET, SOCK_STREAM);
+    assert(::connect(later, server.address().data(), server.address().size()) == 0);
+    for (auto count = 0; count < 100 && !served; ++count)
+        this_thread::sleep(10);
+    assert(served == 1);
+    server.stop();
+    assert(::setrlimit(RLIMIT_NOFILE, &saved) == 0);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_listener_shards();
+        test_listener_descriptors();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
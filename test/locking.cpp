@@ -5,6 +5,9 @@
 #include "locking.hpp"
 #include "print.hpp"
 #include <cassert>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 using namespace busuto;
 
@@ -19,6 +22,47 @@ lock::exclusive<int> counter(3);
 lock::shared<std::unordered_map<std::string, std::string>> tshared;
 lock::shared<struct test> testing;
 lock::shared<std::array<int, 10>> tarray;
+lock::rcu<std::vector<int>> routes(4, 1);
+
+// readers must always see a complete version: every element equal
+void test_rcu() {
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int count = 0; count < 4; ++count) {
+        readers.emplace_back([&] {
+            while (!done) {
+                const lock::rcu_reader table(routes);
+                for (auto value : *table)
+                    assert(value == table[0]);
+            }
+        });
+    }
+
+    for (int value = 2; value < 200; ++value) {
+        lock::rcu_writer table(routes);
+        for (auto& item : *table)
+            item = value;
+        table->push_back(value);
+    }
+    {
+        lock::rcu_writer table(routes);
+        table[0] = -1;
+        table.cancel();
+    }
+    try {
+        lock::rcu_writer table(routes);
+        table[0] = -2;
+        throw std::runtime_error("abandoned");
+    } catch (const std::runtime_error&) { // NOLINT
+    }
+    done = true;
+    for (auto& thread : readers)
+        thread.join();
+
+    lock::rcu<std::vector<int>>::synchronize();
+    const lock::rcu_reader table(routes);
+    assert(table->size() == 202 && table.at(0) == 199);
+}
 } // namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -61,6 +105,7 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         }
         const lock::reader_ptr<struct test> tester(testing);
         assert(tester->v1 == 3);
+        test_rcu();
 
     } catch (std::exception& e) {
         print("ERR: {}\n", e.what());
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "parallel.hpp"
+#include "binary.hpp"
+#include <cassert>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace busuto;
+
+namespace {
+void test_parallel_for() {
+    service::pool pool(3, service::pool::stealing);
+    std::vector<int> marks(10000, 0);
+    parallel_for(pool, 0, marks.size(), [&marks](std::size_t pos) { ++marks[pos]; });
+    assert(std::ranges::all_of(marks, [](int mark) { return mark == 1; }));
+
+    parallel_for(pool, marks, [](int& mark) { mark *= 3; }, 7);
+    assert(std::accumulate(marks.begin(), marks.end(), 0) == 30000);
+
+    // nested from inside a worker, where the caller must help or deadlock
+    std::atomic<int> total{0};
+    parallel_for(pool, 0, 8, [&pool, &total](std::size_t) {
+        parallel_for(pool, 0, 100, [&total](std::size_t) { ++total; }, 1);
+    }, 1);
+    assert(total == 800);
+
+    // a pool that is not running still works on the calling thread
+    service::pool stopped;
+    parallel_for(stopped, marks, [](int& mark) { mark = 0; });
+    assert(std::ranges::all_of(marks, [](int mark) { return mark == 0; }));
+}
+
+void test_parallel_errors() {
+    service::pool pool(2);
+    std::atomic<int> ran{0};
+    auto caught = false;
+    try {
+        parallel_for(pool, 0, 1000, [&ran](std::size_t pos) {
+            ++ran;
+            if (pos == 500) throw std::runtime_error("failed");
+        }, 10);
+    } catch (const std::runtime_error& e) {
+        caught = std::string(e.what()) == "failed";
+    }
+    assert(caught && ran <= 1000);
+}
+
+void test_parallel_transform_reduce() {
+    service::pool pool(4);
+    std::vector<byte_array> blocks;
+    for (auto count = 0; count < 64; ++count)
+        blocks.emplace_back(std::string(100 + count, char('a' + count % 26)).c_str(), 100 + count);
+
+    std::vector<std::string> hex(blocks.size());
+    auto end = parallel_transform(pool, blocks, hex.begin(), [](const byte_array& block) { return block.to_hex(); }, 1);
+    assert(end == hex.end());
+    assert(hex[3] == blocks[3].to_hex());
+
+    const auto bytes = parallel_reduce(pool, blocks, std::size_t(0), std::plus<>{}, [](const byte_array& block) { return block.size(); });
+    assert(bytes == 64 * 100 + 63 * 64 / 2);
+
+    // combined in order even though chunks finish in any order
+    std::vector<std::string> words;
+    for (auto count = 0; count < 500; ++count)
+        words.push_back(std::to_string(count) + ",");
+    const auto joined = parallel_reduce(pool, words, std::string(), std::plus<>{}, std::identity{}, 3);
+    assert(joined == std::accumulate(words.begin(), words.end(), std::string()));
+    assert(parallel_reduce(pool, std::vector<int>{}, 5, std::plus<>{}) == 5);
+}
+
+void test_parallel_scan() {
+    service::pool pool(3);
+    std::vector<long> values(12345);
+    std::iota(values.begin(), values.end(), 1);
+    std::vector<long> scanned(values.size()), expected(values.size());
+    std::inclusive_scan(values.begin(), values.end(), expected.begin(), std::plus<>{}, 10L);
+    auto end = parallel_scan(pool, values, scanned.begin(), 10L);
+    assert(end == scanned.end());
+    assert(scanned == expected);
+
+    parallel_scan(pool, values, scanned.begin(), 0L, std::plus<>{}, 1000);
+    assert(scanned.back() == 12345L * 12346 / 2);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_parallel_for();
+        test_parallel_errors();
+        test_parallel_transform_reduce();
+        test_parallel_scan();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
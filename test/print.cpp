@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "print.hpp"
+#include "streams.hpp"
+#include "service.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <sys/socket.h>
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // end namespace
+
+auto operator new(std::size_t size) -> void * {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t /* size */) noexcept { std::free(ptr); }
+
+using namespace busuto;
+
+namespace {
+void test_format_buffers() {
+    format_buffer<16> buf;
+    auto result = format_to(buf, "{}-{}", 12, "ab");
+    assert(result && result.size == 5);
+    assert(std::string_view(buf.c_str()) == "12-ab");
+
+    result = format_to(buf, "{:>20}", 1);
+    assert(result.truncated() && result.size == 11 && result.needed == 20);
+    assert(buf.size() == 16);
+
+    stringbuf<8> text("x");
+    auto more = format_to(text, "{}", 1234567890);
+    assert(!more && more.size == 7);
+    assert(std::string_view(text.data(), text.size()) == "x1234567");
+
+    char raw[4];
+    assert(format_to(std::span(raw), "{}", 12).size == 2);
+}
+
+void test_format_streams() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    {
+        system_stream<8> out(pair[0]);
+        assert(format_to(out, "{}", "hello"));
+        assert(format_to(out, "{}", "world!"));
+        assert(format_to(out, "{:>12}", 1).truncated());
+        out.flush();
+    }
+
+    char got[32]{};
+    const auto len = ::recv(pair[1], got, sizeof(got), 0);
+    ::close(pair[1]);
+    assert(len == 19 && std::string_view(got, 11) == "helloworld!");
+}
+
+void test_timestamps() {
+    char text[64];
+    const timestamp zulu(ZULU_TIMESTAMP, timestamp::precision::millis, false);
+    auto size = zulu.format(text, {0, 123456789});
+    assert(std::string_view(text, size) == "1970-01-01T00:00:00.123Z");
+
+    // same second from the cache, with only the fraction changed
+    size = zulu.format(text, {0, 5000000});
+    assert(std::string_view(text, size) == "1970-01-01T00:00:00.005Z");
+    size = zulu.format(text, {61, 0});
+    assert(std::string_view(text, size) == "1970-01-01T00:01:01.000Z");
+
+    const timestamp micros(ISO_DATETIME, timestamp::precision::micros, false);
+    const timestamp seconds(ISO_DATETIME, timestamp::precision::seconds, false);
+    assert(micros.to_string({86400, 42000}) == "1970-01-02 00:00:00.000042");
+    assert(seconds.to_string({86400, 42000}) == "1970-01-02 00:00:00");
+    assert(micros.to_string({86401, 0}) == "1970-01-02 00:00:01.000000");
+
+    size = zulu.format(std::span(text, 10), {0, 0});
+    assert(std::string_view(text, size) == "1970-01-01");
+
+    const timestamp coarse(ISO_DATETIME, timestamp::precision::millis, true, true);
+    const auto now = std::time(nullptr);
+    const auto when = coarse.now();
+    assert(when.tv_sec >= now - 1 && when.tv_sec <= now + 1);
+    assert(coarse.to_string().size() == 23);
+}
+
+void test_format_allocations() {
+    const std::string_view path = "/api/v1/metrics";
+    format_buffer<256> line;
+    char raw[256];
+    const auto before = allocations.load();
+    format_to(line, "{} {} {} {:.3f}", "GET", path, 200, 0.25);
+    format_to(std::span(raw), "{:08x} {}", 0xbeefU, path);
+    const timestamp stamp;
+    format_to(line, " {}", stamp);
+    assert(allocations.load() == before);
+    assert(std::string_view(line.c_str()).starts_with("GET /api/v1/metrics 200 0.250 "));
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_format_buffers();
+        test_format_streams();
+        test_timestamps();
+        test_format_allocations();
+    } catch (const std::exception& e) {
+        print("ERR: {}\n", e.what());
+        return -1;
+    }
+    return 0;
+}
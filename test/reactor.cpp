@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "reactor.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <sys/socket.h>
+
+using namespace busuto;
+
+namespace {
+int failures{0};
+
+void test_reactor_inline(service::reactor::engine_t engine) {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) == 0);
+    service::reactor loop(engine);
+    assert(is(loop));
+
+    int reads{0};
+    char buf[16];
+    assert(loop.add(pair[0], service::reactor::readable, [&](int fd, unsigned events) {
+        assert(events & service::reactor::readable);
+        while (::read(fd, buf, sizeof(buf)) > 0)
+            ;
+        ++reads;
+    }));
+    assert(!loop.add(pair[0], service::reactor::readable, [](int, unsigned) {}));
+    assert(loop.contains(pair[0]) && loop.size() == 1);
+
+    assert(loop.run_once(0) == 0);
+    assert(::write(pair[1], "hello", 5) == 5);
+    assert(loop.run_once(1000) == 1 && reads == 1);
+    assert(loop.run_once(0) == 0);
+    assert(::write(pair[1], "again", 5) == 5);
+    assert(loop.run_once(1000) == 1 && reads == 2);
+
+    unsigned seen{0};
+    assert(loop.modify(pair[0], service::reactor::writable));
+    assert(loop.remove(pair[0]));
+    assert(loop.add(pair[0], service::reactor::writable, [&](int, unsigned events) { seen = events; }));
+    assert(loop.run_once(1000) == 1 && (seen & service::reactor::writable));
+    assert(loop.remove(pair[0]) && !loop.remove(pair[0]));
+    ::close(pair[0]);
+    ::close(pair[1]);
+}
+
+void test_reactor_timeout() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) == 0);
+    service::reactor loop;
+    unsigned seen{0};
+    assert(loop.add(pair[0], service::reactor::readable, [&](int, unsigned events) { seen = events; }, std::chrono::milliseconds(20)));
+
+    const auto start = std::chrono::steady_clock::now();
+    while (!seen)
+        loop.run_once(1000);
+    assert(seen == service::reactor::expired);
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+    // handler exceptions reach the error hook and the source stays armed
+    loop.errors([](const std::exception& e) { ++failures; });
+    assert(loop.remove(pair[0]));
+    assert(loop.add(pair[1], service::reactor::writable, [](int, unsigned) { throw std::runtime_error("failed"); }));
+    assert(loop.run_once(1000) == 1 && failures == 1);
+    assert(loop.run_once(1000) == 1 && failures == 2);
+    ::close(pair[0]);
+    ::close(pair[1]);
+}
+
+// a pool that refuses work must not leave sources busy and unarmed
+void test_reactor_refused() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, pair) == 0);
+    service::pool workers(1);
+    workers.shutdown();
+    assert(!workers.dispatch([] {}));
+
+    service::reactor loop(workers);
+    int reads{0};
+    assert(loop.add(pair[0], service::reactor::readable, [&reads](int fd, unsigned) {
+        char buf[8];
+        while (::recv(fd, buf, sizeof(buf), 0) > 0)
+            ;
+        ++reads;
+    }));
+    assert(::send(pair[1], "x", 1, 0) == 1);
+    assert(loop.run_once(1000) == 1 && reads == 1);
+    assert(::send(pair[1], "y", 1, 0) == 1);
+    assert(loop.run_once(1000) == 1 && reads == 2);
+    ::close(pair[0]);
+    ::close(pair[1]);
+}
+
+void test_reactor_pool(service::reactor::engine_t engine) {
+    constexpr int sockets = 8, messages = 50;
+    service::pool workers(2);
+    std::atomic<int> received{0};
+    int pairs[sockets][2];
+    {
+        service::reactor loop(workers, engine);
+        for (auto& pair : pairs) {
+            assert(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, pair) == 0);
+            assert(loop.add(pair[0], service::reactor::readable, [&received](int fd, unsigned) {
+                char buf[8];
+                while (::recv(fd, buf, sizeof(buf), 0) > 0)
+                    ++received;
+            }));
+        }
+
+        loop.startup();
+        for (int count = 0; count < messages; ++count) {
+            for (auto& pair : pairs)
+                assert(::send(pair[1], "x", 1, 0) == 1);
+            this_thread::sleep(1);
+        }
+
+        for (int wait = 0; wait < 200 && received < sockets * messages; ++wait)
+            this_thread::sleep(10);
+        loop.shutdown();
+        workers.shutdown();
+    }
+
+    assert(received == sockets * messages);
+    for (auto& pair : pairs) {
+        ::close(pair[0]);
+        ::close(pair[1]);
+    }
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_reactor_inline(service::reactor::epoll);
+        test_reactor_timeout();
+        test_reactor_refused();
+        test_reactor_pool(service::reactor::epoll);
+
+        const service::reactor probe(service::reactor::uring);
+        if (probe.engine() == service::reactor::uring) {
+            test_reactor_inline(service::reactor::uring);
+            test_reactor_pool(service::reactor::uring);
+        }
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
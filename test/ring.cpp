@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "ring.hpp"
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+
+using namespace busuto;
+
+namespace {
+auto text(std::span<const std::byte> record) {
+    return std::string_view(reinterpret_cast<const char *>(record.data()), record.size());
+}
+
+void test_ring_records() {
+    system::shm_ring ring(4096);
+    assert(ring && ring.capacity() == 4096 && !ring.multi());
+    assert(ring.front().empty() && !ring.wait(0));
+
+    auto record = ring.reserve(100);
+    assert(record && record.size() == 100);
+    std::memcpy(record.data(), "hello", 5);
+    assert(ring.front().empty()); // not committed yet
+    record.commit(5);
+    assert(!record && text(ring.front()) == "hello");
+
+    ring.reserve(10).cancel();
+    { auto dropped = ring.reserve(20); } // NOLINT
+    assert(ring.push("world") && ring.push("", 0));
+    ring.pop();
+    assert(text(ring.front()) == "world");
+    ring.pop();
+    assert(!ring.empty() && ring.front().empty()); // empty record
+    ring.pop();
+    assert(ring.empty() && ring.used() == 0);
+
+    // records that would cross the end are moved to the start
+    std::string block(1000, 'x');
+    for (auto count = 0; count < 20; ++count) {
+        block[0] = char('a' + count);
+        assert(ring.push(block));
+        assert(text(ring.front()) == block);
+        ring.pop();
+    }
+
+    while (ring.push(block)) {}
+    assert(!ring.reserve(1000) && ring.used() > 3000);
+    assert(!ring.reserve(ring.capacity()));
+}
+
+void test_ring_processes() {
+    system::shm_ring ring(1 << 16);
+    constexpr int records = 5000;
+    auto child = at_fork([&ring] {
+        for (int count = 0; count < records;) {
+            const auto body = std::to_string(count) + std::string(std::size_t(count % 300), '.');
+            auto record = ring.reserve(body.size());
+            if (!record) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(record.data(), body.data(), body.size());
+            record.commit();
+            ++count;
+        }
+        return 0;
+    });
+    assert(child > 0);
+
+    // an attached view of the same ring sees what the child writes
+    auto reader = system::shm_ring::attach(::dup(ring.memfd()), ::dup(ring.handle()));
+    for (int count = 0; count < records; ++count) {
+        assert(reader.wait(5000));
+        const auto body = std::to_string(count) + std::string(std::size_t(count % 300), '.');
+        assert(text(reader.front()) == body);
+        reader.pop();
+    }
+
+    int status{-1};
+    assert(::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(ring.front().empty());
+}
+
+void test_ring_producers() {
+    system::shm_ring ring(1 << 14, true);
+    assert(ring.multi());
+    std::vector<std::thread> producers;
+    for (int id = 0; id < 3; ++id) {
+        producers.emplace_back([&ring, id] {
+            for (int count = 0; count < 2000;) {
+                const auto body = std::to_string(id) + ":" + std::to_string(count);
+                if (ring.push(body))
+                    ++count;
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    int next[3]{0, 0, 0};
+    for (int total = 0; total < 6000; ++total) {
+        assert(ring.wait(5000));
+        const auto body = text(ring.front());
+        const auto id = body[0] - '0';
+        assert(body.substr(2) == std::to_string(next[id]));
+        ++next[id];
+        ring.pop();
+    }
+    for (auto& thread : producers)
+        thread.join();
+    assert(next[0] == 2000 && next[1] == 2000 && next[2] == 2000);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_ring_records();
+        test_ring_processes();
+        test_ring_producers();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
@@ -48,6 +48,69 @@ void test_scan_duration() {
     text = "300";
     assert(parse_duration(text) == 300);
 }
+
+void test_scan_digits() {
+    uint64_t value{0};
+    assert(scan::to_unsigned(std::string_view("12345678901234567890"), value) == scan::field_error::none);
+    assert(value == 12345678901234567890ULL);
+    assert(scan::to_unsigned(std::string_view("18446744073709551616"), value) == scan::field_error::range);
+    assert(scan::to_unsigned(std::string_view("12a"), value) == scan::field_error::invalid);
+
+    uint8_t small{0};
+    assert(scan::to_unsigned(std::string_view("256"), small) == scan::field_error::range);
+    assert(scan::to_unsigned(std::string_view("255"), small) == scan::field_error::none && small == 255);
+
+    int64_t number{0};
+    assert(scan::to_integer(std::string_view("-9223372036854775808"), number) == scan::field_error::none);
+    assert(number == std::numeric_limits<int64_t>::min());
+    assert(scan::to_integer(std::string_view("9223372036854775808"), number) == scan::field_error::range);
+    assert(scan::to_integer(std::string_view("-"), number) == scan::field_error::invalid);
+
+    double real{0};
+    assert(scan::to_decimal(std::string_view("-12.375"), real) == scan::field_error::none && real == -12.375);
+    assert(scan::to_decimal(std::string_view("2.5e3"), real) == scan::field_error::none && real == 2500.0);
+    assert(scan::to_decimal(std::string_view("0.1"), real) == scan::field_error::none && real == 0.1);
+    assert(scan::to_decimal(std::string_view("1.2.3"), real) == scan::field_error::invalid);
+    assert(scan::to_decimal(std::string_view("12345678901234567890.5"), real) == scan::field_error::none && real == 12345678901234567890.5);
+    assert(scan::to_decimal(std::string_view("1e400"), real) == scan::field_error::range);
+    assert(scan::to_decimal(std::string_view(".5"), real) == scan::field_error::none && real == 0.5);
+}
+
+void test_scan_record() {
+    struct sample_t {
+        std::string_view host;
+        unsigned port{0};
+        double load{0};
+        bool active{false};
+        int delta{0};
+    } sample;
+
+    auto result = parse_record("db01,5432,0.75,yes,-3", ',', std::tie(sample.host, sample.port, sample.load, sample.active, sample.delta));
+    assert(result && result.count == 5);
+    assert(sample.host == "db01" && sample.port == 5432 && sample.load == 0.75 && sample.active && sample.delta == -3);
+
+    unsigned first{0}, second{0}, third{7};
+    auto partial = parse_record("1,x", ',', first, second, third);
+    assert(!partial && partial.failed() == 1 && partial.count == 2);
+    assert(partial[0] == scan::field_error::none && first == 1);
+    assert(partial[1] == scan::field_error::invalid);
+    assert(partial[2] == scan::field_error::missing && third == 7);
+
+    const std::string line = "0.125,1e3,17";
+    double low{0}, high{0};
+    assert(parse_record(line, ',', low, high, third) && low == 0.125 && high == 1000.0 && third == 17);
+
+    auto extra = parse_record("4,,6,7", ',', first, second);
+    assert(extra.count == 4 && extra[1] == scan::field_error::empty);
+
+    const std::string_view fields[] = {"10", "20", "bad", "40"};
+    assert(parse_fields(fields, first, second) && first == 10 && second == 20);
+
+    int column[4]{};
+    scan::field_error errors[4]{};
+    assert(parse_column<int>(fields, column, errors) == 3);
+    assert(column[3] == 40 && errors[2] == scan::field_error::invalid);
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -57,6 +120,8 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_try_fallbacks();
         test_scan_yesno();
         test_scan_duration();
+        test_scan_digits();
+        test_scan_record();
     } catch (const std::exception& e) {
         print("ERR: {}\n", e.what());
         return -1;
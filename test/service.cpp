@@ -5,14 +5,22 @@
 #include "print.hpp"
 #include "service.hpp"
 #include <cassert>
+#include <sys/wait.h>
 
 using namespace busuto;
 
 namespace {
+std::mutex service_lock;
+std::atomic<int> logged{0};
+std::atomic<bool> log_hold{false};
+std::size_t log_size{0};
+int log_pipe{-1};
+
+template <typename Timer>
 void test_timer() {
     int fast = 0; // scope of function...
     int slow = 0;
-    service::timer timer; // a private timer!
+    Timer timer; // a private timer!
     timer.startup();
     // timer.startup([]{print("started timer thread\n");});
     timer.periodic(std::chrono::milliseconds(150), [&slow] {
@@ -36,11 +44,300 @@ void test_timer() {
     assert(slow >= 2 && fast > slow && slow <= 5);
     assert(slow > prior); // cppcheck-suppress knownConditionTrueFalse
 }
+
+void test_timer_wheel() {
+    using namespace std::chrono_literals;
+    service::timer_wheel wheel;
+    const auto start = service::timer_clock::now();
+    const service::timer_id ids[] = {1, 2, 3, 4, 5};
+    const std::chrono::milliseconds delays[] = {5ms, 300ms, 70000ms, 24h * 60, -10ms};
+    for (auto pos = 0U; pos < 5; ++pos)
+        wheel.arm({ids[pos], 0ms, start + delays[pos], {}});
+    assert(wheel.size() == 5);
+
+    auto entry = wheel.expired(start);
+    assert(entry && entry->id == 5);
+    wheel.erase(*entry);
+    assert(!wheel.expired(start + 4ms));
+    assert(wheel.wakeup() <= start + 7ms);
+    entry = wheel.expired(start + 7ms);
+    assert(entry && entry->id == 1);
+    wheel.erase(*entry);
+
+    assert(!wheel.expired(start + 299ms));
+    entry = wheel.expired(start + 302ms);
+    assert(entry && entry->id == 2);
+    wheel.erase(*entry);
+
+    wheel.rearm(*wheel.find(3), start + 400ms);
+    assert(!wheel.expired(start + 350ms));
+    entry = wheel.expired(start + 402ms);
+    assert(entry && entry->id == 3);
+    wheel.erase(*entry);
+
+    wheel.arm({6, 0ms, start + 2000ms, {}});
+    wheel.erase(*wheel.find(6));
+    assert(!wheel.find(6));
+    assert(!wheel.expired(start + 24h * 59));
+    entry = wheel.expired(start + 24h * 60 + 2ms);
+    assert(entry && entry->id == 4);
+    wheel.erase(*entry);
+    assert(wheel.empty());
+}
+
+void test_timer_self_cancel() {
+    std::atomic<int> fired{0};
+    service::timer timer;
+    timer.startup();
+    service::timer::id_t id{};
+    {
+        const std::lock_guard lock(service_lock);
+        id = timer.periodic(std::chrono::milliseconds(20), [&] {
+            const std::lock_guard hold(service_lock);
+            if (++fired == 2)
+                timer.cancel(id);
+        });
+    }
+    this_thread::sleep(200);
+    assert(fired == 2);
+    assert(!timer.contains(id));
+    assert(timer.empty());
+    timer.shutdown();
+}
+
+void test_stealing_pool() {
+    std::atomic<int> count{0};
+    {
+        service::pool pool(4, service::pool::stealing);
+        assert(pool.mode() == service::pool::stealing);
+        for (auto outer = 0; outer < 100; ++outer) {
+            assert(pool.dispatch([&pool, &count] {
+                ++count;
+                for (auto inner = 0; inner < 9; ++inner)
+                    pool.dispatch([&count] { ++count; });
+            }));
+        }
+        while (count < 1000)
+            this_thread::sleep(10);
+    }
+    assert(count == 1000);
+}
+
+void test_placement() {
+    const auto cpu = thread::topology().nodes.front().cpus.front();
+    thread::placement_t where{"busuto-worker", {{cpu}}};
+    std::atomic<int> placed{0};
+    service::pool pool(service::pool::stealing);
+    pool.placement(where).start(2);
+    try {
+        pool.placement({});
+        assert(false && "placement of running pool");
+    } catch (const std::runtime_error&) { // NOLINT
+    }
+
+    for (auto count = 0; count < 2; ++count) {
+        pool.dispatch([&placed, cpu] {
+            char name[16]{};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            if (std::string_view(name).starts_with("busuto-worke") && unsigned(sched_getcpu()) == cpu)
+                ++placed;
+        });
+    }
+    while (placed < 2)
+        this_thread::sleep(10);
+    pool.shutdown();
+
+    service::tasks queue;
+    std::atomic<bool> named{false};
+    queue.placement({"queue"}).startup();
+    queue.dispatch([&named] {
+        char name[16]{};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        named = std::string_view(name) == "queue";
+    });
+    while (!named)
+        this_thread::sleep(10);
+}
+
+void test_task_lanes() {
+    service::tasks queue;
+    std::atomic<int> expired{0};
+    queue.lanes({4, 1}).expired([&expired](service::task_t&) { ++expired; });
+    queue.startup();
+
+    std::atomic<bool> gate{false}, blocked{false};
+    std::mutex lock;
+    std::string order;
+    std::atomic<int> value{0}, done{0};
+    queue.dispatch([&gate, &blocked] {
+        blocked = true;
+        while (!gate) this_thread::sleep(1);
+    });
+    while (!blocked)
+        this_thread::sleep(1);
+
+    for (auto count = 0; count < 4; ++count) {
+        queue.post([&] { const std::lock_guard guard(lock); order += 'b'; ++done; }, {.lane = 1});
+        queue.post([&] { const std::lock_guard guard(lock); order += 'c'; ++done; }, {.lane = 0});
+    }
+    for (auto count = 1; count <= 3; ++count)
+        queue.post([&value, &done, count] { value = count; ++done; }, {.lane = 1, .key = 7});
+    queue.post([&done] { ++done; }, {.deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1)});
+    assert(queue.size() == 10 && queue.size(1) == 5 && queue.coalesced() == 2);
+    assert(!queue.post([] {}, {.lane = 1, .max = 5}));
+
+    gate = true;
+    while (done < 9 || expired < 1)
+        this_thread::sleep(1);
+    queue.shutdown();
+    assert(value == 3 && done == 9);
+    assert(expired == 1 && queue.expired() == 1);
+    assert(order.find_last_of('c') < order.find_last_of('b'));
+    assert(std::count(order.begin(), order.begin() + 5, 'c') == 4);
+}
+
+void test_service_metrics() {
+    std::atomic<int> count{0};
+    service::tasks queue;
+    queue.startup();
+    for (auto task = 0; task < 10; ++task)
+        queue.dispatch([&count] { ++count; });
+    while (count < 10)
+        this_thread::sleep(1);
+    queue.shutdown();
+    const auto tasks = queue.metrics();
+
+    service::pool pool(2);
+    for (auto task = 0; task < 100; ++task)
+        pool.dispatch([&count] { ++count; });
+    while (count < 110)
+        this_thread::sleep(1);
+    pool.shutdown();
+    const auto pooled = pool.metrics();
+
+    service::timer timer;
+    timer.startup();
+    timer.once(5, [&count] { ++count; });
+    while (count < 111)
+        this_thread::sleep(1);
+    timer.shutdown();
+    const auto timed = timer.metrics();
+
+    if constexpr (metrics::enabled) {
+        assert(tasks.dispatched == 10 && tasks.completed == 10 && tasks.pending() == 0);
+        assert(tasks.wait.count == 10 && tasks.run.count == 10);
+        assert(pooled.dispatched == 100 && pooled.completed == 100 && pooled.external == 100);
+        assert(pooled.wait.count == 100 && pooled.run.count == 100);
+        assert(pooled.run.percentile(0.5) <= pooled.run.percentile(0.99));
+        assert(pooled.wait.percentile(1.0) > std::chrono::nanoseconds(0));
+        assert(timed.fired == 1 && timed.lateness.count == 1);
+    } else {
+        assert(pooled.dispatched == 0 && timed.fired == 0);
+    }
+}
+
+void test_async_logger() {
+    service::logger log;
+    log.set(0, [](const std::string& text, const char *) {
+        while (log_hold)
+            this_thread::sleep(1);
+        log_size = text.size();
+        ++logged;
+    });
+
+    const std::string large(BUSUTO_LOG_RECORD * 3, 'x');
+    log.info() << large;
+    assert(logged == 1 && log_size == large.size());
+
+    log.start();
+    assert(log.is_async());
+    std::vector<std::thread> threads;
+    for (auto id = 0; id < 4; ++id) {
+        threads.emplace_back([&log, id] {
+            for (auto count = 0; count < 250; ++count)
+                log.info() << "thread " << id << " record " << count;
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    log.flush();
+    assert(logged == 1001 && log.dropped() == 0);
+
+    log.info() << large;
+    log.flush();
+    assert(logged == 1002 && log_size == BUSUTO_LOG_RECORD);
+    log.stop();
+    assert(!log.is_async());
+
+    log_hold = true;
+    log.start(service::logger::overflow_t::drop);
+    for (auto count = 0; count < BUSUTO_LOG_QUEUE * 2; ++count)
+        log.info() << "burst " << count;
+    log_hold = false;
+    log.stop();
+    assert(log.dropped() > 0);
+    assert(logged + int(log.dropped()) == 1002 + BUSUTO_LOG_QUEUE * 2);
+
+    // records posted while stopping are written, not lost
+    const auto before = logged.load();
+    log.start();
+    threads.clear();
+    for (auto id = 0; id < 4; ++id) {
+        threads.emplace_back([&log] {
+            for (auto count = 0; count < 1000; ++count)
+                log.info() << "racing " << count;
+        });
+    }
+    this_thread::sleep(1);
+    log.stop();
+    for (auto& thread : threads)
+        thread.join();
+    assert(logged == before + 4000);
+}
+
+void test_fatal_flush() {
+    int fds[2];
+    assert(::pipe(fds) == 0);
+    auto pid = ::fork();
+    if (!pid) {
+        ::close(fds[0]);
+        log_pipe = fds[1];
+        service::logger log;
+        log.set(0, [](const std::string&, const char *) {
+            this_thread::sleep(1);
+            (void)::write(log_pipe, ".", 1);
+        });
+        log.start();
+        for (auto count = 0; count < 20; ++count)
+            log.info() << count;
+        log.fatal(3) << "fatal";
+    }
+
+    ::close(fds[1]);
+    char buf[64];
+    std::size_t total{0};
+    for (auto got = ::read(fds[0], buf, sizeof(buf)); got > 0; got = ::read(fds[0], buf, sizeof(buf)))
+        total += std::size_t(got);
+    ::close(fds[0]);
+    int status{0};
+    assert(::waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+    assert(total == 21);
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
     try {
-        test_timer();
+        test_timer<service::timer>();
+        test_timer<service::wheel_timer>();
+        test_timer_wheel();
+        test_timer_self_cancel();
+        test_stealing_pool();
+        test_placement();
+        test_task_lanes();
+        test_service_metrics();
+        test_async_logger();
+        test_fatal_flush();
     } catch (...) {
         return -1;
     }
@@ -48,6 +48,36 @@ void test_socket_bind() {
     assert(is(b1));
 }
 
+void test_interfaces() {
+    interfaces_t nets;
+    assert(nets.size() > 0 && nets.handle() > -1);
+    auto lo = nets.find("lo");
+    assert(lo && lo->index > 0 && lo->is_up());
+    assert(nets.find(lo->index) == lo);
+    assert(!nets.find("no-such-interface") && !nets.find(0U));
+
+    const auto local = socket::address::from_string("127.0.0.1");
+    assert(nets.find(local.data()) == lo);
+    const auto subnet = socket::address::from_string("127.0.0.2");
+    assert(nets.find(subnet.data()) == lo);
+    assert(lo->find(AF_INET) && *lo->find(AF_INET) == local);
+
+    auto list = nets.list();
+    assert(list.size() == nets.size() && list.front()->index <= list.back()->index);
+
+    auto calls = 0;
+    auto id = nets.subscribe([&calls](interfaces_t::change_t, const interfaces_t::interface_t&) { ++calls; });
+    const auto changes = nets.update();
+    assert(calls == int(changes));
+    nets.unsubscribe(id);
+    assert(nets.update() == 0 && nets.find("lo") == lo);
+
+    auto bound = bind_address(nets, "lo", 5060, AF_INET);
+    assert(bound.to_string() == "127.0.0.1:5060");
+    assert(is(bind_address(nets, "[*]", 5060)));
+    assert(!is(bind_address(nets, "no-such-interface", 5060)));
+}
+
 void test_socket_resolver() {
     auto list = socket::lookup(socket::from_host("localhost"), AF_INET);
     assert(list.front() != nullptr);
@@ -58,6 +88,124 @@ void test_socket_resolver() {
     assert(addr.to_string() == "127.0.0.1");
     assert(addr.port() == 0);
 }
+
+void test_resolver_cache() {
+    std::atomic<int> calls{0};
+    resolver_cache cache(std::chrono::seconds(60), std::chrono::seconds(60), 4, [&calls](const socket::name_t& name, int family, int type, int protocol) {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (name.first == "missing") return socket::service{};
+        if (name.first == "broken" && calls < 9) throw std::runtime_error("transient");
+        return socket::lookup({"127.0.0.1", name.second}, family, type, protocol);
+    });
+
+    auto first = cache.resolve({"host", "80"}, AF_INET);
+    auto second = cache.resolve({"host", "80"}, AF_INET);
+    assert(first.get() == second.get());
+    assert(calls == 1 && cache.misses() == 1 && cache.coalesced() == 1);
+    const socket::address addr = first.get()->c_sockaddr();
+    assert(addr.to_string() == "127.0.0.1:80" && addr.port() == 80);
+
+    assert(cache.lookup({"host", "80"}, AF_INET) == first.get());
+    assert(cache.hits() == 1 && calls == 1);
+    assert(cache.lookup({"host", "80"}, AF_INET, SOCK_DGRAM) != first.get());
+    assert(calls == 2 && cache.size() == 2);
+
+    assert(cache.lookup({"missing", ""})->empty());
+    assert(cache.lookup({"missing", ""})->empty());
+    assert(calls == 3 && cache.hits() == 2);
+
+    for (auto port : {"1", "2", "3"})
+        cache.lookup({"host", port});
+    assert(cache.size() == 4 && calls == 6);
+    cache.clear();
+    assert(cache.size() == 0);
+
+    // a lookup that throws is retried rather than cached as missing
+    auto thrown = 0;
+    try {
+        cache.lookup({"broken", ""});
+    } catch (const std::runtime_error&) {
+        ++thrown;
+    }
+    assert(thrown == 1 && calls == 7 && cache.size() == 0);
+    try {
+        cache.lookup({"broken", ""});
+    } catch (const std::runtime_error&) {
+        ++thrown;
+    }
+    assert(thrown == 2 && calls == 8);
+    assert(!cache.lookup({"broken", ""})->empty() && calls == 9);
+
+    resolver_cache nocache(std::chrono::seconds(0), std::chrono::seconds(0));
+    auto local = nocache.lookup({"127.0.0.1", ""}, AF_INET);
+    assert(local && !local->empty());
+    assert(nocache.size() == 0 && nocache.misses() == 1);
+}
+
+auto bound_udp() {
+    auto so = make_socket(AF_INET, SOCK_DGRAM);
+    auto addr = socket::address::from_string("127.0.0.1", 0);
+    assert(::bind(so, addr.data(), addr.size()) == 0);
+    socklen_t len = addr.max();
+    assert(::getsockname(so, addr.data(), &len) == 0);
+    return std::make_pair(std::move(so), addr);
+}
+
+void test_datagram_batch() {
+    auto [rx_so, rx_addr] = bound_udp();
+    auto [tx_so, tx_addr] = bound_udp();
+    socket::datagram rx(std::move(rx_so), 16, 2048);
+    socket::datagram tx(std::move(tx_so), 8);
+    assert(rx && tx && rx.capacity() == 16);
+    assert(rx.receive(0) == 0 && rx.empty());
+
+    std::vector<std::string> lines;
+    for (auto count = 0; count < 9; ++count)
+        lines.push_back("packet " + std::to_string(count));
+    for (auto count = 0; count < 8; ++count)
+        assert(tx.queue(rx_addr, lines[count]));
+    assert(!tx.queue(rx_addr, lines[8]));
+    assert(tx.flush() == 8 && tx.pending() == 0);
+    assert(tx.queue(rx_addr, lines[8]) && tx.flush() == 1);
+
+    std::size_t total{0};
+    while (total < 9) {
+        auto count = rx.receive(1000);
+        assert(count > 0);
+        for (const auto& packet : rx) {
+            const std::string_view text(reinterpret_cast<const char *>(packet.data.data()), packet.data.size());
+            assert(text == lines[total++]);
+            assert(*packet.peer == tx_addr);
+        }
+    }
+
+    // with gso one message goes out as several datagrams; with gro they
+    // may come back as one message that receive splits again
+    if constexpr (socket::datagram::offload) {
+        socket::datagram big(make_socket(AF_INET, SOCK_DGRAM), 4, 65536);
+        auto [gro_so, gro_addr] = bound_udp();
+        socket::datagram sink(std::move(gro_so), 4, 65536);
+        sink.gro();
+        std::vector<std::byte> payload(4500);
+        for (std::size_t pos = 0; pos < payload.size(); ++pos)
+            payload[pos] = std::byte(pos / 1000);
+        assert(big.queue(gro_addr, payload, 1000));
+        if (big.flush() == 1) {
+            std::size_t parts{0}, bytes{0};
+            while (bytes < payload.size()) {
+                assert(sink.receive(1000) > 0);
+                for (const auto& packet : sink) {
+                    assert(packet.data.size() == (parts < 4 ? 1000U : 500U));
+                    assert(packet.data[0] == std::byte(parts));
+                    bytes += packet.data.size();
+                    ++parts;
+                }
+            }
+            assert(parts == 5);
+        }
+    }
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -65,7 +213,10 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_socket_any();
         test_socket_addr();
         test_socket_bind();
+        test_interfaces();
         test_socket_resolver();
+        test_resolver_cache();
+        test_datagram_batch();
     } catch (const std::exception& e) {
         output::exit(-1) << "ERR " << e.what();
     }
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "streams.hpp"
+#include "binary.hpp"
+
+#include <cassert>
+#include <string>
+#include <sys/socket.h>
+
+using namespace busuto;
+
+namespace {
+auto receive(int fd, std::size_t size) {
+    std::string text;
+    char buf[4096];
+    while (text.size() < size) {
+        auto len = ::recv(fd, buf, sizeof(buf), 0);
+        if (len <= 0) break;
+        text.append(buf, std::size_t(len));
+    }
+    return text;
+}
+
+auto pending(int fd) {
+    char buf[1];
+    return ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT | MSG_PEEK) > 0;
+}
+
+void test_streams_writev() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    auto stream = make_stream<64>(pair[0]);
+
+    const std::string_view head = "head:";
+    const std::string body = "small";
+    stream << "<";
+    assert(stream.writev(head, body));
+    assert(!pending(pair[1]));
+    stream.flush();
+    assert(receive(pair[1], 11) == "<head:small");
+
+    const std::string large(5000, 'x');
+    const byte_array tail(std::u8string(u8"tail"));
+    stream << "<";
+    assert(stream.writev(head, large, tail));
+    auto text = receive(pair[1], 5010);
+    assert(text.size() == 5010 && text.starts_with("<head:x") && text.ends_with("xtail"));
+
+    stream << "a";
+    stream.write(large.data(), std::streamsize(large.size()));
+    assert(receive(pair[1], 5001) == "a" + large);
+    assert(!pending(pair[1]));
+
+    stream.close();
+    ::close(pair[1]);
+}
+
+void test_streams_sendfile() {
+    char path[] = "/tmp/busuto-streamsXXXXXX";
+    auto file = ::mkstemp(path);
+    assert(file >= 0);
+    ::unlink(path);
+    std::string data;
+    for (int count = 0; count < 1000; ++count)
+        data += std::to_string(count) + ",";
+    assert(::write(file, data.data(), data.size()) == ssize_t(data.size()));
+
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    auto stream = make_stream<64>(pair[0]);
+    stream << "body:";
+    assert(stream.sendfile(file, 2, data.size() - 2) == data.size() - 2);
+    assert(receive(pair[1], data.size() + 3) == "body:" + data.substr(2));
+
+    stream.close();
+    ::close(pair[1]);
+    ::close(file);
+}
+
+void test_streams_pooled() {
+    using system::buffer_pool;
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    const auto base = buffer_pool::borrowed();
+    {
+        pooled_stream stream(pair[0]);
+        assert(buffer_pool::borrowed() == base && stream.size() == 0);
+
+        stream << "hello" << std::flush;
+        assert(receive(pair[1], 5) == "hello");
+        assert(buffer_pool::borrowed() == base);
+
+        // a frame larger than the smallest class grows the input buffer
+        const std::string large(buffer_pool::size(0) * 3, 'x');
+        const std::string frame = "line\r\n" + large + "\r\n";
+        assert(::write(pair[1], frame.data(), frame.size()) == ssize_t(frame.size()));
+        assert(stream.getview() == "line");
+        assert(buffer_pool::borrowed() == base + 1);
+        assert(stream.getview() == large);
+        stream.idle();
+        assert(buffer_pool::borrowed() == base);
+
+        assert(::write(pair[1], "tail\n", 5) == 5);
+        std::string tail;
+        std::getline(stream, tail);
+        assert(tail == "tail");
+        stream.idle();
+        assert(buffer_pool::borrowed() == base);
+        stream.close();
+    }
+    assert(buffer_pool::borrowed() == base);
+    ::close(pair[1]);
+}
+
+void test_streams_getview() {
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    ::fcntl(pair[0], F_SETFL, ::fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+    auto stream = make_stream<64>(pair[0]);
+
+    // a delimiter split across reads is found once the rest arrives
+    assert(::write(pair[1], "hello wor", 9) == 9);
+    assert(stream.getview().empty());
+    assert(::write(pair[1], "ld\r", 3) == 3);
+    assert(stream.getview().empty());
+    assert(::write(pair[1], "\nnext\r\n", 7) == 7);
+    assert(stream.getview() == "hello world");
+    assert(stream.getview() == "next");
+
+    const std::string body(40, 'b');
+    const std::string message = body + "\r\n\r\n";
+    assert(::write(pair[1], message.data(), message.size()) == ssize_t(message.size()));
+    assert(stream.getview("\r\n\r\n") == body);
+    stream.close();
+    ::close(pair[1]);
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_streams_writev();
+        test_streams_sendfile();
+        test_streams_pooled();
+        test_streams_getview();
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include "strings.hpp"
 #include "keyfile.hpp"
 #include "print.hpp"
+#include "buffer.hpp"
+#include "safe.hpp"
 #include <cassert>
 
 using namespace busuto::strings;
@@ -73,6 +75,74 @@ auto test_string_tokenizer() {
     assert(args[3] == "' command group '");
     assert(args[4] == "line");
 }
+
+auto test_string_views() {
+    static_assert(std::ranges::forward_range<split_view>);
+    static_assert(std::ranges::view<tokenize_view>);
+    static_assert(std::ranges::distance(split_view("a,b,,c", ",")) == 4);
+
+    std::vector<std::string_view> parts;
+    for (auto part : split_view("GET /index.html HTTP/1.1", " "))
+        parts.push_back(part);
+    assert(parts.size() == 3 && parts[1] == "/index.html");
+
+    parts.clear();
+    for (auto part : split_view("key: value: more", ":", 2))
+        parts.push_back(part);
+    assert(parts.size() == 2 && parts[0] == "key" && parts[1] == " value: more");
+    assert(std::ranges::distance(split_view("", ",")) == 1);
+    assert(*std::ranges::next(split_view("a,", ",").begin()) == "");
+
+    const std::string cmd = "  this is a ' command group ' {x y} line ";
+    auto tokens = tokenize_view(cmd);
+    assert(std::ranges::distance(tokens) == 6);
+    auto pos = tokens.begin();
+    std::ranges::advance(pos, 3);
+    assert(*pos == "' command group '");
+    assert(*++pos == "{x y}");
+    assert(*++pos == "line");
+    assert(std::ranges::distance(tokenize_view("   ")) == 0);
+    assert(*tokenize_view("'open ended", " ").begin() == "'open");
+
+    std::array<std::string_view, 3> fields;
+    assert(split_into("a:b:c:d", fields, ":") == 3);
+    assert(fields[0] == "a" && fields[2] == "c:d");
+    assert(split_into("a", fields, ":") == 1);
+    assert(fields[0] == "a" && fields[1].empty() && fields[2].empty());
+}
+
+auto test_string_join() {
+    const std::vector<std::string> list{"cpu", "12", "", "idle"};
+    assert(join(list) == "cpu,12,,idle");
+    assert(join(list, ", ") == "cpu, 12, , idle");
+    assert(join(std::vector<std::string>{}).empty());
+    assert(joined_size(list, ", ") == 15);
+
+    const auto views = split<std::string_view>("a b c");
+    static_assert(std::is_same_v<decltype(join(views)), std::string>);
+    assert(join(views, "-") == "a-b-c");
+
+    char line[32]{};
+    auto end = join_to(&line[0], split_view("x y z"), "|");
+    assert(std::string_view(line, end) == "x|y|z");
+
+    std::string text = "head:";
+    assert(join_to(text, views, ":") == "head:a:b:c");
+
+    stringbuf<8> small;
+    join_to(small, views, ",");
+    assert(std::string_view(small.data(), small.size()) == "a,b,c");
+    try {
+        join_to(small, list);
+        assert(false);
+    } catch (const range&) {
+        assert(small.size() <= small.capacity());
+    }
+
+    format_buffer<64> buf;
+    join_to(buf, list, ";");
+    assert(buf.to_string() == "cpu;12;;idle");
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -83,6 +153,8 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_string_split();
         test_string_is_expressions();
         test_string_tokenizer();
+        test_string_views();
+        test_string_join();
     } catch (...) {
         return -1;
     }
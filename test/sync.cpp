@@ -5,6 +5,8 @@
 #include "sync.hpp"
 #include "pipeline.hpp"
 #include "atomic.hpp"
+#include <string>
+#include <vector>
 #include <cassert>
 
 using namespace busuto;
@@ -56,6 +58,123 @@ void test_sync_waitgroup() {
     }
     assert(wg.count() == 0);
 }
+
+void test_sync_pipeline() {
+    system::pipeline<int, 2> pipe;
+    std::vector<std::thread> producers;
+    for (int id = 0; id < 3; ++id) {
+        producers.emplace_back([&pipe] {
+            for (int count = 1; count <= 100; ++count)
+                pipe.push(count);
+        });
+    }
+
+    int total{0}, item{0};
+    for (int count = 0; count < 300; ++count) {
+        assert(pipe.pull(item));
+        total += item;
+    }
+
+    for (auto& thread : producers)
+        thread.join();
+    assert(total == 3 * 5050);
+    assert(pipe.empty());
+}
+
+void test_sync_pipeline_batch() {
+    system::notify_pipeline<std::string, 8> pipe;
+    int item{0};
+    std::string text;
+    assert(!pipe.try_pull(text));
+    assert(!pipe.pull_for(text, std::chrono::milliseconds(1)));
+
+    std::vector<std::string> input{"a", "b", "c", "d", "e"};
+    assert(pipe.push_range(input.begin(), input.end()) == 5);
+    assert(pipe.try_push(std::string("f")));
+    assert(pipe.wait(0));
+
+    std::vector<std::string> out;
+    assert(pipe.pull_batch(std::back_inserter(out), 4, std::chrono::milliseconds(0)) == 4);
+    assert(out[0] == "a" && out[3] == "d");
+    assert(pipe.wait(0));
+    assert(pipe.pull_batch(std::back_inserter(out), 8) == 2);
+    assert(out.size() == 6 && out[5] == "f");
+    assert(!pipe.wait(0));
+    assert(pipe.pull_batch(std::back_inserter(out), 8, std::chrono::milliseconds(1)) == 0);
+
+    system::pipeline<int, 4> small;
+    std::vector<int> values(20);
+    for (auto& value : values)
+        value = ++item;
+    std::thread producer([&] {
+        assert(small.push_range(values.begin(), values.end()) == 20);
+    });
+
+    int total{0}, batch[3];
+    for (int count = 0; count < 20;) {
+        auto taken = small.pull_batch(&batch[0], 3, std::chrono::milliseconds(100));
+        for (std::size_t pos = 0; pos < taken; ++pos)
+            total += batch[pos];
+        count += int(taken);
+    }
+    producer.join();
+    assert(total == 210);
+    assert(small.try_push(1) && small.pull_for(item, std::chrono::milliseconds(1)) && item == 1);
+}
+void test_sync_futex_waits() {
+    sync::wait_group group;
+    assert(group.wait_for(std::chrono::milliseconds(1)));
+    group += 1;
+    assert(!group.wait_for(std::chrono::milliseconds(5)));
+    assert(group.release() && group.count() == 0);
+    assert(group.release()); // already done
+
+    constexpr unsigned tasks = 4000;
+    group.add(tasks);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&group] {
+            for (unsigned count = 0; count < tasks / 4; ++count) {
+                const sync::group_scope done(group);
+            }
+        });
+    }
+    group.wait();
+    assert(group.count() == 0);
+    for (auto& thread : threads)
+        thread.join();
+
+    sync::event ready;
+    assert(!ready.try_wait());
+    assert(!ready.wait_for(sync::duration(5)));
+    ready.signal();
+    ready.signal();
+    assert(ready.try_wait() && !ready.try_wait());
+    auto copy = ready;
+    std::thread signaller([copy]() mutable {
+        this_thread::sleep(20);
+        copy.signal();
+    });
+    assert(ready.wait_for(sync::duration(5000)));
+    signaller.join();
+
+    int phases{0};
+    sync::barrier bar(3, [&phases] { ++phases; });
+    std::vector<std::thread> party;
+    for (int thread = 0; thread < 2; ++thread) {
+        party.emplace_back([&bar, thread] {
+            bar.arrive_and_wait();
+            sync::barrier_scope scope(bar);
+            if (thread) scope.drop();
+        });
+    }
+    bar.arrive_and_wait();
+    assert(phases == 1);
+    bar.arrive_and_wait(); // thread 0 waits, thread 1 drops
+    for (auto& thread : party)
+        thread.join();
+    assert(phases == 2);
+}
 } // end namespace
 
 auto main(int /* argc */, char ** /* argv */) -> int {
@@ -64,6 +183,9 @@ auto main(int /* argc */, char ** /* argv */) -> int {
         test_sync_semaphore();
         test_sync_barrier();
         test_sync_event();
+        test_sync_pipeline();
+        test_sync_pipeline_batch();
+        test_sync_futex_waits();
     } catch (...) {
         return -1;
     }
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "system.hpp"
+#include "print.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <sys/wait.h>
+
+using namespace busuto;
+
+namespace {
+auto make_pipe() {
+    int fds[2]{-1, -1};
+    assert(::pipe2(fds, O_CLOEXEC) == 0);
+    return std::make_pair(handle_t(fds[0], [](int fd) { ::close(fd); }), handle_t(fds[1], [](int fd) { ::close(fd); }));
+}
+
+auto read_all(const handle_t& from) {
+    std::string text;
+    char buf[256];
+    for (;;) {
+        const auto got = ::read(from, buf, sizeof(buf));
+        if (got <= 0) break;
+        text.append(buf, std::size_t(got));
+    }
+    return text;
+}
+
+auto exit_code(pid_t pid) {
+    int status{0};
+    assert(::waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+void test_spawn() {
+    auto [input, output] = make_pipe();
+    spawn_t spawn;
+    spawn.redirect(1, output).chdir("/");
+    assert(spawn);
+    auto pid = at_spawn({"sh", "-c", "pwd; exit 2"}, {}, {}, spawn);
+    assert(pid > 0);
+    output.close();
+    assert(read_all(input) == "/\n");
+    assert(exit_code(pid) == 2);
+
+    spawn_t env;
+    auto [env_in, env_out] = make_pipe();
+    env.redirect(1, env_out).defaults().group();
+    pid = env.run({"sh", "-c", "echo $VALUE"}, {}, {"VALUE=spawned"});
+    assert(pid > 0 && ::getpgid(pid) == pid);
+    env_out.close();
+    assert(read_all(env_in) == "spawned\n");
+    assert(exit_code(pid) == 0);
+
+    spawn_t missing;
+    assert(missing.run({"busuto-no-such-command"}) == -1 && errno == ENOENT);
+    assert(missing.run({}) == -1 && errno == EINVAL);
+
+    const handle_t closed;
+    spawn_t bad;
+    bad.redirect(1, closed);
+    assert(!bad && bad.error() == EBADF);
+    assert(bad.run({"true"}) == -1 && errno == EBADF);
+}
+
+void test_zygote() {
+    zygote_t zygote;
+    assert(zygote && zygote.pid() > 0);
+
+    auto [input, output] = make_pipe();
+    auto pid = zygote.spawn({"sh", "-c", "echo $0 $VALUE; exit 3", "zygote"}, {{1, output}}, "sh", {"VALUE=child"});
+    assert(pid > 0);
+    output.close();
+    assert(read_all(input) == "zygote child\n");
+    auto status = zygote.wait(pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+
+    auto [stdin_in, stdin_out] = make_pipe();
+    pid = zygote.spawn({"sh", "-c", "read line || exit 1"}, {{0, stdin_in}});
+    assert(pid > 0);
+    assert(zygote.wait(pid, 20) == -1 && errno == ETIMEDOUT);
+    stdin_out.close();
+    status = zygote.wait(pid, 5000);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+
+    assert(zygote.spawn({"busuto-no-such-command"}) == -1 && errno == ENOENT);
+    assert(zygote.spawn({"true"}, {{1, -1}}) == -1 && errno == EBADF);
+
+    // several in flight, waited out of order
+    pid_t pids[4]{};
+    for (auto& child : pids) {
+        child = zygote.spawn({"true"});
+        assert(child > 0);
+    }
+    for (auto pos = 4; pos-- > 0;) {
+        status = zygote.wait(pids[pos]);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    // exits read by a spawn on another thread still reach their waiters
+    for (auto round = 0; round < 20; ++round) {
+        const auto waited = zygote.spawn({"true"});
+        assert(waited > 0);
+        std::atomic<int> result{-1};
+        std::thread waiter([&] {
+            result = zygote.wait(waited, 5000);
+        });
+        for (auto count = 0; count < 5; ++count) {
+            const auto other = zygote.spawn({"true"});
+            assert(other > 0);
+            assert(WIFEXITED(zygote.wait(other, 5000)));
+        }
+        waiter.join();
+        assert(WIFEXITED(result.load()) && WEXITSTATUS(result.load()) == 0);
+    }
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_spawn();
+        test_zygote();
+    } catch (const std::exception& e) {
+        print("ERR: {}\n", e.what());
+        return -1;
+    }
+    return 0;
+}
@@ -4,6 +4,7 @@
 #undef NDEBUG
 #include "threads.hpp"
 #include <cassert>
+#include <string_view>
 
 using namespace busuto;
 
@@ -16,6 +17,36 @@ void test_sleep() {
     }
 }
 
+void test_topology() {
+    const auto& topo = thread::topology();
+    assert(!topo.nodes.empty() && !topo.nodes.front().cpus.empty());
+    std::size_t total{0};
+    for (const auto& node : topo.nodes)
+        total += node.cpus.size();
+    assert(topo.spread().size() == total);
+    assert(topo.find(topo.nodes.front().id) == &topo.nodes.front());
+
+    thread::placement_t where;
+    assert(!where && where.select(3).empty());
+    where.cpus = {{0, 1}, {2}};
+    assert(where.select(1) == thread::cpus_t{2} && where.select(2).size() == 2);
+    where.cpus.clear();
+    where.topology = true;
+    assert(where.select(0).size() == 1);
+    where.topology = false;
+    where.node = topo.nodes.front().id;
+    assert(where.select(5) == topo.nodes.front().cpus);
+
+    thread::placement_t named{"a-long-worker-name", {{topo.nodes.front().cpus.front()}}};
+    named.node = -1;
+    std::thread([&named] {
+        assert(named.apply(12, 16));
+        char name[16]{};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        assert(std::string_view(name) == "a-long-worker12");
+    }).join();
+}
+
 void test_atomic() {
     std::atomic<int> total = 0;
     thread::parallel_func(3, [&total] {
@@ -37,6 +68,7 @@ void test_notify() {
 auto main(int /* argc */, char ** /* argv */) -> int {
     assert(std::at_quick_exit([] {}) == 0);
     test_sleep();
+    test_topology();
     test_atomic();
     test_notify();
     std::quick_exit(0);
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025 David Sugar <tychosoft@gmail.com>
+
+#undef NDEBUG
+#include "trace.hpp"
+#include "service.hpp"
+#include "print.hpp"
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+using namespace busuto;
+
+namespace {
+auto count_of(const std::string& text, std::string_view what) {
+    std::size_t count{0};
+    for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + what.size()))
+        ++count;
+    return count;
+}
+
+auto drain() {
+    std::ostringstream out;
+    trace::write_json(out);
+    return out.str();
+}
+
+void test_spans() {
+    trace::enable(false);
+    { BUSUTO_TRACE_SPAN("unseen"); }
+    assert(drain().find("unseen") == std::string::npos);
+
+    trace::enable();
+    trace::thread_name("main \"thread\"");
+    {
+        BUSUTO_TRACE_SPAN("outer", "test");
+        BUSUTO_TRACE_SPAN("inner", "test");
+    }
+    std::thread([] {
+        trace::thread_name("helper");
+        BUSUTO_TRACE_SPAN("helper span");
+    }).join();
+
+    std::ostringstream out;
+    assert(trace::write_json(out) == 3);
+    const auto json = out.str();
+    assert(json.starts_with("{\"traceEvents\":[") && json.ends_with("],\"displayTimeUnit\":\"ns\"}\n"));
+    assert(json.find(R"("name":"outer","cat":"test","ph":"X")") != std::string::npos);
+    assert(json.find(R"("name":"inner")") != std::string::npos);
+    assert(json.find(R"("name":"helper span","cat":"busuto")") != std::string::npos);
+    assert(json.find(R"("args":{"name":"main \"thread\""})") != std::string::npos);
+    assert(json.find(R"("args":{"name":"helper"})") != std::string::npos);
+    assert(count_of(json, "\"ph\":\"X\"") == 3);
+
+    // drained, and the exited helper ring is gone with its name
+    const auto again = drain();
+    assert(count_of(again, "\"ph\":\"X\"") == 0 && again.find("helper") == std::string::npos);
+}
+
+void test_ring_overflow() {
+    trace::enable();
+    const auto before = trace::dropped();
+    for (int count = 0; count < BUSUTO_TRACE_EVENTS + 10; ++count)
+        trace::record({"flood", "test", trace::now(), trace::now()});
+    std::ostringstream out;
+    assert(trace::write_json(out) == BUSUTO_TRACE_EVENTS - 1);
+    assert(trace::dropped() - before == 11);
+}
+
+void test_service_spans() {
+    trace::enable();
+    service::tasks queue;
+    queue.startup();
+    std::atomic<int> done{0};
+    queue.dispatch([&done] { ++done; });
+    service::pool pool(2);
+    pool.dispatch([&done] { ++done; });
+    service::timer timer;
+    timer.startup();
+    timer.once(std::chrono::milliseconds(1), [&done] { ++done; });
+    while (done < 3)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    timer.shutdown();
+    pool.shutdown();
+    queue.shutdown();
+
+    const auto json = drain();
+    assert(json.find(R"("name":"task","cat":"tasks")") != std::string::npos);
+    assert(json.find(R"("name":"task","cat":"pool")") != std::string::npos);
+    assert(json.find(R"("name":"timer","cat":"timer")") != std::string::npos);
+}
+
+void test_exporter() {
+    const std::string path = "/tmp/busuto-trace-" + std::to_string(::getpid()) + ".json";
+    {
+        trace::exporter exporter(SIGUSR2, path);
+        assert(trace::enabled());
+        { BUSUTO_TRACE_SPAN("before signal"); }
+        ::raise(SIGUSR2);
+        for (int wait = 0; wait < 2000 && !exporter.exports(); ++wait)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        assert(exporter.exports() == 1);
+    }
+    assert(!trace::enabled());
+    std::ifstream in(path);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("before signal") != std::string::npos);
+    ::unlink(path.c_str());
+}
+} // end namespace
+
+auto main(int /* argc */, char ** /* argv */) -> int {
+    try {
+        test_spans();
+        test_ring_overflow();
+        test_service_spans();
+        test_exporter();
+    } catch (const std::exception& e) {
+        print("ERR: {}\n", e.what());
+        return -1;
+    }
+    return 0;
+}